@@ -27,10 +27,14 @@ void CalibrationChoiceDialog::initialize()
     auto stereoCameraDocument = new QListWidgetItem( tr("Stereo calibration from camera") );
     stereoCameraDocument->setData( Qt::UserRole, STEREO_CAMERA );
 
+    auto simulatedStereoCameraDocument = new QListWidgetItem( tr("Stereo calibration from simulated camera") );
+    simulatedStereoCameraDocument->setData( Qt::UserRole, SIMULATED_STEREO_CAMERA );
+
     m_listWidget->addItem( monocularImageDocument );
     m_listWidget->addItem( stereoImageDocument );
     m_listWidget->addItem( monocularCameraDocument );
     m_listWidget->addItem( stereoCameraDocument );
+    m_listWidget->addItem( simulatedStereoCameraDocument );
 
     m_listWidget->setSelectionMode( QListWidget::SingleSelection );
 
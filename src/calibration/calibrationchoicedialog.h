@@ -7,7 +7,7 @@ class CalibrationChoiceDialog : public DialogBase
     Q_OBJECT
 
 public:
-    enum DocumentType { NONE, MONOCULAR_IMAGE, STEREO_IMAGE, MONOCULAR_CAMERA, STEREO_CAMERA };
+    enum DocumentType { NONE, MONOCULAR_IMAGE, STEREO_IMAGE, MONOCULAR_CAMERA, STEREO_CAMERA, SIMULATED_STEREO_CAMERA };
 
     explicit CalibrationChoiceDialog( QWidget* parent = nullptr );
 
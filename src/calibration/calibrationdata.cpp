@@ -10,6 +10,7 @@ MonocularCalibrationResult::MonocularCalibrationResult()
 
 void MonocularCalibrationResult::initialize()
 {
+    m_error = 0.;
     m_ok = false;
 }
 
@@ -53,6 +54,16 @@ const std::vector< cv::Point3f > &MonocularCalibrationResult::points3d() const
     return m_points3d;
 }
 
+void MonocularCalibrationResult::setError( const double value )
+{
+    m_error = value;
+}
+
+double MonocularCalibrationResult::error() const
+{
+    return m_error;
+}
+
 void MonocularCalibrationResult::setOk( const bool value )
 {
     m_ok = value;
@@ -98,6 +109,11 @@ unsigned int MonocularCalibrationData::resultsSize() const
     return m_results.size();
 }
 
+unsigned int MonocularCalibrationData::rejectedSize() const
+{
+    return std::count_if( m_results.begin(), m_results.end(), []( const MonocularCalibrationResult &result ) { return !result.isOk(); } );
+}
+
 void MonocularCalibrationData::setPreviewImage( const CvImage &image )
 {
     m_previewImage = image;
@@ -22,6 +22,9 @@ public:
     void setPoints3d( const std::vector< cv::Point3f > &value );
     const std::vector< cv::Point3f > &points3d() const;
 
+    void setError( const double value );
+    double error() const;
+
     void setOk( const bool value );
     bool isOk() const;
 
@@ -32,6 +35,8 @@ protected:
     std::vector< cv::Point2f > m_points2d;
     std::vector< cv::Point3f > m_points3d;
 
+    double m_error;
+
     bool m_ok;
 
 private:
@@ -51,6 +56,7 @@ public:
     const MonocularCalibrationResult &result( const unsigned int i ) const;
 
     unsigned int resultsSize() const;
+    unsigned int rejectedSize() const;
 
     void setPreviewImage( const CvImage &image );
     const CvImage &previewImage() const;
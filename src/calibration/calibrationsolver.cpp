@@ -0,0 +1,490 @@
+#include "src/common/precompiled.h"
+
+#include "calibrationsolver.h"
+
+#include <exception>
+
+// CalibrationSolverBase
+CalibrationSolverBase::CalibrationSolverBase()
+{
+    initialize();
+}
+
+void CalibrationSolverBase::initialize()
+{
+    m_warmStart = true;
+    m_maxViewError = 1.0;
+    m_rejectionFactor = 3.0;
+    m_rejectionEnabled = false;
+    m_minimumFrames = 5;
+}
+
+void CalibrationSolverBase::setWarmStart( const bool value )
+{
+    m_warmStart = value;
+}
+
+bool CalibrationSolverBase::warmStart() const
+{
+    return m_warmStart;
+}
+
+void CalibrationSolverBase::setMaxViewError( const double value )
+{
+    m_maxViewError = value;
+}
+
+double CalibrationSolverBase::maxViewError() const
+{
+    return m_maxViewError;
+}
+
+void CalibrationSolverBase::setRejectionFactor( const double value )
+{
+    m_rejectionFactor = value;
+}
+
+double CalibrationSolverBase::rejectionFactor() const
+{
+    return m_rejectionFactor;
+}
+
+void CalibrationSolverBase::setRejectionEnabled( const bool value )
+{
+    m_rejectionEnabled = value;
+}
+
+bool CalibrationSolverBase::rejectionEnabled() const
+{
+    return m_rejectionEnabled;
+}
+
+void CalibrationSolverBase::setMinimumFrames( const unsigned int value )
+{
+    m_minimumFrames = value;
+}
+
+unsigned int CalibrationSolverBase::minimumFrames() const
+{
+    return m_minimumFrames;
+}
+
+bool CalibrationSolverBase::rejectWorstView( const std::vector< double > &viewErrors, std::vector< bool > *activeViews ) const
+{
+    std::vector< double > activeErrors;
+    int worstView = -1;
+
+    for ( size_t i = 0; i < viewErrors.size(); ++i ) {
+        if ( ( *activeViews )[ i ] ) {
+            activeErrors.push_back( viewErrors[ i ] );
+
+            if ( worstView < 0 || viewErrors[ i ] > viewErrors[ worstView ] )
+                worstView = i;
+
+        }
+
+    }
+
+    if ( activeErrors.size() <= m_minimumFrames )
+        return false;
+
+    auto median = activeErrors.begin() + activeErrors.size() / 2;
+    std::nth_element( activeErrors.begin(), median, activeErrors.end() );
+
+    auto threshold = std::max( m_maxViewError, m_rejectionFactor * *median );
+
+    if ( viewErrors[ worstView ] <= threshold )
+        return false;
+
+    ( *activeViews )[ worstView ] = false;
+
+    return true;
+
+}
+
+template < class T >
+std::vector< T > CalibrationSolverBase::selectViews( const std::vector< T > &views, const std::vector< bool > &activeViews )
+{
+    std::vector< T > ret;
+    ret.reserve( views.size() );
+
+    for ( size_t i = 0; i < views.size(); ++i )
+        if ( activeViews[ i ] )
+            ret.push_back( views[ i ] );
+
+    return ret;
+
+}
+
+// MonocularCalibrationSolver
+MonocularCalibrationSolver::MonocularCalibrationSolver()
+{
+    initialize();
+}
+
+void MonocularCalibrationSolver::initialize()
+{
+}
+
+void MonocularCalibrationSolver::reset()
+{
+    m_frameSize = cv::Size();
+    m_cameraMatrix = cv::Mat();
+    m_distortionCoefficients = cv::Mat();
+
+    m_points2d.clear();
+    m_points3d.clear();
+    m_lastResult = MonocularCalibrationData();
+}
+
+MonocularCalibrationData MonocularCalibrationSolver::calibrate( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize )
+{
+    if ( points2d.size() != points3d.size() )
+        throw std::exception();
+
+    if ( m_lastResult.isOk() && frameSize == m_frameSize && points2d == m_points2d && points3d == m_points3d )
+        return m_lastResult;
+
+    std::vector< bool > activeViews( points2d.size(), true );
+
+    auto ret = calibrate( points2d, points3d, frameSize, activeViews );
+
+    if ( m_rejectionEnabled && ret.isOk() ) {
+
+        std::vector< double > viewErrors( points2d.size() );
+
+        // Every re-solve is warm started from the previous one, so it takes a few iterations only
+        while ( true ) {
+
+            for ( size_t i = 0; i < viewErrors.size(); ++i )
+                viewErrors[ i ] = ret.result( i ).error();
+
+            if ( !rejectWorstView( viewErrors, &activeViews ) )
+                break;
+
+            auto resolved = calibrate( points2d, points3d, frameSize, activeViews );
+
+            // A failed re-solve keeps the last successful solution
+            if ( !resolved.isOk() )
+                break;
+
+            ret = resolved;
+
+        }
+
+        updateRejectedErrors( points2d, points3d, &ret );
+
+    }
+
+    if ( ret.isOk() ) {
+        m_points2d = points2d;
+        m_points3d = points3d;
+        m_lastResult = ret;
+    }
+
+    return ret;
+
+}
+
+MonocularCalibrationData MonocularCalibrationSolver::calibrate( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize, const std::vector< bool > &activeViews )
+{
+    MonocularCalibrationData ret;
+
+    ret.setFrameSize( frameSize );
+
+    auto activePoints2d = selectViews( points2d, activeViews );
+    auto activePoints3d = selectViews( points3d, activeViews );
+
+    if ( activePoints2d.size() < m_minimumFrames || activePoints2d.size() != activePoints3d.size() )
+        throw std::exception();
+
+    cv::Mat cameraMatrix;
+    cv::Mat distCoeffs;
+
+    int flags = m_flags;
+
+    if ( m_warmStart && frameSize == m_frameSize && !m_cameraMatrix.empty() ) {
+        cameraMatrix = m_cameraMatrix.clone();
+        distCoeffs = m_distortionCoefficients.clone();
+        flags |= cv::CALIB_USE_INTRINSIC_GUESS;
+    }
+    else {
+        cameraMatrix = cv::Mat::eye( 3, 3, CV_64F );
+        distCoeffs = cv::Mat::zeros( 8, 1, CV_64F );
+    }
+
+    std::vector< cv::Mat > rvecs;
+    std::vector< cv::Mat > tvecs;
+    cv::Mat perViewErrors;
+
+    double rms = cv::calibrateCamera( activePoints3d, activePoints2d, frameSize, cameraMatrix, distCoeffs, rvecs, tvecs,
+                                      cv::noArray(), cv::noArray(), perViewErrors, flags );
+
+    bool ok = cv::checkRange( cameraMatrix ) && cv::checkRange( distCoeffs );
+
+    ret.setCameraMatrix( cameraMatrix );
+    ret.setDistortionCoefficients( distCoeffs );
+
+    std::vector< MonocularCalibrationResult > results( points2d.size() );
+
+    for ( size_t i = 0, j = 0; i < results.size(); ++i ) {
+        if ( activeViews[ i ] ) {
+            results[ i ].setRVec( rvecs[ j ] );
+            results[ i ].setTVec( tvecs[ j ] );
+            results[ i ].setError( perViewErrors.at< double >( j ) );
+            results[ i ].setOk( true );
+            ++j;
+        }
+
+    }
+
+    ret.setResults( results );
+    ret.setError( rms );
+    ret.setOk( ok );
+
+    if ( ok ) {
+        m_frameSize = frameSize;
+        m_cameraMatrix = cameraMatrix.clone();
+        m_distortionCoefficients = distCoeffs.clone();
+    }
+
+    return ret;
+
+}
+
+void MonocularCalibrationSolver::updateRejectedErrors( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, MonocularCalibrationData *data ) const
+{
+    if ( !data->isOk() )
+        return;
+
+    #pragma omp parallel for
+    for ( int i = 0; i < static_cast< int >( data->resultsSize() ); ++i ) {
+
+        auto &result = data->result( i );
+
+        if ( !result.isOk() && !points2d[ i ].empty() ) {
+
+            cv::Mat rvec;
+            cv::Mat tvec;
+
+            if ( cv::solvePnP( points3d[ i ], points2d[ i ], data->cameraMatrix(), data->distortionCoefficients(), rvec, tvec ) ) {
+
+                std::vector< cv::Point2f > projectedPoints;
+                cv::projectPoints( points3d[ i ], rvec, tvec, data->cameraMatrix(), data->distortionCoefficients(), projectedPoints );
+
+                double error = cv::norm( points2d[ i ], projectedPoints, cv::NORM_L2 );
+
+                result.setRVec( rvec );
+                result.setTVec( tvec );
+                result.setError( std::sqrt( error * error / projectedPoints.size() ) );
+
+            }
+
+        }
+
+    }
+
+}
+
+// StereoCalibrationSolver
+StereoCalibrationSolver::StereoCalibrationSolver()
+{
+    initialize();
+}
+
+void StereoCalibrationSolver::initialize()
+{
+    // Views are rejected jointly by the stereo error, the cameras are solved over the same set
+    m_leftSolver.setRejectionEnabled( false );
+    m_rightSolver.setRejectionEnabled( false );
+}
+
+void StereoCalibrationSolver::reset()
+{
+    m_leftSolver.reset();
+    m_rightSolver.reset();
+
+    m_rotationMatrix = cv::Mat();
+    m_translationVector = cv::Mat();
+
+    m_frameSize = cv::Size();
+    m_leftPoints.clear();
+    m_rightPoints.clear();
+    m_points3d.clear();
+    m_lastResult = StereoCalibrationData();
+}
+
+void StereoCalibrationSolver::calibrateCameras( const std::vector< std::vector< cv::Point2f > > &leftPoints, const std::vector< std::vector< cv::Point2f > > &rightPoints, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize,
+                                                const std::vector< bool > &activeViews, MonocularCalibrationData *leftData, MonocularCalibrationData *rightData )
+{
+    m_leftSolver.setWarmStart( m_warmStart );
+    m_rightSolver.setWarmStart( m_warmStart );
+    m_leftSolver.setMinimumFrames( m_minimumFrames );
+    m_rightSolver.setMinimumFrames( m_minimumFrames );
+
+    // Exceptions must not leave the parallel region, they are rethrown after it
+    std::exception_ptr exception;
+
+    #pragma omp parallel sections num_threads( 2 )
+    {
+        #pragma omp section
+        {
+            try {
+                *leftData = m_leftSolver.calibrate( leftPoints, points3d, frameSize, activeViews );
+            }
+            catch ( ... ) {
+                #pragma omp critical
+                exception = std::current_exception();
+            }
+
+        }
+
+        #pragma omp section
+        {
+            try {
+                *rightData = m_rightSolver.calibrate( rightPoints, points3d, frameSize, activeViews );
+            }
+            catch ( ... ) {
+                #pragma omp critical
+                exception = std::current_exception();
+            }
+
+        }
+
+    }
+
+    if ( exception )
+        std::rethrow_exception( exception );
+
+}
+
+StereoCalibrationData StereoCalibrationSolver::calibrate( const std::vector< std::vector< cv::Point2f > > &leftPoints, const std::vector< std::vector< cv::Point2f > > &rightPoints, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize )
+{
+    if ( leftPoints.size() != rightPoints.size() || leftPoints.size() != points3d.size() || leftPoints.size() < m_minimumFrames )
+        throw std::exception();
+
+    if ( m_lastResult.isOk() && frameSize == m_frameSize && leftPoints == m_leftPoints && rightPoints == m_rightPoints && points3d == m_points3d )
+        return m_lastResult;
+
+    if ( frameSize != m_frameSize ) {
+        m_rotationMatrix = cv::Mat();
+        m_translationVector = cv::Mat();
+    }
+
+    StereoCalibrationData ret;
+    bool solved = false;
+
+    std::vector< bool > activeViews( points3d.size(), true );
+    std::vector< double > viewErrors( points3d.size() );
+
+    while ( true ) {
+
+        MonocularCalibrationData leftData;
+        MonocularCalibrationData rightData;
+
+        calibrateCameras( leftPoints, rightPoints, points3d, frameSize, activeViews, &leftData, &rightData );
+
+        if ( !leftData.isOk() || !rightData.isOk() )
+            break;
+
+        auto activeLeftPoints = selectViews( leftPoints, activeViews );
+        auto activeRightPoints = selectViews( rightPoints, activeViews );
+        auto activePoints3d = selectViews( points3d, activeViews );
+
+        cv::Mat leftCameraMatrix = leftData.cameraMatrix().clone();
+        cv::Mat leftDistCoeffs = leftData.distortionCoefficients().clone();
+        cv::Mat rightCameraMatrix = rightData.cameraMatrix().clone();
+        cv::Mat rightDistCoeffs = rightData.distortionCoefficients().clone();
+
+        cv::Mat R;
+        cv::Mat T;
+        cv::Mat E;
+        cv::Mat F;
+        cv::Mat perViewErrors;
+
+        int flags = m_flags | cv::CALIB_USE_INTRINSIC_GUESS;
+
+        if ( m_warmStart && !m_rotationMatrix.empty() ) {
+            R = m_rotationMatrix.clone();
+            T = m_translationVector.clone();
+            flags |= cv::CALIB_USE_EXTRINSIC_GUESS;
+        }
+
+        double rms = cv::stereoCalibrate( activePoints3d, activeLeftPoints, activeRightPoints,
+                                          leftCameraMatrix, leftDistCoeffs, rightCameraMatrix, rightDistCoeffs, frameSize,
+                                          R, T, E, F, perViewErrors, flags,
+                                          cv::TermCriteria( cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 100, 1e-5 ) );
+
+        // A failed re-solve keeps the last successful solution
+        if ( !cv::checkRange( R ) || !cv::checkRange( T ) || !cv::checkRange( F ) )
+            break;
+
+        m_rotationMatrix = R.clone();
+        m_translationVector = T.clone();
+
+        for ( size_t i = 0, j = 0; i < viewErrors.size(); ++i ) {
+            if ( activeViews[ i ] ) {
+                leftData.result( i ).setError( perViewErrors.at< double >( j, 0 ) );
+                rightData.result( i ).setError( perViewErrors.at< double >( j, 1 ) );
+                viewErrors[ i ] = std::max( perViewErrors.at< double >( j, 0 ), perViewErrors.at< double >( j, 1 ) );
+                ++j;
+            }
+
+        }
+
+        leftData.setCameraMatrix( leftCameraMatrix );
+        leftData.setDistortionCoefficients( leftDistCoeffs );
+        rightData.setCameraMatrix( rightCameraMatrix );
+        rightData.setDistortionCoefficients( rightDistCoeffs );
+
+        ret.setLeftCameraResults( leftData );
+        ret.setRightCameraResults( rightData );
+
+        ret.setCorrespondFrameCount( activePoints3d.size() );
+
+        ret.setRotationMatrix( R );
+        ret.setTranslationVector( T );
+        ret.setFundamentalMatrix( F );
+        ret.setEssentialMatrix( E );
+        ret.setError( rms );
+
+        solved = true;
+
+        if ( !m_rejectionEnabled || !rejectWorstView( viewErrors, &activeViews ) )
+            break;
+
+    }
+
+    if ( !solved )
+        return ret;
+
+    m_leftSolver.updateRejectedErrors( leftPoints, points3d, &ret.leftCameraResults() );
+    m_rightSolver.updateRejectedErrors( rightPoints, points3d, &ret.rightCameraResults() );
+
+    cv::Mat R1, R2, P1, P2, Q;
+
+    cv::Rect leftROI;
+    cv::Rect rightROI;
+
+    cv::stereoRectify( ret.leftCameraResults().cameraMatrix(), ret.leftCameraResults().distortionCoefficients(),
+                       ret.rightCameraResults().cameraMatrix(), ret.rightCameraResults().distortionCoefficients(), frameSize,
+                       ret.rotationMatrix(), ret.translationVector(), R1, R2, P1, P2, Q, cv::CALIB_ZERO_DISPARITY, 1, cv::Size(), &leftROI, &rightROI );
+
+    ret.setLeftRectifyMatrix( R1 );
+    ret.setRightRectifyMatrix( R2 );
+    ret.setLeftProjectionMatrix( P1 );
+    ret.setRightProjectionMatrix( P2 );
+    ret.setLeftROI( leftROI );
+    ret.setRightROI( rightROI );
+
+    ret.setOk( true );
+
+    m_frameSize = frameSize;
+    m_leftPoints = leftPoints;
+    m_rightPoints = rightPoints;
+    m_points3d = points3d;
+    m_lastResult = ret;
+
+    return ret;
+
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "calibrationdata.h"
+
+class CalibrationSolverBase
+{
+public:
+    void setWarmStart( const bool value );
+    bool warmStart() const;
+
+    // With rejection enabled (off by default) views with reprojection error above max( maxViewError, rejectionFactor * median )
+    // are dropped one by one, a failed re-solve ends it with the last successful solution
+    void setMaxViewError( const double value );
+    double maxViewError() const;
+
+    void setRejectionFactor( const double value );
+    double rejectionFactor() const;
+
+    void setRejectionEnabled( const bool value );
+    bool rejectionEnabled() const;
+
+    void setMinimumFrames( const unsigned int value );
+    unsigned int minimumFrames() const;
+
+protected:
+    CalibrationSolverBase();
+
+    bool m_warmStart;
+    double m_maxViewError;
+    double m_rejectionFactor;
+    bool m_rejectionEnabled;
+    unsigned int m_minimumFrames;
+
+    static const int m_flags = cv::CALIB_FIX_K3 | cv::CALIB_FIX_K4 | cv::CALIB_FIX_K5;
+
+    bool rejectWorstView( const std::vector< double > &viewErrors, std::vector< bool > *activeViews ) const;
+
+    template < class T >
+    static std::vector< T > selectViews( const std::vector< T > &views, const std::vector< bool > &activeViews );
+
+private:
+    void initialize();
+
+};
+
+class MonocularCalibrationSolver : public CalibrationSolverBase
+{
+public:
+    MonocularCalibrationSolver();
+
+    void reset();
+
+    MonocularCalibrationData calibrate( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize );
+
+    // Single solve over the active views, no rejection
+    MonocularCalibrationData calibrate( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize, const std::vector< bool > &activeViews );
+
+    // Rejected views get their pose and error from solvePnP against the final intrinsics
+    void updateRejectedErrors( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, MonocularCalibrationData *data ) const;
+
+protected:
+    cv::Size m_frameSize;
+    cv::Mat m_cameraMatrix;
+    cv::Mat m_distortionCoefficients;
+
+    std::vector< std::vector< cv::Point2f > > m_points2d;
+    std::vector< std::vector< cv::Point3f > > m_points3d;
+    MonocularCalibrationData m_lastResult;
+
+private:
+    void initialize();
+
+};
+
+class StereoCalibrationSolver : public CalibrationSolverBase
+{
+public:
+    StereoCalibrationSolver();
+
+    void reset();
+
+    StereoCalibrationData calibrate( const std::vector< std::vector< cv::Point2f > > &leftPoints, const std::vector< std::vector< cv::Point2f > > &rightPoints, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize );
+
+protected:
+    MonocularCalibrationSolver m_leftSolver;
+    MonocularCalibrationSolver m_rightSolver;
+
+    cv::Mat m_rotationMatrix;
+    cv::Mat m_translationVector;
+
+    cv::Size m_frameSize;
+    std::vector< std::vector< cv::Point2f > > m_leftPoints;
+    std::vector< std::vector< cv::Point2f > > m_rightPoints;
+    std::vector< std::vector< cv::Point3f > > m_points3d;
+    StereoCalibrationData m_lastResult;
+
+    void calibrateCameras( const std::vector< std::vector< cv::Point2f > > &leftPoints, const std::vector< std::vector< cv::Point2f > > &rightPoints, const std::vector< std::vector< cv::Point3f > > &points3d, const cv::Size &frameSize,
+                           const std::vector< bool > &activeViews, MonocularCalibrationData *leftData, MonocularCalibrationData *rightData );
+
+private:
+    void initialize();
+
+};
@@ -35,6 +35,9 @@ void CalibrationWidgetBase::initialize()
     m_iconViewDialog = new ImageDialog( application()->mainWindow() );
     m_iconViewDialog->resize( 800, 600 );
 
+    m_monocularSolver.setMinimumFrames( m_minimumCalibrationFrames );
+    m_stereoSolver.setMinimumFrames( m_minimumCalibrationFrames );
+
     dropIconCount();
 
 }
@@ -43,6 +46,11 @@ void CalibrationWidgetBase::clearIcons()
 {
     m_iconsList->clear();
 
+    m_monocularSolver.reset();
+    m_stereoSolver.reset();
+
+    m_viewSelector.clear();
+
     dropIconCount();
 
 }
@@ -116,40 +124,10 @@ MonocularCalibrationData CalibrationWidgetBase::calcMonocularCalibration( const
 
 MonocularCalibrationData CalibrationWidgetBase::calcMonocularCalibration( const std::vector< std::vector< cv::Point2f > > &points2d, const std::vector< std::vector< cv::Point3f > > &points3d, cv::Size &frameSize )
 {
-    MonocularCalibrationData ret;
-
-    ret.setFrameSize( frameSize );
-
-    std::vector< MonocularCalibrationResult > results;
-
     if ( points2d.size() < m_minimumCalibrationFrames || points2d.size() != points3d.size() )
         throw std::exception();
 
-    cv::Mat cameraMatrix = cv::Mat::eye( 3, 3, CV_64F );
-    cv::Mat distCoeffs = cv::Mat::zeros( 8, 1, CV_64F );
-    std::vector< cv::Mat > rvecs;
-    std::vector< cv::Mat > tvecs;
-
-    double rms = cv::calibrateCamera( points3d, points2d, frameSize, cameraMatrix, distCoeffs, rvecs, tvecs, cv::CALIB_FIX_K3 | cv::CALIB_FIX_K4 | cv::CALIB_FIX_K5 );
-
-    bool ok = cv::checkRange( cameraMatrix ) && cv::checkRange( distCoeffs );
-
-    ret.setCameraMatrix( cameraMatrix );
-    ret.setDistortionCoefficients( distCoeffs );
-
-    for ( size_t i = 0; i < rvecs.size(); ++i ) {
-        MonocularCalibrationResult result;
-        result.setRVec( rvecs[ i ] );
-        result.setTVec( tvecs[ i ] );
-
-        results.push_back( result );
-    }
-
-    ret.setResults( results );
-    ret.setError( rms );
-    ret.setOk( ok );
-
-    return ret;
+    return m_monocularSolver.calibrate( points2d, points3d, frameSize );
 
 }
 
@@ -195,53 +173,10 @@ StereoCalibrationData CalibrationWidgetBase::calcStereoCalibration(const QList<
 
 StereoCalibrationData CalibrationWidgetBase::calcStereoCalibration( const std::vector< std::vector< cv::Point2f > > &leftPoints, const std::vector< std::vector< cv::Point2f > > &rightPoints, const std::vector<std::vector<cv::Point3f> > &points3d, cv::Size &frameSize )
 {
-    StereoCalibrationData ret;
-
     if ( leftPoints.size() != rightPoints.size() || leftPoints.size() != points3d.size() || leftPoints.size() < m_minimumCalibrationFrames )
         throw std::exception();
 
-    ret.setLeftCameraResults( calcMonocularCalibration( leftPoints, points3d, frameSize ) );
-    ret.setRightCameraResults( calcMonocularCalibration( rightPoints, points3d, frameSize ) );
-
-    ret.setCorrespondFrameCount( points3d.size() );
-
-    cv::Mat R;
-    cv::Mat T;
-    cv::Mat E;
-    cv::Mat F;
-
-    double rms = cv::stereoCalibrate( points3d, leftPoints, rightPoints,
-                                      ret.leftCameraResults().cameraMatrix(), ret.leftCameraResults().distortionCoefficients(),
-                                      ret.rightCameraResults().cameraMatrix(), ret.rightCameraResults().distortionCoefficients(), ret.leftCameraResults().frameSize(),
-                                      R, T, E, F, cv::CALIB_USE_INTRINSIC_GUESS | cv::CALIB_FIX_K3 | cv::CALIB_FIX_K4 | cv::CALIB_FIX_K5,
-                                      cv::TermCriteria( cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 100, 1e-5 ) );
-
-    ret.setRotationMatrix( R );
-    ret.setTranslationVector( T );
-    ret.setFundamentalMatrix( F );
-    ret.setEssentialMatrix( E );
-    ret.setError( rms );
-
-    cv::Mat R1, R2, P1, P2, Q;
-
-    cv::Rect leftROI;
-    cv::Rect rightROI;
-
-    cv::stereoRectify( ret.leftCameraResults().cameraMatrix(), ret.leftCameraResults().distortionCoefficients(),
-                       ret.rightCameraResults().cameraMatrix(), ret.rightCameraResults().distortionCoefficients(), ret.leftCameraResults().frameSize(),
-                       R, T, R1, R2, P1, P2, Q, cv::CALIB_ZERO_DISPARITY, 1, cv::Size(), &leftROI, &rightROI );
-
-
-    ret.setLeftRectifyMatrix( R1 );
-    ret.setRightRectifyMatrix( R2 );
-    ret.setLeftProjectionMatrix( P1 );
-    ret.setRightProjectionMatrix( P2 );
-    ret.setLeftROI( leftROI );
-    ret.setRightROI( rightROI );
-
-    ret.setOk( true );
-
-    return ret;
+    return m_stereoSolver.calibrate( leftPoints, rightPoints, points3d, frameSize );
 
 }
 
@@ -637,27 +572,37 @@ void MonocularCameraCalibrationWidget::makeIcon()
     auto result = m_processorThread.result();
 
     if ( result.exist && result.imagePoints.size() >= m_minimumCalibrationPoints ) {
-        m_iconsList->insertIcon( new MonocularIcon( result.preview, result.sourceFrame.size(),
-                                                    result.imagePoints, result.worldPoints, QObject::tr("Frame") + " " + QString::number( m_iconCount++ ) ) );
+
+        CalibrationViewPose pose( result.imagePoints, result.worldPoints, result.sourceFrame.size() );
+
+        if ( m_viewSelector.accept( pose ) ) {
+            auto icon = new MonocularIcon( result.preview, result.sourceFrame.size(),
+                                           result.imagePoints, result.worldPoints, QObject::tr("Frame") + " " + QString::number( m_iconCount++ ) );
+
+            delete m_viewSelector.add( icon, pose );
+
+            m_iconsList->insertIcon( icon );
+
+        }
 
     }
 
 }
 
 // StereoCameraCalibrationWidget
-StereoCameraCalibrationWidget::StereoCameraCalibrationWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget *parent )
+StereoCameraCalibrationWidget::StereoCameraCalibrationWidget( StereoCameraBase *camera, QWidget *parent )
     : StereoCalibrationWidgetBase( parent )
 {
-    initialize( leftCameraIp, rightCameraIp );
+    initialize( camera );
 }
 
-void StereoCameraCalibrationWidget::initialize( const QString &leftCameraIp, const QString &rightCameraIp )
+void StereoCameraCalibrationWidget::initialize( StereoCameraBase *camera )
 {
     m_splitter = new QSplitter( Qt::Vertical, this );
 
     m_layout->addWidget( m_splitter );
 
-    m_taskWidget = new StereoGrabWidget( leftCameraIp, rightCameraIp, this );
+    m_taskWidget = new StereoGrabWidget( camera, this );
     m_taskWidget->resize( 800, 600 );
 
     m_splitter->addWidget( m_taskWidget );
@@ -759,9 +704,20 @@ void StereoCameraCalibrationWidget::makeIcon()
 
     if ( result.leftExist && result.rightExist && result.leftImagePoints.size() == result.rightImagePoints.size()
          && result.leftImagePoints.size() >= m_minimumCalibrationPoints ) {
-        m_iconsList->insertIcon( new StereoIcon( result.leftPreview, result.rightPreview,
-                               result.sourceFrame.leftImage().size(), result.leftImagePoints, result.rightImagePoints, result.worldPoints,
-                               QObject::tr("Frame") + " " + QString::number( m_iconCount++ ) ) );
+
+        CalibrationViewPose pose( result.leftImagePoints, result.rightImagePoints, result.worldPoints, result.sourceFrame.leftImage().size() );
+
+        if ( m_viewSelector.accept( pose ) ) {
+            auto icon = new StereoIcon( result.leftPreview, result.rightPreview,
+                                        result.sourceFrame.leftImage().size(), result.leftImagePoints, result.rightImagePoints, result.worldPoints,
+                                        QObject::tr("Frame") + " " + QString::number( m_iconCount++ ) );
+
+            // Deleting a list item removes it from the icons list
+            delete m_viewSelector.add( icon, pose );
+
+            m_iconsList->insertIcon( icon );
+
+        }
 
     }
 
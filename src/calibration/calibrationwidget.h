@@ -10,6 +10,8 @@
 #include "src/common/defs.h"
 
 #include "threads.h"
+#include "calibrationsolver.h"
+#include "viewselector.h"
 
 class GrabWidgetBase;
 class MonocularGrabWidget;
@@ -21,6 +23,7 @@ class StereoIcon;
 class ImageWidget;
 class ImageDialog;
 class ParametersWidget;
+class StereoCameraBase;
 
 class CalibrationWidgetBase : public QWidget
 {
@@ -53,6 +56,11 @@ protected:
     StereoCalibrationData calcStereoCalibration( const QList<CalibrationIconBase *> &icons );
     StereoCalibrationData calcStereoCalibration( const std::vector< std::vector< cv::Point2f > > &leftPoints, const std::vector< std::vector< cv::Point2f > > &rightPoints, const std::vector<std::vector<cv::Point3f> > &points3d, cv::Size &frameSize );
 
+    MonocularCalibrationSolver m_monocularSolver;
+    StereoCalibrationSolver m_stereoSolver;
+
+    CalibrationViewSelector m_viewSelector;
+
     int m_iconCount;
 
     void dropIconCount();
@@ -205,7 +213,7 @@ class StereoCameraCalibrationWidget : public StereoCalibrationWidgetBase, public
     Q_OBJECT
 
 public:
-    StereoCameraCalibrationWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget *parent = nullptr );
+    StereoCameraCalibrationWidget( StereoCameraBase *camera, QWidget *parent = nullptr );
 
     StereoGrabWidget *taskWidget() const;
 
@@ -231,6 +239,6 @@ protected:
     StereoIcon *createIcon( const CvImage &leftImage, const CvImage &rightImage );
 
 private:
-    void initialize( const QString &leftCameraIp, const QString &rightCameraIp );
+    void initialize( StereoCameraBase *camera );
 
 };
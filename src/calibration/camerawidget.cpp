@@ -37,6 +37,8 @@ MonocularCameraWidget::MonocularCameraWidget( const QString &cameraIp, QWidget*
 
 void MonocularCameraWidget::initialize()
 {
+    m_frameExtent = 0;
+
     m_previewWidget = new CameraPreviewWidget( this );
     addWidget( m_previewWidget );
 
@@ -57,15 +59,9 @@ void MonocularCameraWidget::setPreviewImage(const CvImage image)
     m_previewWidget->setPreviewImage( image );
 }
 
-const CvImage MonocularCameraWidget::sourceImage() const
+const CvImage MonocularCameraWidget::sourceImage()
 {
-    CvImage ret;
-
-    m_updateMutex.lock();
-    ret = m_previewWidget->sourceImage();
-    m_updateMutex.unlock();
-
-    return ret;
+    return m_camera.getFrame();
 }
 
 const CvImage MonocularCameraWidget::previewImage() const
@@ -85,9 +81,14 @@ bool MonocularCameraWidget::isTemplateExist() const
 
 void MonocularCameraWidget::reciveFrame()
 {
-    auto frame = m_camera.getFrame();
+    // The preview is scaled down to the maximum size anyway, so it is binned from the mosaic as close to that size as possible
+    auto decimation = templateProcessor().resizeFlag() ? previewDecimation( m_frameExtent, static_cast< int >( templateProcessor().frameMaximumSize() ) ) : VimbaDecimationType::WHOLE;
+
+    auto frame = m_camera.getFrame( decimation );
 
     if ( !frame.empty() ) {
+        m_frameExtent = std::max( frame.width(), frame.height() ) * static_cast< int >( decimation );
+
         if ( m_type == TypeComboBox::CHECKERBOARD || m_type == TypeComboBox::CIRCLES || m_type == TypeComboBox::ASYM_CIRCLES )
             m_previewThread.processFrame( frame, MonocularProcessorThread::TEMPLATE );
         else if ( m_type == TypeComboBox::ARUCO_MARKERS )
@@ -188,14 +189,16 @@ void MonocularCameraWidget::setFastCheck( const bool value )
 }
 
 // StereoCameraWidget
-StereoCameraWidget::StereoCameraWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent )
-    : CameraWidgetBase( parent ), m_camera( leftCameraIp.toStdString(), rightCameraIp.toStdString(), parent )
+StereoCameraWidget::StereoCameraWidget( StereoCameraBase *camera, QWidget* parent )
+    : CameraWidgetBase( parent ), m_camera( camera )
 {
     initialize();
 }
 
 void StereoCameraWidget::initialize()
 {
+    m_frameExtent = 0;
+
     m_leftCameraWidget = new CameraPreviewWidget( this );
     m_rightCameraWidget = new CameraPreviewWidget( this );
 
@@ -204,7 +207,9 @@ void StereoCameraWidget::initialize()
 
     m_previewThread.start();
 
-    connect( &m_camera, &StereoCamera::receivedFrame, this, &StereoCameraWidget::reciveFrame );
+    m_camera->setParent( this );
+
+    connect( m_camera, &StereoCameraBase::receivedFrame, this, &StereoCameraWidget::reciveFrame );
     connect( &m_previewThread, &StereoProcessorThread::updateSignal, this, &StereoCameraWidget::updateView );
 
 }
@@ -256,20 +261,18 @@ bool StereoCameraWidget::isTemplateExist() const
 
 StampedStereoImage StereoCameraWidget::sourceFrame()
 {
-    StampedStereoImage ret;
-
-    m_updateMutex.lock();
-    ret = m_sourceFrame;
-    m_updateMutex.unlock();
-
-    return ret;
+    return m_camera->getFrame();
 }
 
 void StereoCameraWidget::reciveFrame()
 {
-    auto frame = m_camera.getFrame();
+    auto decimation = templateProcessor().resizeFlag() ? previewDecimation( m_frameExtent, static_cast< int >( templateProcessor().frameMaximumSize() ) ) : VimbaDecimationType::WHOLE;
+
+    auto frame = m_camera->getFrame( decimation );
 
     if ( !frame.empty() ) {
+        m_frameExtent = std::max( frame.leftImage().width(), frame.leftImage().height() ) * static_cast< int >( decimation );
+
         if ( m_type == TypeComboBox::CHECKERBOARD || m_type == TypeComboBox::CIRCLES || m_type == TypeComboBox::ASYM_CIRCLES )
             m_previewThread.processFrame( frame, StereoProcessorThread::TEMPLATE );
         else if ( m_type == TypeComboBox::ARUCO_MARKERS )
@@ -285,8 +288,6 @@ void StereoCameraWidget::updateView()
 
         auto result = m_previewThread.result();
 
-        m_sourceFrame = result.sourceFrame;
-
         m_leftCameraWidget->setSourceImage( result.sourceFrame.leftImage() );
         m_rightCameraWidget->setSourceImage( result.sourceFrame.rightImage() );
 
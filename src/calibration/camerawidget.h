@@ -42,7 +42,8 @@ class MonocularCameraWidget : public CameraWidgetBase
 public:
     MonocularCameraWidget( const QString &cameraIp, QWidget* parent = nullptr );
 
-    const CvImage sourceImage() const;
+    // Full resolution frame to grab, the preview may be decimated
+    const CvImage sourceImage();
     const CvImage previewImage() const;
 
     void setTemplateExist( const bool value );
@@ -78,6 +79,8 @@ protected:
 
     MasterCamera m_camera;
 
+    int m_frameExtent;
+
     MonocularProcessorThread m_previewThread;
 
     mutable QMutex m_updateMutex;
@@ -92,7 +95,8 @@ class StereoCameraWidget : public CameraWidgetBase
     Q_OBJECT
 
 public:
-    StereoCameraWidget( const QString &cameraIp, const QString &rightCameraIp, QWidget* parent = nullptr );
+    // Takes the ownership of the camera
+    StereoCameraWidget( StereoCameraBase *camera, QWidget* parent = nullptr );
 
     const CvImage leftSourceImage() const;
     const CvImage leftDisplayedImage() const;
@@ -131,6 +135,7 @@ public:
 
     bool isTemplateExist() const;
 
+    // Full resolution frames to grab, the preview may be decimated
     StampedStereoImage sourceFrame();
 
 public slots:
@@ -150,9 +155,9 @@ protected:
 
     StereoProcessorThread m_previewThread;
 
-    StereoCamera m_camera;
+    QPointer< StereoCameraBase > m_camera;
 
-    StampedStereoImage m_sourceFrame;
+    int m_frameExtent;
 
     QMutex m_updateMutex;
 
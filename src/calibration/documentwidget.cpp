@@ -223,15 +223,15 @@ MonocularCameraCalibrationWidget *MonocularCameraCalibrationDocument::widget() c
 }
 
 // StereoCameraCalibrationDocument
-StereoCameraCalibrationDocument::StereoCameraCalibrationDocument( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent )
+StereoCameraCalibrationDocument::StereoCameraCalibrationDocument( StereoCameraBase *camera, QWidget* parent )
     : CameraCalibrationDocumentBase( parent )
 {
-    initialize( leftCameraIp, rightCameraIp );
+    initialize( camera );
 }
 
-void StereoCameraCalibrationDocument::initialize( const QString &leftCameraIp, const QString &rightCameraIp )
+void StereoCameraCalibrationDocument::initialize( StereoCameraBase *camera )
 {
-    setWidget( new StereoCameraCalibrationWidget( leftCameraIp, rightCameraIp, this ) );
+    setWidget( new StereoCameraCalibrationWidget( camera, this ) );
 }
 
 StereoCameraCalibrationWidget *StereoCameraCalibrationDocument::widget() const
@@ -27,6 +27,8 @@ class StereoReportWidget;
 
 class ReportDocumentBase;
 
+class StereoCameraBase;
+
 class CalibrationDocumentBase : public DocumentBase
 {
     Q_OBJECT
@@ -135,12 +137,12 @@ class StereoCameraCalibrationDocument : public CameraCalibrationDocumentBase
     Q_OBJECT
 
 public:
-    explicit StereoCameraCalibrationDocument( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent = nullptr );
+    explicit StereoCameraCalibrationDocument( StereoCameraBase *camera, QWidget* parent = nullptr );
 
     StereoCameraCalibrationWidget *widget() const;
 
 private:
-    void initialize( const QString &leftCameraIp, const QString &rightCameraIp );
+    void initialize( StereoCameraBase *camera );
 
 };
 
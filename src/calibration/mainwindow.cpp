@@ -6,6 +6,8 @@
 #include "documentwidget.h"
 
 #include "src/common/ipwidget.h"
+#include "src/common/simulatedcamerawidget.h"
+#include "src/common/vimbacamera.h"
 
 #include "calibrationchoicedialog.h"
 
@@ -65,7 +67,12 @@ QPointer< MonocularCameraCalibrationDocument > MainWindow::addMonocularCameraCal
 
 QPointer< StereoCameraCalibrationDocument > MainWindow::addStereoCameraCalibrationDocument( const QString &leftCameraIp, const QString &rightCameraIp )
 {
-    QPointer< StereoCameraCalibrationDocument > ret = new StereoCameraCalibrationDocument( leftCameraIp, rightCameraIp, this );
+    return addStereoCameraCalibrationDocument( new StereoCamera( leftCameraIp.toStdString(), rightCameraIp.toStdString() ) );
+}
+
+QPointer< StereoCameraCalibrationDocument > MainWindow::addStereoCameraCalibrationDocument( StereoCameraBase *camera )
+{
+    QPointer< StereoCameraCalibrationDocument > ret = new StereoCameraCalibrationDocument( camera, this );
 
     addDocument( ret );
 
@@ -312,6 +319,9 @@ void MainWindow::choiceCalibrationDialog()
          case CalibrationChoiceDialog::STEREO_CAMERA:
              addStereoCameraCalibrationDialog();
              break;
+         case CalibrationChoiceDialog::SIMULATED_STEREO_CAMERA:
+             addSimulatedCameraCalibrationDialog();
+             break;
          default:
              break;
          }
@@ -345,3 +355,18 @@ void MainWindow::addStereoCameraCalibrationDialog()
         addStereoCameraCalibrationDocument( dialog.leftIp(), dialog.rightIp() );
 
 }
+
+void MainWindow::addSimulatedCameraCalibrationDialog()
+{
+    SimulatedCameraDialog dialog( this );
+
+    if ( dialog.exec() == DialogBase::Accepted ) {
+        auto camera = dialog.createCamera();
+
+        if ( camera )
+            addStereoCameraCalibrationDocument( camera );
+        else
+            QMessageBox::warning( this, tr( "Simulated camera" ), tr( "Can't start the simulated camera: %1" ).arg( dialog.errorString() ) );
+    }
+
+}
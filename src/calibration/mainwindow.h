@@ -18,6 +18,7 @@ class StereoCameraCalibrationDocument;
 class MonocularImageCalibrationDocument;
 class StereoImageCalibrationDocument;
 class TrippleCalibrationDocument;
+class StereoCameraBase;
 class ReportDocumentBase;
 class MonocularReportDocument;
 class StereoReportDocument;
@@ -33,6 +34,7 @@ public:
 
     QPointer< MonocularCameraCalibrationDocument > addMonocularCameraCalibrationDocument( const QString &cameraIp );
     QPointer< StereoCameraCalibrationDocument > addStereoCameraCalibrationDocument( const QString &leftCameraIp, const QString &rightCameraIp );
+    QPointer< StereoCameraCalibrationDocument > addStereoCameraCalibrationDocument( StereoCameraBase *camera );
 
     QPointer< MonocularImageCalibrationDocument > addMonocularCalibrationDocument();
     QPointer< StereoImageCalibrationDocument > addStereoCalibrationDocument();
@@ -68,6 +70,7 @@ public slots:
 
     void addMonocularCameraCalibrationDialog();
     void addStereoCameraCalibrationDialog();
+    void addSimulatedCameraCalibrationDialog();
 
 protected:
     QPointer< QMenuBar > m_menuBar;
@@ -105,6 +105,24 @@ void ReportWidget::addRect( const cv::Rect& rect )
     addText( " " );
 }
 
+void ReportWidget::addFrameErrors( const MonocularCalibrationData& calibration )
+{
+    addText( tr( "Frame errors:" ) + " " );
+
+    for ( auto &i : calibration.results() ) {
+        addNumber( i.error() );
+        addText( i.isOk() ? " " : "* " );
+    }
+
+    addBreak();
+
+    addText( tr( "Rejected frames (*):" ) + " " );
+    addNumber( calibration.rejectedSize() );
+    addText( "/" );
+    addNumber( calibration.resultsSize() );
+    addDoubleBreak();
+}
+
 // MonocularReportWidge
 MonocularReportWidget::MonocularReportWidget( QWidget *parent )
     : ReportWidget( parent )
@@ -161,6 +179,8 @@ void MonocularReportWidget::report( const MonocularCalibrationData &calibration
     addText( tr( "Reprojection error:" ) +  " " + QString::number( calibration.error() ) +"\n" );
     addBreak();
 
+    addFrameErrors( calibration );
+
     if ( calibration.isOk() )
         addText( tr( "Calibration succesful!" ) + "\n" );
     else
@@ -302,6 +322,12 @@ void StereoReportWidget::report(const StereoCalibrationData &calibration )
         addText( tr( "Reprojection error:" ) +  " " + QString::number( calibration.error() ) +"\n" );
         addBreak();
 
+        addText( tr( "Left camera:" ) + "\n" );
+        addFrameErrors( calibration.leftCameraResults() );
+
+        addText( tr( "Right camera:" ) + "\n" );
+        addFrameErrors( calibration.rightCameraResults() );
+
         addText( tr( "Calibration succesful!" ) + "\n" );
 
     }
@@ -27,6 +27,7 @@ public:
     void addSize( const cv::Size& size );
     void addMatrix( const cv::Mat& mat );
     void addRect( const cv::Rect& rect );
+    void addFrameErrors( const MonocularCalibrationData& calibration );
 
 protected:
     static const int m_reportFrameSize = 800;
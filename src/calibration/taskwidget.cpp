@@ -123,15 +123,15 @@ void MonocularGrabWidget::updateParameters()
 }
 
 // StereoGrabWidget
-StereoGrabWidget::StereoGrabWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent )
+StereoGrabWidget::StereoGrabWidget( StereoCameraBase *camera, QWidget* parent )
     : GrabWidgetBase( parent )
 {
-    initialize( leftCameraIp, rightCameraIp );
+    initialize( camera );
 }
 
-void StereoGrabWidget::initialize( const QString &leftCameraIp, const QString &rightCameraIp )
+void StereoGrabWidget::initialize( StereoCameraBase *camera )
 {
-    m_cameraWidget = new StereoCameraWidget( leftCameraIp,  rightCameraIp, this );
+    m_cameraWidget = new StereoCameraWidget( camera, this );
     m_layout->addWidget( m_cameraWidget );
 
     connect ( m_parametersWidget, &CameraParametersWidget::parametersChanges, this, &StereoGrabWidget::updateParameters );
@@ -64,7 +64,7 @@ class StereoGrabWidget : public GrabWidgetBase
     Q_OBJECT
 
 public:
-    explicit StereoGrabWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent = nullptr );
+    explicit StereoGrabWidget( StereoCameraBase *camera, QWidget* parent = nullptr );
 
     StereoCameraWidget *cameraWidget() const;
 
@@ -86,7 +86,7 @@ protected slots:
     void updateParameters();
 
 private:
-    void initialize( const QString &leftCameraIp, const QString &rightCameraIp );
+    void initialize( StereoCameraBase *camera );
 
 };
 
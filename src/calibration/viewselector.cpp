@@ -0,0 +1,221 @@
+#include "src/common/precompiled.h"
+
+#include "viewselector.h"
+
+#include "calibrationiconswidget.h"
+
+// CalibrationViewPose
+CalibrationViewPose::CalibrationViewPose()
+{
+}
+
+CalibrationViewPose::CalibrationViewPose( const std::vector< cv::Point2f > &imagePoints, const std::vector< cv::Point3f > &worldPoints, const cv::Size &frameSize )
+{
+    m_cameraPoses.push_back( cameraPose( imagePoints, worldPoints, frameSize ) );
+}
+
+CalibrationViewPose::CalibrationViewPose( const std::vector< cv::Point2f > &leftImagePoints, const std::vector< cv::Point2f > &rightImagePoints, const std::vector< cv::Point3f > &worldPoints, const cv::Size &frameSize )
+{
+    m_cameraPoses.push_back( cameraPose( leftImagePoints, worldPoints, frameSize ) );
+    m_cameraPoses.push_back( cameraPose( rightImagePoints, worldPoints, frameSize ) );
+}
+
+bool CalibrationViewPose::isEmpty() const
+{
+    return m_cameraPoses.empty();
+}
+
+double CalibrationViewPose::distance( const CalibrationViewPose &other ) const
+{
+    double ret = 0.;
+
+    for ( size_t i = 0; i < std::min( m_cameraPoses.size(), other.m_cameraPoses.size() ); ++i )
+        ret = std::max( ret, cv::norm( m_cameraPoses[ i ], other.m_cameraPoses[ i ] ) );
+
+    return ret;
+
+}
+
+CalibrationViewPose::CameraPose CalibrationViewPose::cameraPose( const std::vector< cv::Point2f > &imagePoints, const std::vector< cv::Point3f > &worldPoints, const cv::Size &frameSize )
+{
+    CameraPose ret;
+
+    if ( imagePoints.empty() || imagePoints.size() != worldPoints.size() || frameSize.empty() )
+        return ret;
+
+    // Board plane corners are mapped to the image, so tilt is measured on the whole board even if corners are missing
+    std::vector< cv::Point2f > boardPoints;
+    boardPoints.reserve( worldPoints.size() );
+
+    for ( auto &i : worldPoints )
+        boardPoints.push_back( cv::Point2f( i.x, i.y ) );
+
+    auto minX = std::min_element( boardPoints.begin(), boardPoints.end(), []( const cv::Point2f &a, const cv::Point2f &b ) { return a.x < b.x; } )->x;
+    auto maxX = std::max_element( boardPoints.begin(), boardPoints.end(), []( const cv::Point2f &a, const cv::Point2f &b ) { return a.x < b.x; } )->x;
+    auto minY = std::min_element( boardPoints.begin(), boardPoints.end(), []( const cv::Point2f &a, const cv::Point2f &b ) { return a.y < b.y; } )->y;
+    auto maxY = std::max_element( boardPoints.begin(), boardPoints.end(), []( const cv::Point2f &a, const cv::Point2f &b ) { return a.y < b.y; } )->y;
+
+    std::vector< cv::Point2f > boardCorners = { cv::Point2f( minX, minY ), cv::Point2f( maxX, minY ),
+                                                cv::Point2f( maxX, maxY ), cv::Point2f( minX, maxY ) };
+
+    std::vector< cv::Point2f > quad;
+
+    cv::Mat homography;
+
+    if ( imagePoints.size() >= 4 )
+        homography = cv::findHomography( boardPoints, imagePoints );
+
+    if ( !homography.empty() )
+        cv::perspectiveTransform( boardCorners, quad, homography );
+    else {
+        auto imageRect = cv::boundingRect( imagePoints );
+        quad = { cv::Point2f( imageRect.tl() ), cv::Point2f( imageRect.br().x, imageRect.tl().y ),
+                 cv::Point2f( imageRect.br() ), cv::Point2f( imageRect.tl().x, imageRect.br().y ) };
+    }
+
+    auto center = ( quad[ 0 ] + quad[ 1 ] + quad[ 2 ] + quad[ 3 ] ) * 0.25f;
+
+    auto top = cv::norm( quad[ 1 ] - quad[ 0 ] );
+    auto right = cv::norm( quad[ 2 ] - quad[ 1 ] );
+    auto bottom = cv::norm( quad[ 3 ] - quad[ 2 ] );
+    auto left = cv::norm( quad[ 0 ] - quad[ 3 ] );
+
+    ret[ 0 ] = center.x / frameSize.width;
+    ret[ 1 ] = center.y / frameSize.height;
+    ret[ 2 ] = std::sqrt( std::abs( cv::contourArea( quad ) ) / frameSize.area() );
+
+    if ( top > 0. && right > 0. && bottom > 0. && left > 0. ) {
+        ret[ 3 ] = std::log( right / left );
+        ret[ 4 ] = std::log( bottom / top );
+    }
+
+    return ret;
+
+}
+
+// CalibrationViewSelector
+CalibrationViewSelector::CalibrationViewSelector()
+{
+    initialize();
+}
+
+void CalibrationViewSelector::initialize()
+{
+    m_enabled = true;
+    m_maxViews = 50;
+    m_minimumDistance = 0.05;
+}
+
+void CalibrationViewSelector::setEnabled( const bool value )
+{
+    m_enabled = value;
+}
+
+bool CalibrationViewSelector::isEnabled() const
+{
+    return m_enabled;
+}
+
+void CalibrationViewSelector::setMaxViews( const unsigned int value )
+{
+    m_maxViews = value;
+}
+
+unsigned int CalibrationViewSelector::maxViews() const
+{
+    return m_maxViews;
+}
+
+void CalibrationViewSelector::setMinimumDistance( const double value )
+{
+    m_minimumDistance = value;
+}
+
+double CalibrationViewSelector::minimumDistance() const
+{
+    return m_minimumDistance;
+}
+
+double CalibrationViewSelector::nearestDistance( const CalibrationViewPose &pose, const int exclude ) const
+{
+    double ret = std::numeric_limits< double >::max();
+
+    for ( size_t i = 0; i < m_views.size(); ++i )
+        if ( static_cast< int >( i ) != exclude )
+            ret = std::min( ret, pose.distance( m_views[ i ].pose ) );
+
+    return ret;
+
+}
+
+int CalibrationViewSelector::mostRedundantView( double *distance ) const
+{
+    int ret = -1;
+    double minDistance = std::numeric_limits< double >::max();
+
+    for ( size_t i = 0; i < m_views.size(); ++i ) {
+        auto currentDistance = nearestDistance( m_views[ i ].pose, i );
+
+        if ( currentDistance < minDistance ) {
+            minDistance = currentDistance;
+            ret = i;
+        }
+
+    }
+
+    if ( distance )
+        *distance = minDistance;
+
+    return ret;
+
+}
+
+bool CalibrationViewSelector::accept( const CalibrationViewPose &pose ) const
+{
+    if ( !m_enabled || pose.isEmpty() )
+        return true;
+
+    auto distance = nearestDistance( pose );
+
+    if ( distance < m_minimumDistance )
+        return false;
+
+    if ( m_views.size() < m_maxViews )
+        return true;
+
+    double redundantDistance;
+    mostRedundantView( &redundantDistance );
+
+    return distance > redundantDistance;
+
+}
+
+CalibrationIconBase *CalibrationViewSelector::add( CalibrationIconBase *icon, const CalibrationViewPose &pose )
+{
+    CalibrationIconBase *ret = nullptr;
+
+    if ( m_enabled && m_views.size() >= m_maxViews ) {
+        auto redundantView = mostRedundantView();
+
+        if ( redundantView >= 0 ) {
+            ret = m_views[ redundantView ].icon;
+            m_views.erase( m_views.begin() + redundantView );
+        }
+
+    }
+
+    m_views.push_back( View{ icon, pose } );
+
+    return ret;
+
+}
+
+void CalibrationViewSelector::clear()
+{
+    m_views.clear();
+}
+
+unsigned int CalibrationViewSelector::size() const
+{
+    return m_views.size();
+}
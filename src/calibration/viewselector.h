@@ -0,0 +1,71 @@
+#pragma once
+
+class CalibrationIconBase;
+
+// Board pose coverage of one view: per camera normalized position, scale and tilt
+class CalibrationViewPose
+{
+public:
+    using CameraPose = cv::Vec< double, 5 >;
+
+    CalibrationViewPose();
+    CalibrationViewPose( const std::vector< cv::Point2f > &imagePoints, const std::vector< cv::Point3f > &worldPoints, const cv::Size &frameSize );
+    CalibrationViewPose( const std::vector< cv::Point2f > &leftImagePoints, const std::vector< cv::Point2f > &rightImagePoints, const std::vector< cv::Point3f > &worldPoints, const cv::Size &frameSize );
+
+    bool isEmpty() const;
+
+    // A view is new if it is new for any of the cameras
+    double distance( const CalibrationViewPose &other ) const;
+
+    static CameraPose cameraPose( const std::vector< cv::Point2f > &imagePoints, const std::vector< cv::Point3f > &worldPoints, const cv::Size &frameSize );
+
+protected:
+    std::vector< CameraPose > m_cameraPoses;
+
+};
+
+// Keeps a bounded subset of the captured views with the best pose coverage
+class CalibrationViewSelector
+{
+public:
+    CalibrationViewSelector();
+
+    void setEnabled( const bool value );
+    bool isEnabled() const;
+
+    void setMaxViews( const unsigned int value );
+    unsigned int maxViews() const;
+
+    void setMinimumDistance( const double value );
+    double minimumDistance() const;
+
+    // False for near-duplicates, and for views adding less coverage than the most redundant one when the set is full
+    bool accept( const CalibrationViewPose &pose ) const;
+
+    // Returns the icon superseded by the new one, the caller deletes it
+    CalibrationIconBase *add( CalibrationIconBase *icon, const CalibrationViewPose &pose );
+
+    void clear();
+
+    unsigned int size() const;
+
+protected:
+    struct View
+    {
+        CalibrationIconBase *icon;
+        CalibrationViewPose pose;
+    };
+
+    bool m_enabled;
+    unsigned int m_maxViews;
+    double m_minimumDistance;
+
+    std::vector< View > m_views;
+
+    double nearestDistance( const CalibrationViewPose &pose, const int exclude = -1 ) const;
+    int mostRedundantView( double *distance = nullptr ) const;
+
+private:
+    void initialize();
+
+};
@@ -0,0 +1,93 @@
+#include "precompiled.h"
+
+#include "demosaic.h"
+
+#include "profiler.h"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+void binBayer( const cv::Mat &bayerImage, cv::Mat *image )
+{
+    CV_Assert( bayerImage.type() == CV_8UC1 );
+
+    image->create( bayerImage.rows / 2, bayerImage.cols / 2, CV_8UC3 );
+
+    auto width = image->cols;
+
+    cv::parallel_for_( cv::Range( 0, image->rows ), [ & ]( const cv::Range &range ) {
+
+        for ( int y = range.start; y < range.end; ++y ) {
+            // G B on the even rows, R G on the odd ones
+            auto evenRow = bayerImage.ptr< uchar >( 2 * y );
+            auto oddRow = bayerImage.ptr< uchar >( 2 * y + 1 );
+            auto target = image->ptr< uchar >( y );
+
+            int x = 0;
+
+#if CV_SIMD
+            for ( ; x <= width - cv::v_uint8::nlanes; x += cv::v_uint8::nlanes ) {
+                cv::v_uint8 g1, b, r, g2;
+
+                cv::v_load_deinterleave( evenRow + 2 * x, g1, b );
+                cv::v_load_deinterleave( oddRow + 2 * x, r, g2 );
+
+                cv::v_store_interleave( target + 3 * x, b, cv::v_avg( g1, g2 ), r );
+            }
+#endif
+
+            for ( ; x < width; ++x ) {
+                target[ 3 * x ] = evenRow[ 2 * x + 1 ];
+                target[ 3 * x + 1 ] = static_cast< uchar >( ( evenRow[ 2 * x ] + oddRow[ 2 * x + 1 ] + 1 ) >> 1 );
+                target[ 3 * x + 2 ] = oddRow[ 2 * x ];
+            }
+
+        }
+
+    } );
+
+}
+
+VimbaDecimationType previewDecimation( const int extent, const int minimumExtent )
+{
+    for ( auto i : { VimbaDecimationType::EIGHTH, VimbaDecimationType::QUARTER, VimbaDecimationType::HALF } )
+        if ( extent / static_cast< int >( i ) >= minimumExtent )
+            return i;
+
+    return VimbaDecimationType::WHOLE;
+}
+
+void demosaic( const cv::Mat &bayerImage, cv::Mat *image, const VimbaDecimationType decimation, const bool gray )
+{
+    PROFILE_SCOPE( "demosaic" );
+
+    if ( bayerImage.empty() ) {
+        image->release();
+        return;
+    }
+
+    // OpenCV names the patterns by the second row, so the GB frames are its GR with swapped R and B:
+    // BayerGB2RGB gives BGR and BayerGR2GRAY weights the channels right
+    if ( decimation == VimbaDecimationType::WHOLE ) {
+        cv::cvtColor( bayerImage, *image, gray ? cv::COLOR_BayerGR2GRAY : cv::COLOR_BayerGB2RGB );
+        return;
+    }
+
+    cv::Mat binned;
+    binBayer( bayerImage, &binned );
+
+    auto factor = static_cast< int >( decimation ) / 2;
+
+    cv::Mat decimated;
+
+    // Integer ratio area resize is a box filter
+    if ( factor > 1 )
+        cv::resize( binned, decimated, cv::Size( binned.cols / factor, binned.rows / factor ), 0., 0., cv::INTER_AREA );
+    else
+        decimated = binned;
+
+    if ( gray )
+        cv::cvtColor( decimated, *image, cv::COLOR_BGR2GRAY );
+    else
+        *image = decimated;
+
+}
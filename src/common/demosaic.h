@@ -0,0 +1,13 @@
+#pragma once
+
+enum class VimbaDecimationType { WHOLE = 1, HALF = 2, QUARTER = 4, EIGHTH = 8 };
+
+// BayerGB8 frames of the cameras to BGR or gray.
+// Decimated images are binned straight from the mosaic, without the full resolution demosaic
+void demosaic( const cv::Mat &bayerImage, cv::Mat *image, const VimbaDecimationType decimation = VimbaDecimationType::WHOLE, const bool gray = false );
+
+// Coarsest decimation keeping the larger side of a frame at least the given size, for previews scaled down anyway
+VimbaDecimationType previewDecimation( const int extent, const int minimumExtent );
+
+// One BGR pixel of every 2x2 cell: its B and R samples and the mean of both G
+void binBayer( const cv::Mat &bayerImage, cv::Mat *image );
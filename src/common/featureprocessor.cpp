@@ -1,13 +1,24 @@
 #include "precompiled.h"
 
 #include "featureprocessor.h"
+#include "klttracker.h"
+#include "paralleltasks.h"
+#include "profiler.h"
 
 #include "defs.h"
 
+#include <opencv2/core/hal/hal.hpp>
+
+#include <numeric>
+
+#include <omp.h>
+
 void extractKeypoints( cv::Ptr< cv::Feature2D > processor, const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints )
 {
     if ( processor && keypoints ) {
 
+        PROFILE_SCOPE( "extraction" );
+
         auto uImage = image.getUMat( cv::ACCESS_READ );
         processor->detect( uImage, *keypoints, mask );
 
@@ -18,6 +29,8 @@ void extractKeypoints( cv::Ptr< cv::Feature2D > processor, const CvImage &image,
 void extractDescriptors( cv::Ptr< cv::Feature2D > processor, const CvImage &image, std::vector< cv::KeyPoint > &keypoints, cv::Mat *descriptors )
 {
     if ( processor && descriptors ) {
+        PROFILE_SCOPE( "description" );
+
         processor->compute( image, keypoints, *descriptors );
 
     }
@@ -27,6 +40,8 @@ void extractDescriptors( cv::Ptr< cv::Feature2D > processor, const CvImage &imag
 void extractAndCompute( cv::Ptr< cv::Feature2D > processor, const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints, cv::Mat *descriptors )
 {
     if ( processor && keypoints && descriptors ) {
+        PROFILE_SCOPE( "extraction" );
+
         processor->detectAndCompute( image, mask, *keypoints, *descriptors );
 
     }
@@ -56,13 +71,18 @@ void FlowProcessor::initialize()
     m_extractPrecision = 1.e-2;
     m_extractDistance = 10.;
     m_blockSize = 3;
+    m_gridCellSize = 0.;
     m_ransacReprojectionThreshold = 1.0;
     m_ransacConfidence = 1.0 - 1.e-2;
 
+    m_rowTolerance = 1.0;
+
 }
 
 void FlowProcessor::extractPoints( const CvImage &image, const cv::Mat &mask, std::vector< cv::Point2f > *points, const size_t count )
 {
+    PROFILE_SCOPE( "extraction" );
+
     if ( points ) {
 
         cv::Mat gray;
@@ -74,6 +94,259 @@ void FlowProcessor::extractPoints( const CvImage &image, const cv::Mat &mask, st
 
 }
 
+struct CornerCandidate
+{
+    cv::Point2f point;
+    float response;
+
+    bool operator<( const CornerCandidate &other ) const
+    {
+        return response > other.response;
+    }
+
+};
+
+// Buckets points by the minimal distance, so a distance check looks at
+// the 3x3 neighbouring buckets only
+class DistanceGrid
+{
+public:
+    DistanceGrid( const cv::Size &size, const double distance )
+        : m_distance( std::max( distance, 1. ) )
+    {
+        m_cols = static_cast< int >( size.width / m_distance ) + 1;
+        m_rows = static_cast< int >( size.height / m_distance ) + 1;
+
+        m_buckets.resize( m_cols * m_rows );
+    }
+
+    void add( const cv::Point2f &point )
+    {
+        auto index = bucket( point );
+
+        if ( index >= 0 )
+            m_buckets[ index ].push_back( point );
+    }
+
+    bool isFree( const cv::Point2f &point ) const
+    {
+        auto col = static_cast< int >( point.x / m_distance );
+        auto row = static_cast< int >( point.y / m_distance );
+
+        auto squaredDistance = m_distance * m_distance;
+
+        for ( int r = std::max( row - 1, 0 ); r <= std::min( row + 1, m_rows - 1 ); ++r )
+            for ( int c = std::max( col - 1, 0 ); c <= std::min( col + 1, m_cols - 1 ); ++c )
+                for ( auto &i : m_buckets[ r * m_cols + c ] ) {
+                    auto delta = i - point;
+                    if ( delta.dot( delta ) < squaredDistance )
+                        return false;
+                }
+
+        return true;
+    }
+
+protected:
+    double m_distance;
+
+    int m_cols;
+    int m_rows;
+
+    std::vector< std::vector< cv::Point2f > > m_buckets;
+
+    int bucket( const cv::Point2f &point ) const
+    {
+        auto col = static_cast< int >( point.x / m_distance );
+        auto row = static_cast< int >( point.y / m_distance );
+
+        if ( col < 0 || row < 0 || col >= m_cols || row >= m_rows )
+            return -1;
+
+        return row * m_cols + col;
+    }
+
+};
+
+void FlowProcessor::extractPoints( const CvImage &image, const std::vector< cv::Point2f > &existingPoints, std::vector< cv::Point2f > *points, const size_t count )
+{
+    PROFILE_SCOPE( "extraction" );
+
+    if ( !points )
+        return;
+
+    points->clear();
+
+    if ( image.empty() || count == 0 )
+        return;
+
+    cv::Mat gray;
+
+    if ( image.channels() > 1 )
+        cv::cvtColor( image, gray, cv::COLOR_BGR2GRAY );
+    else
+        gray = image;
+
+    auto totalCount = count + existingPoints.size();
+
+    auto cellSize = m_gridCellSize > 0. ? m_gridCellSize : std::sqrt( static_cast< double >( gray.total() ) * m_pointsPerCell / totalCount );
+    cellSize = std::max( cellSize, m_extractDistance * 2. );
+
+    auto gridCols = std::max( static_cast< int >( std::ceil( gray.cols / cellSize ) ), 1 );
+    auto gridRows = std::max( static_cast< int >( std::ceil( gray.rows / cellSize ) ), 1 );
+    auto cellsCount = gridCols * gridRows;
+
+    auto cellRect = [ & ]( const int index ) {
+        auto col = index % gridCols;
+        auto row = index / gridCols;
+
+        auto x = col * gray.cols / gridCols;
+        auto y = row * gray.rows / gridRows;
+
+        return cv::Rect( x, y, ( col + 1 ) * gray.cols / gridCols - x, ( row + 1 ) * gray.rows / gridRows - y );
+    };
+
+    // Tracked points are bucketed once instead of painting a mask
+    DistanceGrid existingGrid( gray.size(), m_extractDistance );
+    std::vector< int > cellBudgets( cellsCount, static_cast< int >( ( totalCount + cellsCount - 1 ) / cellsCount ) );
+
+    for ( auto &i : existingPoints ) {
+
+        existingGrid.add( i );
+
+        auto col = std::min( std::max( static_cast< int >( i.x * gridCols / gray.cols ), 0 ), gridCols - 1 );
+        auto row = std::min( std::max( static_cast< int >( i.y * gridRows / gray.rows ), 0 ), gridRows - 1 );
+
+        --cellBudgets[ row * gridCols + col ];
+
+    }
+
+    auto border = static_cast< int >( m_blockSize ) / 2 + 2;
+
+    std::vector< cv::Mat > cellResponses( cellsCount );
+    std::vector< cv::Rect > cellRois( cellsCount );
+    std::vector< double > cellMaximums( cellsCount, 0. );
+
+    // Tasks rather than a nested team, Map::track runs this inside its task graph
+    parallelTasks( cellsCount, [ & ]( const int i ) {
+
+        if ( cellBudgets[ i ] > 0 ) {
+
+            auto roi = cellRect( i );
+
+            cellRois[ i ] = cv::Rect( roi.x - border, roi.y - border, roi.width + border * 2, roi.height + border * 2 ) & cv::Rect( 0, 0, gray.cols, gray.rows );
+
+            cv::cornerMinEigenVal( gray( cellRois[ i ] ), cellResponses[ i ], static_cast< int >( m_blockSize ), 3 );
+
+            cv::minMaxLoc( cellResponses[ i ]( roi - cellRois[ i ].tl() ), nullptr, &cellMaximums[ i ] );
+
+        }
+
+    } );
+
+    auto threshold = *std::max_element( cellMaximums.begin(), cellMaximums.end() ) * m_extractPrecision;
+
+    std::vector< std::vector< CornerCandidate > > cellCandidates( cellsCount );
+
+    parallelTasks( cellsCount, [ & ]( const int i ) {
+
+        if ( cellBudgets[ i ] > 0 && cellMaximums[ i ] > threshold ) {
+
+            auto roi = cellRect( i );
+            auto offset = roi.tl() - cellRois[ i ].tl();
+
+            cv::Mat dilated;
+            cv::dilate( cellResponses[ i ], dilated, cv::Mat() );
+
+            std::vector< CornerCandidate > candidates;
+
+            for ( int y = 0; y < roi.height; ++y ) {
+
+                auto response = cellResponses[ i ].ptr< float >( y + offset.y ) + offset.x;
+                auto maximum = dilated.ptr< float >( y + offset.y ) + offset.x;
+
+                for ( int x = 0; x < roi.width; ++x )
+                    if ( response[ x ] > threshold && response[ x ] == maximum[ x ] )
+                        candidates.push_back( CornerCandidate{ cv::Point2f( roi.x + x, roi.y + y ), response[ x ] } );
+
+            }
+
+            std::sort( candidates.begin(), candidates.end() );
+
+            // Keep a reserve for cells without enough texture
+            auto limit = static_cast< size_t >( cellBudgets[ i ] ) * 2;
+
+            auto &selected = cellCandidates[ i ];
+
+            for ( auto &candidate : candidates ) {
+
+                if ( selected.size() >= limit )
+                    break;
+
+                if ( !existingGrid.isFree( candidate.point ) )
+                    continue;
+
+                bool isFree = true;
+
+                for ( auto &j : selected ) {
+                    auto delta = j.point - candidate.point;
+                    if ( delta.dot( delta ) < m_extractDistance * m_extractDistance ) {
+                        isFree = false;
+                        break;
+                    }
+                }
+
+                if ( isFree )
+                    selected.push_back( candidate );
+
+            }
+
+        }
+
+    } );
+
+    // Neighbouring cells may have picked points closer than the distance,
+    // so the merge checks every accepted point once more
+    DistanceGrid acceptedGrid( gray.size(), m_extractDistance );
+    std::vector< CornerCandidate > reserve;
+
+    for ( int i = 0; i < cellsCount; ++i ) {
+
+        int taken = 0;
+
+        for ( auto &candidate : cellCandidates[ i ] ) {
+
+            if ( taken < cellBudgets[ i ] && points->size() < count ) {
+
+                if ( acceptedGrid.isFree( candidate.point ) ) {
+                    acceptedGrid.add( candidate.point );
+                    points->push_back( candidate.point );
+                    ++taken;
+                }
+
+            }
+            else
+                reserve.push_back( candidate );
+
+        }
+
+    }
+
+    std::sort( reserve.begin(), reserve.end() );
+
+    for ( auto &candidate : reserve ) {
+
+        if ( points->size() >= count )
+            break;
+
+        if ( acceptedGrid.isFree( candidate.point ) ) {
+            acceptedGrid.add( candidate.point );
+            points->push_back( candidate.point );
+        }
+
+    }
+
+}
+
 double FlowProcessor::extractPrecision() const
 {
     return m_extractPrecision;
@@ -94,6 +367,16 @@ void FlowProcessor::setCheckDistance( const double value )
     m_checkDistance = value;
 }
 
+double FlowProcessor::gridCellSize() const
+{
+    return m_gridCellSize;
+}
+
+void FlowProcessor::setGridCellSize( const double value )
+{
+    m_gridCellSize = value;
+}
+
 void FlowProcessor::setExtractionDistance( const double value )
 {
     m_extractDistance = value;
@@ -124,6 +407,16 @@ void FlowProcessor::setRansacConfidence( const double &value )
     m_ransacConfidence = value;
 }
 
+double FlowProcessor::rowTolerance() const
+{
+    return m_rowTolerance;
+}
+
+void FlowProcessor::setRowTolerance( const double value )
+{
+    m_rowTolerance = value;
+}
+
 cv::Mat FlowProcessor::epiTest( const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > &targetPoints, std::vector< int > *inliers )
 {
     if ( inliers ) {
@@ -151,6 +444,36 @@ cv::Mat FlowProcessor::epiTest( const std::vector< cv::Point2f > &sourcePoints,
 
 }
 
+cv::Mat FlowProcessor::rowTest( const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > &targetPoints,
+                                const double minDisparity, const double maxDisparity, std::vector< int > *inliers )
+{
+    if ( inliers && sourcePoints.size() == targetPoints.size() ) {
+
+        inliers->clear();
+        inliers->reserve( sourcePoints.size() );
+
+        for ( size_t i = 0; i < sourcePoints.size(); ++i ) {
+
+            auto disparity = sourcePoints[ i ].x - targetPoints[ i ].x;
+
+            if ( std::abs( sourcePoints[ i ].y - targetPoints[ i ].y ) <= m_rowTolerance && disparity >= minDisparity && disparity <= maxDisparity )
+                inliers->push_back( i );
+
+        }
+
+        return rectifiedFundamentalMatrix();
+
+    }
+
+    return cv::Mat();
+
+}
+
+cv::Mat FlowProcessor::rectifiedFundamentalMatrix()
+{
+    return ( cv::Mat_< double >( 3, 3 ) << 0., 0., 0., 0., 0., -1., 0., 1., 0. );
+}
+
 // GPUFlowProcessor
 GPUFlowProcessor::GPUFlowProcessor()
 {
@@ -207,6 +530,8 @@ void download( const cv::cuda::GpuMat &d_mat, std::vector< float > &vec )
 
 void GPUFlowProcessor::track( const CvImage &sourceImage, const std::vector< cv::Point2f > &sourcePoints, const CvImage &targetImage, std::vector< FlowTrackResult > *trackedPoints )
 {    
+    PROFILE_SCOPE( "lk tracking" );
+
     if ( trackedPoints && !sourcePoints.empty() ) {
 
         std::vector< cv::Point2f > opticalPoints;
@@ -269,10 +594,58 @@ void CPUFlowProcessor::initialize()
 
 }
 
-void CPUFlowProcessor::track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid, std::vector< FlowTrackResult > *trackedPoints )
+void CPUFlowProcessor::track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid, std::vector< FlowTrackResult > *trackedPoints,
+                              const std::vector< cv::Point2f > &guessPoints )
 {
+    PROFILE_SCOPE( "lk tracking" );
+
     if ( trackedPoints && !sourcePoints.empty() ) {
 
+        CV_Assert( guessPoints.empty() || guessPoints.size() == sourcePoints.size() );
+
+        auto rows = targetImagePyramid.front().rows;
+        auto cols = targetImagePyramid.front().cols;
+
+        // A predicted motion leaves only the residual to search
+        auto predicted = !guessPoints.empty();
+        auto levels = predicted ? std::min( m_levels, static_cast< size_t >( m_predictedLevels ) ) : m_levels;
+
+        trackedPoints->clear();
+
+        if ( KLTTracker::isSupported( sourceImagePyramid ) && KLTTracker::isSupported( targetImagePyramid ) ) {
+
+            KLTTracker tracker;
+
+            tracker.setWinSize( cv::Size( m_winSize, m_winSize ) );
+            tracker.setLevels( levels );
+            tracker.setTermCriteria( m_termCriteria );
+            tracker.setMinEigenValue( m_minEigenValue );
+
+            thread_local FlowTrackBuffer buffer;
+
+            if ( predicted )
+                tracker.track( sourceImagePyramid, sourcePoints, guessPoints, targetImagePyramid, &buffer );
+            else
+                tracker.track( sourceImagePyramid, sourcePoints, targetImagePyramid, &buffer );
+
+            for ( size_t i = 0; i < buffer.size(); ++i ) {
+
+                auto &opticalPoint = buffer.points[ i ];
+
+                if ( buffer.statuses[ i ] && buffer.misses[ i ] < m_checkDistance
+                     && opticalPoint.x >= 0 && opticalPoint.y >= 0
+                     && opticalPoint.x < cols && opticalPoint.y < rows ) {
+
+                    trackedPoints->push_back( FlowTrackResult( i, opticalPoint, buffer.errors[ i ], buffer.misses[ i ] ) );
+
+                }
+
+            }
+
+            return;
+
+        }
+
         std::vector< cv::Point2f > opticalPoints;
         std::vector< cv::Point2f > checkPoints;
 
@@ -282,16 +655,27 @@ void CPUFlowProcessor::track( const std::vector< cv::Mat > &sourceImagePyramid,
         std::vector< unsigned char > checkStatuses;
         std::vector< float > checkErr;
 
+        auto flags = cv::OPTFLOW_LK_GET_MIN_EIGENVALS;
+
+        if ( predicted ) {
+            opticalPoints = guessPoints;
+            flags |= cv::OPTFLOW_USE_INITIAL_FLOW;
+        }
+
         cv::calcOpticalFlowPyrLK( sourceImagePyramid, targetImagePyramid, sourcePoints, opticalPoints, statuses, err, cv::Size( m_winSize, m_winSize ),
-                                            m_levels, m_termCriteria, cv::OPTFLOW_LK_GET_MIN_EIGENVALS, m_minEigenValue );
+                                            levels, m_termCriteria, flags, m_minEigenValue );
 
-        cv::calcOpticalFlowPyrLK( targetImagePyramid, sourceImagePyramid, opticalPoints, checkPoints, checkStatuses, checkErr, cv::Size( m_winSize, m_winSize ),
-                                            m_levels, m_termCriteria, cv::OPTFLOW_LK_GET_MIN_EIGENVALS, m_minEigenValue );
+        // The backward pass starts from the inverse prediction
+        if ( predicted ) {
+            checkPoints.resize( opticalPoints.size() );
 
-        auto rows = targetImagePyramid.front().rows;
-        auto cols = targetImagePyramid.front().cols;
+            for ( size_t i = 0; i < opticalPoints.size(); ++i )
+                checkPoints[ i ] = opticalPoints[ i ] + sourcePoints[ i ] - guessPoints[ i ];
 
-        trackedPoints->clear();
+        }
+
+        cv::calcOpticalFlowPyrLK( targetImagePyramid, sourceImagePyramid, opticalPoints, checkPoints, checkStatuses, checkErr, cv::Size( m_winSize, m_winSize ),
+                                            levels, m_termCriteria, flags, m_minEigenValue );
 
         for ( size_t i = 0; i < statuses.size(); ++i ) {
 
@@ -311,10 +695,105 @@ void CPUFlowProcessor::track( const std::vector< cv::Mat > &sourceImagePyramid,
 
 }
 
+cv::Mat CPUFlowProcessor::trackStereo( const std::vector< cv::Mat > &leftImagePyramid, const std::vector< cv::Point2f > &leftPoints, const std::vector< cv::Mat > &rightImagePyramid,
+                                       const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints )
+{
+    PROFILE_SCOPE( "lk stereo tracking" );
+
+    if ( trackedPoints && !leftPoints.empty() ) {
+
+        trackedPoints->clear();
+
+        if ( KLTTracker::isSupported( leftImagePyramid ) && KLTTracker::isSupported( rightImagePyramid ) ) {
+
+            KLTTracker tracker;
+
+            tracker.setWinSize( cv::Size( m_winSize, m_winSize ) );
+            tracker.setLevels( m_levels );
+            tracker.setTermCriteria( m_termCriteria );
+            tracker.setMinEigenValue( m_minEigenValue );
+
+            thread_local FlowTrackBuffer buffer;
+
+            tracker.trackRows( leftImagePyramid, leftPoints, rightImagePyramid, minDisparity, maxDisparity, &buffer );
+
+            auto cols = rightImagePyramid.front().cols;
+
+            for ( size_t i = 0; i < buffer.size(); ++i ) {
+
+                auto &rightPoint = buffer.points[ i ];
+
+                auto disparity = leftPoints[ i ].x - rightPoint.x;
+
+                if ( buffer.statuses[ i ] && buffer.misses[ i ] < m_checkDistance
+                     && rightPoint.x >= 0 && rightPoint.x < cols
+                     && disparity >= minDisparity && disparity <= maxDisparity ) {
+
+                    trackedPoints->push_back( FlowTrackResult( i, rightPoint, buffer.errors[ i ], buffer.misses[ i ] ) );
+
+                }
+
+            }
+
+            return rectifiedFundamentalMatrix();
+
+        }
+
+        std::vector< FlowTrackResult > flowResults;
+
+        track( leftImagePyramid, leftPoints, rightImagePyramid, &flowResults );
+
+        std::vector< cv::Point2f > sourcePoints, targetPoints;
+        sourcePoints.reserve( flowResults.size() );
+        targetPoints.reserve( flowResults.size() );
+
+        for ( auto &i : flowResults ) {
+            sourcePoints.push_back( leftPoints[ i.index ] );
+            targetPoints.push_back( i );
+        }
+
+        std::vector< int > rowIndexes;
+
+        auto fmat = rowTest( sourcePoints, targetPoints, minDisparity, maxDisparity, &rowIndexes );
+
+        for ( auto &i : rowIndexes )
+            trackedPoints->push_back( flowResults[ i ] );
+
+        return fmat;
+
+    }
+
+    return cv::Mat();
+
+}
+
 void CPUFlowProcessor::buildImagePyramid( const CvImage &image, std::vector< cv::Mat > *imagePyramid )
 {
-    if ( imagePyramid )
-        cv::buildOpticalFlowPyramid( image, *imagePyramid, cv::Size( m_winSize, m_winSize ), m_levels );
+    if ( imagePyramid ) {
+
+        if ( imagePyramid->empty() )
+            m_pyramidPool.acquire( imagePyramid );
+
+        if ( image.channels() > 1 ) {
+
+            // Level 0 is copied with a border, so the gray image is scratch
+            thread_local cv::Mat grayImage;
+
+            cv::cvtColor( image, grayImage, cv::COLOR_BGR2GRAY );
+
+            cv::buildOpticalFlowPyramid( grayImage, *imagePyramid, cv::Size( m_winSize, m_winSize ), m_levels );
+
+        }
+        else
+            cv::buildOpticalFlowPyramid( image, *imagePyramid, cv::Size( m_winSize, m_winSize ), m_levels );
+
+    }
+
+}
+
+void CPUFlowProcessor::releaseImagePyramid( std::vector< cv::Mat > *imagePyramid )
+{
+    m_pyramidPool.release( imagePyramid );
 }
 
 size_t CPUFlowProcessor::winSize() const
@@ -357,43 +836,138 @@ double CPUFlowProcessor::minEigenValue() const
     return m_minEigenValue;
 }
 
-// KeyPointProcessor
-void KeyPointProcessor::extractKeypoints( const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints )
+// FeatureBatch
+void FeatureBatch::resize( const size_t size )
 {
-    ::extractKeypoints( m_processor, image, mask, keypoints );
+    keypoints.resize( size );
+    descriptors.resize( size );
 }
 
-// DescriptorProcessor
-void DescriptorProcessor::extractDescriptors( const CvImage &image, std::vector< cv::KeyPoint > &keypoints, cv::Mat *descriptors )
+size_t FeatureBatch::size() const
 {
-    ::extractDescriptors( m_processor, image, keypoints, descriptors );
+    return keypoints.size();
 }
 
-// FullProcessor
-void FullProcessor::extractAndCompute( const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints, cv::Mat *descriptors )
+// FeatureProcessor
+void FeatureProcessor::processBatch( const size_t count, const std::function< void( cv::Feature2D *processor, const size_t index ) > &function )
 {
-    ::extractAndCompute( m_processor, image, mask, keypoints, descriptors );
+    auto threadsCount = std::max( 1, std::min( static_cast< int >( count ), omp_get_max_threads() ) );
+
+    if ( m_threadProcessors.empty() || m_threadProcessors.front() != m_processor ) {
+        m_threadProcessors.clear();
+        m_threadProcessors.push_back( m_processor );
+    }
+
+    // A smaller batch uses the first instances, a larger one adds the missing ones
+    while ( m_threadProcessors.size() < static_cast< size_t >( threadsCount ) )
+        m_threadProcessors.push_back( createProcessor() );
+
+    #pragma omp parallel for num_threads( threadsCount ) schedule( dynamic )
+    for ( int i = 0; i < static_cast< int >( count ); ++i )
+        function( m_threadProcessors[ omp_get_thread_num() ].get(), i );
+
 }
 
-// GFTTProcessor
-GFTTProcessor::GFTTProcessor()
+void FeatureProcessor::resetThreadProcessors()
 {
-    initialize();
+    m_threadProcessors.clear();
 }
 
-void GFTTProcessor::initialize()
+// KeyPointProcessor
+void KeyPointProcessor::extractKeypoints( const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints )
 {
-    m_processor = cv::GFTTDetector::create( 1000, 1.e-3, 10. );
+    ::extractKeypoints( m_processor, image, mask, keypoints );
 }
 
-cv::Ptr< cv::GFTTDetector > GFTTProcessor::processor() const
+void KeyPointProcessor::extractKeypoints( const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, FeatureBatch *batch )
 {
-    return std::dynamic_pointer_cast< cv::GFTTDetector >( m_processor );
+    if ( batch ) {
+
+        CV_Assert( masks.empty() || masks.size() == images.size() );
+
+        batch->resize( images.size() );
+
+        processBatch( images.size(), [ & ]( cv::Feature2D *processor, const size_t index ) {
+            processor->detect( images[ index ], batch->keypoints[ index ], masks.empty() ? cv::Mat() : masks[ index ] );
+        } );
+
+    }
+
+}
+
+// DescriptorProcessor
+void DescriptorProcessor::extractDescriptors( const CvImage &image, std::vector< cv::KeyPoint > &keypoints, cv::Mat *descriptors )
+{
+    ::extractDescriptors( m_processor, image, keypoints, descriptors );
+}
+
+void DescriptorProcessor::extractDescriptors( const std::vector< CvImage > &images, FeatureBatch *batch )
+{
+    if ( batch ) {
+
+        CV_Assert( batch->size() == images.size() );
+
+        processBatch( images.size(), [ & ]( cv::Feature2D *processor, const size_t index ) {
+            processor->compute( images[ index ], batch->keypoints[ index ], batch->descriptors[ index ] );
+        } );
+
+    }
+
+}
+
+// FullProcessor
+void FullProcessor::extractAndCompute( const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints, cv::Mat *descriptors )
+{
+    ::extractAndCompute( m_processor, image, mask, keypoints, descriptors );
+}
+
+void FullProcessor::extractAndCompute( const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, FeatureBatch *batch )
+{
+    if ( batch ) {
+
+        CV_Assert( masks.empty() || masks.size() == images.size() );
+
+        batch->resize( images.size() );
+
+        processBatch( images.size(), [ & ]( cv::Feature2D *processor, const size_t index ) {
+            processor->detectAndCompute( images[ index ], masks.empty() ? cv::Mat() : masks[ index ], batch->keypoints[ index ], batch->descriptors[ index ] );
+        } );
+
+    }
+
+}
+
+// GFTTProcessor
+GFTTProcessor::GFTTProcessor()
+{
+    initialize();
+}
+
+void GFTTProcessor::initialize()
+{
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > GFTTProcessor::createProcessor() const
+{
+    auto current = processor();
+
+    if ( current )
+        return cv::GFTTDetector::create( current->getMaxFeatures(), current->getQualityLevel(), current->getMinDistance(),
+                                         current->getBlockSize(), current->getHarrisDetector(), current->getK() );
+
+    return cv::GFTTDetector::create( 1000, 1.e-3, 10. );
+}
+
+cv::Ptr< cv::GFTTDetector > GFTTProcessor::processor() const
+{
+    return std::dynamic_pointer_cast< cv::GFTTDetector >( m_processor );
 }
 
 void GFTTProcessor::setMaxFeatures( const int value )
 {
     processor()->setMaxFeatures( value );
+    resetThreadProcessors();
 }
 
 int GFTTProcessor::maxFeatures() const
@@ -404,6 +978,7 @@ int GFTTProcessor::maxFeatures() const
 void GFTTProcessor::setQualityLevel( double value )
 {
     processor()->setQualityLevel( value );
+    resetThreadProcessors();
 }
 
 double GFTTProcessor::qualityLevel() const
@@ -414,6 +989,7 @@ double GFTTProcessor::qualityLevel() const
 void GFTTProcessor::setMinDistance( double value )
 {
     processor()->setMinDistance( value );
+    resetThreadProcessors();
 }
 
 double GFTTProcessor::minDistance() const
@@ -424,6 +1000,7 @@ double GFTTProcessor::minDistance() const
 void GFTTProcessor::setBlockSize( int value )
 {
     processor()->setBlockSize( value );
+    resetThreadProcessors();
 }
 
 int GFTTProcessor::blockSize() const
@@ -434,6 +1011,7 @@ int GFTTProcessor::blockSize() const
 void GFTTProcessor::setHarrisDetector( bool value )
 {
     processor()->setHarrisDetector( value );
+    resetThreadProcessors();
 }
 
 bool GFTTProcessor::harrisDetector() const
@@ -444,6 +1022,7 @@ bool GFTTProcessor::harrisDetector() const
 void GFTTProcessor::setK( double value )
 {
     processor()->setK( value );
+    resetThreadProcessors();
 }
 
 double GFTTProcessor::k() const
@@ -459,7 +1038,17 @@ FastProcessor::FastProcessor()
 
 void FastProcessor::initialize()
 {
-    m_processor = cv::FastFeatureDetector::create( 50 );
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > FastProcessor::createProcessor() const
+{
+    auto current = processor();
+
+    if ( current )
+        return cv::FastFeatureDetector::create( current->getThreshold(), current->getNonmaxSuppression(), current->getType() );
+
+    return cv::FastFeatureDetector::create( 50 );
 }
 
 cv::Ptr< cv::FastFeatureDetector > FastProcessor::processor() const
@@ -470,6 +1059,7 @@ cv::Ptr< cv::FastFeatureDetector > FastProcessor::processor() const
 void FastProcessor::setThreshold( const int value )
 {
     processor()->setThreshold( value );
+    resetThreadProcessors();
 }
 
 int FastProcessor::threshold() const
@@ -480,6 +1070,7 @@ int FastProcessor::threshold() const
 void FastProcessor::setNonmaxSuppression( bool value )
 {
     processor()->setNonmaxSuppression( value );
+    resetThreadProcessors();
 }
 
 bool FastProcessor::nonmaxSuppression()
@@ -490,6 +1081,7 @@ bool FastProcessor::nonmaxSuppression()
 void FastProcessor::setType( cv::FastFeatureDetector::DetectorType value )
 {
     processor()->setType( value );
+    resetThreadProcessors();
 }
 
 cv::FastFeatureDetector::DetectorType FastProcessor::type()
@@ -500,10 +1092,15 @@ cv::FastFeatureDetector::DetectorType FastProcessor::type()
 // SuperGlueProcessor
 SuperGlueProcessor::SuperGlueProcessor( const std::string &detectorModelFile, const std::string &matcherModelFile )
 {
-    initialize( detectorModelFile, matcherModelFile );
+    initialize( detectorModelFile, matcherModelFile, backendConfig( detectorModelFile ) );
+}
+
+SuperGlueProcessor::SuperGlueProcessor( const std::string &detectorModelFile, const std::string &matcherModelFile, const marker::BackendConfig &backendConfig )
+{
+    initialize( detectorModelFile, matcherModelFile, backendConfig );
 }
 
-void SuperGlueProcessor::initialize( const std::string &detectorModelFile, const std::string &matcherModelFile )
+void SuperGlueProcessor::initialize( const std::string &detectorModelFile, const std::string &matcherModelFile, const marker::BackendConfig &backendConfig )
 {
     marker::StreamLogger logger( std::cout, marker::StreamLogger::Severity::kWARNING );
 
@@ -514,9 +1111,25 @@ void SuperGlueProcessor::initialize( const std::string &detectorModelFile, const
 
     _matcherThreshold = 0.5;
 
-    _detector = std::make_unique< marker::SuperPointDetector >( detectorModelFile, logger );
-    _keypointSelector = std::make_unique< marker::KeypointSelector >( cfg, _detector->scores_shape() );
-    _matcher = std::make_unique< marker::SuperGlueMatcher >( matcherModelFile, logger );
+    _detector = std::make_unique< marker::SuperPointDetector >( detectorModelFile, logger, backendConfig );
+    _keypointSelector = std::make_unique< marker::KeypointSelector >( cfg, _detector->scores_shape(), _detector->device() );
+    _matcher = std::make_unique< marker::SuperGlueMatcher >( matcherModelFile, logger, backendConfig );
+    _featureCache = std::make_unique< marker::FeatureCache >( _defaultCacheSize );
+}
+
+marker::BackendConfig SuperGlueProcessor::backendConfig( const std::string &modelFile )
+{
+    static const std::string torchScriptExtension = ".pt";
+
+    marker::BackendConfig ret;
+
+    auto torchScript = modelFile.size() >= torchScriptExtension.size() &&
+            modelFile.compare( modelFile.size() - torchScriptExtension.size(), torchScriptExtension.size(), torchScriptExtension ) == 0;
+
+    ret.type = torchScript ? marker::BackendType::TORCH_CPU : marker::BackendType::TENSOR_RT;
+
+    return ret;
+
 }
 
 void SuperGlueProcessor::setMatchingThreshold( const double value )
@@ -532,30 +1145,276 @@ int SuperGlueProcessor::matchingThreshold() const
 void SuperGlueProcessor::extractAndMatch( const CvImage &image1, const cv::Mat &mask1, const CvImage &image2, const cv::Mat &mask2,
                                             std::vector<cv::KeyPoint> *keypoints1, std::vector<cv::KeyPoint> *keypoints2, const size_t count, std::vector<cv::DMatch> *matches )
 {
-    CV_Assert( image1.channels() == 1 && image2.channels() == 1 );
+    std::vector< std::vector< cv::KeyPoint > > keypoints;
+    std::vector< std::vector< cv::DMatch > > pairMatches;
+
+    extractAndMatch( { image1, image2 }, { mask1, mask2 }, { { 0, 1 } }, count, &keypoints, &pairMatches );
+
+    *keypoints1 = std::move( keypoints[ 0 ] );
+    *keypoints2 = std::move( keypoints[ 1 ] );
+    *matches = std::move( pairMatches.front() );
+
+}
+
+void SuperGlueProcessor::extractAndMatch( const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, const std::vector< std::pair< size_t, size_t > > &pairs, const size_t count,
+                                            std::vector< std::vector< cv::KeyPoint > > *keypoints, std::vector< std::vector< cv::DMatch > > *matches )
+{
+    PROFILE_SCOPE( "superglue matching" );
+
+    CV_Assert( !images.empty() && images.size() <= maxBatchSize() );
     CV_Assert( count <= _maxPointsCount );
 
-    _detector->detect( image1, image2 );
+    for ( auto &i : images )
+        CV_Assert( i.channels() == 1 );
+
+    _detector->detect( std::vector< cv::Mat >( images.begin(), images.end() ) );
     auto& scoreMap = _detector->score_map();
     auto& descrMap = _detector->descriptor_map();
 
-    auto keypointSet = marker::KeypointSelector::make_keypoints();
+    auto keypointSet = marker::KeypointSelector::make_keypoints( _detector->device(), images.size() );
 
-    _keypointSelector->select_keypoints( scoreMap, mask1, mask2, count, keypointSet );
+    _keypointSelector->select_keypoints( scoreMap, masks, count, keypointSet );
 
     auto descrSets = marker::sample_descriptors( descrMap, keypointSet );
 
-    _matcher->match( keypointSet, descrSets );
-    auto& match_table = _matcher->output();
+    std::vector< marker::ImagePair > imagePairs;
+
+    imagePairs.reserve( pairs.size() );
+
+    for ( auto &i : pairs ) {
+        CV_Assert( i.first < images.size() && i.second < images.size() );
+        imagePairs.push_back( { static_cast< int >( i.first ), static_cast< int >( i.second ) } );
+    }
+
+    _matcher->match( keypointSet, descrSets, imagePairs );
+    auto& match_tables = _matcher->outputs();
+
+    keypoints->resize( images.size() );
+
+    for ( size_t i = 0; i < images.size(); ++i )
+        keypointSet[ i ].get_keypoints( keypoints->at( i ) );
+
+    matches->resize( pairs.size() );
+
+    for ( size_t i = 0; i < pairs.size(); ++i )
+        extractMatches( match_tables[ i ], &matches->at( i ) );
+
+}
+
+size_t SuperGlueProcessor::maxBatchSize() const
+{
+    return _detector->max_batch_size();
+}
+
+void SuperGlueProcessor::extractFeatures( const std::vector< size_t > &frameIds, const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, const size_t count,
+                                            std::vector< std::vector< cv::KeyPoint > > *keypoints )
+{
+    PROFILE_SCOPE( "superpoint extraction" );
+
+    CV_Assert( frameIds.size() == images.size() && frameIds.size() <= cacheSize() );
+    CV_Assert( count <= _maxPointsCount );
+
+    std::vector< size_t > missedIds;
+    std::vector< cv::Mat > missedImages;
+    std::vector< cv::Mat > missedMasks;
+
+    std::vector< size_t > reselectedIndexes;
+
+    for ( size_t i = 0; i < frameIds.size(); ++i ) {
+
+        auto features = _featureCache->find( frameIds[ i ] );
+        auto mask = i < masks.size() ? masks[ i ] : cv::Mat();
+
+        if ( !features ) {
+            CV_Assert( images[ i ].channels() == 1 );
+
+            missedIds.push_back( frameIds[ i ] );
+            missedImages.push_back( images[ i ] );
+            missedMasks.push_back( mask );
+        }
+        else if ( features->keypoint_count != static_cast< int >( count ) || features->mask_hash != maskHash( mask ) )
+            reselectedIndexes.push_back( i );
+
+    }
+
+    for ( size_t begin = 0; begin < missedIds.size(); begin += maxBatchSize() ) {
+
+        auto end = std::min( missedIds.size(), begin + maxBatchSize() );
+
+        detectFeatures( std::vector< size_t >( missedIds.begin() + begin, missedIds.begin() + end ),
+                        std::vector< cv::Mat >( missedImages.begin() + begin, missedImages.begin() + end ),
+                        std::vector< cv::Mat >( missedMasks.begin() + begin, missedMasks.begin() + end ), count );
+
+    }
+
+    // Cached maps are enough to select another count of keypoints or under another mask
+    for ( auto i : reselectedIndexes )
+        selectFeatures( _featureCache->find( frameIds[ i ] ), i < masks.size() ? masks[ i ] : cv::Mat(), count );
 
-    keypointSet[ 0 ].get_keypoints( *keypoints1 );
-    keypointSet[ 1 ].get_keypoints( *keypoints2 );
+    keypoints->resize( frameIds.size() );
 
+    for ( size_t i = 0; i < frameIds.size(); ++i )
+        _featureCache->find( frameIds[ i ] )->keypoints.get_keypoints( keypoints->at( i ) );
+
+}
+
+void SuperGlueProcessor::detectFeatures( const std::vector< size_t > &frameIds, const std::vector< cv::Mat > &images, const std::vector< cv::Mat > &masks, const size_t count )
+{
+    _detector->detect( images );
+    auto& scoreMap = _detector->score_map();
+    auto& descrMap = _detector->descriptor_map();
+
+    auto keypointSet = marker::KeypointSelector::make_keypoints( _detector->device(), images.size() );
+
+    _keypointSelector->select_keypoints( scoreMap, masks, count, keypointSet );
+
+    auto descrSets = marker::sample_descriptors( descrMap, keypointSet );
+
+    for ( size_t i = 0; i < frameIds.size(); ++i ) {
+        marker::FrameFeatures features;
+
+        // Maps are views of the detector buffers, so they are copied out
+        features.score_map = scoreMap.values.select( 0, i ).clone();
+        features.descriptor_map = descrMap.values.select( 0, i ).clone();
+        features.image_size = images[ i ].size();
+        features.keypoints = keypointSet[ i ];
+        features.descriptors = descrSets[ i ];
+        features.keypoint_count = count;
+        features.mask_hash = maskHash( masks[ i ] );
+
+        _featureCache->insert( frameIds[ i ], std::move( features ) );
+    }
+
+}
+
+void SuperGlueProcessor::selectFeatures( marker::FrameFeatures *features, const cv::Mat &mask, const size_t count )
+{
+    marker::ScoreMap scoreMap;
+    scoreMap.values = features->score_map.unsqueeze( 0 );
+    scoreMap.image_size = { features->image_size };
+
+    marker::DescriptorMap descrMap;
+    descrMap.values = features->descriptor_map.unsqueeze( 0 );
+
+    auto keypointSet = marker::KeypointSelector::make_keypoints( _detector->device(), 1 );
+
+    _keypointSelector->select_keypoints( scoreMap, { mask }, count, keypointSet );
+
+    auto descrSets = marker::sample_descriptors( descrMap, keypointSet );
+
+    features->keypoints = keypointSet.front();
+    features->descriptors = descrSets.front();
+    features->keypoint_count = count;
+    features->mask_hash = maskHash( mask );
+}
+
+size_t SuperGlueProcessor::maskHash( const cv::Mat &mask )
+{
+    if ( mask.empty() )
+        return 0;
+
+    // FNV-1a over the size and the mask bytes
+    size_t ret = 14695981039346656037ull;
+
+    auto add = [ &ret ]( const uchar value ) {
+        ret ^= value;
+        ret *= 1099511628211ull;
+    };
+
+    for ( auto i : { mask.rows, mask.cols, mask.type() } )
+        for ( size_t j = 0; j < sizeof( i ); ++j )
+            add( static_cast< uchar >( i >> ( 8 * j ) ) );
+
+    for ( int i = 0; i < mask.rows; ++i ) {
+        auto row = mask.ptr< uchar >( i );
+
+        for ( size_t j = 0; j < mask.cols * mask.elemSize(); ++j )
+            add( row[ j ] );
+    }
+
+    // Zero stays for no mask
+    return ret ? ret : 1;
+
+}
+
+void SuperGlueProcessor::match( const size_t frameId1, const size_t frameId2, std::vector< cv::DMatch > *matches )
+{
+    std::vector< std::vector< cv::DMatch > > pairMatches;
+
+    match( { { frameId1, frameId2 } }, &pairMatches );
+
+    *matches = std::move( pairMatches.front() );
+}
+
+void SuperGlueProcessor::match( const std::vector< std::pair< size_t, size_t > > &framePairs, std::vector< std::vector< cv::DMatch > > *matches )
+{
+    PROFILE_SCOPE( "superglue matching" );
+
+    std::vector< size_t > frameIds;
+
+    marker::KeypointSetArray keypointSet;
+    marker::DescriptorSetArray descrSets;
+
+    auto frameIndex = [ & ]( const size_t frameId ) {
+        auto it = std::find( frameIds.begin(), frameIds.end(), frameId );
+
+        if ( it != frameIds.end() )
+            return static_cast< int >( it - frameIds.begin() );
+
+        auto features = _featureCache->find( frameId );
+
+        CV_Assert( features );
+
+        frameIds.push_back( frameId );
+        keypointSet.push_back( features->keypoints );
+        descrSets.push_back( features->descriptors );
+
+        return static_cast< int >( frameIds.size() - 1 );
+    };
+
+    std::vector< marker::ImagePair > imagePairs;
+
+    imagePairs.reserve( framePairs.size() );
+
+    for ( auto &i : framePairs ) {
+        auto first = frameIndex( i.first );
+        auto second = frameIndex( i.second );
+
+        imagePairs.push_back( { first, second } );
+    }
+
+    _matcher->match( keypointSet, descrSets, imagePairs );
+    auto& match_tables = _matcher->outputs();
+
+    matches->resize( framePairs.size() );
+
+    for ( size_t i = 0; i < framePairs.size(); ++i )
+        extractMatches( match_tables[ i ], &matches->at( i ) );
+
+}
+
+void SuperGlueProcessor::setCacheSize( const size_t value )
+{
+    _featureCache->set_capacity( value );
+}
+
+size_t SuperGlueProcessor::cacheSize() const
+{
+    return _featureCache->capacity();
+}
+
+void SuperGlueProcessor::clearCache()
+{
+    _featureCache->clear();
+}
+
+void SuperGlueProcessor::extractMatches( const marker::MatchTable &table, std::vector< cv::DMatch > *matches ) const
+{
     matches->clear();
 
     cv::Mat scores;
 
-    match_table.get_scores(scores);
+    table.get_scores(scores);
 
     for(int i = 0; i < scores.rows - 1; ++i) {
         auto row_begin = scores.ptr<float>(i);
@@ -574,42 +1433,26 @@ void SuperGlueProcessor::extractAndMatch( const CvImage &image1, const cv::Mat &
 
 void SuperGlueProcessor::match( const CvImage &image1, const CvImage &image2, const std::vector<cv::KeyPoint> &keypoints1, const std::vector<cv::KeyPoint> &keypoints2, std::vector< cv::DMatch > *matches )
 {
+    PROFILE_SCOPE( "superglue matching" );
+
     CV_Assert( image1.channels() == 1 && image2.channels() == 1 );
 
     _detector->detect( image1, image2 );
     auto& descrMap = _detector->descriptor_map();
 
-    auto keypointSet = marker::KeypointSelector::make_keypoints();
+    auto keypointSet = marker::KeypointSelector::make_keypoints( _detector->device() );
 
     keypointSet[ 0 ].image_size = image1.size();
     keypointSet[ 1 ].image_size = image2.size();
 
-    keypointSet[ 0 ].set_keypoints( keypoints1 );
-    keypointSet[ 1 ].set_keypoints( keypoints2 );
+    keypointSet[ 0 ].set_keypoints( keypoints1, _detector->device() );
+    keypointSet[ 1 ].set_keypoints( keypoints2, _detector->device() );
 
     auto descrSets = marker::sample_descriptors( descrMap, keypointSet );
 
     _matcher->match( keypointSet, descrSets );
-    auto& match_table = _matcher->output();
-
-    matches->clear();
 
-    cv::Mat scores;
-
-    match_table.get_scores(scores);
-
-    for(int i = 0; i < scores.rows - 1; ++i) {
-        auto row_begin = scores.ptr<float>(i);
-        auto row_end = row_begin + scores.cols;
-        auto max_score = std::max_element(row_begin, row_end);
-        if ( max_score < row_end - 1 && *max_score > _matcherThreshold )
-        {
-            int j = max_score - row_begin;
-            float d = 1.f - *max_score;
-            matches->emplace_back( i, j, d );
-        }
-
-    }
+    extractMatches( _matcher->output(), matches );
 
 }
 
@@ -621,7 +1464,12 @@ DaisyProcessor::DaisyProcessor()
 
 void DaisyProcessor::initialize()
 {
-    m_processor = cv::xfeatures2d::DAISY::create();
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > DaisyProcessor::createProcessor() const
+{
+    return cv::xfeatures2d::DAISY::create();
 }
 
 // DaisyProcessor
@@ -632,7 +1480,12 @@ FreakProcessor::FreakProcessor()
 
 void FreakProcessor::initialize()
 {
-    m_processor = cv::xfeatures2d::FREAK::create();
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > FreakProcessor::createProcessor() const
+{
+    return cv::xfeatures2d::FREAK::create();
 }
 
 // SiftProcessor
@@ -643,7 +1496,12 @@ SiftProcessor::SiftProcessor()
 
 void SiftProcessor::initialize()
 {
-    m_processor = cv::SIFT::create( 5000 );
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > SiftProcessor::createProcessor() const
+{
+    return cv::SIFT::create( 5000 );
 }
 
 // SurfProcessor
@@ -654,7 +1512,12 @@ SurfProcessor::SurfProcessor()
 
 void SurfProcessor::initialize()
 {
-    m_processor = cv::xfeatures2d::SURF::create();
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > SurfProcessor::createProcessor() const
+{
+    return cv::xfeatures2d::SURF::create();
 }
 
 // OrbProcessor
@@ -665,7 +1528,12 @@ OrbProcessor::OrbProcessor()
 
 void OrbProcessor::initialize()
 {
-    m_processor = cv::ORB::create( 5000 );
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > OrbProcessor::createProcessor() const
+{
+    return cv::ORB::create( 5000 );
 }
 
 // KazeProcessor
@@ -676,7 +1544,12 @@ KazeProcessor::KazeProcessor()
 
 void KazeProcessor::initialize()
 {
-    m_processor = cv::KAZE::create();
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > KazeProcessor::createProcessor() const
+{
+    return cv::KAZE::create();
 }
 
 // AKazeProcessor
@@ -687,7 +1560,12 @@ AKazeProcessor::AKazeProcessor()
 
 void AKazeProcessor::initialize()
 {
-    m_processor = cv::AKAZE::create();
+    m_processor = createProcessor();
+}
+
+cv::Ptr< cv::Feature2D > AKazeProcessor::createProcessor() const
+{
+    return cv::AKAZE::create();
 }
 
 // FeatureMatcherBase
@@ -706,6 +1584,8 @@ DescriptorMatcher::DescriptorMatcher()
 cv::Mat DescriptorMatcher::match( const std::vector< cv::KeyPoint > &queryKeypoints, const cv::Mat &queryDescriptors,
                               const std::vector< cv::KeyPoint > &trainKeypoints, const cv::Mat &trainDescriptors, std::vector< cv::DMatch > *matches )
 {
+    PROFILE_SCOPE( "descriptor matching" );
+
     if ( matches ) {
 
         matches->clear();
@@ -713,41 +1593,26 @@ cv::Mat DescriptorMatcher::match( const std::vector< cv::KeyPoint > &queryKeypoi
         if ( !queryKeypoints.empty() ) {
 
             std::vector< std::vector< cv::DMatch > > fwdKnnMatches;
-            m_matcher->knnMatch( queryDescriptors, trainDescriptors, fwdKnnMatches, 2 );
-
-            std::vector< cv::DMatch > fwdMatches;
-
-            for ( size_t i = 0; i < fwdKnnMatches.size(); ++i ) {
-                if ( fwdKnnMatches[ i ].size() > 1 && fwdKnnMatches[ i ][ 0 ].distance < m_threshold * fwdKnnMatches[ i ][ 1 ].distance ) {
-                    fwdMatches.push_back( fwdKnnMatches[ i ][ 0 ] );
-                }
-
-            }
-
             std::vector< std::vector< cv::DMatch > > revKnnMatches;
-            m_matcher->knnMatch( trainDescriptors, queryDescriptors, revKnnMatches, 2 );
 
-            std::vector< cv::DMatch > revMatches;
+            knnMatch( queryKeypoints, queryDescriptors, trainKeypoints, trainDescriptors, &fwdKnnMatches, &revKnnMatches );
 
-            for ( size_t i = 0; i < revKnnMatches.size(); ++i ) {
-                if ( revKnnMatches[ i ].size() > 1 && revKnnMatches[ i ][ 0 ].distance < m_threshold * revKnnMatches[ i ][ 1 ].distance ) {
-                    revMatches.push_back( revKnnMatches[ i ][ 0 ] );
-                }
+            std::vector< int > fwdIndexes;
+            std::vector< int > revIndexes;
 
-            }
+            ratioTest( fwdKnnMatches, &fwdIndexes );
+            ratioTest( revKnnMatches, &revIndexes );
 
+            // A forward match is symmetric when the best reverse match of its
+            // train point leads back to it
             std::vector< cv::DMatch > symMatches;
 
-            for ( auto &i : fwdMatches ) {
+            for ( size_t i = 0; i < fwdIndexes.size(); ++i ) {
 
-                for ( auto &j : revMatches ) {
+                auto trainIdx = fwdIndexes[ i ];
 
-                    if ( i.queryIdx == j.trainIdx && i.trainIdx == j.queryIdx ) {
-                        symMatches.push_back( i );
-                        break;
-                    }
-
-                }
+                if ( trainIdx >= 0 && static_cast< size_t >( trainIdx ) < revIndexes.size() && revIndexes[ trainIdx ] == fwdKnnMatches[ i ][ 0 ].queryIdx )
+                    symMatches.push_back( fwdKnnMatches[ i ][ 0 ] );
 
             }
 
@@ -783,16 +1648,475 @@ cv::Mat DescriptorMatcher::match( const std::vector< cv::KeyPoint > &queryKeypoi
 
 }
 
-// FlannMatcher
-BFMatcher::BFMatcher()
-    : DescriptorMatcher()
+size_t DescriptorMatcher::guidedMatch( const std::vector< cv::Point2f > &predictedPoints, const cv::Mat &queryDescriptors,
+                                       const std::vector< cv::Point2f > &trainPoints, const cv::Mat &trainDescriptors,
+                                       const double radius, std::vector< cv::DMatch > *matches ) const
+{
+    PROFILE_SCOPE( "guided matching" );
+
+    if ( !matches )
+        return 0;
+
+    matches->clear();
+
+    if ( predictedPoints.empty() || trainPoints.empty() || radius <= 0. )
+        return 0;
+
+    CV_Assert( static_cast< int >( predictedPoints.size() ) == queryDescriptors.rows && static_cast< int >( trainPoints.size() ) == trainDescriptors.rows );
+
+    // Train points bucketed into cells of the radius size, so a query only
+    // visits the 3x3 cells around its prediction
+    auto bounds = cv::boundingRect( trainPoints );
+
+    auto cellSize = static_cast< float >( radius );
+
+    auto gridCols = static_cast< int >( bounds.width / cellSize ) + 1;
+    auto gridRows = static_cast< int >( bounds.height / cellSize ) + 1;
+
+    std::vector< std::vector< int > > grid( gridCols * gridRows );
+
+    for ( size_t i = 0; i < trainPoints.size(); ++i ) {
+
+        auto col = static_cast< int >( ( trainPoints[ i ].x - bounds.x ) / cellSize );
+        auto row = static_cast< int >( ( trainPoints[ i ].y - bounds.y ) / cellSize );
+
+        grid[ std::min( row, gridRows - 1 ) * gridCols + std::min( col, gridCols - 1 ) ].push_back( i );
+
+    }
+
+    auto radiusSquared = radius * radius;
+    auto normType = this->normType();
+
+    std::vector< cv::DMatch > bestMatches( predictedPoints.size(), cv::DMatch( -1, -1, std::numeric_limits< float >::max() ) );
+
+    #pragma omp parallel for schedule( dynamic, 64 )
+    for ( int i = 0; i < static_cast< int >( predictedPoints.size() ); ++i ) {
+
+        auto &point = predictedPoints[ i ];
+
+        auto col = static_cast< int >( std::floor( ( point.x - bounds.x ) / cellSize ) );
+        auto row = static_cast< int >( std::floor( ( point.y - bounds.y ) / cellSize ) );
+
+        std::vector< cv::DMatch > best( 2, cv::DMatch( i, -1, std::numeric_limits< float >::max() ) );
+
+        for ( auto r = std::max( row - 1, 0 ); r <= std::min( row + 1, gridRows - 1 ); ++r )
+            for ( auto c = std::max( col - 1, 0 ); c <= std::min( col + 1, gridCols - 1 ); ++c )
+                for ( auto j : grid[ r * gridCols + c ] ) {
+
+                    auto delta = trainPoints[ j ] - point;
+
+                    if ( delta.dot( delta ) > radiusSquared )
+                        continue;
+
+                    auto distance = static_cast< float >( cv::norm( queryDescriptors.row( i ), trainDescriptors.row( j ), normType ) );
+
+                    if ( distance < best[ 0 ].distance ) {
+                        best[ 1 ] = best[ 0 ];
+                        best[ 0 ] = cv::DMatch( i, j, distance );
+                    }
+                    else if ( distance < best[ 1 ].distance )
+                        best[ 1 ] = cv::DMatch( i, j, distance );
+
+                }
+
+        // A single candidate in the window is accepted, the prediction
+        // already did the job of the ratio test
+        if ( best[ 0 ].trainIdx >= 0 && ( best[ 1 ].trainIdx < 0 || best[ 0 ].distance < m_threshold * best[ 1 ].distance ) )
+            bestMatches[ i ] = best[ 0 ];
+
+    }
+
+    // Each train point keeps its best query only
+    std::vector< int > trainOwners( trainPoints.size(), -1 );
+
+    for ( size_t i = 0; i < bestMatches.size(); ++i ) {
+
+        auto trainIdx = bestMatches[ i ].trainIdx;
+
+        if ( trainIdx >= 0 ) {
+
+            auto &owner = trainOwners[ trainIdx ];
+
+            if ( owner < 0 || bestMatches[ i ].distance < bestMatches[ owner ].distance )
+                owner = i;
+
+        }
+
+    }
+
+    for ( size_t i = 0; i < bestMatches.size(); ++i )
+        if ( bestMatches[ i ].trainIdx >= 0 && trainOwners[ bestMatches[ i ].trainIdx ] == static_cast< int >( i ) )
+            matches->push_back( bestMatches[ i ] );
+
+    return matches->size();
+
+}
+
+int DescriptorMatcher::normType() const
+{
+    return cv::NORM_L2;
+}
+
+void DescriptorMatcher::knnMatch( const std::vector< cv::KeyPoint > &, const cv::Mat &queryDescriptors,
+                                  const std::vector< cv::KeyPoint > &, const cv::Mat &trainDescriptors,
+                                  std::vector< std::vector< cv::DMatch > > *fwdKnnMatches, std::vector< std::vector< cv::DMatch > > *revKnnMatches )
+{
+    m_matcher->knnMatch( queryDescriptors, trainDescriptors, *fwdKnnMatches, 2 );
+    m_matcher->knnMatch( trainDescriptors, queryDescriptors, *revKnnMatches, 2 );
+}
+
+void DescriptorMatcher::ratioTest( const std::vector< std::vector< cv::DMatch > > &knnMatches, std::vector< int > *bestIndexes )
+{
+    bestIndexes->assign( knnMatches.size(), -1 );
+
+    #pragma omp parallel for
+    for ( int i = 0; i < static_cast< int >( knnMatches.size() ); ++i ) {
+
+        auto &knn = knnMatches[ i ];
+
+        if ( knn.size() > 1 && knn[ 0 ].distance < m_threshold * knn[ 1 ].distance )
+            ( *bestIndexes )[ i ] = knn[ 0 ].trainIdx;
+
+    }
+
+}
+
+// BFMatcher
+BFMatcher::BFMatcher( const int normType )
+    : DescriptorMatcher(), m_normType( normType )
 {
     initialize();
 }
 
 void BFMatcher::initialize()
 {
-    m_matcher = cv::BFMatcher::create();
+    m_matcher = cv::BFMatcher::create( m_normType );
+
+    m_singlePass = false;
+}
+
+void BFMatcher::setSinglePass( const bool value )
+{
+    m_singlePass = value;
+}
+
+bool BFMatcher::singlePass() const
+{
+    return m_singlePass;
+}
+
+int BFMatcher::normType() const
+{
+    return m_normType;
+}
+
+void updateBestMatches( std::vector< cv::DMatch > *best, const int queryIdx, const int trainIdx, const float distance )
+{
+    if ( distance < ( *best )[ 0 ].distance ) {
+        ( *best )[ 1 ] = ( *best )[ 0 ];
+        ( *best )[ 0 ] = cv::DMatch( queryIdx, trainIdx, distance );
+    }
+    else if ( distance < ( *best )[ 1 ].distance )
+        ( *best )[ 1 ] = cv::DMatch( queryIdx, trainIdx, distance );
+
+}
+
+void mergeBestMatches( std::vector< cv::DMatch > *best, const cv::DMatch &match )
+{
+    auto isBetter = []( const cv::DMatch &first, const cv::DMatch &second ) {
+        return first.distance < second.distance || ( first.distance == second.distance && first.trainIdx < second.trainIdx );
+    };
+
+    if ( match.trainIdx < 0 )
+        return;
+
+    if ( isBetter( match, ( *best )[ 0 ] ) ) {
+        ( *best )[ 1 ] = ( *best )[ 0 ];
+        ( *best )[ 0 ] = match;
+    }
+    else if ( isBetter( match, ( *best )[ 1 ] ) )
+        ( *best )[ 1 ] = match;
+
+}
+
+void removeEmptyMatches( std::vector< std::vector< cv::DMatch > > *knnMatches )
+{
+    for ( auto &i : *knnMatches )
+        while ( !i.empty() && i.back().trainIdx < 0 )
+            i.pop_back();
+}
+
+void BFMatcher::knnMatch( const std::vector< cv::KeyPoint > &queryKeypoints, const cv::Mat &queryDescriptors,
+                          const std::vector< cv::KeyPoint > &trainKeypoints, const cv::Mat &trainDescriptors,
+                          std::vector< std::vector< cv::DMatch > > *fwdKnnMatches, std::vector< std::vector< cv::DMatch > > *revKnnMatches )
+{
+    if ( !m_singlePass || queryDescriptors.empty() || trainDescriptors.empty() ) {
+        DescriptorMatcher::knnMatch( queryKeypoints, queryDescriptors, trainKeypoints, trainDescriptors, fwdKnnMatches, revKnnMatches );
+        return;
+    }
+
+    // The distance is symmetric, so one tiled pass over the distance matrix
+    // gives the two nearest neighbours in both directions. Ties keep the
+    // lowest index, like cv::BFMatcher does.
+    auto queryCount = queryDescriptors.rows;
+    auto trainCount = trainDescriptors.rows;
+
+    auto dtype = m_normType == cv::NORM_HAMMING || m_normType == cv::NORM_HAMMING2 ? CV_32S : CV_32F;
+
+    const cv::DMatch empty( -1, -1, std::numeric_limits< float >::max() );
+
+    fwdKnnMatches->assign( queryCount, std::vector< cv::DMatch >( 2, empty ) );
+
+    auto tilesCount = ( queryCount + m_tileSize - 1 ) / m_tileSize;
+
+    std::vector< std::vector< std::vector< cv::DMatch > > > threadRevMatches;
+
+    #pragma omp parallel
+    {
+        std::vector< std::vector< cv::DMatch > > revMatches( trainCount, std::vector< cv::DMatch >( 2, empty ) );
+
+        cv::Mat distances;
+
+        #pragma omp for schedule( dynamic )
+        for ( int tile = 0; tile < tilesCount; ++tile ) {
+
+            auto begin = tile * m_tileSize;
+            auto end = std::min( begin + m_tileSize, queryCount );
+
+            cv::batchDistance( queryDescriptors.rowRange( begin, end ), trainDescriptors, distances, dtype, cv::noArray(), m_normType );
+
+            for ( int i = begin; i < end; ++i ) {
+
+                auto &fwd = ( *fwdKnnMatches )[ i ];
+
+                for ( int j = 0; j < trainCount; ++j ) {
+
+                    auto distance = dtype == CV_32S ? static_cast< float >( distances.at< int >( i - begin, j ) ) : distances.at< float >( i - begin, j );
+
+                    updateBestMatches( &fwd, i, j, distance );
+                    updateBestMatches( &revMatches[ j ], j, i, distance );
+
+                }
+
+            }
+
+        }
+
+        #pragma omp critical
+        threadRevMatches.push_back( std::move( revMatches ) );
+
+    }
+
+    revKnnMatches->assign( trainCount, std::vector< cv::DMatch >( 2, empty ) );
+
+    // Ties keep the lowest index whatever thread found them
+    for ( auto &revMatches : threadRevMatches )
+        for ( int j = 0; j < trainCount; ++j )
+            for ( auto &k : revMatches[ j ] )
+                mergeBestMatches( &( *revKnnMatches )[ j ], k );
+
+    removeEmptyMatches( fwdKnnMatches );
+    removeEmptyMatches( revKnnMatches );
+
+}
+
+// HammingMatcher
+HammingMatcher::HammingMatcher()
+    : DescriptorMatcher()
+{
+    initialize();
+}
+
+void HammingMatcher::initialize()
+{
+    m_matcher = cv::BFMatcher::create( cv::NORM_HAMMING );
+
+    resetConstraints();
+}
+
+void HammingMatcher::setRowBand( const double value )
+{
+    m_rowBand = value;
+}
+
+double HammingMatcher::rowBand() const
+{
+    return m_rowBand;
+}
+
+void HammingMatcher::setDisparityRange( const double minDisparity, const double maxDisparity )
+{
+    m_minDisparity = minDisparity;
+    m_maxDisparity = maxDisparity;
+}
+
+double HammingMatcher::minDisparity() const
+{
+    return m_minDisparity;
+}
+
+double HammingMatcher::maxDisparity() const
+{
+    return m_maxDisparity;
+}
+
+void HammingMatcher::setSearchRadius( const double value )
+{
+    m_searchRadius = value;
+}
+
+double HammingMatcher::searchRadius() const
+{
+    return m_searchRadius;
+}
+
+int HammingMatcher::normType() const
+{
+    return cv::NORM_HAMMING;
+}
+
+void HammingMatcher::resetConstraints()
+{
+    m_rowBand = 0.;
+
+    m_minDisparity = -std::numeric_limits< double >::max();
+    m_maxDisparity = std::numeric_limits< double >::max();
+
+    m_searchRadius = 0.;
+}
+
+bool HammingMatcher::isCandidate( const cv::Point2f &queryPoint, const cv::Point2f &trainPoint ) const
+{
+    if ( m_rowBand > 0. ) {
+
+        auto disparity = queryPoint.x - trainPoint.x;
+
+        if ( std::abs( queryPoint.y - trainPoint.y ) > m_rowBand || disparity < m_minDisparity || disparity > m_maxDisparity )
+            return false;
+
+    }
+
+    if ( m_searchRadius > 0. ) {
+
+        auto delta = queryPoint - trainPoint;
+
+        if ( delta.dot( delta ) > m_searchRadius * m_searchRadius )
+            return false;
+
+    }
+
+    return true;
+}
+
+void HammingMatcher::knnMatch( const std::vector< cv::KeyPoint > &queryKeypoints, const cv::Mat &queryDescriptors,
+                               const std::vector< cv::KeyPoint > &trainKeypoints, const cv::Mat &trainDescriptors,
+                               std::vector< std::vector< cv::DMatch > > *fwdKnnMatches, std::vector< std::vector< cv::DMatch > > *revKnnMatches )
+{
+    if ( queryDescriptors.empty() || trainDescriptors.empty() ) {
+        fwdKnnMatches->assign( queryDescriptors.rows, std::vector< cv::DMatch >() );
+        revKnnMatches->assign( trainDescriptors.rows, std::vector< cv::DMatch >() );
+        return;
+    }
+
+    CV_Assert( queryDescriptors.type() == CV_8U && trainDescriptors.type() == CV_8U && queryDescriptors.cols == trainDescriptors.cols );
+    CV_Assert( static_cast< int >( queryKeypoints.size() ) == queryDescriptors.rows && static_cast< int >( trainKeypoints.size() ) == trainDescriptors.rows );
+
+    auto queryCount = queryDescriptors.rows;
+    auto trainCount = trainDescriptors.rows;
+    auto length = queryDescriptors.cols;
+
+    // Train points sorted by row, so a row band is a binary search
+    std::vector< int > trainOrder( trainCount );
+    std::iota( trainOrder.begin(), trainOrder.end(), 0 );
+
+    std::sort( trainOrder.begin(), trainOrder.end(), [ &trainKeypoints ]( const int first, const int second ) {
+        return trainKeypoints[ first ].pt.y < trainKeypoints[ second ].pt.y;
+    } );
+
+    std::vector< float > trainRows( trainCount );
+
+    for ( int i = 0; i < trainCount; ++i )
+        trainRows[ i ] = trainKeypoints[ trainOrder[ i ] ].pt.y;
+
+    // Queries are tiled in the same order, so neighbouring queries scan the
+    // same train descriptors while they are in cache
+    std::vector< int > queryOrder( queryCount );
+    std::iota( queryOrder.begin(), queryOrder.end(), 0 );
+
+    std::sort( queryOrder.begin(), queryOrder.end(), [ &queryKeypoints ]( const int first, const int second ) {
+        return queryKeypoints[ first ].pt.y < queryKeypoints[ second ].pt.y;
+    } );
+
+    auto window = std::max( m_rowBand, m_searchRadius );
+
+    const cv::DMatch empty( -1, -1, std::numeric_limits< float >::max() );
+
+    fwdKnnMatches->assign( queryCount, std::vector< cv::DMatch >( 2, empty ) );
+
+    auto tilesCount = ( queryCount + m_tileSize - 1 ) / m_tileSize;
+
+    std::vector< std::vector< std::vector< cv::DMatch > > > threadRevMatches;
+
+    #pragma omp parallel
+    {
+        std::vector< std::vector< cv::DMatch > > revMatches( trainCount, std::vector< cv::DMatch >( 2, empty ) );
+
+        #pragma omp for schedule( dynamic )
+        for ( int tile = 0; tile < tilesCount; ++tile ) {
+
+            auto begin = tile * m_tileSize;
+            auto end = std::min( begin + m_tileSize, queryCount );
+
+            for ( int k = begin; k < end; ++k ) {
+
+                auto i = queryOrder[ k ];
+
+                auto &queryPoint = queryKeypoints[ i ].pt;
+
+                auto first = 0;
+                auto last = trainCount;
+
+                if ( window > 0. ) {
+                    first = std::lower_bound( trainRows.begin(), trainRows.end(), queryPoint.y - window ) - trainRows.begin();
+                    last = std::upper_bound( trainRows.begin(), trainRows.end(), queryPoint.y + window ) - trainRows.begin();
+                }
+
+                auto &fwd = ( *fwdKnnMatches )[ i ];
+                auto queryDescriptor = queryDescriptors.ptr< uchar >( i );
+
+                for ( auto l = first; l < last; ++l ) {
+
+                    auto j = trainOrder[ l ];
+
+                    if ( !isCandidate( queryPoint, trainKeypoints[ j ].pt ) )
+                        continue;
+
+                    auto distance = static_cast< float >( cv::hal::normHamming( queryDescriptor, trainDescriptors.ptr< uchar >( j ), length ) );
+
+                    mergeBestMatches( &fwd, cv::DMatch( i, j, distance ) );
+                    mergeBestMatches( &revMatches[ j ], cv::DMatch( j, i, distance ) );
+
+                }
+
+            }
+
+        }
+
+        #pragma omp critical
+        threadRevMatches.push_back( std::move( revMatches ) );
+
+    }
+
+    revKnnMatches->assign( trainCount, std::vector< cv::DMatch >( 2, empty ) );
+
+    for ( auto &revMatches : threadRevMatches )
+        for ( int j = 0; j < trainCount; ++j )
+            for ( auto &k : revMatches[ j ] )
+                mergeBestMatches( &( *revKnnMatches )[ j ], k );
+
+    removeEmptyMatches( fwdKnnMatches );
+    removeEmptyMatches( revKnnMatches );
+
 }
 
 // FlannMatcher
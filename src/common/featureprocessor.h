@@ -1,6 +1,7 @@
 #pragma once
 
 #include "src/common/image.h"
+#include "src/common/pyramidpool.h"
 
 #include <opencv2/features2d.hpp>
 #include <opencv2/xfeatures2d.hpp>
@@ -11,6 +12,8 @@
 
 #include "src/superglue/super_match_includes.hpp"
 
+#include <functional>
+
 struct FlowTrackResult : public cv::Point2f
 {
 public:
@@ -35,6 +38,7 @@ class FlowProcessor : public FeatureProcessorBase
 {
 public:
     void extractPoints( const CvImage &image, const cv::Mat &mask, std::vector< cv::Point2f > *points, const size_t count );
+    void extractPoints( const CvImage &image, const std::vector< cv::Point2f > &existingPoints, std::vector< cv::Point2f > *points, const size_t count );
 
     double extractPrecision() const;
     void setExtractPrecision( const double value );
@@ -42,6 +46,9 @@ public:
     double checkDistance() const;
     void setCheckDistance( const double value );
 
+    double gridCellSize() const;
+    void setGridCellSize( const double value );
+
     void setExtractionDistance( const double value );
     double extractionDistance() const;
 
@@ -57,8 +64,18 @@ public:
     double ransacConfidence() const;
     void setRansacConfidence( const double &value );
 
+    double rowTolerance() const;
+    void setRowTolerance( const double value );
+
     cv::Mat epiTest( const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > &targetPoints, std::vector<int> *inliers );
 
+    // Epipolar test for a rectified pair: matches stay on the row and within
+    // the disparity band, the fundamental matrix is known
+    cv::Mat rowTest( const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > &targetPoints,
+                     const double minDisparity, const double maxDisparity, std::vector< int > *inliers );
+
+    static cv::Mat rectifiedFundamentalMatrix();
+
 protected:
     FlowProcessor();
 
@@ -68,9 +85,15 @@ protected:
     double m_extractDistance;
     double m_blockSize;
 
+    double m_gridCellSize;
+
+    static const size_t m_pointsPerCell = 8;
+
     double m_ransacReprojectionThreshold;
     double m_ransacConfidence;
 
+    double m_rowTolerance;
+
 private:
     void initialize();
 };
@@ -111,9 +134,15 @@ class CPUFlowProcessor : public FlowProcessor
 public:
     CPUFlowProcessor();
 
-    void track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid, std::vector< FlowTrackResult > *trackedPoints );
+    // Guess points, if given, are the predicted targets: the search starts there on fewer pyramid levels
+    void track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid, std::vector< FlowTrackResult > *trackedPoints,
+                const std::vector< cv::Point2f > &guessPoints = std::vector< cv::Point2f >() );
+
+    cv::Mat trackStereo( const std::vector< cv::Mat > &leftImagePyramid, const std::vector< cv::Point2f > &leftPoints, const std::vector< cv::Mat > &rightImagePyramid,
+                         const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints );
 
     void buildImagePyramid( const CvImage &image, std::vector< cv::Mat > *imagePyramid );
+    void releaseImagePyramid( std::vector< cv::Mat > *imagePyramid );
 
     virtual size_t winSize() const override;
     virtual void setWinSize( const size_t value ) override;
@@ -135,11 +164,29 @@ protected:
 
     double m_minEigenValue;
 
+    PyramidPool m_pyramidPool;
+
+    static const size_t m_predictedLevels = 2;
+
 private:
     void initialize();
 
 };
 
+// Per-image outputs of a batch extraction. The keypoint vectors keep their
+// capacity between batches, a descriptor matrix is reused only while the
+// caller leaves it in the batch.
+struct FeatureBatch
+{
+public:
+    void resize( const size_t size );
+    size_t size() const;
+
+    std::vector< std::vector< cv::KeyPoint > > keypoints;
+    std::vector< cv::Mat > descriptors;
+
+};
+
 class FeatureProcessor : public FeatureProcessorBase
 {
 public:
@@ -149,12 +196,24 @@ protected:
 
     cv::Ptr< cv::Feature2D > m_processor;
 
+    // cv::Feature2D is not thread safe, so every thread of a batch runs
+    // its own instance. They are created on the first batch and dropped
+    // when a parameter changes
+    std::vector< cv::Ptr< cv::Feature2D > > m_threadProcessors;
+
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const = 0;
+
+    void resetThreadProcessors();
+
+    void processBatch( const size_t count, const std::function< void( cv::Feature2D *processor, const size_t index ) > &function );
+
 };
 
 class KeyPointProcessor : public virtual FeatureProcessor
 {
 public:
     void extractKeypoints( const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints );
+    void extractKeypoints( const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, FeatureBatch *batch );
 
 protected:
     KeyPointProcessor() = default;
@@ -165,6 +224,7 @@ class DescriptorProcessor : public virtual FeatureProcessor
 {
 public:
     void extractDescriptors( const CvImage &image, std::vector< cv::KeyPoint > &keypoints, cv::Mat *descriptors );
+    void extractDescriptors( const std::vector< CvImage > &images, FeatureBatch *batch );
 
 protected:
     DescriptorProcessor() = default;
@@ -175,6 +235,7 @@ class FullProcessor : public KeyPointProcessor, public DescriptorProcessor
 {
 public:
     void extractAndCompute( const CvImage &image, const cv::Mat &mask, std::vector< cv::KeyPoint > *keypoints, cv::Mat *descriptors );
+    void extractAndCompute( const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, FeatureBatch *batch );
 
 protected:
     FullProcessor() = default;
@@ -207,6 +268,9 @@ public:
     double k() const;
 
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -228,21 +292,31 @@ public:
     void setType( cv::FastFeatureDetector::DetectorType value );
     cv::FastFeatureDetector::DetectorType type();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
 };
 
 namespace marker {
+    struct BackendConfig;
     class SuperPointDetector;
     class KeypointSelector;
     class SuperGlueMatcher;
+    class FeatureCache;
+    struct FrameFeatures;
 }
 
 class SuperGlueProcessor : public FeatureProcessorBase
 {
 public:
+    // TorchScript modules (.pt) run on the CPU backend, other model files are taken for TensorRT engines
     SuperGlueProcessor( const std::string &detectorModelFile, const std::string &matcherModelFile );
+    SuperGlueProcessor( const std::string &detectorModelFile, const std::string &matcherModelFile, const marker::BackendConfig &backendConfig );
+
+    static marker::BackendConfig backendConfig( const std::string &modelFile );
 
     void setMatchingThreshold( const double value );
     int matchingThreshold() const;
@@ -250,18 +324,47 @@ public:
     void extractAndMatch( const CvImage &image1, const cv::Mat &mask1, const CvImage &image2, const cv::Mat &mask2,
                            std::vector< cv::KeyPoint > *keypoints1, std::vector< cv::KeyPoint > *keypoints2, const size_t count, std::vector< cv::DMatch > *matches );
 
+    void extractAndMatch( const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, const std::vector< std::pair< size_t, size_t > > &pairs, const size_t count,
+                           std::vector< std::vector< cv::KeyPoint > > *keypoints, std::vector< std::vector< cv::DMatch > > *matches );
+
+    size_t maxBatchSize() const;
+
+    // Cached variants: SuperPoint runs only for frames missing in the cache,
+    // matching runs SuperGlue on the cached keypoints and descriptors
+    void extractFeatures( const std::vector< size_t > &frameIds, const std::vector< CvImage > &images, const std::vector< cv::Mat > &masks, const size_t count,
+                          std::vector< std::vector< cv::KeyPoint > > *keypoints );
+
+    void match( const size_t frameId1, const size_t frameId2, std::vector< cv::DMatch > *matches );
+    void match( const std::vector< std::pair< size_t, size_t > > &framePairs, std::vector< std::vector< cv::DMatch > > *matches );
+
+    void setCacheSize( const size_t value );
+    size_t cacheSize() const;
+
+    void clearCache();
+
     void match( const CvImage &image1, const CvImage &image2, const std::vector< cv::KeyPoint > &keypoints1, const std::vector< cv::KeyPoint > &keypoints2, std::vector< cv::DMatch > *matches );
 
 protected:
     std::unique_ptr< marker::SuperPointDetector > _detector;
     std::unique_ptr< marker::KeypointSelector > _keypointSelector;
     std::unique_ptr< marker::SuperGlueMatcher > _matcher;
+    std::unique_ptr< marker::FeatureCache > _featureCache;
 
     double _matcherThreshold;
 
     static const size_t _maxPointsCount = 1024;
+    static const size_t _defaultCacheSize = 8;
+
+    void extractMatches( const marker::MatchTable &table, std::vector< cv::DMatch > *matches ) const;
+
+    void detectFeatures( const std::vector< size_t > &frameIds, const std::vector< cv::Mat > &images, const std::vector< cv::Mat > &masks, const size_t count );
+    void selectFeatures( marker::FrameFeatures *features, const cv::Mat &mask, const size_t count );
+
+    // Cached keypoints are selected under a mask, another mask needs another selection
+    static size_t maskHash( const cv::Mat &mask );
+
 private:
-    void initialize( const std::string &detectorModelFile, const std::string &matcherModelFile );
+    void initialize( const std::string &detectorModelFile, const std::string &matcherModelFile, const marker::BackendConfig &backendConfig );
 
 };
 
@@ -270,6 +373,9 @@ class DaisyProcessor : public DescriptorProcessor
 public:
     DaisyProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -280,6 +386,9 @@ class FreakProcessor : public DescriptorProcessor
 public:
     FreakProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -290,6 +399,9 @@ class SiftProcessor : public FullProcessor
 public:
     SiftProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -300,6 +412,9 @@ class SurfProcessor : public FullProcessor
 public:
     SurfProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -310,6 +425,9 @@ class OrbProcessor : public FullProcessor
 public:
     OrbProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -320,6 +438,9 @@ class KazeProcessor : public FullProcessor
 public:
     KazeProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -330,6 +451,9 @@ class AKazeProcessor : public FullProcessor
 public:
     AKazeProcessor();
 
+protected:
+    virtual cv::Ptr< cv::Feature2D > createProcessor() const override;
+
 private:
     void initialize();
 
@@ -350,22 +474,97 @@ class DescriptorMatcher : public FeatureMatcherBase
 public:
     DescriptorMatcher();
 
+    virtual ~DescriptorMatcher() = default;
+
     cv::Mat match( const std::vector<cv::KeyPoint> &queryKeypoints, const cv::Mat &queryDescriptors,
                 const std::vector<cv::KeyPoint> &trainKeypoints, const cv::Mat &trainDescriptors,
                 std::vector< cv::DMatch > *matches );
 
+    // Matches points with known predicted positions: each query is compared
+    // only with train points within the radius around its prediction
+    size_t guidedMatch( const std::vector< cv::Point2f > &predictedPoints, const cv::Mat &queryDescriptors,
+                        const std::vector< cv::Point2f > &trainPoints, const cv::Mat &trainDescriptors,
+                        const double radius, std::vector< cv::DMatch > *matches ) const;
+
+    virtual int normType() const;
+
 protected:
     static double m_threshold;
 
     cv::Ptr< cv::DescriptorMatcher > m_matcher;
 
+    virtual void knnMatch( const std::vector< cv::KeyPoint > &queryKeypoints, const cv::Mat &queryDescriptors,
+                           const std::vector< cv::KeyPoint > &trainKeypoints, const cv::Mat &trainDescriptors,
+                           std::vector< std::vector< cv::DMatch > > *fwdKnnMatches, std::vector< std::vector< cv::DMatch > > *revKnnMatches );
+
+    static void ratioTest( const std::vector< std::vector< cv::DMatch > > &knnMatches, std::vector< int > *bestIndexes );
+
 private:
 };
 
 class BFMatcher : public DescriptorMatcher
 {
 public:
-    BFMatcher();
+    BFMatcher( const int normType = cv::NORM_L2 );
+
+    void setSinglePass( const bool value );
+    bool singlePass() const;
+
+    virtual int normType() const override;
+
+protected:
+    int m_normType;
+
+    bool m_singlePass;
+
+    static const int m_tileSize = 256;
+
+    virtual void knnMatch( const std::vector< cv::KeyPoint > &queryKeypoints, const cv::Mat &queryDescriptors,
+                           const std::vector< cv::KeyPoint > &trainKeypoints, const cv::Mat &trainDescriptors,
+                           std::vector< std::vector< cv::DMatch > > *fwdKnnMatches, std::vector< std::vector< cv::DMatch > > *revKnnMatches ) override;
+
+private:
+    void initialize();
+
+};
+
+// Brute force matcher for binary descriptors (ORB, AKAZE). Candidates can
+// be limited to a row band with a disparity range (stereo) or to a radius
+// (consecutive frames), so most distances are never computed.
+class HammingMatcher : public DescriptorMatcher
+{
+public:
+    HammingMatcher();
+
+    void setRowBand( const double value );
+    double rowBand() const;
+
+    void setDisparityRange( const double minDisparity, const double maxDisparity );
+    double minDisparity() const;
+    double maxDisparity() const;
+
+    void setSearchRadius( const double value );
+    double searchRadius() const;
+
+    void resetConstraints();
+
+    virtual int normType() const override;
+
+protected:
+    double m_rowBand;
+
+    double m_minDisparity;
+    double m_maxDisparity;
+
+    double m_searchRadius;
+
+    static const int m_tileSize = 64;
+
+    virtual void knnMatch( const std::vector< cv::KeyPoint > &queryKeypoints, const cv::Mat &queryDescriptors,
+                           const std::vector< cv::KeyPoint > &trainKeypoints, const cv::Mat &trainDescriptors,
+                           std::vector< std::vector< cv::DMatch > > *fwdKnnMatches, std::vector< std::vector< cv::DMatch > > *revKnnMatches ) override;
+
+    bool isCandidate( const cv::Point2f &queryPoint, const cv::Point2f &trainPoint ) const;
 
 private:
     void initialize();
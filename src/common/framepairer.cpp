@@ -0,0 +1,183 @@
+#include "precompiled.h"
+
+#include "framepairer.h"
+
+// StereoFramePairer
+StereoFramePairer::StereoFramePairer()
+{
+    initialize();
+}
+
+void StereoFramePairer::initialize()
+{
+    m_window = std::chrono::microseconds( 500 );
+    m_maxBufferSize = 4;
+
+    m_pairUpdated = false;
+
+    m_pairedFrames = 0;
+    m_droppedLeftFrames = 0;
+    m_droppedRightFrames = 0;
+}
+
+void StereoFramePairer::setWindow( const std::chrono::microseconds &value )
+{
+    m_window = value;
+}
+
+const std::chrono::microseconds &StereoFramePairer::window() const
+{
+    return m_window;
+}
+
+void StereoFramePairer::setMaxBufferSize( const size_t value )
+{
+    if ( value > 0 )
+        m_maxBufferSize = value;
+}
+
+size_t StereoFramePairer::maxBufferSize() const
+{
+    return m_maxBufferSize;
+}
+
+void StereoFramePairer::addLeftFrame( CapturedFrame &&frame )
+{
+    addFrame( std::move( frame ), &m_leftFrames, &m_droppedLeftFrames );
+}
+
+void StereoFramePairer::addRightFrame( CapturedFrame &&frame )
+{
+    addFrame( std::move( frame ), &m_rightFrames, &m_droppedRightFrames );
+}
+
+std::chrono::microseconds StereoFramePairer::difference( const CapturedFrame &frame1, const CapturedFrame &frame2 )
+{
+    if ( frame1.cameraTime >= 0 && frame2.cameraTime >= 0 )
+        return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::nanoseconds( frame1.cameraTime - frame2.cameraTime ) );
+
+    return std::chrono::duration_cast< std::chrono::microseconds >( frame1.time - frame2.time );
+}
+
+void StereoFramePairer::addFrame( CapturedFrame &&frame, std::deque< CapturedFrame > *frames, uint64_t *dropped )
+{
+    if ( frame.bayerImage.empty() ) {
+        recycle( std::move( frame ) );
+        return;
+    }
+
+    // Frames of one camera come in order, a stale one can't be matched anymore
+    if ( !frames->empty() && difference( frame, frames->back() ).count() <= 0 ) {
+        recycle( std::move( frame ) );
+        ++*dropped;
+        return;
+    }
+
+    frames->push_back( std::move( frame ) );
+
+    while ( frames->size() > m_maxBufferSize ) {
+        recycle( std::move( frames->front() ) );
+        frames->pop_front();
+        ++*dropped;
+    }
+
+    match();
+
+}
+
+void StereoFramePairer::match()
+{
+    while ( !m_leftFrames.empty() && !m_rightFrames.empty() ) {
+        auto &leftFrame = m_leftFrames.front();
+        auto &rightFrame = m_rightFrames.front();
+
+        auto diff = difference( leftFrame, rightFrame );
+
+        if ( std::abs( diff.count() ) <= m_window.count() ) {
+            // One stamp for both, so the pair doesn't carry the latency difference of the cameras
+            rightFrame.time = leftFrame.time;
+
+            std::swap( m_pairedLeftFrame, leftFrame );
+            std::swap( m_pairedRightFrame, rightFrame );
+
+            // Buffers of the replaced pair are kept for reuse
+            recycle( std::move( leftFrame ) );
+            recycle( std::move( rightFrame ) );
+
+            m_leftFrames.pop_front();
+            m_rightFrames.pop_front();
+
+            m_pairUpdated = true;
+            ++m_pairedFrames;
+        }
+        else if ( diff.count() < 0 ) {
+            // The right camera is already past this frame
+            recycle( std::move( leftFrame ) );
+            m_leftFrames.pop_front();
+            ++m_droppedLeftFrames;
+        }
+        else {
+            recycle( std::move( rightFrame ) );
+            m_rightFrames.pop_front();
+            ++m_droppedRightFrames;
+        }
+
+    }
+
+}
+
+bool StereoFramePairer::takePair( CapturedFrame *leftFrame, CapturedFrame *rightFrame )
+{
+    if ( !m_pairUpdated )
+        return false;
+
+    std::swap( *leftFrame, m_pairedLeftFrame );
+    std::swap( *rightFrame, m_pairedRightFrame );
+
+    m_pairUpdated = false;
+
+    return true;
+
+}
+
+CapturedFrame StereoFramePairer::spareFrame()
+{
+    CapturedFrame ret;
+
+    if ( !m_spareFrames.empty() ) {
+        ret = std::move( m_spareFrames.back() );
+        m_spareFrames.pop_back();
+    }
+
+    return ret;
+
+}
+
+void StereoFramePairer::recycle( CapturedFrame &&frame )
+{
+    if ( !frame.bayerImage.empty() && m_spareFrames.size() < 2 * m_maxBufferSize )
+        m_spareFrames.push_back( std::move( frame ) );
+}
+
+uint64_t StereoFramePairer::pairedFrames() const
+{
+    return m_pairedFrames;
+}
+
+uint64_t StereoFramePairer::droppedLeftFrames() const
+{
+    return m_droppedLeftFrames;
+}
+
+uint64_t StereoFramePairer::droppedRightFrames() const
+{
+    return m_droppedRightFrames;
+}
+
+void StereoFramePairer::clear()
+{
+    m_leftFrames.clear();
+    m_rightFrames.clear();
+
+    m_pairUpdated = false;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <vector>
+
+// Raw Bayer frame copied out of the camera buffer.
+// time is the camera timestamp mapped to the system clock, or the arrival time if the camera has none.
+// cameraTime is the raw camera timestamp in nanoseconds, -1 if there is none
+struct CapturedFrame
+{
+    cv::Mat bayerImage;
+    std::chrono::time_point< std::chrono::system_clock > time;
+    int64_t cameraTime = -1;
+};
+
+// Matches left and right frames by timestamp within a window.
+// Frames are compared by the raw camera timestamps when both have one, the cameras share the PTP clock
+// while each camera maps it to the system clock with its own delay. A paired right frame gets the time of the left one.
+// Each camera keeps a short buffer ordered by time, frames left without a partner are dropped and counted
+class StereoFramePairer
+{
+public:
+    StereoFramePairer();
+
+    void setWindow( const std::chrono::microseconds &value );
+    const std::chrono::microseconds &window() const;
+
+    void setMaxBufferSize( const size_t value );
+    size_t maxBufferSize() const;
+
+    void addLeftFrame( CapturedFrame &&frame );
+    void addRightFrame( CapturedFrame &&frame );
+
+    // Swaps the newest matched pair into the given frames, false if nothing was matched since the previous call
+    bool takePair( CapturedFrame *leftFrame, CapturedFrame *rightFrame );
+
+    // A frame with a buffer from an earlier frame, to be filled without allocation
+    CapturedFrame spareFrame();
+    void recycle( CapturedFrame &&frame );
+
+    uint64_t pairedFrames() const;
+    uint64_t droppedLeftFrames() const;
+    uint64_t droppedRightFrames() const;
+
+    void clear();
+
+protected:
+    std::chrono::microseconds m_window;
+    size_t m_maxBufferSize;
+
+    std::deque< CapturedFrame > m_leftFrames;
+    std::deque< CapturedFrame > m_rightFrames;
+
+    CapturedFrame m_pairedLeftFrame;
+    CapturedFrame m_pairedRightFrame;
+    bool m_pairUpdated;
+
+    std::vector< CapturedFrame > m_spareFrames;
+
+    uint64_t m_pairedFrames;
+    uint64_t m_droppedLeftFrames;
+    uint64_t m_droppedRightFrames;
+
+    static std::chrono::microseconds difference( const CapturedFrame &frame1, const CapturedFrame &frame2 );
+
+    void addFrame( CapturedFrame &&frame, std::deque< CapturedFrame > *frames, uint64_t *dropped );
+    void match();
+
+private:
+    void initialize();
+
+};
@@ -0,0 +1,156 @@
+#include "precompiled.h"
+
+#include "imulog.h"
+
+#include "xsens.h"
+
+#include <cstring>
+
+namespace {
+
+const char imuLogMagic[ 4 ] = { 'I', 'M', 'U', 'L' };
+const uint32_t imuLogVersion = 1;
+
+#pragma pack( push, 1 )
+struct ImuLogRecord
+{
+    int64_t time;
+    double xsensTime;
+    float acceleration[ 3 ];
+    float gyro[ 3 ];
+    float magnitometer[ 3 ];
+};
+#pragma pack( pop )
+
+}
+
+// ImuLogWriter
+ImuLogWriter::ImuLogWriter()
+{
+    initialize();
+}
+
+void ImuLogWriter::initialize()
+{
+    m_count = 0;
+}
+
+ImuLogWriter::~ImuLogWriter()
+{
+    close();
+}
+
+bool ImuLogWriter::open( const std::string &fileName )
+{
+    close();
+
+    m_stream.open( fileName, std::ios::binary | std::ios::trunc );
+
+    if ( !m_stream.is_open() )
+        return false;
+
+    uint32_t recordSize = sizeof( ImuLogRecord );
+
+    m_stream.write( imuLogMagic, sizeof( imuLogMagic ) );
+    m_stream.write( reinterpret_cast< const char * >( &imuLogVersion ), sizeof( imuLogVersion ) );
+    m_stream.write( reinterpret_cast< const char * >( &recordSize ), sizeof( recordSize ) );
+
+    return m_stream.good();
+
+}
+
+void ImuLogWriter::close()
+{
+    if ( m_stream.is_open() )
+        m_stream.close();
+
+    m_count = 0;
+}
+
+bool ImuLogWriter::isOpen() const
+{
+    return m_stream.is_open();
+}
+
+bool ImuLogWriter::write( const XsensData &packet )
+{
+    if ( !m_stream.is_open() || !packet.valid() )
+        return false;
+
+    ImuLogRecord record;
+
+    record.time = std::chrono::duration_cast< std::chrono::microseconds >( packet.utcTime().time_since_epoch() ).count();
+    record.xsensTime = packet.xsensTime();
+
+    for ( int i = 0; i < 3; ++i ) {
+        record.acceleration[ i ] = packet.acceleration()[ i ];
+        record.gyro[ i ] = packet.gyro()[ i ];
+        record.magnitometer[ i ] = packet.magnitometer()[ i ];
+    }
+
+    // Buffered by the stream, the callback thread is not held by the disk
+    m_stream.write( reinterpret_cast< const char * >( &record ), sizeof( record ) );
+
+    ++m_count;
+
+    return m_stream.good();
+
+}
+
+size_t ImuLogWriter::count() const
+{
+    return m_count;
+}
+
+// ImuLogReader
+bool ImuLogReader::read( const std::string &fileName, std::vector< XsensData > *packets )
+{
+    if ( !packets )
+        return false;
+
+    packets->clear();
+
+    std::ifstream stream( fileName, std::ios::binary );
+
+    if ( !stream.is_open() )
+        return false;
+
+    char magic[ 4 ];
+    uint32_t version;
+    uint32_t recordSize;
+
+    stream.read( magic, sizeof( magic ) );
+    stream.read( reinterpret_cast< char * >( &version ), sizeof( version ) );
+    stream.read( reinterpret_cast< char * >( &recordSize ), sizeof( recordSize ) );
+
+    if ( !stream || std::memcmp( magic, imuLogMagic, sizeof( magic ) ) != 0 || version != imuLogVersion || recordSize != sizeof( ImuLogRecord ) )
+        return false;
+
+    auto dataStart = stream.tellg();
+    stream.seekg( 0, std::ios::end );
+    auto dataSize = static_cast< size_t >( stream.tellg() - dataStart );
+    stream.seekg( dataStart );
+
+    std::vector< ImuLogRecord > records( dataSize / sizeof( ImuLogRecord ) );
+
+    // A record cut by an interrupted recording is ignored
+    stream.read( reinterpret_cast< char * >( records.data() ), records.size() * sizeof( ImuLogRecord ) );
+
+    if ( !stream )
+        return false;
+
+    packets->reserve( records.size() );
+
+    for ( auto &i : records ) {
+        auto time = std::chrono::time_point< std::chrono::high_resolution_clock >(
+                    std::chrono::duration_cast< std::chrono::high_resolution_clock::duration >( std::chrono::microseconds( i.time ) ) );
+
+        packets->push_back( XsensData( time, i.xsensTime,
+                                       Eigen::Vector3d( i.acceleration[ 0 ], i.acceleration[ 1 ], i.acceleration[ 2 ] ),
+                                       Eigen::Vector3d( i.gyro[ 0 ], i.gyro[ 1 ], i.gyro[ 2 ] ),
+                                       Eigen::Vector3d( i.magnitometer[ 0 ], i.magnitometer[ 1 ], i.magnitometer[ 2 ] ) ) );
+    }
+
+    return true;
+
+}
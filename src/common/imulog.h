@@ -0,0 +1,41 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+class XsensData;
+
+// Compact binary IMU log: "IMUL" magic, version and record size, then fixed size little-endian records of
+// the arrival time (int64 microseconds, system clock, same as the stereo frame times), the device time (double, seconds)
+// and acceleration, gyro and magnetometer (9 floats)
+class ImuLogWriter
+{
+public:
+    ImuLogWriter();
+    ~ImuLogWriter();
+
+    bool open( const std::string &fileName );
+    void close();
+
+    bool isOpen() const;
+
+    bool write( const XsensData &packet );
+
+    size_t count() const;
+
+protected:
+    std::ofstream m_stream;
+    size_t m_count;
+
+private:
+    void initialize();
+
+};
+
+class ImuLogReader
+{
+public:
+    static bool read( const std::string &fileName, std::vector< XsensData > *packets );
+
+};
@@ -0,0 +1,578 @@
+#include "precompiled.h"
+
+#include "klttracker.h"
+#include "paralleltasks.h"
+
+#include <opencv2/core/hal/intrin.hpp>
+
+static const int W_BITS = 14;
+static const float FLT_SCALE = 1.f / ( 1 << 20 );
+
+inline int descale( const int value, const int bits )
+{
+    return ( value + ( 1 << ( bits - 1 ) ) ) >> bits;
+}
+
+// FlowTrackBuffer
+void FlowTrackBuffer::resize( const size_t size )
+{
+    points.resize( size );
+    errors.resize( size );
+    misses.resize( size );
+    statuses.resize( size );
+}
+
+size_t FlowTrackBuffer::size() const
+{
+    return points.size();
+}
+
+// KLTTracker
+KLTTracker::KLTTracker()
+{
+    initialize();
+}
+
+void KLTTracker::initialize()
+{
+    m_winSize = cv::Size( 21, 21 );
+    m_levels = 3;
+
+    m_termCriteria = cv::TermCriteria( cv::TermCriteria::COUNT + cv::TermCriteria::EPS, 30, 0.01 );
+
+    m_minEigenValue = 1.e-4;
+}
+
+bool KLTTracker::isSupported( const std::vector< cv::Mat > &imagePyramid )
+{
+    return imagePyramid.size() >= 2 && imagePyramid.size() % 2 == 0
+            && imagePyramid[ 0 ].type() == CV_8UC1 && imagePyramid[ 1 ].type() == CV_16SC2;
+}
+
+void KLTTracker::track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid, FlowTrackBuffer *buffer ) const
+{
+    track( sourceImagePyramid, sourcePoints, sourcePoints, targetImagePyramid, buffer );
+}
+
+void KLTTracker::track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > &guessPoints,
+                        const std::vector< cv::Mat > &targetImagePyramid, FlowTrackBuffer *buffer ) const
+{
+    CV_Assert( guessPoints.size() == sourcePoints.size() );
+
+    trackBatch( sourceImagePyramid, sourcePoints, &guessPoints, targetImagePyramid, false, 0.f, 0.f, buffer );
+}
+
+void KLTTracker::trackRows( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid,
+                            const float minDisparity, const float maxDisparity, FlowTrackBuffer *buffer ) const
+{
+    trackBatch( sourceImagePyramid, sourcePoints, nullptr, targetImagePyramid, true, minDisparity, maxDisparity, buffer );
+}
+
+void KLTTracker::trackBatch( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > *guessPoints,
+                             const std::vector< cv::Mat > &targetImagePyramid, const bool rows, const float minDisparity, const float maxDisparity, FlowTrackBuffer *buffer ) const
+{
+    CV_Assert( isSupported( sourceImagePyramid ) && isSupported( targetImagePyramid ) );
+
+    if ( !buffer )
+        return;
+
+    buffer->resize( sourcePoints.size() );
+
+    auto levels = levelsCount( sourceImagePyramid, targetImagePyramid );
+    auto levelScale = static_cast< float >( 1. / ( 1 << levels ) );
+
+    auto chunksCount = static_cast< int >( ( sourcePoints.size() + m_chunkSize - 1 ) / m_chunkSize );
+
+    auto tasksCount = ( chunksCount + m_taskChunks - 1 ) / m_taskChunks;
+
+    // Each task pipelines a contiguous run of chunks, so a chunk is followed
+    // by the next one. Tasks share the threads of a caller's task graph.
+    parallelTasks( tasksCount, [ & ]( const int task ) {
+
+        Patch patch;
+
+        std::vector< PointState > forward;
+        std::vector< PointState > backward;
+
+        size_t backwardBegin = 0;
+
+        auto backwardLevel = [ & ]( const int level ) {
+            for ( size_t i = 0; i < backward.size(); ++i )
+                if ( backward[ i ].status )
+                    trackLevel( targetImagePyramid, sourceImagePyramid, level, levels, buffer->points[ backwardBegin + i ], rows, &backward[ i ], &patch );
+        };
+
+        // The backward states of the previous chunk, finished with the results of its forward pass
+        auto finishBackward = [ & ]() {
+            for ( size_t i = 0; i < backward.size(); ++i ) {
+
+                auto index = backwardBegin + i;
+                auto &sourcePoint = sourcePoints[ index ];
+                auto &checkPoint = backward[ i ].point;
+
+                auto status = buffer->statuses[ index ] && backward[ i ].status;
+
+                buffer->statuses[ index ] = status;
+
+                if ( !status )
+                    buffer->misses[ index ] = std::numeric_limits< float >::max();
+                else if ( rows )
+                    buffer->misses[ index ] = std::abs( checkPoint.x - sourcePoint.x );
+                else
+                    buffer->misses[ index ] = static_cast< float >( cv::norm( checkPoint - sourcePoint ) );
+
+            }
+
+            backward.clear();
+        };
+
+        auto flushBackward = [ & ]() {
+            for ( int level = levels; level >= 0; --level )
+                backwardLevel( level );
+
+            finishBackward();
+        };
+
+        auto lastChunk = std::min( ( task + 1 ) * m_taskChunks, chunksCount );
+
+        for ( int chunk = task * m_taskChunks; chunk < lastChunk; ++chunk ) {
+
+            auto begin = chunk * m_chunkSize;
+            auto end = std::min( begin + m_chunkSize, sourcePoints.size() );
+
+            forward.resize( end - begin );
+
+            for ( size_t i = begin; i < end; ++i ) {
+
+                auto &sourcePoint = sourcePoints[ i ];
+
+                cv::Point2f guessPoint;
+
+                // Left to right the shift is the disparity, right to left it
+                // is the negated one
+                if ( rows )
+                    guessPoint = sourcePoint - cv::Point2f( searchRow( sourceImagePyramid[ levels * 2 ], targetImagePyramid[ levels * 2 ], levels, sourcePoint, minDisparity, maxDisparity ), 0.f );
+                else
+                    guessPoint = guessPoints ? ( *guessPoints )[ i ] : sourcePoint;
+
+                forward[ i - begin ] = { guessPoint * levelScale, 0.f, true };
+
+            }
+
+            for ( int level = levels; level >= 0; --level ) {
+
+                for ( size_t i = begin; i < end; ++i )
+                    trackLevel( sourceImagePyramid, targetImagePyramid, level, levels, sourcePoints[ i ], rows, &forward[ i - begin ], &patch );
+
+                backwardLevel( level );
+
+            }
+
+            finishBackward();
+
+            backwardBegin = begin;
+            backward.resize( end - begin );
+
+            for ( size_t i = begin; i < end; ++i ) {
+
+                auto &state = forward[ i - begin ];
+                auto &sourcePoint = sourcePoints[ i ];
+
+                buffer->points[ i ] = state.point;
+                buffer->errors[ i ] = state.minEigenValue;
+                buffer->statuses[ i ] = state.status;
+
+                cv::Point2f checkGuess;
+
+                // The backward pass starts from the inverse prediction
+                if ( rows ) {
+                    if ( state.status )
+                        checkGuess = state.point - cv::Point2f( searchRow( targetImagePyramid[ levels * 2 ], sourceImagePyramid[ levels * 2 ], levels, state.point, -maxDisparity, -minDisparity ), 0.f );
+                }
+                else
+                    checkGuess = guessPoints ? state.point + sourcePoint - ( *guessPoints )[ i ] : state.point;
+
+                backward[ i - begin ] = { checkGuess * levelScale, 0.f, state.status };
+
+            }
+
+        }
+
+        // The last chunk of the task has nothing left to pair its backward pass with
+        flushBackward();
+
+    } );
+
+}
+
+int KLTTracker::levelsCount( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Mat > &targetImagePyramid ) const
+{
+    return std::min( { m_levels, static_cast< int >( sourceImagePyramid.size() / 2 ) - 1, static_cast< int >( targetImagePyramid.size() / 2 ) - 1 } );
+}
+
+float KLTTracker::searchRow( const cv::Mat &sourceImage, const cv::Mat &targetImage, const int level,
+                             const cv::Point2f &sourcePoint, const float minShift, const float maxShift ) const
+{
+    // Sum of absolute differences along the row on the coarsest level, the
+    // band there is 2^level times narrower
+    auto scale = static_cast< float >( 1 << level );
+
+    auto x = cvRound( sourcePoint.x / scale );
+    auto y = cvRound( sourcePoint.y / scale );
+
+    auto firstShift = static_cast< int >( std::ceil( minShift / scale ) );
+    auto lastShift = static_cast< int >( std::floor( maxShift / scale ) );
+
+    auto bestShift = ( minShift + maxShift ) * 0.5f;
+
+    if ( y - m_blockRadius < 0 || y + m_blockRadius >= sourceImage.rows || x - m_blockRadius < 0 || x + m_blockRadius >= sourceImage.cols )
+        return bestShift;
+
+    auto bestSum = std::numeric_limits< int >::max();
+
+    for ( auto shift = firstShift; shift <= lastShift; ++shift ) {
+
+        auto targetX = x - shift;
+
+        if ( targetX - m_blockRadius < 0 || targetX + m_blockRadius >= targetImage.cols )
+            continue;
+
+        int sum = 0;
+
+        for ( int row = -m_blockRadius; row <= m_blockRadius && sum < bestSum; ++row ) {
+
+            auto source = sourceImage.ptr< uchar >( y + row ) + x;
+            auto target = targetImage.ptr< uchar >( y + row ) + targetX;
+
+            for ( int col = -m_blockRadius; col <= m_blockRadius; ++col )
+                sum += std::abs( source[ col ] - target[ col ] );
+
+        }
+
+        if ( sum < bestSum ) {
+            bestSum = sum;
+            bestShift = shift * scale;
+        }
+
+    }
+
+    return bestShift;
+}
+
+void KLTTracker::trackLevel( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Mat > &targetImagePyramid, const int level, const int levels,
+                             const cv::Point2f &sourcePoint, const bool horizontal, PointState *state, Patch *patch ) const
+{
+    const cv::Point2f halfWin( ( m_winSize.width - 1 ) * 0.5f, ( m_winSize.height - 1 ) * 0.5f );
+
+    const int area = m_winSize.area();
+
+    const int maxCount = std::min( std::max( m_termCriteria.type & cv::TermCriteria::COUNT ? m_termCriteria.maxCount : 30, 0 ), 100 );
+    const double epsilon = m_termCriteria.type & cv::TermCriteria::EPS ? std::min( std::max( m_termCriteria.epsilon, 0. ), 10. ) : 0.01;
+    const double epsilonSquared = epsilon * epsilon;
+
+    patch->image.resize( area );
+    patch->derivatives.resize( area * 2 );
+
+    const cv::Mat &I = sourceImagePyramid[ level * 2 ];
+    const cv::Mat &derivI = sourceImagePyramid[ level * 2 + 1 ];
+    const cv::Mat &J = targetImagePyramid[ level * 2 ];
+
+    auto &nextPoint = state->point;
+
+    if ( level < levels )
+        nextPoint *= 2.f;
+
+    cv::Point2f prevPt = sourcePoint * static_cast< float >( 1. / ( 1 << level ) ) - halfWin;
+
+    cv::Point2i iprevPt( cvFloor( prevPt.x ), cvFloor( prevPt.y ) );
+
+    if ( iprevPt.x < -m_winSize.width || iprevPt.x >= derivI.cols || iprevPt.y < -m_winSize.height || iprevPt.y >= derivI.rows ) {
+
+        if ( level == 0 ) {
+            state->minEigenValue = 0.f;
+            state->status = false;
+        }
+
+        return;
+
+    }
+
+    float a = prevPt.x - iprevPt.x;
+    float b = prevPt.y - iprevPt.y;
+
+    int iw00 = cvRound( ( 1.f - a ) * ( 1.f - b ) * ( 1 << W_BITS ) );
+    int iw01 = cvRound( a * ( 1.f - b ) * ( 1 << W_BITS ) );
+    int iw10 = cvRound( ( 1.f - a ) * b * ( 1 << W_BITS ) );
+    int iw11 = ( 1 << W_BITS ) - iw00 - iw01 - iw10;
+
+    auto stepI = I.step1();
+    auto stepD = derivI.step1();
+
+    float iA11 = 0.f, iA12 = 0.f, iA22 = 0.f;
+
+#if CV_SIMD128
+    // Bilinear weights of horizontally adjacent pixel pairs, one multiply-add gives a sample
+    cv::v_int16x8 qw0( iw00, iw01, iw00, iw01, iw00, iw01, iw00, iw01 );
+    cv::v_int16x8 qw1( iw10, iw11, iw10, iw11, iw10, iw11, iw10, iw11 );
+
+    const cv::v_int32x4 qdelta = cv::v_setall_s32( 1 << ( W_BITS - 5 - 1 ) );
+    const cv::v_int32x4 qdeltaD = cv::v_setall_s32( 1 << ( W_BITS - 1 ) );
+
+    cv::v_float32x4 qA11 = cv::v_setzero_f32(), qA12 = cv::v_setzero_f32(), qA22 = cv::v_setzero_f32();
+#endif
+
+    // Source patch and its gradients are sampled once per level
+    for ( int y = 0; y < m_winSize.height; ++y ) {
+
+        const uchar *src = I.ptr< uchar >( y + iprevPt.y ) + iprevPt.x;
+        const short *dsrc = derivI.ptr< short >( y + iprevPt.y ) + iprevPt.x * 2;
+
+        short *Iptr = patch->image.data() + y * m_winSize.width;
+        short *dIptr = patch->derivatives.data() + y * m_winSize.width * 2;
+
+        int x = 0;
+
+#if CV_SIMD128
+        for ( ; x <= m_winSize.width - 8; x += 8 ) {
+
+            cv::v_int16x8 t00, t01, t10, t11;
+
+            cv::v_zip( cv::v_reinterpret_as_s16( cv::v_load_expand( src + x ) ), cv::v_reinterpret_as_s16( cv::v_load_expand( src + x + 1 ) ), t00, t01 );
+            cv::v_zip( cv::v_reinterpret_as_s16( cv::v_load_expand( src + x + stepI ) ), cv::v_reinterpret_as_s16( cv::v_load_expand( src + x + stepI + 1 ) ), t10, t11 );
+
+            cv::v_int32x4 t0 = ( cv::v_dotprod( t00, qw0, qdelta ) + cv::v_dotprod( t10, qw1 ) ) >> ( W_BITS - 5 );
+            cv::v_int32x4 t1 = ( cv::v_dotprod( t01, qw0, qdelta ) + cv::v_dotprod( t11, qw1 ) ) >> ( W_BITS - 5 );
+
+            cv::v_store( Iptr + x, cv::v_pack( t0, t1 ) );
+
+            // Four interleaved gradient pairs at a time
+            for ( int k = 0; k < 8; k += 4 ) {
+
+                auto d = dsrc + ( x + k ) * 2;
+
+                cv::v_zip( cv::v_load( d ), cv::v_load( d + 2 ), t00, t01 );
+                cv::v_zip( cv::v_load( d + stepD ), cv::v_load( d + stepD + 2 ), t10, t11 );
+
+                t0 = ( cv::v_dotprod( t00, qw0, qdeltaD ) + cv::v_dotprod( t10, qw1 ) ) >> W_BITS;
+                t1 = ( cv::v_dotprod( t01, qw0, qdeltaD ) + cv::v_dotprod( t11, qw1 ) ) >> W_BITS;
+
+                auto gradients = cv::v_pack( t0, t1 );
+
+                cv::v_store( dIptr + ( x + k ) * 2, gradients );
+
+                // Ix0 Iy0 Ix1 Iy1 ... to Ix0 Ix1 Ix2 Ix3 Iy0 Iy1 Iy2 Iy3
+                cv::v_int32x4 ix, iy;
+                cv::v_expand( cv::v_reinterpret_as_s16( cv::v_interleave_pairs( cv::v_reinterpret_as_s32( cv::v_interleave_pairs( gradients ) ) ) ), ix, iy );
+
+                auto fx = cv::v_cvt_f32( ix );
+                auto fy = cv::v_cvt_f32( iy );
+
+                qA11 = cv::v_muladd( fx, fx, qA11 );
+                qA12 = cv::v_muladd( fx, fy, qA12 );
+                qA22 = cv::v_muladd( fy, fy, qA22 );
+
+            }
+
+        }
+#endif
+
+        for ( ; x < m_winSize.width; ++x ) {
+
+            int ival = descale( src[ x ] * iw00 + src[ x + 1 ] * iw01 + src[ x + stepI ] * iw10 + src[ x + stepI + 1 ] * iw11, W_BITS - 5 );
+
+            int ixval = descale( dsrc[ x * 2 ] * iw00 + dsrc[ x * 2 + 2 ] * iw01 + dsrc[ x * 2 + stepD ] * iw10 + dsrc[ x * 2 + stepD + 2 ] * iw11, W_BITS );
+            int iyval = descale( dsrc[ x * 2 + 1 ] * iw00 + dsrc[ x * 2 + 3 ] * iw01 + dsrc[ x * 2 + stepD + 1 ] * iw10 + dsrc[ x * 2 + stepD + 3 ] * iw11, W_BITS );
+
+            Iptr[ x ] = static_cast< short >( ival );
+            dIptr[ x * 2 ] = static_cast< short >( ixval );
+            dIptr[ x * 2 + 1 ] = static_cast< short >( iyval );
+
+            iA11 += static_cast< float >( ixval * ixval );
+            iA12 += static_cast< float >( ixval * iyval );
+            iA22 += static_cast< float >( iyval * iyval );
+
+        }
+
+    }
+
+#if CV_SIMD128
+    iA11 += cv::v_reduce_sum( qA11 );
+    iA12 += cv::v_reduce_sum( qA12 );
+    iA22 += cv::v_reduce_sum( qA22 );
+#endif
+
+    float A11 = iA11 * FLT_SCALE;
+    float A12 = iA12 * FLT_SCALE;
+    float A22 = iA22 * FLT_SCALE;
+
+    // Along a row only the horizontal gradient matters
+    float D = horizontal ? A11 : A11 * A22 - A12 * A12;
+    float minEig = horizontal ? A11 / area : ( A22 + A11 - std::sqrt( ( A11 - A22 ) * ( A11 - A22 ) + 4.f * A12 * A12 ) ) / ( 2 * area );
+
+    state->minEigenValue = minEig;
+
+    if ( minEig < m_minEigenValue || D < FLT_EPSILON ) {
+
+        if ( level == 0 )
+            state->status = false;
+
+        return;
+
+    }
+
+    D = 1.f / D;
+
+    nextPoint -= halfWin;
+
+    cv::Point2f prevDelta;
+
+    auto stepJ = J.step1();
+
+    for ( int j = 0; j < maxCount; ++j ) {
+
+        cv::Point2i inextPt( cvFloor( nextPoint.x ), cvFloor( nextPoint.y ) );
+
+        if ( inextPt.x < -m_winSize.width || inextPt.x >= J.cols || inextPt.y < -m_winSize.height || inextPt.y >= J.rows ) {
+
+            if ( level == 0 )
+                state->status = false;
+
+            break;
+
+        }
+
+        a = nextPoint.x - inextPt.x;
+        b = nextPoint.y - inextPt.y;
+
+        iw00 = cvRound( ( 1.f - a ) * ( 1.f - b ) * ( 1 << W_BITS ) );
+        iw01 = cvRound( a * ( 1.f - b ) * ( 1 << W_BITS ) );
+        iw10 = cvRound( ( 1.f - a ) * b * ( 1 << W_BITS ) );
+        iw11 = ( 1 << W_BITS ) - iw00 - iw01 - iw10;
+
+        float ib1 = 0.f, ib2 = 0.f;
+
+#if CV_SIMD128
+        qw0 = cv::v_int16x8( iw00, iw01, iw00, iw01, iw00, iw01, iw00, iw01 );
+        qw1 = cv::v_int16x8( iw10, iw11, iw10, iw11, iw10, iw11, iw10, iw11 );
+
+        cv::v_float32x4 qb0 = cv::v_setzero_f32(), qb1 = cv::v_setzero_f32();
+#endif
+
+        for ( int y = 0; y < m_winSize.height; ++y ) {
+
+            const uchar *Jptr = J.ptr< uchar >( y + inextPt.y ) + inextPt.x;
+
+            const short *Iptr = patch->image.data() + y * m_winSize.width;
+            const short *dIptr = patch->derivatives.data() + y * m_winSize.width * 2;
+
+            int x = 0;
+
+#if CV_SIMD128
+            for ( ; x <= m_winSize.width - 8; x += 8 ) {
+
+                cv::v_int16x8 t00, t01, t10, t11;
+
+                cv::v_zip( cv::v_reinterpret_as_s16( cv::v_load_expand( Jptr + x ) ), cv::v_reinterpret_as_s16( cv::v_load_expand( Jptr + x + 1 ) ), t00, t01 );
+                cv::v_zip( cv::v_reinterpret_as_s16( cv::v_load_expand( Jptr + x + stepJ ) ), cv::v_reinterpret_as_s16( cv::v_load_expand( Jptr + x + stepJ + 1 ) ), t10, t11 );
+
+                cv::v_int32x4 t0 = ( cv::v_dotprod( t00, qw0, qdelta ) + cv::v_dotprod( t10, qw1 ) ) >> ( W_BITS - 5 );
+                cv::v_int32x4 t1 = ( cv::v_dotprod( t01, qw0, qdelta ) + cv::v_dotprod( t11, qw1 ) ) >> ( W_BITS - 5 );
+
+                auto diff = cv::v_pack( t0, t1 ) - cv::v_load( Iptr + x );
+
+                // d0 d4 d0 d4 d1 d5 ... against Ix0 Ix4 Iy0 Iy4 Ix1 Ix5 ..., even lanes sum to b1 and odd ones to b2
+                cv::v_int16x8 diff0, diff1, gradients0, gradients1;
+
+                cv::v_zip( diff, diff, diff0, diff1 );
+                cv::v_zip( diff0, diff1, t00, t01 );
+                cv::v_zip( cv::v_load( dIptr + x * 2 ), cv::v_load( dIptr + x * 2 + 8 ), gradients0, gradients1 );
+
+                qb0 += cv::v_cvt_f32( cv::v_dotprod( t00, gradients0 ) );
+                qb1 += cv::v_cvt_f32( cv::v_dotprod( t01, gradients1 ) );
+
+            }
+#endif
+
+            for ( ; x < m_winSize.width; ++x ) {
+
+                int diff = descale( Jptr[ x ] * iw00 + Jptr[ x + 1 ] * iw01 + Jptr[ x + stepJ ] * iw10 + Jptr[ x + stepJ + 1 ] * iw11, W_BITS - 5 ) - Iptr[ x ];
+
+                ib1 += static_cast< float >( diff * dIptr[ x * 2 ] );
+                ib2 += static_cast< float >( diff * dIptr[ x * 2 + 1 ] );
+
+            }
+
+        }
+
+#if CV_SIMD128
+        float CV_DECL_ALIGNED( 16 ) sums[ 4 ];
+
+        cv::v_store_aligned( sums, qb0 + qb1 );
+
+        ib1 += sums[ 0 ] + sums[ 2 ];
+        ib2 += sums[ 1 ] + sums[ 3 ];
+#endif
+
+        float b1 = ib1 * FLT_SCALE;
+        float b2 = ib2 * FLT_SCALE;
+
+        cv::Point2f delta = horizontal ? cv::Point2f( -b1 * D, 0.f )
+                                       : cv::Point2f( ( A12 * b2 - A22 * b1 ) * D, ( A12 * b1 - A11 * b2 ) * D );
+
+        nextPoint += delta;
+
+        if ( delta.ddot( delta ) <= epsilonSquared )
+            break;
+
+        if ( j > 0 && std::abs( delta.x + prevDelta.x ) < 0.01 && std::abs( delta.y + prevDelta.y ) < 0.01 ) {
+            nextPoint -= delta * 0.5f;
+            break;
+        }
+
+        prevDelta = delta;
+
+    }
+
+    nextPoint += halfWin;
+
+}
+
+void KLTTracker::setWinSize( const cv::Size &value )
+{
+    m_winSize = value;
+}
+
+const cv::Size &KLTTracker::winSize() const
+{
+    return m_winSize;
+}
+
+void KLTTracker::setLevels( const int value )
+{
+    m_levels = value;
+}
+
+int KLTTracker::levels() const
+{
+    return m_levels;
+}
+
+void KLTTracker::setTermCriteria( const cv::TermCriteria &value )
+{
+    m_termCriteria = value;
+}
+
+const cv::TermCriteria &KLTTracker::termCriteria() const
+{
+    return m_termCriteria;
+}
+
+void KLTTracker::setMinEigenValue( const double value )
+{
+    m_minEigenValue = value;
+}
+
+double KLTTracker::minEigenValue() const
+{
+    return m_minEigenValue;
+}
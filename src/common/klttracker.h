@@ -0,0 +1,100 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+// Structure-of-arrays result of a forward-backward sparse flow pass
+struct FlowTrackBuffer
+{
+public:
+    void resize( const size_t size );
+    size_t size() const;
+
+    std::vector< cv::Point2f > points;
+    std::vector< float > errors;
+    std::vector< float > misses;
+    std::vector< unsigned char > statuses;
+
+};
+
+// Pyramidal Lucas-Kanade for single channel pyramids built by
+// cv::buildOpticalFlowPyramid() with derivatives. The fixed point
+// arithmetic follows cv::calcOpticalFlowPyrLK() with
+// OPTFLOW_LK_GET_MIN_EIGENVALS, so errors are minimal eigenvalues and the
+// eigenvalue threshold and termination criteria mean the same. Patches are
+// sampled and summed with universal intrinsics. Points go level by level in
+// chunks, and the backward check of a chunk runs on each level together
+// with the forward pass of the next chunk, both reading the same two levels.
+// For rectified stereo trackRows() keeps the row and only solves for the
+// horizontal shift, starting from a block search within the disparity band.
+class KLTTracker
+{
+public:
+    KLTTracker();
+
+    static bool isSupported( const std::vector< cv::Mat > &imagePyramid );
+
+    void track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid, FlowTrackBuffer *buffer ) const;
+
+    // Starts from the predicted target points, the backward check from the inverse prediction
+    void track( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > &guessPoints,
+                const std::vector< cv::Mat > &targetImagePyramid, FlowTrackBuffer *buffer ) const;
+
+    void trackRows( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Mat > &targetImagePyramid,
+                    const float minDisparity, const float maxDisparity, FlowTrackBuffer *buffer ) const;
+
+    void setWinSize( const cv::Size &value );
+    const cv::Size &winSize() const;
+
+    void setLevels( const int value );
+    int levels() const;
+
+    void setTermCriteria( const cv::TermCriteria &value );
+    const cv::TermCriteria &termCriteria() const;
+
+    void setMinEigenValue( const double value );
+    double minEigenValue() const;
+
+protected:
+    cv::Size m_winSize;
+    int m_levels;
+
+    cv::TermCriteria m_termCriteria;
+
+    double m_minEigenValue;
+
+    static const size_t m_chunkSize = 64;
+    static const int m_taskChunks = 4;
+    static const int m_blockRadius = 3;
+
+    struct Patch
+    {
+        std::vector< short > image;
+        std::vector< short > derivatives;
+    };
+
+    // Estimate of one point in the coordinates of the current level
+    struct PointState
+    {
+        cv::Point2f point;
+        float minEigenValue;
+        bool status;
+    };
+
+    int levelsCount( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Mat > &targetImagePyramid ) const;
+
+    // Forward and backward passes of track() and trackRows(), guessPoints is null to start from the source points
+    void trackBatch( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Point2f > &sourcePoints, const std::vector< cv::Point2f > *guessPoints,
+                     const std::vector< cv::Mat > &targetImagePyramid, const bool rows, const float minDisparity, const float maxDisparity, FlowTrackBuffer *buffer ) const;
+
+    void trackLevel( const std::vector< cv::Mat > &sourceImagePyramid, const std::vector< cv::Mat > &targetImagePyramid, const int level, const int levels,
+                     const cv::Point2f &sourcePoint, const bool horizontal, PointState *state, Patch *patch ) const;
+
+    float searchRow( const cv::Mat &sourceImage, const cv::Mat &targetImage, const int level,
+                     const cv::Point2f &sourcePoint, const float minShift, const float maxShift ) const;
+
+private:
+    void initialize();
+
+};
@@ -0,0 +1,11 @@
+#pragma once
+
+// Runs body( i ) for every i in [ 0, count ) as an OpenMP taskloop. Inside an
+// active parallel region the tasks go to the threads of that region, so a
+// kernel called from a task graph shares its pool instead of opening a nested
+// region that would run on one thread. Outside of any region a team is opened
+// for the loop.
+template < typename Body >
+void parallelTasks( const int count, Body &&body );
+
+#include "paralleltasks.inl"
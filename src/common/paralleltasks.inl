@@ -0,0 +1,26 @@
+#include <omp.h>
+
+template < typename Body >
+void parallelTasks( const int count, Body &&body )
+{
+    if ( count <= 0 )
+        return;
+
+    if ( omp_in_parallel() ) {
+
+        #pragma omp taskloop
+        for ( int i = 0; i < count; ++i )
+            body( i );
+
+    }
+    else {
+
+        #pragma omp parallel
+        #pragma omp single
+        #pragma omp taskloop
+        for ( int i = 0; i < count; ++i )
+            body( i );
+
+    }
+
+}
@@ -0,0 +1,590 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+// Profiler::ThreadRing
+Profiler::ThreadRing::ThreadRing( const int thread )
+    : m_head( 0 ), m_tail( 0 ), m_lost( 0 ), m_retired( false ), m_thread( thread )
+{
+    for ( auto &i : m_slots )
+        i.sequence.store( 0, std::memory_order_relaxed );
+}
+
+void Profiler::ThreadRing::push( const Event &event )
+{
+    auto head = m_head.load( std::memory_order_relaxed );
+
+    auto &slot = m_slots[ head % m_ringSize ];
+
+    // Odd while written, 2 * ( index + 1 ) once the event of that index is complete
+    slot.sequence.store( 2 * head + 1, std::memory_order_relaxed );
+    std::atomic_thread_fence( std::memory_order_release );
+
+    slot.name.store( event.name, std::memory_order_relaxed );
+    slot.type.store( event.type, std::memory_order_relaxed );
+    slot.start.store( event.start, std::memory_order_relaxed );
+    slot.duration.store( event.duration, std::memory_order_relaxed );
+    slot.value.store( event.value, std::memory_order_relaxed );
+
+    slot.sequence.store( 2 * head + 2, std::memory_order_release );
+
+    m_head.store( head + 1, std::memory_order_release );
+}
+
+void Profiler::ThreadRing::pop( std::vector< Event > *events )
+{
+    auto head = m_head.load( std::memory_order_acquire );
+
+    if ( head - m_tail > m_ringSize ) {
+        m_lost += head - m_tail - m_ringSize;
+        m_tail = head - m_ringSize;
+    }
+
+    for ( auto i = m_tail; i < head; ++i ) {
+
+        auto &slot = m_slots[ i % m_ringSize ];
+
+        auto sequence = slot.sequence.load( std::memory_order_acquire );
+
+        Event event;
+        event.name = slot.name.load( std::memory_order_relaxed );
+        event.type = static_cast< EventType >( slot.type.load( std::memory_order_relaxed ) );
+        event.start = slot.start.load( std::memory_order_relaxed );
+        event.duration = slot.duration.load( std::memory_order_relaxed );
+        event.value = slot.value.load( std::memory_order_relaxed );
+
+        std::atomic_thread_fence( std::memory_order_acquire );
+
+        // The owner has wrapped over the slot while it was read
+        if ( sequence != 2 * i + 2 || slot.sequence.load( std::memory_order_relaxed ) != sequence )
+            ++m_lost;
+        else
+            events->push_back( event );
+
+    }
+
+    m_tail = head;
+}
+
+void Profiler::ThreadRing::retire()
+{
+    // Publishes the last events of the owner to the consumer that sees the ring retired
+    m_retired.store( true, std::memory_order_release );
+}
+
+bool Profiler::ThreadRing::retired() const
+{
+    return m_retired.load( std::memory_order_acquire );
+}
+
+void Profiler::ThreadRing::discard()
+{
+    auto head = m_head.load( std::memory_order_acquire );
+
+    m_lost += head - m_tail;
+    m_tail = head;
+}
+
+void Profiler::ThreadRing::reuse( const int thread )
+{
+    // Indices go on from the drained head, so the slot sequences stay valid
+    m_thread = thread;
+    m_retired.store( false, std::memory_order_relaxed );
+}
+
+int Profiler::ThreadRing::thread() const
+{
+    return m_thread;
+}
+
+uint64_t Profiler::ThreadRing::lost() const
+{
+    return m_lost.load( std::memory_order_relaxed );
+}
+
+// Profiler::ThreadRingRetirer
+Profiler::ThreadRingRetirer::ThreadRingRetirer( ThreadRing *&ring )
+    : m_ring( ring )
+{
+}
+
+Profiler::ThreadRingRetirer::~ThreadRingRetirer()
+{
+    m_ring->retire();
+
+    // Events from later thread local destructors take a new ring, the retired one may already have a new owner
+    m_ring = nullptr;
+}
+
+// Profiler
+const std::chrono::milliseconds Profiler::m_collectPeriod( 100 );
+
+Profiler::Profiler()
+{
+    initialize();
+}
+
+void Profiler::initialize()
+{
+    m_epoch = std::chrono::steady_clock::now();
+    m_windowStart = m_epoch;
+
+    m_threadsCount = 0;
+
+    m_maxTraceEvents = 1 << 20;
+    m_droppedTraceEvents = 0;
+
+    m_collectorStopped = true;
+    m_summaryPeriod = std::chrono::milliseconds( 0 );
+    m_summaryStream = &std::cout;
+
+    auto traceFileName = std::getenv( "PROFILER_TRACE_FILE" );
+
+    if ( traceFileName )
+        m_traceFileName = traceFileName;
+
+    m_traceEnabled = !m_traceFileName.empty();
+
+    if ( m_traceEnabled )
+        startCollector();
+
+    auto summaryPeriod = std::getenv( "PROFILER_SUMMARY_PERIOD" );
+
+    if ( summaryPeriod ) {
+        auto period = std::atof( summaryPeriod );
+
+        if ( period > 0. )
+            startPeriodicSummary( std::chrono::milliseconds( static_cast< int64_t >( period * 1000. ) ) );
+
+    }
+
+    std::atexit( &Profiler::finish );
+
+}
+
+Profiler &Profiler::instance()
+{
+    // Leaked on purpose, see finish()
+    static Profiler *profiler = new Profiler();
+
+    return *profiler;
+}
+
+void Profiler::finish()
+{
+    auto &profiler = instance();
+
+    profiler.stopCollector();
+
+    if ( !profiler.m_traceFileName.empty() )
+        profiler.writeChromeTrace( profiler.m_traceFileName );
+}
+
+Profiler::ThreadRing *Profiler::threadRing()
+{
+    static thread_local ThreadRing *ring = nullptr;
+
+    if ( !ring ) {
+        ring = acquireRing();
+
+        // Constructed once, a ring taken after the thread exit has started is never retired
+        static thread_local ThreadRingRetirer retirer( ring );
+    }
+
+    return ring;
+}
+
+Profiler::ThreadRing *Profiler::acquireRing()
+{
+    bool collectorStopped;
+
+    {
+        std::lock_guard< std::mutex > lock( m_collectorMutex );
+        collectorStopped = m_collectorStopped;
+    }
+
+    // Retired rings are checked and taken on the consumer side
+    std::lock_guard< std::mutex > collectLock( m_collectMutex );
+    std::lock_guard< std::mutex > lock( m_ringsMutex );
+
+    // Rings are owned by the profiler, so events of finished threads are still collected
+    for ( auto &i : m_rings ) {
+
+        if ( !i->retired() )
+            continue;
+
+        // Events left by the exited thread are collected now, or dropped if nothing would ever collect them
+        if ( collectorStopped )
+            i->discard();
+        else
+            collectRing( i.get() );
+
+        i->reuse( m_threadsCount++ );
+
+        return i.get();
+
+    }
+
+    m_rings.push_back( std::make_shared< ThreadRing >( m_threadsCount++ ) );
+
+    return m_rings.back().get();
+}
+
+void Profiler::addSpan( const char *name, const std::chrono::steady_clock::time_point &start, const std::chrono::steady_clock::time_point &finish )
+{
+    Event event;
+    event.name = name;
+    event.type = SPAN;
+    event.start = std::chrono::duration_cast< std::chrono::nanoseconds >( start - m_epoch ).count();
+    event.duration = std::chrono::duration_cast< std::chrono::nanoseconds >( finish - start ).count();
+    event.value = 0.;
+
+    threadRing()->push( event );
+}
+
+void Profiler::addCounter( const char *name, const double value )
+{
+    Event event;
+    event.name = name;
+    event.type = COUNTER;
+    event.start = std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now() - m_epoch ).count();
+    event.duration = 0;
+    event.value = value;
+
+    threadRing()->push( event );
+}
+
+void Profiler::setThreadName( const std::string &name )
+{
+    auto thread = threadRing()->thread();
+
+    std::lock_guard< std::mutex > lock( m_ringsMutex );
+
+    m_threadNames[ thread ] = name;
+}
+
+void Profiler::setTraceEnabled( const bool value )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_collectMutex );
+        m_traceEnabled = value;
+    }
+
+    if ( value )
+        startCollector();
+}
+
+bool Profiler::traceEnabled() const
+{
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    return m_traceEnabled;
+}
+
+void Profiler::setMaxTraceEvents( const size_t value )
+{
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    m_maxTraceEvents = value;
+}
+
+size_t Profiler::maxTraceEvents() const
+{
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    return m_maxTraceEvents;
+}
+
+void Profiler::collect()
+{
+    std::vector< std::shared_ptr< ThreadRing > > rings;
+
+    {
+        std::lock_guard< std::mutex > lock( m_ringsMutex );
+        rings = m_rings;
+    }
+
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    for ( auto &ring : rings )
+        collectRing( ring.get() );
+
+}
+
+void Profiler::collectRing( ThreadRing *ring )
+{
+    std::vector< Event > events;
+
+    ring->pop( &events );
+
+    for ( auto &i : events ) {
+
+        if ( i.type == SPAN )
+            m_windowSpans[ i.name ].push_back( i.duration * 1.e-6 );
+        else
+            m_windowCounters[ i.name ].push_back( i.value );
+
+        if ( m_traceEnabled ) {
+
+            if ( m_traceEvents.size() < m_maxTraceEvents )
+                m_traceEvents.push_back( TraceEvent{ i, ring->thread() } );
+            else
+                ++m_droppedTraceEvents;
+
+        }
+
+    }
+
+}
+
+uint64_t Profiler::lostEvents()
+{
+    std::lock_guard< std::mutex > lock( m_ringsMutex );
+
+    uint64_t ret = 0;
+
+    for ( auto &ring : m_rings )
+        ret += ring->lost();
+
+    return ret;
+}
+
+uint64_t Profiler::droppedTraceEvents() const
+{
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    return m_droppedTraceEvents;
+}
+
+bool Profiler::writeChromeTrace( const std::string &fileName )
+{
+    collect();
+
+    std::ofstream file( fileName );
+
+    if ( !file.is_open() )
+        return false;
+
+    std::map< int, std::string > threadNames;
+
+    {
+        std::lock_guard< std::mutex > lock( m_ringsMutex );
+        threadNames = m_threadNames;
+    }
+
+    auto lost = lostEvents();
+
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    file << std::fixed << std::setprecision( 3 );
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+
+    for ( auto &i : threadNames ) {
+        auto name = i.second;
+        std::replace( name.begin(), name.end(), '"', '\'' );
+
+        file << ( first ? "\n" : ",\n" );
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i.first << ",\"args\":{\"name\":\"" << name << "\"}}";
+
+        first = false;
+    }
+
+    // Timestamps are microseconds
+    for ( auto &i : m_traceEvents ) {
+        file << ( first ? "\n" : ",\n" );
+
+        if ( i.event.type == SPAN )
+            file << "{\"name\":\"" << i.event.name << "\",\"cat\":\"stage\",\"ph\":\"X\",\"ts\":" << i.event.start * 1.e-3
+                 << ",\"dur\":" << i.event.duration * 1.e-3 << ",\"pid\":1,\"tid\":" << i.thread << "}";
+        else
+            file << "{\"name\":\"" << i.event.name << "\",\"ph\":\"C\",\"ts\":" << i.event.start * 1.e-3
+                 << ",\"pid\":1,\"tid\":" << i.thread << ",\"args\":{\"value\":" << i.event.value << "}}";
+
+        first = false;
+    }
+
+    // Events missing from the trace: overwritten in the rings and over the trace limit
+    file << "\n],\"otherData\":{\"lostEvents\":" << lost << ",\"droppedTraceEvents\":" << m_droppedTraceEvents << "}}\n";
+
+    return file.good();
+
+}
+
+double Profiler::percentile( const std::vector< double > &sortedValues, const double value )
+{
+    if ( sortedValues.empty() )
+        return 0.;
+
+    auto index = static_cast< size_t >( value * ( sortedValues.size() - 1 ) + 0.5 );
+
+    return sortedValues[ std::min( index, sortedValues.size() - 1 ) ];
+}
+
+std::string Profiler::summary()
+{
+    collect();
+
+    std::vector< std::shared_ptr< ThreadRing > > rings;
+
+    {
+        std::lock_guard< std::mutex > lock( m_ringsMutex );
+        rings = m_rings;
+    }
+
+    std::lock_guard< std::mutex > lock( m_collectMutex );
+
+    auto now = std::chrono::steady_clock::now();
+
+    std::ostringstream stream;
+
+    stream << std::fixed << std::setprecision( 3 );
+
+    stream << "Profiler summary, " << std::chrono::duration< double >( now - m_windowStart ).count() << " s:\n";
+
+    for ( auto &i : m_windowSpans ) {
+        auto &values = i.second;
+        std::sort( values.begin(), values.end() );
+
+        stream << "  " << std::left << std::setw( 24 ) << i.first << std::right
+               << " n=" << std::setw( 6 ) << values.size()
+               << " p50=" << std::setw( 9 ) << percentile( values, 0.5 )
+               << " p95=" << std::setw( 9 ) << percentile( values, 0.95 )
+               << " p99=" << std::setw( 9 ) << percentile( values, 0.99 ) << " ms\n";
+    }
+
+    for ( auto &i : m_windowCounters ) {
+        auto &values = i.second;
+
+        double mean = 0.;
+
+        for ( auto &j : values )
+            mean += j;
+
+        mean /= values.size();
+
+        stream << "  " << std::left << std::setw( 24 ) << i.first << std::right
+               << " n=" << std::setw( 6 ) << values.size()
+               << " last=" << std::setw( 9 ) << values.back()
+               << " mean=" << std::setw( 9 ) << mean << "\n";
+    }
+
+    uint64_t lost = 0;
+
+    for ( auto &ring : rings )
+        lost += ring->lost();
+
+    if ( lost > 0 )
+        stream << "  lost events: " << lost << "\n";
+
+    if ( m_droppedTraceEvents > 0 )
+        stream << "  events over the trace limit: " << m_droppedTraceEvents << "\n";
+
+    m_windowSpans.clear();
+    m_windowCounters.clear();
+    m_windowStart = now;
+
+    return stream.str();
+
+}
+
+void Profiler::startPeriodicSummary( const std::chrono::milliseconds &period, std::ostream &stream )
+{
+    {
+        std::lock_guard< std::mutex > lock( m_collectorMutex );
+
+        m_summaryPeriod = period;
+        m_summaryStream = &stream;
+    }
+
+    startCollector();
+}
+
+void Profiler::stopPeriodicSummary()
+{
+    {
+        std::lock_guard< std::mutex > lock( m_collectorMutex );
+        m_summaryPeriod = std::chrono::milliseconds( 0 );
+    }
+
+    if ( !traceEnabled() )
+        stopCollector();
+}
+
+void Profiler::startCollector()
+{
+    std::lock_guard< std::mutex > lock( m_collectorMutex );
+
+    if ( !m_collectorStopped )
+        return;
+
+    // A collector stopped before is joined here, its loop has already ended
+    if ( m_collectorThread.joinable() )
+        m_collectorThread.join();
+
+    m_collectorStopped = false;
+
+    m_collectorThread = std::thread( [ this ]() {
+        auto lastSummary = std::chrono::steady_clock::now();
+
+        std::unique_lock< std::mutex > lock( m_collectorMutex );
+
+        while ( !m_collectorCondition.wait_for( lock, m_collectPeriod, [ this ]() { return m_collectorStopped; } ) ) {
+            auto period = m_summaryPeriod;
+            auto stream = m_summaryStream;
+
+            lock.unlock();
+
+            auto now = std::chrono::steady_clock::now();
+
+            if ( period.count() > 0 && now - lastSummary >= period ) {
+                *stream << summary() << std::flush;
+                lastSummary = now;
+            }
+            else
+                collect();
+
+            lock.lock();
+        }
+
+    } );
+
+}
+
+void Profiler::stopCollector()
+{
+    std::thread thread;
+
+    {
+        std::lock_guard< std::mutex > lock( m_collectorMutex );
+
+        m_collectorStopped = true;
+        thread = std::move( m_collectorThread );
+    }
+
+    m_collectorCondition.notify_all();
+
+    if ( thread.joinable() )
+        thread.join();
+}
+
+// ProfileScope
+ProfileScope::ProfileScope( const char *name )
+    : m_name( name )
+{
+    // The first scope creates the profiler, so its epoch precedes the scope start
+    Profiler::instance();
+
+    m_start = std::chrono::steady_clock::now();
+}
+
+ProfileScope::~ProfileScope()
+{
+    Profiler::instance().addSpan( m_name, m_start, std::chrono::steady_clock::now() );
+}
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hot path profiler: scoped timers and counters go to per-thread rings without locks,
+// a collector thread drains them into a Chrome trace (chrome://tracing, Perfetto) and p50/p95/p99 summaries.
+// Environment: PROFILER_TRACE_FILE writes the trace on exit, PROFILER_SUMMARY_PERIOD (seconds) prints summaries.
+// The profiler is never destroyed, threads still running at exit keep writing to valid rings.
+// The ring of an exited thread is drained and reused by a new thread, so rings only grow with concurrent threads.
+class Profiler
+{
+public:
+    enum EventType { SPAN, COUNTER };
+
+    struct Event
+    {
+        const char *name;
+        EventType type;
+        int64_t start;
+        int64_t duration;
+        double value;
+    };
+
+    static Profiler &instance();
+
+    // Names must be string literals, only pointers are stored
+    void addSpan( const char *name, const std::chrono::steady_clock::time_point &start, const std::chrono::steady_clock::time_point &finish );
+    void addCounter( const char *name, const double value );
+
+    void setThreadName( const std::string &name );
+
+    void setTraceEnabled( const bool value );
+    bool traceEnabled() const;
+
+    void setMaxTraceEvents( const size_t value );
+    size_t maxTraceEvents() const;
+
+    // Drains the thread rings into the trace and the summary window
+    void collect();
+
+    // Events overwritten in the rings before they were drained, and left out of the full trace
+    uint64_t lostEvents();
+    uint64_t droppedTraceEvents() const;
+
+    bool writeChromeTrace( const std::string &fileName );
+
+    // Statistics since the previous summary
+    std::string summary();
+
+    void startPeriodicSummary( const std::chrono::milliseconds &period, std::ostream &stream = std::cout );
+    void stopPeriodicSummary();
+
+protected:
+    Profiler();
+
+    static const size_t m_ringSize = 1 << 14;
+
+    // Single producer (owner thread), single consumer (collector under m_collectMutex).
+    // Slots are seqlocked atomics: a slot the owner rewrote while it was read is counted as lost
+    class ThreadRing
+    {
+    public:
+        explicit ThreadRing( const int thread );
+
+        void push( const Event &event );
+        void pop( std::vector< Event > *events );
+
+        // Owner side, on the thread exit
+        void retire();
+        bool retired() const;
+
+        // Consumer side: unread events are counted as lost, a new owner takes the ring
+        void discard();
+        void reuse( const int thread );
+
+        int thread() const;
+        uint64_t lost() const;
+
+    protected:
+        struct Slot
+        {
+            std::atomic< uint64_t > sequence;
+            std::atomic< const char * > name;
+            std::atomic< int > type;
+            std::atomic< int64_t > start;
+            std::atomic< int64_t > duration;
+            std::atomic< double > value;
+        };
+
+        std::array< Slot, m_ringSize > m_slots;
+        std::atomic< uint64_t > m_head;
+        uint64_t m_tail;
+        std::atomic< uint64_t > m_lost;
+        std::atomic< bool > m_retired;
+        int m_thread;
+    };
+
+    // Thread local: retires the ring of its thread on the thread exit
+    class ThreadRingRetirer
+    {
+    public:
+        explicit ThreadRingRetirer( ThreadRing *&ring );
+        ~ThreadRingRetirer();
+
+    protected:
+        ThreadRing *&m_ring;
+    };
+
+    struct TraceEvent
+    {
+        Event event;
+        int thread;
+    };
+
+    std::chrono::steady_clock::time_point m_epoch;
+
+    std::mutex m_ringsMutex;
+    std::vector< std::shared_ptr< ThreadRing > > m_rings;
+    std::map< int, std::string > m_threadNames;
+    int m_threadsCount;
+
+    mutable std::mutex m_collectMutex;
+    bool m_traceEnabled;
+    size_t m_maxTraceEvents;
+    std::vector< TraceEvent > m_traceEvents;
+    uint64_t m_droppedTraceEvents;
+    std::map< std::string, std::vector< double > > m_windowSpans;
+    std::map< std::string, std::vector< double > > m_windowCounters;
+    std::chrono::steady_clock::time_point m_windowStart;
+
+    std::string m_traceFileName;
+
+    // Drains the rings while tracing or summaries are on, so rings only overflow within a period
+    static const std::chrono::milliseconds m_collectPeriod;
+
+    std::thread m_collectorThread;
+    std::mutex m_collectorMutex;
+    std::condition_variable m_collectorCondition;
+    bool m_collectorStopped;
+    std::chrono::milliseconds m_summaryPeriod;
+    std::ostream *m_summaryStream;
+
+    ThreadRing *threadRing();
+    ThreadRing *acquireRing();
+
+    // Under m_collectMutex
+    void collectRing( ThreadRing *ring );
+
+    void startCollector();
+    void stopCollector();
+
+    // Registered with atexit(): stops the collector and writes PROFILER_TRACE_FILE
+    static void finish();
+
+    static double percentile( const std::vector< double > &sortedValues, const double value );
+
+private:
+    void initialize();
+
+};
+
+class ProfileScope
+{
+public:
+    explicit ProfileScope( const char *name );
+    ~ProfileScope();
+
+protected:
+    const char *m_name;
+    std::chrono::steady_clock::time_point m_start;
+
+};
+
+#ifdef PROFILING_ENABLED
+#define PROFILE_CONCAT_IMPL( a, b ) a##b
+#define PROFILE_CONCAT( a, b ) PROFILE_CONCAT_IMPL( a, b )
+#define PROFILE_SCOPE( name ) ProfileScope PROFILE_CONCAT( profileScope, __LINE__ )( "" name )
+#define PROFILE_COUNTER( name, value ) Profiler::instance().addCounter( "" name, static_cast< double >( value ) )
+#define PROFILE_THREAD( name ) Profiler::instance().setThreadName( name )
+#else
+#define PROFILE_SCOPE( name )
+#define PROFILE_COUNTER( name, value ) static_cast< void >( sizeof( value ) )
+#define PROFILE_THREAD( name )
+#endif
@@ -0,0 +1,75 @@
+#include "precompiled.h"
+
+#include "pyramidpool.h"
+
+// PyramidPool
+PyramidPool::PyramidPool( const size_t capacity )
+    : m_capacity( capacity )
+{
+}
+
+void PyramidPool::acquire( std::vector< cv::Mat > *imagePyramid )
+{
+    if ( imagePyramid ) {
+
+        std::lock_guard< std::mutex > lock( m_mutex );
+
+        if ( !m_pyramids.empty() ) {
+            *imagePyramid = std::move( m_pyramids.front() );
+            m_pyramids.pop_front();
+        }
+
+    }
+
+}
+
+void PyramidPool::release( std::vector< cv::Mat > *imagePyramid )
+{
+    if ( imagePyramid ) {
+
+        // Levels still referenced elsewhere can't be overwritten
+        if ( !imagePyramid->empty() && isUnique( *imagePyramid ) ) {
+
+            std::lock_guard< std::mutex > lock( m_mutex );
+
+            if ( m_pyramids.size() < m_capacity )
+                m_pyramids.push_back( std::move( *imagePyramid ) );
+
+        }
+
+        imagePyramid->clear();
+
+    }
+
+}
+
+size_t PyramidPool::capacity() const
+{
+    return m_capacity;
+}
+
+void PyramidPool::setCapacity( const size_t value )
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    m_capacity = value;
+
+    while ( m_pyramids.size() > m_capacity )
+        m_pyramids.pop_back();
+}
+
+size_t PyramidPool::size() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    return m_pyramids.size();
+}
+
+bool PyramidPool::isUnique( const std::vector< cv::Mat > &imagePyramid )
+{
+    for ( auto &i : imagePyramid )
+        if ( !i.u || i.u->refcount != 1 )
+            return false;
+
+    return true;
+}
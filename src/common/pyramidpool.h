@@ -0,0 +1,33 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+
+#include <list>
+#include <mutex>
+
+// Recycles optical flow pyramids. cv::buildOpticalFlowPyramid() builds into
+// levels of matching size in place, so a pyramid taken from the pool is
+// rebuilt without allocations.
+class PyramidPool
+{
+public:
+    PyramidPool( const size_t capacity = 8 );
+
+    void acquire( std::vector< cv::Mat > *imagePyramid );
+    void release( std::vector< cv::Mat > *imagePyramid );
+
+    size_t capacity() const;
+    void setCapacity( const size_t value );
+
+    size_t size() const;
+
+protected:
+    mutable std::mutex m_mutex;
+
+    std::list< std::vector< cv::Mat > > m_pyramids;
+
+    size_t m_capacity;
+
+    static bool isUnique( const std::vector< cv::Mat > &imagePyramid );
+
+};
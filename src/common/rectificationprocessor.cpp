@@ -2,6 +2,8 @@
 
 #include "rectificationprocessor.h"
 
+#include "profiler.h"
+
 // RectificationProcessorBase
 RectificationProcessorBase::RectificationProcessorBase()
 {
@@ -145,6 +147,8 @@ void StereoRectificationProcessor::calcRectificationMaps()
 
 bool StereoRectificationProcessor::rectify( const CvImage &leftImage, const CvImage &rightImage, CvImage *leftResult, CvImage *rightResult ) const
 {
+    PROFILE_SCOPE( "rectification" );
+
     auto result = rectifyLeft( leftImage, leftResult );
     result = result && rectifyRight( rightImage, rightResult );
 
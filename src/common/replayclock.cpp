@@ -0,0 +1,54 @@
+#include "precompiled.h"
+
+#include "replayclock.h"
+
+// ReplayClock
+ReplayClock::ReplayClock( const double speed )
+{
+    initialize( speed );
+}
+
+void ReplayClock::initialize( const double speed )
+{
+    m_speed = speed > 0. ? speed : 1.;
+    m_started = false;
+}
+
+double ReplayClock::speed() const
+{
+    return m_speed;
+}
+
+void ReplayClock::start()
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    if ( m_started )
+        return;
+
+    m_startTime = std::chrono::steady_clock::now();
+    m_systemStartTime = std::chrono::system_clock::now();
+    m_started = true;
+}
+
+bool ReplayClock::isStarted() const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    return m_started;
+}
+
+std::chrono::steady_clock::time_point ReplayClock::dueTime( const std::chrono::steady_clock::duration &offset ) const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    return m_startTime + std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( offset ) / m_speed );
+}
+
+std::chrono::time_point< std::chrono::system_clock > ReplayClock::stamp( const std::chrono::steady_clock::duration &offset ) const
+{
+    std::lock_guard< std::mutex > lock( m_mutex );
+
+    // Stamps keep the recorded intervals, only the release is scaled by the speed
+    return m_systemStartTime + std::chrono::duration_cast< std::chrono::system_clock::duration >( offset );
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+
+// Common time base of sources replayed together, e.g. a simulated stereo camera and an IMU log.
+// Offsets from the start of the recordings are released at the replay speed and stamped on one system clock epoch,
+// so the frames and the packets get comparable times whatever their recorded wall-clock times were.
+// The clock starts on the first start() of any of the sources
+class ReplayClock
+{
+public:
+    explicit ReplayClock( const double speed = 1. );
+
+    double speed() const;
+
+    void start();
+    bool isStarted() const;
+
+    std::chrono::steady_clock::time_point dueTime( const std::chrono::steady_clock::duration &offset ) const;
+    std::chrono::time_point< std::chrono::system_clock > stamp( const std::chrono::steady_clock::duration &offset ) const;
+
+protected:
+    double m_speed;
+
+    bool m_started;
+    std::chrono::steady_clock::time_point m_startTime;
+    std::chrono::time_point< std::chrono::system_clock > m_systemStartTime;
+
+    mutable std::mutex m_mutex;
+
+private:
+    void initialize( const double speed );
+
+};
@@ -0,0 +1,456 @@
+#include "precompiled.h"
+
+#include "simulatedcamera.h"
+
+#include "profiler.h"
+#include "replayclock.h"
+
+#include <random>
+
+// SimulatedStereoCamera
+const std::chrono::milliseconds SimulatedStereoCamera::m_readAheadPoll( 1 );
+const std::chrono::milliseconds SimulatedStereoCamera::m_unreadableRetry( 1000 );
+
+SimulatedStereoCamera::SimulatedStereoCamera( QObject *parent )
+    : StereoCameraBase( parent ), m_readAheadRing( m_readAheadSize ), m_leftRing( m_ringSize ), m_rightRing( m_ringSize )
+{
+    initialize();
+}
+
+SimulatedStereoCamera::~SimulatedStereoCamera()
+{
+    stop();
+}
+
+void SimulatedStereoCamera::initialize()
+{
+    m_frameSize = cv::Size( 1280, 960 );
+    m_fps = 30.;
+    m_jitter = std::chrono::microseconds( 2000 );
+    m_dropProbability = 0.;
+    m_skew = std::chrono::microseconds( 0 );
+
+    m_leftDroppedFrames = 0;
+    m_rightDroppedFrames = 0;
+
+    m_stopped = true;
+
+    // Frames come from the generator thread, like the Vimba callbacks
+    connect( this, &SimulatedStereoCamera::generatedFrame, this, &SimulatedStereoCamera::updateFrame, Qt::QueuedConnection );
+}
+
+void SimulatedStereoCamera::setFileNames( const QStringList &leftFileNames, const QStringList &rightFileNames )
+{
+    m_leftFileNames = leftFileNames;
+    m_rightFileNames = rightFileNames;
+}
+
+const QStringList &SimulatedStereoCamera::leftFileNames() const
+{
+    return m_leftFileNames;
+}
+
+const QStringList &SimulatedStereoCamera::rightFileNames() const
+{
+    return m_rightFileNames;
+}
+
+void SimulatedStereoCamera::setFrameSize( const cv::Size &value )
+{
+    m_frameSize = value;
+}
+
+const cv::Size &SimulatedStereoCamera::frameSize() const
+{
+    return m_frameSize;
+}
+
+void SimulatedStereoCamera::setFps( const double value )
+{
+    m_fps = value;
+}
+
+double SimulatedStereoCamera::fps() const
+{
+    return m_fps;
+}
+
+void SimulatedStereoCamera::setJitter( const std::chrono::microseconds &value )
+{
+    m_jitter = value;
+}
+
+const std::chrono::microseconds &SimulatedStereoCamera::jitter() const
+{
+    return m_jitter;
+}
+
+void SimulatedStereoCamera::setDropProbability( const double value )
+{
+    m_dropProbability = value;
+}
+
+double SimulatedStereoCamera::dropProbability() const
+{
+    return m_dropProbability;
+}
+
+void SimulatedStereoCamera::setSkew( const std::chrono::microseconds &value )
+{
+    m_skew = value;
+}
+
+const std::chrono::microseconds &SimulatedStereoCamera::skew() const
+{
+    return m_skew;
+}
+
+void SimulatedStereoCamera::setClock( const std::shared_ptr< ReplayClock > &value )
+{
+    m_clock = value;
+}
+
+const std::shared_ptr< ReplayClock > &SimulatedStereoCamera::clock() const
+{
+    return m_clock;
+}
+
+bool SimulatedStereoCamera::start()
+{
+    stop();
+
+    m_errorString.clear();
+
+    if ( m_fps <= 0. ) {
+        m_errorString = tr( "Invalid frame rate %1" ).arg( m_fps );
+        return false;
+    }
+
+    if ( m_leftFileNames.empty() || m_rightFileNames.empty() )
+        renderSequence();
+    else if ( !loadSequence() )
+        return false;
+
+    m_stopped = false;
+
+    if ( m_leftSequence.empty() )
+        m_readerThread = std::thread( &SimulatedStereoCamera::readSequence, this );
+
+    m_thread = std::thread( &SimulatedStereoCamera::run, this );
+
+    return true;
+
+}
+
+void SimulatedStereoCamera::stop()
+{
+    m_stopped = true;
+
+    if ( m_thread.joinable() )
+        m_thread.join();
+
+    if ( m_readerThread.joinable() )
+        m_readerThread.join();
+
+    // Both threads are stopped, the next start reads from the first pair
+    while ( m_readAheadRing.readSlot() )
+        m_readAheadRing.commitRead();
+
+}
+
+bool SimulatedStereoCamera::isRunning() const
+{
+    return !m_stopped;
+}
+
+const QString &SimulatedStereoCamera::errorString() const
+{
+    return m_errorString;
+}
+
+uint64_t SimulatedStereoCamera::droppedLeftFrames() const
+{
+    return StereoCameraBase::droppedLeftFrames() + m_leftDroppedFrames;
+}
+
+uint64_t SimulatedStereoCamera::droppedRightFrames() const
+{
+    return StereoCameraBase::droppedRightFrames() + m_rightDroppedFrames;
+}
+
+cv::Mat SimulatedStereoCamera::bayerMosaic( const cv::Mat &image )
+{
+    CV_Assert( image.type() == CV_8UC3 );
+
+    cv::Mat ret( image.size(), CV_8UC1 );
+
+    // BayerGB8 of the cameras: G B on even rows, R G on odd rows; COLOR_BayerGB2RGB turns it back into BGR
+    for ( int y = 0; y < image.rows; ++y ) {
+        auto source = image.ptr< cv::Vec3b >( y );
+        auto target = ret.ptr< uchar >( y );
+
+        if ( y % 2 == 0 ) {
+            for ( int x = 0; x < image.cols; ++x )
+                target[ x ] = source[ x ][ x % 2 == 0 ? 1 : 0 ];
+        }
+        else {
+            for ( int x = 0; x < image.cols; ++x )
+                target[ x ] = source[ x ][ x % 2 == 0 ? 2 : 1 ];
+        }
+
+    }
+
+    return ret;
+
+}
+
+bool SimulatedStereoCamera::loadSequence()
+{
+    // Recorded frames are streamed by readSequence(), only the files are checked here
+    m_leftSequence.clear();
+    m_rightSequence.clear();
+
+    if ( m_leftFileNames.size() != m_rightFileNames.size() ) {
+        m_errorString = tr( "Different numbers of left and right images: %1 and %2" ).arg( m_leftFileNames.size() ).arg( m_rightFileNames.size() );
+        return false;
+    }
+
+    for ( int i = 0; i < m_leftFileNames.size(); ++i ) {
+        for ( auto &fileName : { m_leftFileNames[ i ], m_rightFileNames[ i ] } ) {
+            if ( !QFileInfo( fileName ).isReadable() ) {
+                m_errorString = tr( "Can't read the image %1" ).arg( fileName );
+                return false;
+            }
+
+        }
+
+    }
+
+    // The first pair is decoded to catch files that are not images before the playback
+    if ( cv::imread( m_leftFileNames.front().toStdString(), cv::IMREAD_COLOR ).empty() || cv::imread( m_rightFileNames.front().toStdString(), cv::IMREAD_COLOR ).empty() ) {
+        m_errorString = tr( "Can't decode the image pair %1, %2" ).arg( m_leftFileNames.front(), m_rightFileNames.front() );
+        return false;
+    }
+
+    return true;
+
+}
+
+void SimulatedStereoCamera::readSequence()
+{
+    PROFILE_THREAD( "simulated camera reader" );
+
+    // Pairs failed in a row, a whole pass of them means nothing is readable now
+    int failedCount = 0;
+
+    // Only m_readAheadSize pairs are held in memory, the reader waits for the playback to free a slot
+    for ( int i = 0; !m_stopped; i = ( i + 1 ) % m_leftFileNames.size() ) {
+        SequenceFrame *slot;
+
+        if ( failedCount >= m_leftFileNames.size() ) {
+            if ( failedCount == m_leftFileNames.size() )
+                std::cout << "Simulated camera can't read any image pair, retrying" << std::endl;
+
+            // The files may come back, e.g. on a remounted drive; the sleep is cut short by stop()
+            for ( auto waited = std::chrono::milliseconds::zero(); waited < m_unreadableRetry && !m_stopped; waited += m_readAheadPoll )
+                std::this_thread::sleep_for( m_readAheadPoll );
+
+            if ( m_stopped )
+                return;
+        }
+
+        while ( !( slot = m_readAheadRing.writeSlot() ) ) {
+            if ( m_stopped )
+                return;
+
+            std::this_thread::sleep_for( m_readAheadPoll );
+        }
+
+        auto leftImage = cv::imread( m_leftFileNames[ i ].toStdString(), cv::IMREAD_COLOR );
+        auto rightImage = cv::imread( m_rightFileNames[ i ].toStdString(), cv::IMREAD_COLOR );
+
+        // A pair that became unreadable during the playback is skipped
+        if ( leftImage.empty() || rightImage.empty() ) {
+            ++failedCount;
+            continue;
+        }
+
+        failedCount = 0;
+
+        slot->leftImage = bayerMosaic( leftImage );
+        slot->rightImage = bayerMosaic( rightImage );
+
+        m_readAheadRing.commitWrite();
+
+    }
+
+}
+
+void SimulatedStereoCamera::renderSequence()
+{
+    m_leftSequence.clear();
+    m_rightSequence.clear();
+
+    for ( size_t i = 0; i < m_syntheticFramesCount; ++i ) {
+        m_leftSequence.push_back( bayerMosaic( renderFrame( i, false ) ) );
+        m_rightSequence.push_back( bayerMosaic( renderFrame( i, true ) ) );
+    }
+
+}
+
+cv::Mat SimulatedStereoCamera::renderFrame( const size_t number, const bool right ) const
+{
+    // Chessboard with 9x6 inner corners swinging at a constant depth, the right view is shifted by a constant disparity
+    const cv::Size squaresCount( 10, 7 );
+    const int squareSize = 64;
+
+    cv::Mat board( ( squaresCount.height + 2 ) * squareSize, ( squaresCount.width + 2 ) * squareSize, CV_8UC3, cv::Scalar::all( 255 ) );
+
+    for ( int i = 0; i < squaresCount.height; ++i )
+        for ( int j = 0; j < squaresCount.width; ++j )
+            if ( ( i + j ) % 2 == 0 )
+                cv::rectangle( board, cv::Rect( ( j + 1 ) * squareSize, ( i + 1 ) * squareSize, squareSize, squareSize ), cv::Scalar::all( 0 ), cv::FILLED );
+
+    auto phase = 2. * CV_PI * number / m_syntheticFramesCount;
+
+    auto scale = 0.6 * std::min( m_frameSize.width / static_cast< double >( board.cols ), m_frameSize.height / static_cast< double >( board.rows ) );
+    auto angle = 0.25 * std::sin( phase );
+
+    auto shiftX = 0.5 * m_frameSize.width + 0.15 * m_frameSize.width * std::cos( phase ) - ( right ? m_syntheticDisparity : 0 );
+    auto shiftY = 0.5 * m_frameSize.height + 0.1 * m_frameSize.height * std::sin( 2. * phase );
+
+    cv::Matx33d center( 1., 0., -0.5 * board.cols, 0., 1., -0.5 * board.rows, 0., 0., 1. );
+    cv::Matx33d tilt( 1., 0., 0., 0., 1., 0., 0.3 * std::sin( phase ) / board.cols, 0.3 * std::cos( phase ) / board.rows, 1. );
+    cv::Matx33d rotation( scale * std::cos( angle ), -scale * std::sin( angle ), 0., scale * std::sin( angle ), scale * std::cos( angle ), 0., 0., 0., 1. );
+    cv::Matx33d shift( 1., 0., shiftX, 0., 1., shiftY, 0., 0., 1. );
+
+    cv::Mat ret;
+
+    cv::warpPerspective( board, ret, cv::Mat( shift * rotation * tilt * center ), m_frameSize, cv::INTER_LINEAR, cv::BORDER_CONSTANT, cv::Scalar::all( 128 ) );
+
+    return ret;
+
+}
+
+void SimulatedStereoCamera::run()
+{
+    PROFILE_THREAD( "simulated camera" );
+
+    std::mt19937 generator( std::random_device{}() );
+    std::uniform_real_distribution< double > distribution( 0., 1. );
+
+    auto period = std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( 1. / m_fps ) );
+    auto jitter = std::min( std::chrono::duration_cast< std::chrono::steady_clock::duration >( m_jitter ), period );
+    auto skew = std::chrono::duration_cast< std::chrono::system_clock::duration >( m_skew );
+    auto dropProbability = m_dropProbability;
+
+    auto clock = m_clock ? m_clock : std::make_shared< ReplayClock >();
+
+    clock->start();
+
+    for ( size_t number = 0; !m_stopped; ++number ) {
+        auto offset = period * static_cast< int64_t >( number );
+        auto frameTime = clock->dueTime( offset );
+
+        auto leftTime = clock->stamp( offset );
+        auto rightTime = leftTime + skew;
+
+        auto leftDelay = std::chrono::duration_cast< std::chrono::steady_clock::duration >( jitter * distribution( generator ) );
+        auto rightDelay = std::chrono::duration_cast< std::chrono::steady_clock::duration >( jitter * distribution( generator ) );
+
+        auto leftDropped = distribution( generator ) < dropProbability;
+        auto rightDropped = distribution( generator ) < dropProbability;
+
+        SequenceFrame *readAhead = nullptr;
+
+        // A pair read late is delivered late, like a stalled camera link, with the scheduled time
+        if ( m_leftSequence.empty() ) {
+            while ( !( readAhead = m_readAheadRing.readSlot() ) && !m_stopped )
+                std::this_thread::sleep_for( m_readAheadPoll );
+
+            if ( !readAhead )
+                break;
+        }
+
+        auto &leftImage = readAhead ? readAhead->leftImage : m_leftSequence[ number % m_leftSequence.size() ];
+        auto &rightImage = readAhead ? readAhead->rightImage : m_rightSequence[ number % m_rightSequence.size() ];
+
+        // Cameras deliver in the order of their delays
+        if ( leftDelay <= rightDelay ) {
+            std::this_thread::sleep_until( frameTime + leftDelay );
+
+            if ( !leftDropped )
+                deliver( leftImage, leftTime, &m_leftRing, &m_leftDroppedFrames );
+
+            std::this_thread::sleep_until( frameTime + rightDelay );
+
+            if ( !rightDropped )
+                deliver( rightImage, rightTime, &m_rightRing, &m_rightDroppedFrames );
+
+        }
+        else {
+            std::this_thread::sleep_until( frameTime + rightDelay );
+
+            if ( !rightDropped )
+                deliver( rightImage, rightTime, &m_rightRing, &m_rightDroppedFrames );
+
+            std::this_thread::sleep_until( frameTime + leftDelay );
+
+            if ( !leftDropped )
+                deliver( leftImage, leftTime, &m_leftRing, &m_leftDroppedFrames );
+
+        }
+
+        // Delivered frames are copies, the slot goes back to the reader
+        if ( readAhead )
+            m_readAheadRing.commitRead();
+
+    }
+
+}
+
+void SimulatedStereoCamera::deliver( const cv::Mat &image, const std::chrono::time_point< std::chrono::system_clock > &time, SpscRing< CapturedFrame > *ring, std::atomic< uint64_t > *dropped )
+{
+    auto slot = ring->writeSlot();
+
+    if ( slot ) {
+        image.copyTo( slot->bayerImage );
+        slot->time = time;
+
+        ring->commitWrite();
+
+        emit generatedFrame();
+
+    }
+    else
+        ++*dropped;
+
+}
+
+void SimulatedStereoCamera::collectFrames()
+{
+    auto frame = m_pairer.spareFrame();
+
+    while ( auto slot = m_leftRing.readSlot() ) {
+        std::swap( frame.bayerImage, slot->bayerImage );
+        frame.time = slot->time;
+        frame.cameraTime = slot->cameraTime;
+        m_leftRing.commitRead();
+
+        m_pairer.addLeftFrame( std::move( frame ) );
+        frame = m_pairer.spareFrame();
+    }
+
+    while ( auto slot = m_rightRing.readSlot() ) {
+        std::swap( frame.bayerImage, slot->bayerImage );
+        frame.time = slot->time;
+        frame.cameraTime = slot->cameraTime;
+        m_rightRing.commitRead();
+
+        m_pairer.addRightFrame( std::move( frame ) );
+        frame = m_pairer.spareFrame();
+    }
+
+    m_pairer.recycle( std::move( frame ) );
+
+}
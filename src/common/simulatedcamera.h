@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "spscring.h"
+#include "stereocamerabase.h"
+
+class ReplayClock;
+
+// Mosaiced image pair of a recorded sequence, read ahead of the playback
+struct SequenceFrame
+{
+    cv::Mat leftImage;
+    cv::Mat rightImage;
+};
+
+// Stereo source without hardware: plays a recorded sequence or a synthetic chessboard in a loop.
+// A recorded sequence is streamed from the disk by a reader thread a few frames ahead of the playback.
+// Frames are mosaiced to BayerGB and delivered like the Vimba callback does, with arrival jitter,
+// random drops and a timestamp skew of the right camera. Parameters are applied on start().
+// With a replay clock the frames are released and stamped on it, to pair with the other sources replayed on it
+class SimulatedStereoCamera : public StereoCameraBase
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedStereoCamera( QObject *parent = nullptr );
+    ~SimulatedStereoCamera();
+
+    // Synthetic frames if the lists are empty
+    void setFileNames( const QStringList &leftFileNames, const QStringList &rightFileNames );
+    const QStringList &leftFileNames() const;
+    const QStringList &rightFileNames() const;
+
+    // Size of the synthetic frames
+    void setFrameSize( const cv::Size &value );
+    const cv::Size &frameSize() const;
+
+    void setFps( const double value );
+    double fps() const;
+
+    // Arrival delay up to this value, limited by the frame period
+    void setJitter( const std::chrono::microseconds &value );
+    const std::chrono::microseconds &jitter() const;
+
+    // Probability of losing a frame, for each camera separately
+    void setDropProbability( const double value );
+    double dropProbability() const;
+
+    void setSkew( const std::chrono::microseconds &value );
+    const std::chrono::microseconds &skew() const;
+
+    void setClock( const std::shared_ptr< ReplayClock > &value );
+    const std::shared_ptr< ReplayClock > &clock() const;
+
+    bool start();
+    void stop();
+
+    bool isRunning() const;
+
+    // Why the last start() failed
+    const QString &errorString() const;
+
+    virtual uint64_t droppedLeftFrames() const override;
+    virtual uint64_t droppedRightFrames() const override;
+
+    static cv::Mat bayerMosaic( const cv::Mat &image );
+
+signals:
+    void generatedFrame();
+
+protected:
+    QStringList m_leftFileNames;
+    QStringList m_rightFileNames;
+
+    cv::Size m_frameSize;
+    double m_fps;
+    std::chrono::microseconds m_jitter;
+    double m_dropProbability;
+    std::chrono::microseconds m_skew;
+
+    std::shared_ptr< ReplayClock > m_clock;
+
+    std::vector< cv::Mat > m_leftSequence;
+    std::vector< cv::Mat > m_rightSequence;
+
+    SpscRing< SequenceFrame > m_readAheadRing;
+
+    SpscRing< CapturedFrame > m_leftRing;
+    SpscRing< CapturedFrame > m_rightRing;
+
+    std::atomic< uint64_t > m_leftDroppedFrames;
+    std::atomic< uint64_t > m_rightDroppedFrames;
+
+    std::thread m_thread;
+    std::thread m_readerThread;
+    std::atomic< bool > m_stopped;
+
+    QString m_errorString;
+
+    static const size_t m_ringSize = 4;
+    static const size_t m_readAheadSize = 8;
+    static const std::chrono::milliseconds m_readAheadPoll;
+    static const std::chrono::milliseconds m_unreadableRetry;
+    static const size_t m_syntheticFramesCount = 30;
+    static const int m_syntheticDisparity = 48;
+
+    bool loadSequence();
+    void renderSequence();
+
+    void readSequence();
+
+    cv::Mat renderFrame( const size_t number, const bool right ) const;
+
+    void run();
+    void deliver( const cv::Mat &image, const std::chrono::time_point< std::chrono::system_clock > &time, SpscRing< CapturedFrame > *ring, std::atomic< uint64_t > *dropped );
+
+    virtual void collectFrames() override;
+
+private:
+    void initialize();
+
+};
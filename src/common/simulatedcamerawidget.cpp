@@ -0,0 +1,150 @@
+#include "precompiled.h"
+
+#include "simulatedcamerawidget.h"
+
+#include "fileslistwidget.h"
+#include "simulatedcamera.h"
+
+// SimulatedCameraWidget
+SimulatedCameraWidget::SimulatedCameraWidget( QWidget *parent )
+    : QWidget( parent )
+{
+    initialize();
+}
+
+void SimulatedCameraWidget::initialize()
+{
+    auto layout = new QVBoxLayout( this );
+
+    auto parametersLayout = new QGridLayout();
+
+    m_fpsSpinBox = new QDoubleSpinBox( this );
+    m_fpsSpinBox->setMinimum( 1. );
+    m_fpsSpinBox->setMaximum( 500. );
+    m_fpsSpinBox->setValue( 30. );
+    m_fpsSpinBox->setAlignment( Qt::AlignRight );
+
+    m_jitterSpinBox = new QDoubleSpinBox( this );
+    m_jitterSpinBox->setMinimum( 0. );
+    m_jitterSpinBox->setMaximum( 1000. );
+    m_jitterSpinBox->setValue( 2. );
+    m_jitterSpinBox->setAlignment( Qt::AlignRight );
+
+    m_dropSpinBox = new QDoubleSpinBox( this );
+    m_dropSpinBox->setMinimum( 0. );
+    m_dropSpinBox->setMaximum( 100. );
+    m_dropSpinBox->setValue( 0. );
+    m_dropSpinBox->setAlignment( Qt::AlignRight );
+
+    m_skewSpinBox = new QSpinBox( this );
+    m_skewSpinBox->setMinimum( -100000 );
+    m_skewSpinBox->setMaximum( 100000 );
+    m_skewSpinBox->setValue( 0 );
+    m_skewSpinBox->setAlignment( Qt::AlignRight );
+
+    parametersLayout->addWidget( new QLabel( tr( "Frames per second:" ), this ), 0, 0 );
+    parametersLayout->addWidget( m_fpsSpinBox, 0, 1 );
+    parametersLayout->addWidget( new QLabel( tr( "Arrival jitter, ms:" ), this ), 1, 0 );
+    parametersLayout->addWidget( m_jitterSpinBox, 1, 1 );
+    parametersLayout->addWidget( new QLabel( tr( "Dropped frames, %:" ), this ), 2, 0 );
+    parametersLayout->addWidget( m_dropSpinBox, 2, 1 );
+    parametersLayout->addWidget( new QLabel( tr( "Right camera skew, us:" ), this ), 3, 0 );
+    parametersLayout->addWidget( m_skewSpinBox, 3, 1 );
+
+    layout->addLayout( parametersLayout );
+
+    layout->addWidget( new QLabel( tr( "Recorded sequence (a synthetic chessboard if empty):" ), this ) );
+
+    m_filesListWidget = new StereoFilesListWidget( this );
+    layout->addWidget( m_filesListWidget );
+
+}
+
+QStringList SimulatedCameraWidget::leftFileNames() const
+{
+    return m_filesListWidget->leftFileNames();
+}
+
+QStringList SimulatedCameraWidget::rightFileNames() const
+{
+    return m_filesListWidget->rightFileNames();
+}
+
+double SimulatedCameraWidget::fps() const
+{
+    return m_fpsSpinBox->value();
+}
+
+std::chrono::microseconds SimulatedCameraWidget::jitter() const
+{
+    return std::chrono::microseconds( static_cast< int64_t >( m_jitterSpinBox->value() * 1000. ) );
+}
+
+double SimulatedCameraWidget::dropProbability() const
+{
+    return m_dropSpinBox->value() * 0.01;
+}
+
+std::chrono::microseconds SimulatedCameraWidget::skew() const
+{
+    return std::chrono::microseconds( m_skewSpinBox->value() );
+}
+
+SimulatedStereoCamera *SimulatedCameraWidget::createCamera( const std::shared_ptr< ReplayClock > &clock )
+{
+    m_errorString.clear();
+
+    auto ret = new SimulatedStereoCamera();
+
+    ret->setFileNames( leftFileNames(), rightFileNames() );
+    ret->setFps( fps() );
+    ret->setJitter( jitter() );
+    ret->setDropProbability( dropProbability() );
+    ret->setSkew( skew() );
+    ret->setClock( clock );
+
+    if ( !ret->start() ) {
+        m_errorString = ret->errorString();
+        delete ret;
+        return nullptr;
+    }
+
+    return ret;
+
+}
+
+const QString &SimulatedCameraWidget::errorString() const
+{
+    return m_errorString;
+}
+
+// SimulatedCameraDialog
+SimulatedCameraDialog::SimulatedCameraDialog( QWidget *parent )
+    : DialogBase( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, parent )
+{
+    initialize();
+}
+
+void SimulatedCameraDialog::initialize()
+{
+    setWindowTitle( tr( "Simulated camera" ) );
+
+    setWidget( new SimulatedCameraWidget( this ) );
+
+    connect( m_buttons, &QDialogButtonBox::accepted, this, &DialogBase::accept );
+}
+
+SimulatedCameraWidget *SimulatedCameraDialog::widget() const
+{
+    return dynamic_cast< SimulatedCameraWidget * >( m_widget.data() );
+}
+
+SimulatedStereoCamera *SimulatedCameraDialog::createCamera( const std::shared_ptr< ReplayClock > &clock )
+{
+    return widget()->createCamera( clock );
+}
+
+QString SimulatedCameraDialog::errorString() const
+{
+    return widget()->errorString();
+}
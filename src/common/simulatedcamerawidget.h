@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QWidget>
+
+#include "supportwidgets.h"
+
+#include <memory>
+
+class QDoubleSpinBox;
+class QSpinBox;
+class StereoFilesListWidget;
+class SimulatedStereoCamera;
+class ReplayClock;
+
+class SimulatedCameraWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedCameraWidget( QWidget *parent = nullptr );
+
+    QStringList leftFileNames() const;
+    QStringList rightFileNames() const;
+
+    double fps() const;
+    std::chrono::microseconds jitter() const;
+    double dropProbability() const;
+    std::chrono::microseconds skew() const;
+
+    // Started camera with the chosen parameters, nullptr and the reason in errorString() if it can't start.
+    // The clock is shared with the sources replayed along, e.g. an IMU log
+    SimulatedStereoCamera *createCamera( const std::shared_ptr< ReplayClock > &clock = nullptr );
+
+    const QString &errorString() const;
+
+protected:
+    QPointer< QDoubleSpinBox > m_fpsSpinBox;
+    QPointer< QDoubleSpinBox > m_jitterSpinBox;
+    QPointer< QDoubleSpinBox > m_dropSpinBox;
+    QPointer< QSpinBox > m_skewSpinBox;
+
+    QPointer< StereoFilesListWidget > m_filesListWidget;
+
+    QString m_errorString;
+
+private:
+    void initialize();
+
+};
+
+class SimulatedCameraDialog : public DialogBase
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedCameraDialog( QWidget *parent = nullptr );
+
+    SimulatedCameraWidget *widget() const;
+
+    SimulatedStereoCamera *createCamera( const std::shared_ptr< ReplayClock > &clock = nullptr );
+
+    QString errorString() const;
+
+private:
+    void initialize();
+
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+// Lock-free ring of preallocated slots for one producer and one consumer thread.
+// Slots are filled and read in place, so buffers inside them are reused without allocation
+template < typename T >
+class SpscRing
+{
+public:
+    SpscRing();
+    SpscRing( const size_t capacity );
+
+    // Producer side: the slot to fill or nullptr if the ring is full, then commitWrite() publishes it
+    T *writeSlot();
+    void commitWrite();
+
+    // Consumer side: the oldest slot or nullptr if the ring is empty, then commitRead() releases it
+    T *readSlot();
+    void commitRead();
+
+    size_t size() const;
+    bool empty() const;
+
+    size_t capacity() const;
+
+protected:
+    std::vector< T > m_slots;
+
+    // Separate cache lines, the producer writes the head and the consumer writes the tail
+    alignas( 64 ) std::atomic< size_t > m_head;
+    alignas( 64 ) std::atomic< size_t > m_tail;
+
+    static const size_t m_defaultCapacity = 4;
+
+private:
+    void initialize( const size_t capacity );
+
+};
+
+#include "spscring.inl"
@@ -0,0 +1,73 @@
+// SpscRing
+template < typename T >
+SpscRing< T >::SpscRing()
+{
+    initialize( m_defaultCapacity );
+}
+
+template < typename T >
+SpscRing< T >::SpscRing( const size_t capacity )
+{
+    initialize( capacity );
+}
+
+template < typename T >
+void SpscRing< T >::initialize( const size_t capacity )
+{
+    m_slots.resize( std::max< size_t >( capacity, 1 ) );
+
+    m_head = 0;
+    m_tail = 0;
+}
+
+template < typename T >
+T *SpscRing< T >::writeSlot()
+{
+    auto head = m_head.load( std::memory_order_relaxed );
+
+    if ( head - m_tail.load( std::memory_order_acquire ) >= m_slots.size() )
+        return nullptr;
+
+    return &m_slots[ head % m_slots.size() ];
+}
+
+template < typename T >
+void SpscRing< T >::commitWrite()
+{
+    m_head.store( m_head.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+}
+
+template < typename T >
+T *SpscRing< T >::readSlot()
+{
+    auto tail = m_tail.load( std::memory_order_relaxed );
+
+    if ( tail == m_head.load( std::memory_order_acquire ) )
+        return nullptr;
+
+    return &m_slots[ tail % m_slots.size() ];
+}
+
+template < typename T >
+void SpscRing< T >::commitRead()
+{
+    m_tail.store( m_tail.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+}
+
+template < typename T >
+size_t SpscRing< T >::size() const
+{
+    return m_head.load( std::memory_order_acquire ) - m_tail.load( std::memory_order_acquire );
+}
+
+template < typename T >
+bool SpscRing< T >::empty() const
+{
+    return size() == 0;
+}
+
+template < typename T >
+size_t SpscRing< T >::capacity() const
+{
+    return m_slots.size();
+}
@@ -0,0 +1,107 @@
+#include "precompiled.h"
+
+#include "stereocamerabase.h"
+
+// StereoCameraBase
+StereoCameraBase::StereoCameraBase( QObject *parent )
+    : QObject( parent )
+{
+    initialize();
+}
+
+void StereoCameraBase::initialize()
+{
+    m_pairUpdated = false;
+
+    m_frameDecimation = VimbaDecimationType::WHOLE;
+    m_frameGray = false;
+}
+
+void StereoCameraBase::updateFrame()
+{
+    bool paired = false;
+
+    m_framesMutex.lock();
+
+    // Only raw frames are paired here, the demosaic is left to getFrame()
+    collectFrames();
+
+    if ( m_pairer.takePair( &m_pairedLeftFrame, &m_pairedRightFrame ) ) {
+        m_pairUpdated = true;
+        paired = true;
+    }
+
+    m_framesMutex.unlock();
+
+    if ( paired )
+        emit receivedFrame();
+
+}
+
+StampedStereoImage StereoCameraBase::getFrame( const VimbaDecimationType decimation, const bool gray )
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    // The paired raw frames are kept until the next pair, so they can be demosaiced again with other parameters
+    auto parametersChanged = !m_stereoFrame.empty() && ( decimation != m_frameDecimation || gray != m_frameGray );
+
+    if ( m_pairUpdated || parametersChanged ) {
+        StampedImage leftFrame( m_pairedLeftFrame.time );
+        StampedImage rightFrame( m_pairedRightFrame.time );
+
+        demosaic( m_pairedLeftFrame.bayerImage, &leftFrame, decimation, gray );
+        demosaic( m_pairedRightFrame.bayerImage, &rightFrame, decimation, gray );
+
+        m_stereoFrame = StampedStereoImage( leftFrame, rightFrame );
+
+        m_frameDecimation = decimation;
+        m_frameGray = gray;
+
+        m_pairUpdated = false;
+    }
+
+    return m_stereoFrame;
+
+}
+
+bool StereoCameraBase::empty() const
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    return m_stereoFrame.empty() && !m_pairUpdated;
+}
+
+void StereoCameraBase::setPairingWindow( const std::chrono::microseconds &value )
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    m_pairer.setWindow( value );
+}
+
+std::chrono::microseconds StereoCameraBase::pairingWindow() const
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    return m_pairer.window();
+}
+
+uint64_t StereoCameraBase::pairedFrames() const
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    return m_pairer.pairedFrames();
+}
+
+uint64_t StereoCameraBase::droppedLeftFrames() const
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    return m_pairer.droppedLeftFrames();
+}
+
+uint64_t StereoCameraBase::droppedRightFrames() const
+{
+    QMutexLocker lock( &m_framesMutex );
+
+    return m_pairer.droppedRightFrames();
+}
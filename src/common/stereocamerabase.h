@@ -0,0 +1,56 @@
+#pragma once
+
+#include <QObject>
+
+#include <QMutex>
+
+#include "demosaic.h"
+#include "framepairer.h"
+#include "image.h"
+
+// Common part of the live stereo sources: raw frames of both cameras are paired by time
+// and the latest pair is demosaiced when it is requested
+class StereoCameraBase : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StereoCameraBase( QObject *parent = nullptr );
+
+    // Decimated or gray pairs are binned from the raw frames, the last pair is reused while neither the frames nor the parameters change
+    StampedStereoImage getFrame( const VimbaDecimationType decimation = VimbaDecimationType::WHOLE, const bool gray = false );
+
+    bool empty() const;
+
+    void setPairingWindow( const std::chrono::microseconds &value );
+    std::chrono::microseconds pairingWindow() const;
+
+    uint64_t pairedFrames() const;
+    virtual uint64_t droppedLeftFrames() const;
+    virtual uint64_t droppedRightFrames() const;
+
+signals:
+    void receivedFrame();
+
+protected slots:
+    void updateFrame();
+
+protected:
+    StereoFramePairer m_pairer;
+
+    CapturedFrame m_pairedLeftFrame;
+    CapturedFrame m_pairedRightFrame;
+    bool m_pairUpdated;
+
+    StampedStereoImage m_stereoFrame;
+    VimbaDecimationType m_frameDecimation;
+    bool m_frameGray;
+    mutable QMutex m_framesMutex;
+
+    // Moves the frames delivered since the previous call into the pairer, called with m_framesMutex locked
+    virtual void collectFrames() = 0;
+
+private:
+    void initialize();
+
+};
@@ -3,6 +3,7 @@
 #include "stereoprocessor.h"
 
 #include "src/common/functions.h"
+#include "src/common/profiler.h"
 
 const float MISSING_Z = 10000.;
 
@@ -631,6 +632,8 @@ cv::Mat StereoProcessorBase::processDisparity( const CvImage &left, const CvImag
     if ( !m_disparityProcessor )
         return cv::Mat();
 
+    PROFILE_SCOPE( "disparity" );
+
     return m_disparityProcessor->processDisparity( left, right );
 }
 
@@ -690,6 +693,8 @@ std::list< ColorPoint3d > StereoProcessor::processPointList( const CvImage &left
 
 cv::Mat StereoProcessor::reprojectPoints( const cv::Mat &disparity )
 {
+    PROFILE_SCOPE( "reprojection" );
+
     cv::Mat points;
 
     cv::reprojectImageTo3D( disparity, points, m_disparityToDepthMatrix );
@@ -0,0 +1,137 @@
+#include "precompiled.h"
+
+#include "stereorecorder.h"
+
+#include "profiler.h"
+
+// StereoRecorder
+const std::chrono::milliseconds StereoRecorder::m_writePoll( 1 );
+
+StereoRecorder::StereoRecorder()
+    : m_framesRing( m_ringSize )
+{
+    initialize();
+}
+
+StereoRecorder::~StereoRecorder()
+{
+    stop();
+}
+
+void StereoRecorder::initialize()
+{
+    m_stopped = true;
+
+    m_recordedFrames = 0;
+    m_droppedFrames = 0;
+}
+
+bool StereoRecorder::start( const std::string &folder )
+{
+    stop();
+
+    QDir dir( QString::fromStdString( folder ) );
+
+    if ( !dir.mkpath( "left" ) || !dir.mkpath( "right" ) )
+        return false;
+
+    m_leftFolder = dir.filePath( "left" ).toStdString();
+    m_rightFolder = dir.filePath( "right" ).toStdString();
+
+    m_recordedFrames = 0;
+    m_droppedFrames = 0;
+
+    m_stopped = false;
+
+    m_writerThread = std::thread( &StereoRecorder::writeFrames, this );
+
+    return true;
+}
+
+void StereoRecorder::stop()
+{
+    m_stopped = true;
+
+    // The writer drains the ring before it exits
+    if ( m_writerThread.joinable() )
+        m_writerThread.join();
+}
+
+bool StereoRecorder::isRecording() const
+{
+    return !m_stopped;
+}
+
+bool StereoRecorder::addFrame( const StampedStereoImage &frame )
+{
+    if ( m_stopped || frame.empty() )
+        return false;
+
+    auto slot = m_framesRing.writeSlot();
+
+    if ( !slot ) {
+        ++m_droppedFrames;
+        return false;
+    }
+
+    // Images are shared, the camera delivers a new buffer for every frame
+    *slot = frame;
+
+    m_framesRing.commitWrite();
+
+    return true;
+}
+
+uint64_t StereoRecorder::recordedFrames() const
+{
+    return m_recordedFrames;
+}
+
+uint64_t StereoRecorder::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+void StereoRecorder::writeFrames()
+{
+    PROFILE_THREAD( "stereo recorder" );
+
+    const std::vector< int > parameters = { cv::IMWRITE_PNG_COMPRESSION, m_pngCompression };
+
+    auto fileName = []( const std::string &folder, const StampedImage &image ) {
+        auto time = std::chrono::duration_cast< std::chrono::microseconds >( image.time().time_since_epoch() ).count();
+
+        return folder + "/" + std::to_string( time ) + ".png";
+    };
+
+    while ( true ) {
+
+        auto slot = m_framesRing.readSlot();
+
+        if ( !slot ) {
+
+            if ( m_stopped )
+                return;
+
+            std::this_thread::sleep_for( m_writePoll );
+
+            continue;
+
+        }
+
+        {
+            PROFILE_SCOPE( "stereo recording" );
+
+            cv::imwrite( fileName( m_leftFolder, slot->leftImage() ), slot->leftImage(), parameters );
+            cv::imwrite( fileName( m_rightFolder, slot->rightImage() ), slot->rightImage(), parameters );
+        }
+
+        *slot = StampedStereoImage();
+
+        m_framesRing.commitRead();
+
+        ++m_recordedFrames;
+
+    }
+
+}
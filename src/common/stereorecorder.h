@@ -0,0 +1,52 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "image.h"
+#include "spscring.h"
+
+// Writes stereo pairs to left/ and right/ subfolders from a writer thread. Images are named by the
+// frame time in system clock microseconds, the time base of the IMU log recorded beside them, and
+// are lossless so a simulated camera can replay them
+class StereoRecorder
+{
+public:
+    StereoRecorder();
+    ~StereoRecorder();
+
+    bool start( const std::string &folder );
+    void stop();
+
+    bool isRecording() const;
+
+    // From one producer thread; false if the writer is behind and the pair is dropped
+    bool addFrame( const StampedStereoImage &frame );
+
+    uint64_t recordedFrames() const;
+    uint64_t droppedFrames() const;
+
+protected:
+    SpscRing< StampedStereoImage > m_framesRing;
+
+    std::thread m_writerThread;
+    std::atomic< bool > m_stopped;
+
+    std::atomic< uint64_t > m_recordedFrames;
+    std::atomic< uint64_t > m_droppedFrames;
+
+    std::string m_leftFolder;
+    std::string m_rightFolder;
+
+    static const size_t m_ringSize = 8;
+    static const int m_pngCompression = 1;
+    static const std::chrono::milliseconds m_writePoll;
+
+    void writeFrames();
+
+private:
+    void initialize();
+
+};
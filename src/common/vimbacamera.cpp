@@ -3,6 +3,7 @@
 #include "vimbacamera.h"
 
 #include "functions.h"
+#include "profiler.h"
 
 #include <unistd.h>
 
@@ -11,7 +12,7 @@ int FrameObserver::m_currentNumber = 0;
 const std::chrono::time_point< std::chrono::system_clock > FrameObserver::m_startTime = std::chrono::system_clock::now();
 
 FrameObserver::FrameObserver( AVT::VmbAPI::CameraPtr pCamera )
-    : AVT::VmbAPI::IFrameObserver( pCamera )
+    : AVT::VmbAPI::IFrameObserver( pCamera ), m_framesRing( m_ringSize )
 {
     inititalize();
 }
@@ -19,6 +20,26 @@ FrameObserver::FrameObserver( AVT::VmbAPI::CameraPtr pCamera )
 void FrameObserver::inititalize()
 {
     m_number = m_currentNumber++;
+
+    m_droppedFrames = 0;
+
+    m_sharedClock = false;
+
+    m_lastDecimation = VimbaDecimationType::WHOLE;
+    m_lastGray = false;
+
+    m_timestampOffset = 0;
+    m_timestampOffsetValid = false;
+
+    // Without the tick frequency frames are stamped at arrival
+    m_timestampFrequency = 0.;
+
+    try {
+        m_timestampFrequency = getVimbaFeature< VmbInt64_t >( m_pCamera, "GevTimestampTickFrequency" );
+    }
+    catch ( const std::exception & ) {
+    }
+
 }
 
 int64_t FrameObserver::timeFromStart()
@@ -45,12 +66,20 @@ void FrameObserver::FrameReceived( const AVT::VmbAPI::FramePtr pFrame )
             checkVimbaStatus( pFrame->GetHeight( nHeight ), "FAILED to aquire height of frame!" );
             checkVimbaStatus( pFrame->GetImage( pImage ), "FAILED to acquire image data of frame!" );
 
-            m_framesMutex.lock();
-            m_sourceMat = cv::Mat( nHeight, nWidth, CV_8UC1, pImage );
-            m_sourceTime = time;
-            m_framesMutex.unlock();
+            // The Vimba buffer is requeued below, so the frame is copied into a preallocated slot first
+            auto slot = m_framesRing.writeSlot();
+
+            if ( slot ) {
+                cv::Mat( nHeight, nWidth, CV_8UC1, pImage ).copyTo( slot->bayerImage );
+                stampFrame( pFrame, time, slot );
 
-            emit receivedFrame();
+                m_framesRing.commitWrite();
+
+                emit receivedFrame();
+
+            }
+            else
+                ++m_droppedFrames;
 
         }
 
@@ -60,65 +89,132 @@ void FrameObserver::FrameReceived( const AVT::VmbAPI::FramePtr pFrame )
 
 }
 
-StampedImage FrameObserver::getFrame()
+StampedImage FrameObserver::getFrame( const VimbaDecimationType decimation, const bool gray )
 {
-    StampedImage res;
+    QMutexLocker lock( &m_consumerMutex );
+
+    auto updated = takeFrameUnsafe( &m_capturedFrame );
 
-    m_framesMutex.lock();
+    if ( updated || decimation != m_lastDecimation || gray != m_lastGray ) {
+        StampedImage res( m_capturedFrame.time );
+        demosaic( m_capturedFrame.bayerImage, &res, decimation, gray );
 
-    if ( !m_sourceMat.empty() ) {
-        res.setTime( m_sourceTime );
-        cv::cvtColor( m_sourceMat, res, cv::COLOR_BayerGB2RGB );
+        m_lastImage = res;
+        m_lastDecimation = decimation;
+        m_lastGray = gray;
     }
 
-    m_framesMutex.unlock();
+    return m_lastImage;
 
-    return res;
+}
 
+bool FrameObserver::takeFrame( CapturedFrame *frame )
+{
+    QMutexLocker lock( &m_consumerMutex );
+
+    return takeFrameUnsafe( frame );
 }
 
-void FrameObserver::lockMutex()
+bool FrameObserver::popFrame( CapturedFrame *frame )
 {
-    m_framesMutex.lock();
+    QMutexLocker lock( &m_consumerMutex );
+
+    auto slot = m_framesRing.readSlot();
+
+    if ( !slot )
+        return false;
+
+    std::swap( frame->bayerImage, slot->bayerImage );
+    frame->time = slot->time;
+    frame->cameraTime = slot->cameraTime;
+
+    m_framesRing.commitRead();
+
+    return true;
+
 }
 
-void FrameObserver::unlockMutex()
+bool FrameObserver::takeFrameUnsafe( CapturedFrame *frame )
 {
-    m_framesMutex.unlock();
+    bool ret = false;
+
+    while ( auto slot = m_framesRing.readSlot() ) {
+        std::swap( frame->bayerImage, slot->bayerImage );
+        frame->time = slot->time;
+        frame->cameraTime = slot->cameraTime;
+
+        m_framesRing.commitRead();
+
+        ret = true;
+    }
+
+    if ( ret )
+        PROFILE_COUNTER( "capture latency", std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::system_clock::now() - frame->time ).count() * 1.e-3 );
+
+    return ret;
+
 }
 
-StampedImage FrameObserver::getFrameUnsafe() const
+void FrameObserver::stampFrame( const AVT::VmbAPI::FramePtr pFrame, const std::chrono::time_point< std::chrono::system_clock > &arrivalTime, CapturedFrame *frame )
 {
-    StampedImage res;
+    VmbUint64_t timestamp;
 
-    if ( !m_sourceMat.empty() ) {
-        res.setTime( m_sourceTime );
-        cv::cvtColor( m_sourceMat, res, cv::COLOR_BayerGB2RGB );
+    if ( m_timestampFrequency <= 0. || pFrame->GetTimestamp( timestamp ) != VmbErrorSuccess ) {
+        frame->time = arrivalTime;
+        frame->cameraTime = -1;
+        return;
     }
 
-    return res;
+    auto cameraTime = static_cast< int64_t >( timestamp / m_timestampFrequency * 1.e9 );
+    auto offset = std::chrono::duration_cast< std::chrono::nanoseconds >( arrivalTime.time_since_epoch() ).count() - cameraTime;
+
+    // The smallest delay is the closest to the bare transfer time, it may grow slowly to follow the clock drift.
+    // A jump of more than a second means the camera clock was reset
+    if ( !m_timestampOffsetValid || std::abs( offset - m_timestampOffset ) > 1000000000 )
+        m_timestampOffset = offset;
+    else
+        m_timestampOffset = std::min( offset, m_timestampOffset + m_timestampOffsetDrift );
+
+    m_timestampOffsetValid = true;
+
+    frame->time = std::chrono::time_point< std::chrono::system_clock >( std::chrono::duration_cast< std::chrono::system_clock::duration >( std::chrono::nanoseconds( cameraTime + m_timestampOffset ) ) );
+    frame->cameraTime = m_sharedClock ? cameraTime : -1;
 
 }
 
-std::chrono::time_point< std::chrono::system_clock > FrameObserver::getTimeUnsafe() const
+uint64_t FrameObserver::droppedFrames() const
 {
-    return m_sourceTime;
+    return m_droppedFrames;
+}
+
+void FrameObserver::setSharedClock( const bool value )
+{
+    m_sharedClock = value;
 }
 
 // CameraBase
+const std::chrono::milliseconds CameraBase::m_ptpPollInterval( 100 );
+const std::chrono::milliseconds CameraBase::m_ptpTimeout( 10000 );
+
 CameraBase::CameraBase( QObject *parent )
     : QObject( parent )
 {
     initialize();
 }
 
+CameraBase::~CameraBase()
+{
+    stopPtp();
+}
+
 void CameraBase::initialize()
 {
+    m_ptpStopped = true;
 }
 
-StampedImage CameraBase::getFrame()
+StampedImage CameraBase::getFrame( const VimbaDecimationType decimation, const bool gray )
 {
-    return m_frameObserver->getFrame();
+    return m_frameObserver->getFrame( decimation, gray );
 }
 
 void CameraBase::setMaxValue( const char* const name )
@@ -137,24 +233,72 @@ void CameraBase::setMaxValue( const char* const name )
 
 }
 
-void CameraBase::lockMutex()
+bool CameraBase::enablePtp( const char *const mode )
 {
-    m_frameObserver->lockMutex();
+    stopPtp();
+
+    m_frameObserver->setSharedClock( false );
+
+    try {
+        setVimbaFeature( m_camera, "PtpMode", mode );
+    }
+    catch ( const std::exception & ) {
+        return false;
+    }
+
+    m_ptpStopped = false;
+
+    // The master election and the clock adjustment take seconds, the
+    // cameras are opened without waiting for them
+    m_ptpThread = std::thread( [ this, status = std::string( mode ) ]() {
+        auto finishTime = std::chrono::steady_clock::now() + m_ptpTimeout;
+
+        while ( !m_ptpStopped && std::chrono::steady_clock::now() < finishTime ) {
+
+            try {
+                if ( getVimbaFeature< std::string >( m_camera, "PtpStatus" ) == status ) {
+                    m_frameObserver->setSharedClock( true );
+                    return;
+                }
+            }
+            catch ( const std::exception & ) {
+                return;
+            }
+
+            std::this_thread::sleep_for( m_ptpPollInterval );
+
+        }
+
+        if ( !m_ptpStopped )
+            std::cout << "PTP " << status << " is not synchronized in " << m_ptpTimeout.count() << " ms, frames keep the system time" << std::endl;
+
+    } );
+
+    return true;
+
 }
 
-void CameraBase::unlockMutex()
+void CameraBase::stopPtp()
 {
-    m_frameObserver->unlockMutex();
+    m_ptpStopped = true;
+
+    if ( m_ptpThread.joinable() )
+        m_ptpThread.join();
 }
 
-StampedImage CameraBase::getFrameUnsafe() const
+bool CameraBase::takeFrame( CapturedFrame *frame )
 {
-    return m_frameObserver->getFrameUnsafe();
+    return m_frameObserver->takeFrame( frame );
 }
 
-std::chrono::time_point< std::chrono::system_clock > CameraBase::getTimeUnsafe() const
+bool CameraBase::popFrame( CapturedFrame *frame )
 {
-    return m_frameObserver->getTimeUnsafe();
+    return m_frameObserver->popFrame( frame );
+}
+
+uint64_t CameraBase::droppedFrames() const
+{
+    return m_frameObserver->droppedFrames();
 }
 
 // MasterCamera
@@ -166,6 +310,8 @@ MasterCamera::MasterCamera( const std::string &ip, QObject *parent )
 
 MasterCamera::~MasterCamera()
 {
+    stopPtp();
+
     m_camera->StopContinuousImageAcquisition();
 
     m_camera->Close();
@@ -187,6 +333,8 @@ void MasterCamera::initialize( const std::string &ip )
 
     SP_SET( m_frameObserver, new FrameObserver( m_camera ) );
 
+    enablePtp( "Master" );
+
     connect( m_frameObserver.get(), &FrameObserver::receivedFrame, this, &MasterCamera::receivedFrame );
 
     checkVimbaStatus( SP_ACCESS( m_camera )->StartContinuousImageAcquisition( m_numFrames,  m_frameObserver ), "Can't start image acquisition" );
@@ -202,6 +350,8 @@ SlaveCamera::SlaveCamera( const std::string &ip, QObject *parent )
 
 SlaveCamera::~SlaveCamera()
 {
+    stopPtp();
+
     setVimbaFeature( m_camera, "TriggerMode", "Off" );
 
     m_camera->StopContinuousImageAcquisition();
@@ -227,6 +377,8 @@ void SlaveCamera::initialize( const std::string &ip )
 
     SP_SET( m_frameObserver, new FrameObserver( m_camera ) );
 
+    enablePtp( "Slave" );
+
     connect( m_frameObserver.get(), &FrameObserver::receivedFrame, this, &SlaveCamera::receivedFrame );
 
     checkVimbaStatus( SP_ACCESS( m_camera )->StartContinuousImageAcquisition( m_numFrames,  m_frameObserver ), "Can't start image acquisition" );
@@ -235,7 +387,7 @@ void SlaveCamera::initialize( const std::string &ip )
 
 // StereoCamera
 StereoCamera::StereoCamera( const std::string &leftIp, const std::string &rightIp, QObject *parent )
-    : QObject( parent ), m_leftCamera( leftIp, parent ), m_rightCamera( rightIp, parent )
+    : StereoCameraBase( parent ), m_leftCamera( leftIp, parent ), m_rightCamera( rightIp, parent )
 {
     initialize();
 }
@@ -246,53 +398,32 @@ void StereoCamera::initialize()
     connect( &m_rightCamera, &SlaveCamera::receivedFrame, this, &StereoCamera::updateFrame );
 }
 
-void StereoCamera::updateFrame()
-{    
-    StampedImage leftFrame;
-    StampedImage rightFrame;
-
-    m_leftCamera.lockMutex();
-    m_rightCamera.lockMutex();
+void StereoCamera::collectFrames()
+{
+    auto frame = m_pairer.spareFrame();
 
-    if ( std::abs( std::chrono::duration_cast< std::chrono::microseconds >( m_leftCamera.getTimeUnsafe() - m_rightCamera.getTimeUnsafe() ).count() ) < 500 ) {
-        leftFrame = m_leftCamera.getFrameUnsafe();
-        rightFrame = m_rightCamera.getFrameUnsafe();
+    while ( m_leftCamera.popFrame( &frame ) ) {
+        m_pairer.addLeftFrame( std::move( frame ) );
+        frame = m_pairer.spareFrame();
     }
 
-    m_leftCamera.unlockMutex();
-    m_rightCamera.unlockMutex();
-
-    if ( !leftFrame.empty() && !rightFrame.empty() ) {
-
-        m_framesMutex.lock();
-        m_framesQueue.push( StampedStereoImage( leftFrame, rightFrame ) );
-        m_framesMutex.unlock();
-
-        emit receivedFrame();
-
+    while ( m_rightCamera.popFrame( &frame ) ) {
+        m_pairer.addRightFrame( std::move( frame ) );
+        frame = m_pairer.spareFrame();
     }
 
+    m_pairer.recycle( std::move( frame ) );
+
 }
 
-StampedStereoImage StereoCamera::getFrame()
+uint64_t StereoCamera::droppedLeftFrames() const
 {
-    StampedStereoImage res;
-
-    m_framesMutex.lock();
-
-    if( !m_framesQueue.empty() ) {
-        res = m_framesQueue.back();
-    }
-
-    m_framesMutex.unlock();
-
-    return res;
-
+    return StereoCameraBase::droppedLeftFrames() + m_leftCamera.droppedFrames();
 }
 
-bool StereoCamera::empty() const
+uint64_t StereoCamera::droppedRightFrames() const
 {
-    return m_framesQueue.empty();
+    return StereoCameraBase::droppedRightFrames() + m_rightCamera.droppedFrames();
 }
 
 void checkVimbaStatus( VmbErrorType status, std::string message )
@@ -4,7 +4,13 @@
 
 #include <QMutex>
 
-#include "limitedqueue.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "demosaic.h"
+#include "spscring.h"
+#include "stereocamerabase.h"
 
 #include <VimbaCPP/Include/VimbaCPP.h>
 
@@ -13,8 +19,6 @@
 
 static const int VIMBA_ORIGINAL_FRAME_SIZE = 2048;
 
-enum class VimbaDecimationType { WHOLE = 1, HALF = 2, QUARTER = 4, EIGHTH = 8 };
-
 static const VmbInt64_t ACTION_DEVICE_KEY = 1;
 static const VmbInt64_t ACTION_GROUP_KEY = 1;
 static const VmbInt64_t ACTION_GROUP_MASK = 1;
@@ -30,28 +34,58 @@ public :
 
     virtual void FrameReceived( const AVT::VmbAPI::FramePtr pFrame ) override;
 
-    StampedImage getFrame();
+    // Demosaics the newest frame in the calling thread, older ones are skipped.
+    // The last image is reused until a new frame comes or another size or format is requested
+    StampedImage getFrame( const VimbaDecimationType decimation = VimbaDecimationType::WHOLE, const bool gray = false );
+
+    // Swaps the newest frame into the given one, so its buffer goes back to the ring; false if there is no new frame
+    bool takeFrame( CapturedFrame *frame );
+
+    // Swaps the oldest frame into the given one, for consumers that need every frame in order
+    bool popFrame( CapturedFrame *frame );
+
+    uint64_t droppedFrames() const;
+
+    // The camera clock is PTP synchronized with the other camera, so the raw timestamps are comparable
+    void setSharedClock( const bool value );
 
 signals:
     void receivedFrame();
 
 protected:
-    QMutex m_framesMutex;
     int m_number;
 
-    cv::Mat m_sourceMat;
-    std::chrono::time_point< std::chrono::system_clock > m_sourceTime;
+    std::atomic< bool > m_sharedClock;
+
+    // Camera clock to system clock: ticks per second and the smallest delivery delay seen so far
+    double m_timestampFrequency;
+    int64_t m_timestampOffset;
+    bool m_timestampOffsetValid;
+
+    static const int64_t m_timestampOffsetDrift = 1000;
+
+    // Written only by the Vimba callback, read only by consumers
+    SpscRing< CapturedFrame > m_framesRing;
+    std::atomic< uint64_t > m_droppedFrames;
+
+    // Serializes consumers, the Vimba callback never takes it
+    QMutex m_consumerMutex;
+    CapturedFrame m_capturedFrame;
+    StampedImage m_lastImage;
+    VimbaDecimationType m_lastDecimation;
+    bool m_lastGray;
+
+    static const size_t m_ringSize = 4;
 
     static int m_currentNumber;
     static const std::chrono::time_point< std::chrono::system_clock > m_startTime;
 
     static int64_t timeFromStart();
 
-    void lockMutex();
-    void unlockMutex();
+    bool takeFrameUnsafe( CapturedFrame *frame );
 
-    StampedImage getFrameUnsafe() const;
-    std::chrono::time_point< std::chrono::system_clock > getTimeUnsafe() const;
+    // Stamps the frame with the raw camera time and the system time it maps to
+    void stampFrame( const AVT::VmbAPI::FramePtr pFrame, const std::chrono::time_point< std::chrono::system_clock > &arrivalTime, CapturedFrame *frame );
 
 private:
     void inititalize();
@@ -66,8 +100,9 @@ class CameraBase : public QObject
 
 public:
     CameraBase( QObject *parent = nullptr );
+    ~CameraBase();
 
-    StampedImage getFrame();
+    StampedImage getFrame( const VimbaDecimationType decimation = VimbaDecimationType::WHOLE, const bool gray = false );
 
 signals:
     void receivedFrame();
@@ -78,14 +113,24 @@ protected:
 
     static const int m_numFrames = 3;
 
+    // Polls the PTP status until the camera is synchronized, frames keep the system time until then
+    std::thread m_ptpThread;
+    std::atomic< bool > m_ptpStopped;
+
+    static const std::chrono::milliseconds m_ptpPollInterval;
+    static const std::chrono::milliseconds m_ptpTimeout;
+
     void setMaxValue(const char * const name );
 
-    void lockMutex();
-    void unlockMutex();
+    // Starts PTP in the given mode, false if the camera doesn't support it. Camera
+    // time is shared once PtpStatus reports the mode, never if the timeout passes first
+    bool enablePtp( const char *const mode );
+    void stopPtp();
 
-    StampedImage getFrameUnsafe() const;
+    bool takeFrame( CapturedFrame *frame );
+    bool popFrame( CapturedFrame *frame );
 
-    std::chrono::time_point< std::chrono::system_clock > getTimeUnsafe() const;
+    uint64_t droppedFrames() const;
 
 private:
     void initialize();
@@ -119,31 +164,21 @@ private:
 
 };
 
-class StereoCamera : public QObject
+class StereoCamera : public StereoCameraBase
 {
     Q_OBJECT
 
 public:
     StereoCamera( const std::string &leftIp, const std::string &rightIp, QObject *parent = nullptr );
 
-    StampedStereoImage getFrame();
-
-    bool empty() const;
-
-signals:
-    void receivedFrame();
-
-public slots:
-
-protected slots:
-    void updateFrame();
+    virtual uint64_t droppedLeftFrames() const override;
+    virtual uint64_t droppedRightFrames() const override;
 
 protected:
     MasterCamera m_leftCamera;
     SlaveCamera m_rightCamera;
 
-    LimitedQueue< StampedStereoImage > m_framesQueue;
-    QMutex m_framesMutex;
+    virtual void collectFrames() override;
 
 private:
     void initialize();
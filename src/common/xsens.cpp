@@ -27,6 +27,13 @@ XsensData::XsensData( const std::chrono::time_point< std::chrono::high_resolutio
     setValues( packet );
 }
 
+XsensData::XsensData( const std::chrono::time_point< std::chrono::high_resolution_clock > &time, const double xsensTime,
+                      const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro, const Eigen::Vector3d &magnitometer )
+    : _xsensTime( xsensTime ), _acceleration( acceleration ), _gyro( gyro ), _magnitometer( magnitometer ), _valid( true )
+{
+    setUtcTime( time );
+}
+
 void XsensData::setValues( const XsDataPacket &packet )
 {
     _valid = false;
@@ -135,6 +142,20 @@ std::vector< XsensData > XsensCallback::all( const std::chrono::milliseconds &ti
     return ret;
 }
 
+bool XsensCallback::setRecordFile( const std::string &fileName )
+{
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    return _logWriter.open( fileName );
+}
+
+void XsensCallback::closeRecordFile()
+{
+    std::lock_guard< std::mutex > lock( _mutex );
+
+    _logWriter.close();
+}
+
 void XsensCallback::onLiveDataAvailable( XsDevice *, const XsDataPacket *packet )
 {
     auto now = std::chrono::high_resolution_clock::now();
@@ -145,6 +166,9 @@ void XsensCallback::onLiveDataAvailable( XsDevice *, const XsDataPacket *packet
 
         _buffer.push( XsensData( now, *packet ) );
 
+        if ( _logWriter.isOpen() )
+            _logWriter.write( _buffer.back() );
+
         lock.unlock();
 
         _condition.notify_one();
@@ -178,6 +202,16 @@ std::vector< XsensData > XsensInterface::getAllPackets( const std::chrono::milli
     return _xsensCallback.all( timeout );
 }
 
+bool XsensInterface::setRecordFile( const std::string &fileName )
+{
+    return _xsensCallback.setRecordFile( fileName );
+}
+
+void XsensInterface::closeRecordFile()
+{
+    _xsensCallback.closeRecordFile();
+}
+
 bool XsensInterface::connectDevice()
 {
     XsPortInfo mtPort;
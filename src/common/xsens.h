@@ -10,12 +10,15 @@
 #include <Eigen/Eigen>
 
 #include "limitedqueue.h"
+#include "imulog.h"
 
 class XsensData : public XsDataPacket
 {
 public:
     XsensData();
     XsensData( const std::chrono::time_point< std::chrono::high_resolution_clock > &time, const XsDataPacket &packet );
+    XsensData( const std::chrono::time_point< std::chrono::high_resolution_clock > &time, const double xsensTime,
+               const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro, const Eigen::Vector3d &magnitometer );
 
     void setValues( const XsDataPacket &packet );
 
@@ -53,6 +56,9 @@ public:
     XsensData next( const std::chrono::milliseconds &timeout );
     std::vector< XsensData > all( const std::chrono::milliseconds &timeout );
 
+    bool setRecordFile( const std::string &fileName );
+    void closeRecordFile();
+
 protected:
     void onLiveDataAvailable( XsDevice *, const XsDataPacket *packet ) override;
 
@@ -61,20 +67,41 @@ private:
     std::condition_variable _condition;
     LimitedQueue< XsensData > _buffer;
 
+    // Packets are logged as they arrive, whether they are taken or not
+    ImuLogWriter _logWriter;
+
     static const size_t m_bufferSize = 1000;
 };
 
+// Packet source of the IMU code paths: a live device or a recorded log
+class XsensSource
+{
+public:
+    virtual ~XsensSource() = default;
+
+    virtual XsensData getPacket( std::chrono::milliseconds timeout ) = 0;
+    virtual std::vector< XsensData > getAllPackets( const std::chrono::milliseconds &timeout ) = 0;
+
+protected:
+    XsensSource() = default;
+
+};
+
 struct XsControl;
 struct XsDevice;
 
-class XsensInterface
+class XsensInterface : public XsensSource
 {
 public:
     XsensInterface();
     ~XsensInterface();
 
-    XsensData getPacket( std::chrono::milliseconds timeout );
-    std::vector< XsensData > getAllPackets( const std::chrono::milliseconds &timeout );
+    virtual XsensData getPacket( std::chrono::milliseconds timeout ) override;
+    virtual std::vector< XsensData > getAllPackets( const std::chrono::milliseconds &timeout ) override;
+
+    // Records the live packets to an IMU log, see ImuLogWriter
+    bool setRecordFile( const std::string &fileName );
+    void closeRecordFile();
 
     bool connectDevice();
     bool connectDevice( const std::string &portName );
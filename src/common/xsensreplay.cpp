@@ -0,0 +1,169 @@
+#include "precompiled.h"
+
+#include "xsensreplay.h"
+
+#include "replayclock.h"
+
+#include <thread>
+
+// XsensReplay
+XsensReplay::XsensReplay()
+{
+    initialize();
+}
+
+XsensReplay::XsensReplay( const std::string &fileName, const double speed )
+{
+    initialize();
+
+    setSpeed( speed );
+    open( fileName );
+}
+
+void XsensReplay::initialize()
+{
+    m_position = 0;
+    m_speed = 1.;
+    m_started = false;
+}
+
+bool XsensReplay::open( const std::string &fileName )
+{
+    restart();
+
+    return ImuLogReader::read( fileName, &m_packets );
+}
+
+void XsensReplay::setSpeed( const double value )
+{
+    if ( m_started && m_position < m_packets.size() ) {
+        // The packet due now stays due, the rest follows at the new speed
+        auto now = std::chrono::steady_clock::now();
+        auto recorded = std::chrono::duration< double >( m_packets[ m_position ].utcTime() - m_packets.front().utcTime() ).count();
+
+        m_startTime = value > 0. ? now - std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( recorded / value ) ) : now;
+    }
+
+    m_speed = std::max( value, 0. );
+}
+
+double XsensReplay::speed() const
+{
+    return m_clock ? m_clock->speed() : m_speed;
+}
+
+void XsensReplay::setClock( const std::shared_ptr< ReplayClock > &value )
+{
+    m_clock = value;
+}
+
+const std::shared_ptr< ReplayClock > &XsensReplay::clock() const
+{
+    return m_clock;
+}
+
+void XsensReplay::restart()
+{
+    m_position = 0;
+    m_started = false;
+}
+
+bool XsensReplay::atEnd() const
+{
+    return m_position >= m_packets.size();
+}
+
+size_t XsensReplay::size() const
+{
+    return m_packets.size();
+}
+
+std::chrono::steady_clock::duration XsensReplay::recordedOffset( const size_t index ) const
+{
+    return std::chrono::duration_cast< std::chrono::steady_clock::duration >( m_packets[ index ].utcTime() - m_packets.front().utcTime() );
+}
+
+std::chrono::steady_clock::time_point XsensReplay::dueTime( const size_t index ) const
+{
+    if ( m_clock )
+        return m_clock->dueTime( recordedOffset( index ) );
+
+    if ( m_speed <= 0. )
+        return m_startTime;
+
+    auto recorded = std::chrono::duration< double >( recordedOffset( index ) ).count();
+
+    return m_startTime + std::chrono::duration_cast< std::chrono::steady_clock::duration >( std::chrono::duration< double >( recorded / m_speed ) );
+}
+
+XsensData XsensReplay::takePacket()
+{
+    auto &packet = m_packets[ m_position ];
+
+    if ( !m_clock ) {
+        ++m_position;
+        return packet;
+    }
+
+    auto time = std::chrono::time_point< std::chrono::high_resolution_clock >(
+                std::chrono::duration_cast< std::chrono::high_resolution_clock::duration >( m_clock->stamp( recordedOffset( m_position++ ) ).time_since_epoch() ) );
+
+    return XsensData( time, packet.xsensTime(), packet.acceleration(), packet.gyro(), packet.magnitometer() );
+}
+
+bool XsensReplay::waitNext( const std::chrono::milliseconds &timeout )
+{
+    if ( atEnd() ) {
+        std::this_thread::sleep_for( timeout );
+        return false;
+    }
+
+    if ( !m_started ) {
+        if ( m_clock )
+            m_clock->start();
+        else
+            m_startTime = std::chrono::steady_clock::now();
+
+        m_started = true;
+    }
+
+    auto due = dueTime( m_position );
+    auto now = std::chrono::steady_clock::now();
+
+    if ( due <= now )
+        return true;
+
+    if ( due > now + timeout ) {
+        std::this_thread::sleep_for( timeout );
+        return false;
+    }
+
+    std::this_thread::sleep_until( due );
+
+    return true;
+
+}
+
+XsensData XsensReplay::getPacket( std::chrono::milliseconds timeout )
+{
+    if ( !waitNext( timeout ) )
+        return XsensData();
+
+    return takePacket();
+}
+
+std::vector< XsensData > XsensReplay::getAllPackets( const std::chrono::milliseconds &timeout )
+{
+    std::vector< XsensData > ret;
+
+    if ( !waitNext( timeout ) )
+        return ret;
+
+    auto now = std::chrono::steady_clock::now();
+
+    while ( m_position < m_packets.size() && dueTime( m_position ) <= now )
+        ret.push_back( takePacket() );
+
+    return ret;
+
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "xsens.h"
+
+#include <memory>
+
+class ReplayClock;
+
+// Plays an IMU log back through the packet source interface.
+// Packets keep their recorded times and are released on the recorded intervals divided by the speed,
+// speed 1 is real time and 0 releases them as fast as they are requested.
+// With a replay clock the speed is the clock's one and the packets are stamped on the clock,
+// to pair with the other sources replayed on it
+class XsensReplay : public XsensSource
+{
+public:
+    XsensReplay();
+    explicit XsensReplay( const std::string &fileName, const double speed = 1. );
+
+    bool open( const std::string &fileName );
+
+    void setSpeed( const double value );
+    double speed() const;
+
+    void setClock( const std::shared_ptr< ReplayClock > &value );
+    const std::shared_ptr< ReplayClock > &clock() const;
+
+    // Starts over from the first packet
+    void restart();
+
+    bool atEnd() const;
+    size_t size() const;
+
+    virtual XsensData getPacket( std::chrono::milliseconds timeout ) override;
+    virtual std::vector< XsensData > getAllPackets( const std::chrono::milliseconds &timeout ) override;
+
+protected:
+    std::vector< XsensData > m_packets;
+    size_t m_position;
+
+    double m_speed;
+
+    bool m_started;
+    std::chrono::steady_clock::time_point m_startTime;
+
+    std::shared_ptr< ReplayClock > m_clock;
+
+    std::chrono::steady_clock::duration recordedOffset( const size_t index ) const;
+    std::chrono::steady_clock::time_point dueTime( const size_t index ) const;
+
+    XsensData takePacket();
+
+    // Starts the clock on the first request, waits up to the timeout for the next packet.
+    // Sleeps for the whole timeout at the end of the log, so the polling loops don't spin
+    bool waitNext( const std::chrono::milliseconds &timeout );
+
+private:
+    void initialize();
+
+};
@@ -24,9 +24,13 @@ void DisparityChoiceDialog::initialize()
     auto cameraDocument = new QListWidgetItem( tr("Disparity from camera") );
     cameraDocument->setData( Qt::UserRole, CAMERA );
 
+    auto simulatedCameraDocument = new QListWidgetItem( tr("Disparity from simulated camera") );
+    simulatedCameraDocument->setData( Qt::UserRole, SIMULATED_CAMERA );
+
     m_listWidget->addItem( stereoDocument );
     m_listWidget->addItem( fileDocument );
     m_listWidget->addItem( cameraDocument );
+    m_listWidget->addItem( simulatedCameraDocument );
 
     m_listWidget->setSelectionMode( QListWidget::SingleSelection );
 
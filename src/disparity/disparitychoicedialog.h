@@ -7,7 +7,7 @@ class DisparityChoiceDialog : public DialogBase
     Q_OBJECT
 
 public:
-    enum DocumentType { NONE, STEREO, FILE, CAMERA };
+    enum DocumentType { NONE, STEREO, FILE, CAMERA, SIMULATED_CAMERA };
 
     explicit DisparityChoiceDialog( QWidget* parent = nullptr );
 
@@ -317,22 +317,24 @@ void ViewDisparityWidget::processDisparity( const CvImage &color, const CvImage
 }
 
 // CameraDisparityWidget
-CameraDisparityWidget::CameraDisparityWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent )
-    : ControlDisparityWidget( parent ), m_camera( leftCameraIp.toStdString(), rightCameraIp.toStdString(), parent )
+CameraDisparityWidget::CameraDisparityWidget( StereoCameraBase *camera, QWidget* parent )
+    : ControlDisparityWidget( parent ), m_camera( camera )
 {
     initialize();
 }
 
 void CameraDisparityWidget::initialize()
 {
-    connect( &m_camera, &StereoCamera::receivedFrame, this, &CameraDisparityWidget::updateFrame );
+    m_camera->setParent( this );
+
+    connect( m_camera, &StereoCameraBase::receivedFrame, this, &CameraDisparityWidget::updateFrame );
 }
 
 void CameraDisparityWidget::updateFrame()
 {
     if ( m_updateMutex.tryLock() ) {
 
-        auto frame = m_camera.getFrame();
+        auto frame = m_camera->getFrame();
 
         ControlDisparityWidget::processFrame( frame );
 
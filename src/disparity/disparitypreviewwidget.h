@@ -136,13 +136,14 @@ class CameraDisparityWidget : public ControlDisparityWidget
     Q_OBJECT
 
 public:
-    explicit CameraDisparityWidget( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent = nullptr );
+    // Takes the ownership of the camera
+    explicit CameraDisparityWidget( StereoCameraBase *camera, QWidget* parent = nullptr );
 
 protected slots:
     void updateFrame();
 
 protected:
-    StereoCamera m_camera;
+    QPointer< StereoCameraBase > m_camera;
 
     QMutex m_updateMutex;
 
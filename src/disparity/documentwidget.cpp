@@ -17,15 +17,15 @@ void DisparityDocumentBase::initialize()
 }
 
 // CameraDisparityDocument
-CameraDisparityDocument::CameraDisparityDocument( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent )
+CameraDisparityDocument::CameraDisparityDocument( StereoCameraBase *camera, QWidget* parent )
     : DisparityDocumentBase( parent )
 {
-    initialize( leftCameraIp, rightCameraIp );
+    initialize( camera );
 }
 
-void CameraDisparityDocument::initialize( const QString &leftCameraIp, const QString &rightCameraIp )
+void CameraDisparityDocument::initialize( StereoCameraBase *camera )
 {
-    setWidget( new CameraDisparityWidget( leftCameraIp, rightCameraIp, this ) );
+    setWidget( new CameraDisparityWidget( camera, this ) );
 }
 
 CameraDisparityWidget *CameraDisparityDocument::widget() const
@@ -6,6 +6,8 @@
 
 class QVBoxLayout;
 
+class StereoCameraBase;
+
 class CameraDisparityWidget;
 class DiskDisparityWidget;
 class StereoDisparityWidget;
@@ -32,7 +34,7 @@ class CameraDisparityDocument : public DisparityDocumentBase
     Q_OBJECT
 
 public:
-    explicit CameraDisparityDocument( const QString &leftCameraIp, const QString &rightCameraIp, QWidget* parent = nullptr );
+    explicit CameraDisparityDocument( StereoCameraBase *camera, QWidget* parent = nullptr );
 
     CameraDisparityWidget *widget() const;
 
@@ -42,7 +44,7 @@ public slots:
     virtual void loadCalibrationDialog() override;
 
 private:
-    void initialize( const QString &leftCameraIp, const QString &rightCameraIp );
+    void initialize( StereoCameraBase *camera );
 
 };
 
@@ -5,6 +5,8 @@
 #include "disparitypreviewwidget.h"
 #include "documentwidget.h"
 #include "src/common/ipwidget.h"
+#include "src/common/simulatedcamerawidget.h"
+#include "src/common/vimbacamera.h"
 
 #include "disparitychoicedialog.h"
 
@@ -41,7 +43,12 @@ void MainWindow::addFileDisparityDocument()
 
 void MainWindow::addCameraDisparityDocument( const QString &leftCameraIp, const QString &rightCameraIp )
 {
-    addDocument( new CameraDisparityDocument( leftCameraIp, rightCameraIp, this ) );
+    addCameraDisparityDocument( new StereoCamera( leftCameraIp.toStdString(), rightCameraIp.toStdString() ) );
+}
+
+void MainWindow::addCameraDisparityDocument( StereoCameraBase *camera )
+{
+    addDocument( new CameraDisparityDocument( camera, this ) );
 }
 
 DisparityDocumentBase *MainWindow::currentDisparityDocument() const
@@ -84,6 +91,9 @@ void MainWindow::choiceDisparityDialog()
          case DisparityChoiceDialog::CAMERA:
              addCameraDisparityDialog();
              break;
+         case DisparityChoiceDialog::SIMULATED_CAMERA:
+             addSimulatedCameraDisparityDialog();
+             break;
          default:
              break;
          }
@@ -110,6 +120,21 @@ void MainWindow::addCameraDisparityDialog()
 
 }
 
+void MainWindow::addSimulatedCameraDisparityDialog()
+{
+    SimulatedCameraDialog dialog( this );
+
+    if ( dialog.exec() == DialogBase::Accepted ) {
+        auto camera = dialog.createCamera();
+
+        if ( camera )
+            addCameraDisparityDocument( camera );
+        else
+            QMessageBox::warning( this, tr( "Simulated camera" ), tr( "Can't start the simulated camera: %1" ).arg( dialog.errorString() ) );
+    }
+
+}
+
 void MainWindow::loadCalibrationDialog()
 {
     auto doc = currentDisparityDocument();
@@ -14,6 +14,8 @@ class DiskDisparityDocument;
 class StereoDisparityDocument;
 class FileDisparityDocument;
 
+class StereoCameraBase;
+
 class MainWindow : public DocumentMainWindow
 {
     Q_OBJECT
@@ -25,6 +27,7 @@ public:
     void addStereoDisparityDocument();
     void addFileDisparityDocument();
     void addCameraDisparityDocument( const QString &leftCameraIp, const QString &rightCameraIp );
+    void addCameraDisparityDocument( StereoCameraBase *camera );
 
     DisparityDocumentBase *currentDisparityDocument() const;
     DiskDisparityDocument *currentDiskDisparityDocument() const;
@@ -38,6 +41,7 @@ public slots:
     void addStereoDisparity();
     void addFileDisparity();
     void addCameraDisparityDialog();
+    void addSimulatedCameraDisparityDialog();
 
     void loadCalibrationDialog();
 
@@ -68,18 +68,22 @@ void ProcessorThread::run()
 
     if ( !m_img1.empty() && !m_img2.empty() ) {
 
-        std::vector< cv::KeyPoint > keyPoints1, keyPoints2;
+        std::vector< CvImage > images = { m_img1, m_img2 };
 
-        auto keypointProcessor = std::dynamic_pointer_cast< KeyPointProcessor >( m_detector );
+        m_batch.resize( images.size() );
 
-        if ( keypointProcessor ) {
+        auto &keyPoints1 = m_batch.keypoints[ 0 ];
+        auto &keyPoints2 = m_batch.keypoints[ 1 ];
 
-            keypointProcessor->extractKeypoints( m_img1, cv::Mat(), &keyPoints1 );
-            keypointProcessor->extractKeypoints( m_img2, cv::Mat(), &keyPoints2 );
+        auto keypointProcessor = std::dynamic_pointer_cast< KeyPointProcessor >( m_detector );
 
-        }
+        if ( keypointProcessor )
+            keypointProcessor->extractKeypoints( images, std::vector< cv::Mat >(), &m_batch );
         else {
 
+            keyPoints1.clear();
+            keyPoints2.clear();
+
             auto superglueProcessor = std::dynamic_pointer_cast< SuperGlueProcessor >( m_detector );
 
             if ( superglueProcessor )  {
@@ -137,10 +141,10 @@ void ProcessorThread::run()
 
             if ( descriptorProcessor ) {
 
-                cv::Mat descriptors1, descriptors2;
+                descriptorProcessor->extractDescriptors( images, &m_batch );
 
-                descriptorProcessor->extractDescriptors( m_img1, keyPoints1, &descriptors1 );
-                descriptorProcessor->extractDescriptors( m_img2, keyPoints2, &descriptors2 );
+                auto &descriptors1 = m_batch.descriptors[ 0 ];
+                auto &descriptors2 = m_batch.descriptors[ 1 ];
 
                 std::vector< cv::DMatch > matches;
 
@@ -43,6 +43,8 @@ protected:
     std::shared_ptr< FeatureProcessorBase > m_descriptor;
     std::shared_ptr< DescriptorMatcher > m_matcher;
 
+    FeatureBatch m_batch;
+
     virtual void run() override;
 
 private:
@@ -21,8 +21,12 @@ void ChoiceDialog::initialize()
     auto cameraDocument = new QListWidgetItem( tr("Camera capture") );
     cameraDocument->setData( Qt::UserRole, CAMERA );
 
+    auto simulatedCameraDocument = new QListWidgetItem( tr("Simulated camera capture") );
+    simulatedCameraDocument->setData( Qt::UserRole, SIMULATED_CAMERA );
+
     m_listWidget->addItem( imagesDocument );
     m_listWidget->addItem( cameraDocument );
+    m_listWidget->addItem( simulatedCameraDocument );
 
     m_listWidget->setSelectionMode( QListWidget::SingleSelection );
 
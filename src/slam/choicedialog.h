@@ -7,7 +7,7 @@ class ChoiceDialog : public DialogBase
     Q_OBJECT
 
 public:
-    enum DocumentType { NONE, IMAGES, CAMERA };
+    enum DocumentType { NONE, IMAGES, CAMERA, SIMULATED_CAMERA };
 
     explicit ChoiceDialog( QWidget* parent = nullptr );
 
@@ -294,7 +294,14 @@ void FlowFrame::buildPyramid()
 
 void FlowFrame::clearPyramid()
 {
+    auto imagePyramid = std::move( m_imagePyramid );
+
     m_imagePyramid.clear();
+
+    auto world = parentWorld();
+
+    if ( world )
+        world->flowTracker()->releasePyramid( &imagePyramid );
 }
 
 std::vector< MonoPointPtr > FlowFrame::framePoints() const
@@ -351,13 +358,30 @@ FlowFrame::ObjectConstPtr FlowFrame::shared_from_this() const
     return std::dynamic_pointer_cast< const FlowFrame >( MonoFrame::shared_from_this() );
 }
 
-cv::Mat track( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame )
+cv::Mat track( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame, const cv::Mat &prediction )
 {
-    if ( prevFrame && nextFrame ) {
+    std::vector< FlowTrackResult > trackedPoints;
 
-        std::vector< FlowTrackResult > trackedPoints;
+    auto fmat = computeTrack( prevFrame, nextFrame, &trackedPoints, prediction );
+
+    applyTrack( prevFrame, nextFrame, trackedPoints );
+
+    return fmat;
+
+}
 
-        auto fmat = prevFrame->parentWorld()->flowTracker()->track( prevFrame, nextFrame, &trackedPoints );
+cv::Mat computeTrack( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat &prediction )
+{
+    if ( prevFrame && nextFrame && trackedPoints )
+        return prevFrame->parentWorld()->flowTracker()->track( prevFrame, nextFrame, trackedPoints, prediction );
+
+    return cv::Mat();
+
+}
+
+void applyTrack( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame, const std::vector< FlowTrackResult > &trackedPoints )
+{
+    if ( prevFrame && nextFrame ) {
 
         auto trackPoints = prevFrame->flowPoints();
 
@@ -379,12 +403,8 @@ cv::Mat track( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_
 
         }
 
-        return fmat;
-
     }
 
-    return cv::Mat();
-
 }
 
 // FlowKeyFrame
@@ -1267,6 +1287,16 @@ int StereoKeyFrame::triangulatePoints()
 
 }
 
+void StereoKeyFrame::setImuPreintegration( const ImuPreintegration &value )
+{
+    m_imuPreintegration = value;
+}
+
+const ImuPreintegration &StereoKeyFrame::imuPreintegration() const
+{
+    return m_imuPreintegration;
+}
+
 // ProcessedStereoKeyFrame
 ProcessedStereoKeyFrame::ProcessedStereoKeyFrame( const MapPtr &parentMap )
     : StereoFrame( parentMap ), ProcessedStereoFrame( parentMap ), StereoKeyFrame( parentMap )
@@ -1322,11 +1352,17 @@ void FlowStereoFrame::buildPyramid()
     auto leftFrame = this->leftFrame();
     auto rightFrame = this->rightFrame();
 
-    if ( leftFrame )
-        leftFrame->buildPyramid();
+    #pragma omp parallel sections if( parentWorld()->flowTracker()->isConcurrent() )
+    {
+        #pragma omp section
+        if ( leftFrame )
+            leftFrame->buildPyramid();
+
+        #pragma omp section
+        if ( rightFrame )
+            rightFrame->buildPyramid();
+    }
 
-    if ( rightFrame )
-        rightFrame->buildPyramid();
 }
 
 void FlowStereoFrame::clearPyramid()
@@ -1352,15 +1388,52 @@ FlowFramePtr FlowStereoFrame::rightFrame() const
 }
 
 cv::Mat FlowStereoFrame::match()
+{
+    std::vector< FlowTrackResult > trackedPoints;
+
+    auto fmat = computeMatch( &trackedPoints );
+
+    applyMatch( trackedPoints );
+
+    return fmat;
+
+}
+
+cv::Mat FlowStereoFrame::computeMatch( std::vector< FlowTrackResult > *trackedPoints ) const
 {
     auto leftFrame = this->leftFrame();
     auto rightFrame = this->rightFrame();
 
-    if ( leftFrame && rightFrame ) {
+    if ( leftFrame && rightFrame && trackedPoints ) {
 
-        std::vector< FlowTrackResult > trackedPoints;
+        // With depth in baselines the disparity is fx / depth
+        auto &settings = parentWorld()->settings();
 
-        auto fmat = parentWorld()->flowTracker()->track( leftFrame, rightFrame, &trackedPoints );
+        auto fx = parentMap()->projectionMatrix().leftProjectionMatrix().fx();
+
+        auto minDisparity = parentWorld()->minStereoDisparity();
+        auto maxDisparity = static_cast< double >( leftFrame->image().cols );
+
+        if ( settings.maxStereoDepth() > 0. )
+            minDisparity = std::max( minDisparity, fx / settings.maxStereoDepth() );
+
+        if ( settings.minStereoDepth() > 0. )
+            maxDisparity = std::min( maxDisparity, fx / settings.minStereoDepth() );
+
+        return parentWorld()->flowTracker()->match( leftFrame, rightFrame, minDisparity, maxDisparity, trackedPoints );
+
+    }
+
+    return cv::Mat();
+
+}
+
+void FlowStereoFrame::applyMatch( const std::vector< FlowTrackResult > &trackedPoints )
+{
+    auto leftFrame = this->leftFrame();
+    auto rightFrame = this->rightFrame();
+
+    if ( leftFrame && rightFrame ) {
 
         auto trackPoints = leftFrame->flowPoints();
 
@@ -1391,12 +1464,8 @@ cv::Mat FlowStereoFrame::match()
 
         }
 
-        return fmat;
-
     }
 
-    return cv::Mat();
-
 }
 
 // FlowStereoKeyFrame
@@ -2025,6 +2094,8 @@ void FinishedStereoKeyFrame::replace( const ProcessedStereoKeyFramePtr &frame )
 {
     if ( frame ) {
 
+        setImuPreintegration( frame->imuPreintegration() );
+
         auto leftFrame = this->leftFrame();
         if ( !leftFrame ) {
             leftFrame = FinishedKeyFrame::create();
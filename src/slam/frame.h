@@ -5,6 +5,7 @@
 
 #include "framepoint.h"
 #include "mappoint.h"
+#include "imudata.h"
 
 #include "src/common/projectionmatrix.h"
 #include "src/common/featureprocessor.h"
@@ -179,7 +180,10 @@ private:
     void initialize();
 };
 
-cv::Mat track( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame );
+cv::Mat track( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame, const cv::Mat &prediction = cv::Mat() );
+
+cv::Mat computeTrack( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat &prediction = cv::Mat() );
+void applyTrack( const std::shared_ptr< FlowFrame > &prevFrame, const std::shared_ptr< FlowFrame > &nextFrame, const std::vector< FlowTrackResult > &trackedPoints );
 
 class FlowKeyFrame : public FlowFrame, public ProcessedKeyFrame
 {
@@ -400,8 +404,14 @@ public:
 
     int triangulatePoints();
 
+    // IMU motion since the previous key frame, empty without an IMU
+    void setImuPreintegration( const ImuPreintegration &value );
+    const ImuPreintegration &imuPreintegration() const;
+
 protected:
     StereoKeyFrame( const MapPtr &parentMap );
+
+    ImuPreintegration m_imuPreintegration;
 };
 
 class ProcessedStereoKeyFrame : public virtual ProcessedStereoFrame, public virtual StereoKeyFrame
@@ -438,6 +448,9 @@ public:
 
     cv::Mat match();
 
+    cv::Mat computeMatch( std::vector< FlowTrackResult > *trackedPoints ) const;
+    void applyMatch( const std::vector< FlowTrackResult > &trackedPoints );
+
 protected:
     FlowStereoFrame( const MapPtr &parentMap );
 
@@ -2,5 +2,565 @@
 
 #include "imudata.h"
 
+#include "src/common/profiler.h"
+#include "src/common/xsens.h"
+
+#include <Eigen/Geometry>
+
+#include <opencv2/core/eigen.hpp>
+
 namespace slam {
+
+// ImuData
+ImuData::ImuData()
+    : m_acceleration( Eigen::Vector3d::Zero() ), m_gyro( Eigen::Vector3d::Zero() )
+{
+}
+
+ImuData::ImuData( const std::chrono::time_point< std::chrono::system_clock > &time, const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro )
+    : m_time( time ), m_acceleration( acceleration ), m_gyro( gyro )
+{
+}
+
+ImuData::ImuData( const XsensData &packet )
+    : m_acceleration( packet.acceleration() ), m_gyro( packet.gyro() )
+{
+    // Packets are stamped at arrival, as the camera frames without a hardware timestamp
+    m_time = std::chrono::time_point< std::chrono::system_clock >( std::chrono::duration_cast< std::chrono::system_clock::duration >( packet.utcTime().time_since_epoch() ) );
+}
+
+void ImuData::setTime( const std::chrono::time_point< std::chrono::system_clock > &value )
+{
+    m_time = value;
+}
+
+const std::chrono::time_point< std::chrono::system_clock > &ImuData::time() const
+{
+    return m_time;
+}
+
+void ImuData::setAcceleration( const Eigen::Vector3d &value )
+{
+    m_acceleration = value;
+}
+
+const Eigen::Vector3d &ImuData::acceleration() const
+{
+    return m_acceleration;
+}
+
+void ImuData::setGyro( const Eigen::Vector3d &value )
+{
+    m_gyro = value;
+}
+
+const Eigen::Vector3d &ImuData::gyro() const
+{
+    return m_gyro;
+}
+
+// ImuBias
+ImuBias::ImuBias()
+    : acceleration( Eigen::Vector3d::Zero() ), gyro( Eigen::Vector3d::Zero() )
+{
+}
+
+ImuBias::ImuBias( const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro )
+    : acceleration( acceleration ), gyro( gyro )
+{
+}
+
+// ImuPreintegration
+ImuPreintegration::ImuPreintegration()
+{
+    initialize();
+}
+
+void ImuPreintegration::initialize()
+{
+    // Radians per second and meters per second squared per square root of hertz, Xsens MTi datasheet order
+    m_gyroNoiseDensity = 2.e-4;
+    m_accelerationNoiseDensity = 1.2e-3;
+
+    reset( std::chrono::time_point< std::chrono::system_clock >(), ImuBias() );
+}
+
+void ImuPreintegration::reset( const std::chrono::time_point< std::chrono::system_clock > &time, const ImuBias &bias )
+{
+    m_startTime = time;
+    m_finishTime = time;
+
+    m_deltaTime = 0.;
+
+    m_bias = bias;
+
+    m_deltaRotation.setIdentity();
+    m_deltaVelocity.setZero();
+    m_deltaPosition.setZero();
+
+    m_covariance.setZero();
+
+    m_rotationGyroJacobian.setZero();
+    m_velocityGyroJacobian.setZero();
+    m_velocityAccelerationJacobian.setZero();
+    m_positionGyroJacobian.setZero();
+    m_positionAccelerationJacobian.setZero();
+}
+
+void ImuPreintegration::integrate( const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro, const double dt )
+{
+    if ( dt <= 0. )
+        return;
+
+    Eigen::Vector3d correctedAcceleration = acceleration - m_bias.acceleration;
+    Eigen::Vector3d correctedGyro = gyro - m_bias.gyro;
+
+    Eigen::Matrix3d incrementRotation = expMap( correctedGyro * dt );
+    Eigen::Matrix3d incrementJacobian = rightJacobian( correctedGyro * dt );
+
+    Eigen::Matrix3d accelerationSkew = skew( correctedAcceleration );
+
+    auto dt2 = dt * dt;
+
+    // Noise propagation uses the deltas before the step
+    Matrix9d a = Matrix9d::Identity();
+    a.block< 3, 3 >( 0, 0 ) = incrementRotation.transpose();
+    a.block< 3, 3 >( 3, 0 ) = -m_deltaRotation * accelerationSkew * dt;
+    a.block< 3, 3 >( 6, 0 ) = -0.5 * m_deltaRotation * accelerationSkew * dt2;
+    a.block< 3, 3 >( 6, 3 ) = Eigen::Matrix3d::Identity() * dt;
+
+    Eigen::Matrix< double, 9, 3 > gyroNoise = Eigen::Matrix< double, 9, 3 >::Zero();
+    gyroNoise.block< 3, 3 >( 0, 0 ) = incrementJacobian * dt;
+
+    Eigen::Matrix< double, 9, 3 > accelerationNoise = Eigen::Matrix< double, 9, 3 >::Zero();
+    accelerationNoise.block< 3, 3 >( 3, 0 ) = m_deltaRotation * dt;
+    accelerationNoise.block< 3, 3 >( 6, 0 ) = 0.5 * m_deltaRotation * dt2;
+
+    // Noise densities to the discrete sample variances
+    auto gyroVariance = m_gyroNoiseDensity * m_gyroNoiseDensity / dt;
+    auto accelerationVariance = m_accelerationNoiseDensity * m_accelerationNoiseDensity / dt;
+
+    m_covariance = a * m_covariance * a.transpose()
+                   + gyroVariance * gyroNoise * gyroNoise.transpose()
+                   + accelerationVariance * accelerationNoise * accelerationNoise.transpose();
+
+    // Position Jacobians take the velocity ones of the previous step
+    m_positionAccelerationJacobian += m_velocityAccelerationJacobian * dt - 0.5 * m_deltaRotation * dt2;
+    m_positionGyroJacobian += m_velocityGyroJacobian * dt - 0.5 * m_deltaRotation * accelerationSkew * m_rotationGyroJacobian * dt2;
+
+    m_velocityAccelerationJacobian -= m_deltaRotation * dt;
+    m_velocityGyroJacobian -= m_deltaRotation * accelerationSkew * m_rotationGyroJacobian * dt;
+
+    m_rotationGyroJacobian = incrementRotation.transpose() * m_rotationGyroJacobian - incrementJacobian * dt;
+
+    m_deltaPosition += m_deltaVelocity * dt + 0.5 * m_deltaRotation * correctedAcceleration * dt2;
+    m_deltaVelocity += m_deltaRotation * correctedAcceleration * dt;
+
+    m_deltaRotation = Eigen::Quaterniond( m_deltaRotation * incrementRotation ).normalized().toRotationMatrix();
+
+    m_deltaTime += dt;
+
+}
+
+void ImuPreintegration::setNoiseDensity( const double gyro, const double acceleration )
+{
+    m_gyroNoiseDensity = gyro;
+    m_accelerationNoiseDensity = acceleration;
+}
+
+bool ImuPreintegration::isEmpty() const
+{
+    return m_deltaTime <= 0.;
+}
+
+void ImuPreintegration::setStartTime( const std::chrono::time_point< std::chrono::system_clock > &value )
+{
+    m_startTime = value;
+}
+
+const std::chrono::time_point< std::chrono::system_clock > &ImuPreintegration::startTime() const
+{
+    return m_startTime;
+}
+
+void ImuPreintegration::setFinishTime( const std::chrono::time_point< std::chrono::system_clock > &value )
+{
+    m_finishTime = value;
+}
+
+const std::chrono::time_point< std::chrono::system_clock > &ImuPreintegration::finishTime() const
+{
+    return m_finishTime;
+}
+
+double ImuPreintegration::deltaTime() const
+{
+    return m_deltaTime;
+}
+
+const ImuBias &ImuPreintegration::bias() const
+{
+    return m_bias;
+}
+
+const Eigen::Matrix3d &ImuPreintegration::deltaRotation() const
+{
+    return m_deltaRotation;
+}
+
+const Eigen::Vector3d &ImuPreintegration::deltaVelocity() const
+{
+    return m_deltaVelocity;
+}
+
+const Eigen::Vector3d &ImuPreintegration::deltaPosition() const
+{
+    return m_deltaPosition;
+}
+
+const ImuPreintegration::Matrix9d &ImuPreintegration::covariance() const
+{
+    return m_covariance;
+}
+
+const Eigen::Matrix3d &ImuPreintegration::rotationGyroJacobian() const
+{
+    return m_rotationGyroJacobian;
+}
+
+const Eigen::Matrix3d &ImuPreintegration::velocityGyroJacobian() const
+{
+    return m_velocityGyroJacobian;
+}
+
+const Eigen::Matrix3d &ImuPreintegration::velocityAccelerationJacobian() const
+{
+    return m_velocityAccelerationJacobian;
+}
+
+const Eigen::Matrix3d &ImuPreintegration::positionGyroJacobian() const
+{
+    return m_positionGyroJacobian;
+}
+
+const Eigen::Matrix3d &ImuPreintegration::positionAccelerationJacobian() const
+{
+    return m_positionAccelerationJacobian;
+}
+
+Eigen::Matrix3d ImuPreintegration::deltaRotation( const ImuBias &bias ) const
+{
+    Eigen::Vector3d gyroDelta = bias.gyro - m_bias.gyro;
+
+    return m_deltaRotation * expMap( m_rotationGyroJacobian * gyroDelta );
+}
+
+Eigen::Vector3d ImuPreintegration::deltaVelocity( const ImuBias &bias ) const
+{
+    Eigen::Vector3d gyroDelta = bias.gyro - m_bias.gyro;
+    Eigen::Vector3d accelerationDelta = bias.acceleration - m_bias.acceleration;
+
+    return m_deltaVelocity + m_velocityGyroJacobian * gyroDelta + m_velocityAccelerationJacobian * accelerationDelta;
+}
+
+Eigen::Vector3d ImuPreintegration::deltaPosition( const ImuBias &bias ) const
+{
+    Eigen::Vector3d gyroDelta = bias.gyro - m_bias.gyro;
+    Eigen::Vector3d accelerationDelta = bias.acceleration - m_bias.acceleration;
+
+    return m_deltaPosition + m_positionGyroJacobian * gyroDelta + m_positionAccelerationJacobian * accelerationDelta;
+}
+
+Eigen::Matrix3d ImuPreintegration::skew( const Eigen::Vector3d &value )
+{
+    Eigen::Matrix3d ret;
+
+    ret << 0., -value.z(), value.y(),
+           value.z(), 0., -value.x(),
+           -value.y(), value.x(), 0.;
+
+    return ret;
+}
+
+Eigen::Matrix3d ImuPreintegration::expMap( const Eigen::Vector3d &value )
+{
+    auto angle = value.norm();
+
+    if ( angle < 1.e-8 )
+        return Eigen::Matrix3d::Identity() + skew( value );
+
+    return Eigen::AngleAxisd( angle, value / angle ).toRotationMatrix();
+}
+
+Eigen::Vector3d ImuPreintegration::logMap( const Eigen::Matrix3d &value )
+{
+    Eigen::AngleAxisd angleAxis( value );
+
+    return angleAxis.angle() * angleAxis.axis();
+}
+
+Eigen::Matrix3d ImuPreintegration::rightJacobian( const Eigen::Vector3d &value )
+{
+    auto angle = value.norm();
+
+    Eigen::Matrix3d valueSkew = skew( value );
+
+    if ( angle < 1.e-5 )
+        return Eigen::Matrix3d::Identity() - 0.5 * valueSkew;
+
+    auto angle2 = angle * angle;
+
+    return Eigen::Matrix3d::Identity() - ( 1. - std::cos( angle ) ) / angle2 * valueSkew
+                + ( angle - std::sin( angle ) ) / ( angle2 * angle ) * valueSkew * valueSkew;
+}
+
+// ImuIntegrator
+ImuIntegrator::ImuIntegrator()
+    : m_samplesRing( m_ringSize )
+{
+    initialize();
+}
+
+void ImuIntegrator::initialize()
+{
+    m_droppedSamples = 0;
+
+    m_lastTimeValid = false;
+
+    m_gyroNoiseDensity = 2.e-4;
+    m_accelerationNoiseDensity = 1.2e-3;
+
+    m_cameraRotation.setIdentity();
+    m_cameraRotationValid = false;
+
+    m_rectificationRotation.setIdentity();
+}
+
+bool ImuIntegrator::addData( const ImuData &data )
+{
+    auto slot = m_samplesRing.writeSlot();
+
+    if ( !slot ) {
+        ++m_droppedSamples;
+        return false;
+    }
+
+    *slot = data;
+
+    m_samplesRing.commitWrite();
+
+    return true;
+
+}
+
+void ImuIntegrator::integrate( const std::chrono::time_point< std::chrono::system_clock > &frameTime )
+{
+    PROFILE_SCOPE( "imu preintegration" );
+
+    m_framePreintegration.reset( m_lastTimeValid ? m_lastTime : frameTime, m_bias );
+
+    while ( auto sample = m_samplesRing.readSlot() ) {
+
+        if ( !m_lastTimeValid ) {
+            // The first sample only opens the stream, its measurement covers the time before it
+            m_lastTime = sample->time();
+            m_lastTimeValid = true;
+
+            m_framePreintegration.reset( m_lastTime, m_bias );
+            m_keyFramePreintegration.reset( m_lastTime, m_bias );
+        }
+        else if ( sample->time() > frameTime ) {
+
+            if ( frameTime > m_lastTime )
+                integrateInterval( *sample, frameTime );
+
+            break;
+
+        }
+        else if ( sample->time() > m_lastTime )
+            integrateInterval( *sample, sample->time() );
+
+        m_samplesRing.commitRead();
+
+    }
+
+    PROFILE_COUNTER( "imu samples pending", m_samplesRing.size() );
+
+}
+
+void ImuIntegrator::integrateInterval( const ImuData &data, const std::chrono::time_point< std::chrono::system_clock > &finishTime )
+{
+    auto interval = std::chrono::duration_cast< std::chrono::microseconds >( finishTime - m_lastTime ).count();
+
+    if ( interval <= m_maxSampleInterval ) {
+        auto dt = interval * 1.e-6;
+
+        m_framePreintegration.integrate( data.acceleration(), data.gyro(), dt );
+        m_keyFramePreintegration.integrate( data.acceleration(), data.gyro(), dt );
+    }
+
+    m_lastTime = finishTime;
+
+    m_framePreintegration.setFinishTime( m_lastTime );
+    m_keyFramePreintegration.setFinishTime( m_lastTime );
+
+}
+
+bool ImuIntegrator::isActive() const
+{
+    return m_lastTimeValid;
+}
+
+const ImuPreintegration &ImuIntegrator::framePreintegration() const
+{
+    return m_framePreintegration;
+}
+
+const ImuPreintegration &ImuIntegrator::keyFramePreintegration() const
+{
+    return m_keyFramePreintegration;
+}
+
+void ImuIntegrator::startKeyFrame()
+{
+    m_keyFramePreintegration.reset( m_lastTime, m_bias );
+}
+
+void ImuIntegrator::setBias( const ImuBias &value )
+{
+    m_bias = value;
+}
+
+const ImuBias &ImuIntegrator::bias() const
+{
+    return m_bias;
+}
+
+void ImuIntegrator::setNoiseDensity( const double gyro, const double acceleration )
+{
+    m_gyroNoiseDensity = gyro;
+    m_accelerationNoiseDensity = acceleration;
+
+    m_framePreintegration.setNoiseDensity( gyro, acceleration );
+    m_keyFramePreintegration.setNoiseDensity( gyro, acceleration );
+}
+
+bool ImuIntegrator::loadParameters( const std::string &fileName )
+{
+    cv::FileStorage fs( fileName, cv::FileStorage::READ );
+
+    if ( !fs.isOpened() )
+        return false;
+
+    auto node = fs[ "imu" ];
+
+    if ( node.empty() )
+        return false;
+
+    cv::Mat cameraRotation, gyroBias, accelerationBias;
+
+    node[ "cameraRotation" ] >> cameraRotation;
+    node[ "gyroBias" ] >> gyroBias;
+    node[ "accelerationBias" ] >> accelerationBias;
+
+    if ( cameraRotation.rows == 3 && cameraRotation.cols == 3 ) {
+        cv::cv2eigen( cameraRotation, m_cameraRotation );
+        m_cameraRotationValid = true;
+    }
+
+    auto bias = m_bias;
+
+    if ( gyroBias.total() == 3 )
+        cv::cv2eigen( gyroBias.reshape( 1, 3 ), bias.gyro );
+
+    if ( accelerationBias.total() == 3 )
+        cv::cv2eigen( accelerationBias.reshape( 1, 3 ), bias.acceleration );
+
+    setBias( bias );
+
+    auto gyroNoiseDensity = m_gyroNoiseDensity;
+    auto accelerationNoiseDensity = m_accelerationNoiseDensity;
+
+    if ( !node[ "gyroNoiseDensity" ].empty() )
+        node[ "gyroNoiseDensity" ] >> gyroNoiseDensity;
+
+    if ( !node[ "accelerationNoiseDensity" ].empty() )
+        node[ "accelerationNoiseDensity" ] >> accelerationNoiseDensity;
+
+    setNoiseDensity( gyroNoiseDensity, accelerationNoiseDensity );
+
+    return true;
+}
+
+void ImuIntegrator::setCameraRotation( const Eigen::Matrix3d &value )
+{
+    m_cameraRotation = value;
+    m_cameraRotationValid = true;
+}
+
+const Eigen::Matrix3d &ImuIntegrator::cameraRotation() const
+{
+    return m_cameraRotation;
+}
+
+bool ImuIntegrator::hasCameraRotation() const
+{
+    return m_cameraRotationValid;
+}
+
+void ImuIntegrator::setRectificationRotation( const Eigen::Matrix3d &value )
+{
+    m_rectificationRotation = value;
+}
+
+const Eigen::Matrix3d &ImuIntegrator::rectificationRotation() const
+{
+    return m_rectificationRotation;
+}
+
+Eigen::Matrix3d ImuIntegrator::rectifiedCameraRotation() const
+{
+    return m_rectificationRotation * m_cameraRotation;
+}
+
+Eigen::Matrix3d ImuIntegrator::frameCameraRotation() const
+{
+    auto cameraRotation = rectifiedCameraRotation();
+
+    return cameraRotation * m_framePreintegration.deltaRotation() * cameraRotation.transpose();
+}
+
+cv::Mat ImuIntegrator::predictionHomography( const cv::Mat &cameraMatrix ) const
+{
+    if ( !m_cameraRotationValid || m_framePreintegration.isEmpty() || cameraMatrix.empty() )
+        return cv::Mat();
+
+    cv::Mat rotation;
+    cv::eigen2cv( Eigen::Matrix3d( frameCameraRotation().transpose() ), rotation );
+
+    cv::Mat intrinsics;
+    cameraMatrix.colRange( 0, 3 ).rowRange( 0, 3 ).convertTo( intrinsics, CV_64F );
+
+    // Points far away move with the rotation only: x2 = K * R^T * K^-1 * x1,
+    // R is taken in the rectified camera frame as R1 * Rc * dR * Rc^T * R1^T
+    return intrinsics * rotation * intrinsics.inv();
+
+}
+
+uint64_t ImuIntegrator::droppedSamples() const
+{
+    return m_droppedSamples;
+}
+
+void ImuIntegrator::clear()
+{
+    while ( m_samplesRing.readSlot() )
+        m_samplesRing.commitRead();
+
+    m_lastTimeValid = false;
+
+    m_framePreintegration.reset( std::chrono::time_point< std::chrono::system_clock >(), m_bias );
+    m_keyFramePreintegration.reset( std::chrono::time_point< std::chrono::system_clock >(), m_bias );
+}
+
 }
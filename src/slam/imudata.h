@@ -1,9 +1,213 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+#include <opencv2/core.hpp>
+
+#include <Eigen/Core>
+
+#include "src/common/spscring.h"
+
+class XsensData;
+
 namespace slam {
 
 class ImuData
 {
 public:
+    ImuData();
+    ImuData( const std::chrono::time_point< std::chrono::system_clock > &time, const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro );
+    explicit ImuData( const XsensData &packet );
+
+    void setTime( const std::chrono::time_point< std::chrono::system_clock > &value );
+    const std::chrono::time_point< std::chrono::system_clock > &time() const;
+
+    void setAcceleration( const Eigen::Vector3d &value );
+    const Eigen::Vector3d &acceleration() const;
+
+    void setGyro( const Eigen::Vector3d &value );
+    const Eigen::Vector3d &gyro() const;
+
+protected:
+    std::chrono::time_point< std::chrono::system_clock > m_time;
+
+    Eigen::Vector3d m_acceleration;
+    Eigen::Vector3d m_gyro;
+
+};
+
+struct ImuBias
+{
+    ImuBias();
+    ImuBias( const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro );
+
+    Eigen::Vector3d acceleration;
+    Eigen::Vector3d gyro;
+};
+
+// On-manifold pre-integration of the IMU measurements between two frames (Forster et al.):
+// rotation, velocity and position deltas in the body frame of the first one, their covariance
+// in [ rotation, velocity, position ] order and first order Jacobians on the biases,
+// so a bias update corrects the deltas without integrating again
+class ImuPreintegration
+{
+public:
+    using Matrix9d = Eigen::Matrix< double, 9, 9 >;
+
+    ImuPreintegration();
+
+    void reset( const std::chrono::time_point< std::chrono::system_clock > &time, const ImuBias &bias );
+
+    void integrate( const Eigen::Vector3d &acceleration, const Eigen::Vector3d &gyro, const double dt );
+
+    void setNoiseDensity( const double gyro, const double acceleration );
+
+    bool isEmpty() const;
+
+    void setStartTime( const std::chrono::time_point< std::chrono::system_clock > &value );
+    const std::chrono::time_point< std::chrono::system_clock > &startTime() const;
+
+    void setFinishTime( const std::chrono::time_point< std::chrono::system_clock > &value );
+    const std::chrono::time_point< std::chrono::system_clock > &finishTime() const;
+
+    double deltaTime() const;
+
+    const ImuBias &bias() const;
+
+    const Eigen::Matrix3d &deltaRotation() const;
+    const Eigen::Vector3d &deltaVelocity() const;
+    const Eigen::Vector3d &deltaPosition() const;
+
+    const Matrix9d &covariance() const;
+
+    const Eigen::Matrix3d &rotationGyroJacobian() const;
+    const Eigen::Matrix3d &velocityGyroJacobian() const;
+    const Eigen::Matrix3d &velocityAccelerationJacobian() const;
+    const Eigen::Matrix3d &positionGyroJacobian() const;
+    const Eigen::Matrix3d &positionAccelerationJacobian() const;
+
+    Eigen::Matrix3d deltaRotation( const ImuBias &bias ) const;
+    Eigen::Vector3d deltaVelocity( const ImuBias &bias ) const;
+    Eigen::Vector3d deltaPosition( const ImuBias &bias ) const;
+
+    static Eigen::Matrix3d skew( const Eigen::Vector3d &value );
+    static Eigen::Matrix3d expMap( const Eigen::Vector3d &value );
+    static Eigen::Vector3d logMap( const Eigen::Matrix3d &value );
+    static Eigen::Matrix3d rightJacobian( const Eigen::Vector3d &value );
+
 protected:
+    std::chrono::time_point< std::chrono::system_clock > m_startTime;
+    std::chrono::time_point< std::chrono::system_clock > m_finishTime;
+
+    double m_deltaTime;
+
+    ImuBias m_bias;
+
+    double m_gyroNoiseDensity;
+    double m_accelerationNoiseDensity;
+
+    Eigen::Matrix3d m_deltaRotation;
+    Eigen::Vector3d m_deltaVelocity;
+    Eigen::Vector3d m_deltaPosition;
+
+    Matrix9d m_covariance;
+
+    Eigen::Matrix3d m_rotationGyroJacobian;
+    Eigen::Matrix3d m_velocityGyroJacobian;
+    Eigen::Matrix3d m_velocityAccelerationJacobian;
+    Eigen::Matrix3d m_positionGyroJacobian;
+    Eigen::Matrix3d m_positionAccelerationJacobian;
+
+private:
+    void initialize();
+
+};
+
+// Consumes the IMU stream and pre-integrates it between the camera timestamps.
+// addData() is the producer side of a preallocated ring and never blocks, integrate() is called by the tracking thread
+class ImuIntegrator
+{
+public:
+    ImuIntegrator();
+
+    bool addData( const ImuData &data );
+
+    // Integrates the samples up to the frame time, the sample straddling it is split
+    void integrate( const std::chrono::time_point< std::chrono::system_clock > &frameTime );
+
+    bool isActive() const;
+
+    // Since the previous frame, for the motion prediction of the tracker
+    const ImuPreintegration &framePreintegration() const;
+
+    // Since the previous key frame, for the inertial edges of the optimizer
+    const ImuPreintegration &keyFramePreintegration() const;
+    void startKeyFrame();
+
+    void setBias( const ImuBias &value );
+    const ImuBias &bias() const;
+
+    void setNoiseDensity( const double gyro, const double acceleration );
+
+    // Optional "imu" node of a calibration file: cameraRotation (body to left camera, 3x3),
+    // gyroBias and accelerationBias (3x1), gyroNoiseDensity and accelerationNoiseDensity.
+    // Missing values keep the current ones
+    bool loadParameters( const std::string &fileName );
+
+    // Rotation of the body frame vectors to the camera frame. Until it is
+    // set or loaded the body and camera axes are unknown, so nothing is predicted
+    void setCameraRotation( const Eigen::Matrix3d &value );
+    const Eigen::Matrix3d &cameraRotation() const;
+    bool hasCameraRotation() const;
+
+    // Rectification rotation of the left camera (R1), the tracked images are rectified
+    void setRectificationRotation( const Eigen::Matrix3d &value );
+    const Eigen::Matrix3d &rectificationRotation() const;
+
+    // Rotation of the body frame vectors to the rectified left camera frame
+    Eigen::Matrix3d rectifiedCameraRotation() const;
+
+    // Rotation of the rectified left camera from the previous frame to the current one, camera to world convention
+    Eigen::Matrix3d frameCameraRotation() const;
+
+    // Infinite homography of the frame rotation: previous frame pixels to the predicted current ones,
+    // empty without the camera rotation
+    cv::Mat predictionHomography( const cv::Mat &cameraMatrix ) const;
+
+    uint64_t droppedSamples() const;
+
+    void clear();
+
+protected:
+    SpscRing< ImuData > m_samplesRing;
+    std::atomic< uint64_t > m_droppedSamples;
+
+    ImuPreintegration m_framePreintegration;
+    ImuPreintegration m_keyFramePreintegration;
+
+    std::chrono::time_point< std::chrono::system_clock > m_lastTime;
+    bool m_lastTimeValid;
+
+    ImuBias m_bias;
+
+    double m_gyroNoiseDensity;
+    double m_accelerationNoiseDensity;
+
+    Eigen::Matrix3d m_cameraRotation;
+    bool m_cameraRotationValid;
+
+    Eigen::Matrix3d m_rectificationRotation;
+
+    static const size_t m_ringSize = 4096;
+
+    // Microseconds, gaps longer than that are not integrated
+    static const int64_t m_maxSampleInterval = 100000;
+
+    void integrateInterval( const ImuData &data, const std::chrono::time_point< std::chrono::system_clock > &finishTime );
+
+private:
+    void initialize();
 
 };
 
@@ -7,6 +7,14 @@
 #include "slamdialog.h"
 #include "choicedialog.h"
 
+#include "src/common/replayclock.h"
+#include "src/common/vimbacamera.h"
+#include "src/common/xsensreplay.h"
+
+#include "slamwidget.h"
+
+const QString MainWindow::m_imuPortName = "/dev/ttyUSB0";
+
 MainWindow::MainWindow( QWidget *parent )
     : DocumentMainWindow( parent )
 {
@@ -18,6 +26,8 @@ void MainWindow::initialize()
     setupActions();
     setupMenus();
     setupToolBars();
+
+    connect( m_documentArea, &QMdiArea::subWindowActivated, this, &MainWindow::updateRecordAction );
 }
 
 
@@ -36,6 +46,10 @@ void MainWindow::choiceDialog()
              addCameraSlamDialog();
              break;
 
+         case ChoiceDialog::SIMULATED_CAMERA:
+             addSimulatedCameraSlamDialog();
+             break;
+
          default:
              break;
 
@@ -50,7 +64,7 @@ void MainWindow::addImageSlamDialog()
     ImagesDialog dialog( this );
 
     if ( dialog.exec() == DialogBase::Accepted )
-        addImagesDocument( dialog.leftFileNames(), dialog.rightFileNames(), dialog.calibrationFile() );
+        addImagesDocument( dialog.leftFileNames(), dialog.rightFileNames(), dialog.calibrationFile(), dialog.recordFile() );
 }
 
 void MainWindow::addCameraSlamDialog()
@@ -58,27 +72,246 @@ void MainWindow::addCameraSlamDialog()
     CamerasDialog dialog( this );
 
     if ( dialog.exec() == DialogBase::Accepted )
-        addCamerasDocument( dialog.leftIp(), dialog.rightIp(), dialog.calibrationFile() );
+        addCamerasDocument( dialog.leftIp(), dialog.rightIp(), dialog.calibrationFile(), dialog.imuPort(), dialog.recordFile() );
+}
+
+void MainWindow::addSimulatedCameraSlamDialog()
+{
+    SimulatedCamerasDialog dialog( this );
+
+    if ( dialog.exec() == DialogBase::Accepted ) {
+        XsensReplay *replay = nullptr;
+        std::shared_ptr< ReplayClock > clock;
+
+        auto imuLogFile = dialog.imuLogFile();
+
+        if ( !imuLogFile.isEmpty() ) {
+            replay = new XsensReplay();
+
+            if ( !replay->open( imuLogFile.toStdString() ) ) {
+                QMessageBox::warning( this, tr( "Replay IMU log" ), tr( "Can't read the IMU log %1" ).arg( imuLogFile ) );
+                delete replay;
+                return;
+            }
+
+            // The log keeps its recording times, both sources are re-stamped on one clock to pair in the SLAM
+            clock = std::make_shared< ReplayClock >();
+            replay->setClock( clock );
+        }
+
+        auto camera = dialog.createCamera( clock );
+
+        if ( camera )
+            addCamerasDocument( camera, dialog.calibrationFile(), replay, dialog.recordFile() );
+        else {
+            QMessageBox::warning( this, tr( "Simulated camera" ), tr( "Can't start the simulated camera: %1" ).arg( dialog.errorString() ) );
+            delete replay;
+        }
+    }
+
 }
 
-void MainWindow::addImagesDocument( const QStringList &leftList, const QStringList &rightList, const QString &calibrationFile )
+void MainWindow::addImagesDocument( const QStringList &leftList, const QStringList &rightList, const QString &calibrationFile, const QString &recordFile )
 {
-    addDocument( new ImageSlamDocument( leftList, rightList, calibrationFile, this ) );
+    auto document = new ImageSlamDocument( leftList, rightList, calibrationFile, this );
+
+    setRecordFile( document->widget(), recordFile );
+
+    addDocument( document );
+}
+
+void MainWindow::addCamerasDocument( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile,
+                                     const QString &imuPort, const QString &recordFile )
+{
+    addCamerasDocument( new StereoCamera( leftCameraIp.toStdString(), rightCameraIp.toStdString() ), calibrationFile,
+                        imuPort.isEmpty() ? nullptr : connectXsensInterface( imuPort ), recordFile );
+}
+
+void MainWindow::addCamerasDocument( StereoCameraBase *camera, const QString &calibrationFile, XsensSource *imuSource, const QString &recordFile )
+{
+    auto document = new CameraSlamDocument( camera, calibrationFile, this );
+
+    if ( imuSource )
+        document->widget()->setImuSource( imuSource );
+
+    setRecordFile( document->widget(), recordFile );
+
+    addDocument( document );
 }
 
-void MainWindow::addCamerasDocument( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile )
+void MainWindow::setRecordFile( SlamWidgetBase *slamWidget, const QString &recordFile )
 {
-    addDocument( new CameraSlamDocument( leftCameraIp, rightCameraIp, calibrationFile, this ) );
+    if ( !recordFile.isEmpty() && !slamWidget->setRecordFile( recordFile ) )
+        QMessageBox::warning( this, tr( "Record map" ), tr( "Can't open the map file %1" ).arg( recordFile ) );
 }
 
 void MainWindow::addImuDocument()
 {
-    addDocument( new ImuDocument( "/dev/ttyUSB0", this ) );
+    addDocument( new ImuDocument( m_imuPortName, this ) );
 }
 
 void MainWindow::addImuCalibrationDocument()
 {
-    addDocument( new ImuCalibrationDocument( "/dev/ttyUSB0", this ) );
+    addDocument( new ImuCalibrationDocument( m_imuPortName, this ) );
+}
+
+void MainWindow::addImuRecordDocument()
+{
+    auto fileName = QFileDialog::getSaveFileName( this, tr( "Record IMU log" ), QString(), tr( "IMU logs (*.imulog);;All files (*)" ) );
+
+    if ( fileName.isEmpty() )
+        return;
+
+    auto xsensInterface = connectXsensInterface( m_imuPortName );
+
+    if ( !xsensInterface->setRecordFile( fileName.toStdString() ) )
+        QMessageBox::warning( this, tr( "Record IMU log" ), tr( "Can't open the log file %1" ).arg( fileName ) );
+
+    addDocument( new ImuDocument( xsensInterface, this ) );
+}
+
+void MainWindow::addImuReplayDocument()
+{
+    auto replay = createImuReplay();
+
+    if ( replay )
+        addDocument( new ImuDocument( replay, this ) );
+}
+
+void MainWindow::addImuCalibrationReplayDocument()
+{
+    auto replay = createImuReplay();
+
+    if ( replay )
+        addDocument( new ImuCalibrationDocument( replay, this ) );
+}
+
+XsensReplay *MainWindow::createImuReplay()
+{
+    auto fileName = QFileDialog::getOpenFileName( this, tr( "Replay IMU log" ), QString(), tr( "IMU logs (*.imulog);;All files (*)" ) );
+
+    if ( fileName.isEmpty() )
+        return nullptr;
+
+    bool ok;
+
+    // 1 is real time, 0 is as fast as the document takes the packets
+    auto speed = QInputDialog::getDouble( this, tr( "Replay IMU log" ), tr( "Speed:" ), 1., 0., 100., 2, &ok );
+
+    if ( !ok )
+        return nullptr;
+
+    auto ret = new XsensReplay();
+    ret->setSpeed( speed );
+
+    if ( !ret->open( fileName.toStdString() ) ) {
+        QMessageBox::warning( this, tr( "Replay IMU log" ), tr( "Can't read the IMU log %1" ).arg( fileName ) );
+        delete ret;
+        return nullptr;
+    }
+
+    return ret;
+
+}
+
+SlamWidgetBase *MainWindow::currentSlamWidget() const
+{
+    auto document = currentDocument();
+
+    return document ? dynamic_cast< SlamWidgetBase * >( document->widget() ) : nullptr;
+}
+
+SlamCameraWidget *MainWindow::currentSlamCameraWidget() const
+{
+    return dynamic_cast< SlamCameraWidget * >( currentSlamWidget() );
+}
+
+void MainWindow::saveMapDialog()
+{
+    auto slamWidget = currentSlamWidget();
+
+    if ( !slamWidget )
+        return;
+
+    auto fileName = QFileDialog::getSaveFileName( this, tr( "Save map" ), QString(), tr( "Maps (*.map);;All files (*)" ) );
+
+    if ( !fileName.isEmpty() && !slamWidget->saveMap( fileName ) )
+        QMessageBox::warning( this, tr( "Save map" ), tr( "Can't save the map to %1 or read it back" ).arg( fileName ) );
+}
+
+void MainWindow::loadMapDialog()
+{
+    auto slamWidget = currentSlamWidget();
+
+    if ( !slamWidget )
+        return;
+
+    auto fileName = QFileDialog::getOpenFileName( this, tr( "Load map" ), QString(), tr( "Maps (*.map);;All files (*)" ) );
+
+    if ( !fileName.isEmpty() && !slamWidget->loadMap( fileName ) )
+        QMessageBox::warning( this, tr( "Load map" ), tr( "Can't read the map %1" ).arg( fileName ) );
+}
+
+void MainWindow::exportMapDialog()
+{
+    auto slamWidget = currentSlamWidget();
+
+    if ( !slamWidget )
+        return;
+
+    auto fileName = QFileDialog::getSaveFileName( this, tr( "Export map" ), QString(), tr( "PLY point clouds (*.ply);;PCD point clouds (*.pcd)" ) );
+
+    if ( !fileName.isEmpty() && !slamWidget->exportMap( fileName ) )
+        QMessageBox::warning( this, tr( "Export map" ), tr( "Can't export the map to %1" ).arg( fileName ) );
+}
+
+void MainWindow::memorySettingsDialog()
+{
+    auto slamWidget = currentSlamWidget();
+
+    if ( !slamWidget )
+        return;
+
+    MemorySettingsDialog dialog( this );
+
+    dialog.setMemoryBudget( slamWidget->memoryBudget() );
+    dialog.setRedundantKeyFrameRatio( slamWidget->redundantKeyFrameRatio() );
+    dialog.setSpillFile( slamWidget->spillFile() );
+
+    if ( dialog.exec() == DialogBase::Accepted ) {
+        slamWidget->setMemoryBudget( dialog.memoryBudget() );
+        slamWidget->setRedundantKeyFrameRatio( dialog.redundantKeyFrameRatio() );
+
+        if ( dialog.spillFile() != slamWidget->spillFile() && !slamWidget->setSpillFile( dialog.spillFile() ) )
+            QMessageBox::warning( this, tr( "Memory settings" ), tr( "Can't open the spill file %1" ).arg( dialog.spillFile() ) );
+    }
+
+}
+
+void MainWindow::recordStereo( bool checked )
+{
+    auto slamWidget = currentSlamCameraWidget();
+
+    if ( slamWidget && checked ) {
+
+        auto folder = QFileDialog::getExistingDirectory( this, tr( "Record stereo" ) );
+
+        if ( !folder.isEmpty() && !slamWidget->startRecording( folder ) )
+            QMessageBox::warning( this, tr( "Record stereo" ), tr( "Can't record the stereo pairs or the IMU log to %1" ).arg( folder ) );
+
+    }
+    else if ( slamWidget )
+        slamWidget->stopRecording();
+
+    updateRecordAction();
+}
+
+void MainWindow::updateRecordAction()
+{
+    auto slamWidget = currentSlamCameraWidget();
+
+    m_recordStereoAction->setEnabled( slamWidget != nullptr );
+    m_recordStereoAction->setChecked( slamWidget && slamWidget->isRecording() );
 }
 
 void MainWindow::setupActions()
@@ -86,6 +319,16 @@ void MainWindow::setupActions()
     m_newSlamDocumentAction = new QAction( QIcon( ":/resources/images/new.ico" ), tr( "New SLAM document" ), this );
     m_newImuDocumentAction = new QAction( QIcon( ":/resources/images/map.ico" ), tr( "New IMU document" ), this );
     m_newImuCalibrationDocumentAction = new QAction( QIcon( ":/resources/images/calibration.ico" ), tr( "New IMU calibration document" ), this );
+    m_recordImuDocumentAction = new QAction( QIcon( ":/resources/images/map.ico" ), tr( "New IMU document with log recording" ), this );
+    m_replayImuDocumentAction = new QAction( QIcon( ":/resources/images/map.ico" ), tr( "Replay IMU log" ), this );
+    m_replayImuCalibrationDocumentAction = new QAction( QIcon( ":/resources/images/calibration.ico" ), tr( "Replay IMU log for calibration" ), this );
+    m_saveMapAction = new QAction( QIcon( ":/resources/images/save.ico" ), tr( "Save map" ), this );
+    m_loadMapAction = new QAction( QIcon( ":/resources/images/open.ico" ), tr( "Load map" ), this );
+    m_exportMapAction = new QAction( QIcon( ":/resources/images/export.ico" ), tr( "Export map" ), this );
+    m_memorySettingsAction = new QAction( QIcon( ":/resources/images/settings.ico" ), tr( "Memory settings" ), this );
+    m_recordStereoAction = new QAction( QIcon( ":/resources/images/camera.ico" ), tr( "Record stereo" ), this );
+    m_recordStereoAction->setCheckable( true );
+    m_recordStereoAction->setEnabled( false );
 
     m_exitAction = new QAction( QIcon( ":/resources/images/power.ico" ), tr( "Exit" ), this );
     m_aboutAction = new QAction( QIcon( ":/resources/images/help.ico" ), tr( "About" ), this );
@@ -93,6 +336,14 @@ void MainWindow::setupActions()
     connect( m_newSlamDocumentAction, &QAction::triggered, this, &MainWindow::choiceDialog );
     connect( m_newImuDocumentAction, &QAction::triggered, this, &MainWindow::addImuDocument );
     connect( m_newImuCalibrationDocumentAction, &QAction::triggered, this, &MainWindow::addImuCalibrationDocument );
+    connect( m_recordImuDocumentAction, &QAction::triggered, this, &MainWindow::addImuRecordDocument );
+    connect( m_replayImuDocumentAction, &QAction::triggered, this, &MainWindow::addImuReplayDocument );
+    connect( m_replayImuCalibrationDocumentAction, &QAction::triggered, this, &MainWindow::addImuCalibrationReplayDocument );
+    connect( m_saveMapAction, &QAction::triggered, this, &MainWindow::saveMapDialog );
+    connect( m_loadMapAction, &QAction::triggered, this, &MainWindow::loadMapDialog );
+    connect( m_exportMapAction, &QAction::triggered, this, &MainWindow::exportMapDialog );
+    connect( m_memorySettingsAction, &QAction::triggered, this, &MainWindow::memorySettingsDialog );
+    connect( m_recordStereoAction, &QAction::triggered, this, &MainWindow::recordStereo );
     connect( m_exitAction, &QAction::triggered, this, &MainWindow::close );
 }
 
@@ -105,8 +356,20 @@ void MainWindow::setupMenus()
     fileMenu->addAction( m_newImuDocumentAction );
     fileMenu->addAction( m_newImuCalibrationDocumentAction );
     fileMenu->addSeparator();
+    fileMenu->addAction( m_recordImuDocumentAction );
+    fileMenu->addAction( m_replayImuDocumentAction );
+    fileMenu->addAction( m_replayImuCalibrationDocumentAction );
+    fileMenu->addSeparator();
+    fileMenu->addAction( m_saveMapAction );
+    fileMenu->addAction( m_loadMapAction );
+    fileMenu->addAction( m_exportMapAction );
+    fileMenu->addSeparator();
     fileMenu->addAction( m_exitAction );
 
+    auto actionsMenu = m_menuBar->addMenu( tr( "Actions" ) );
+    actionsMenu->addAction( m_memorySettingsAction );
+    actionsMenu->addAction( m_recordStereoAction );
+
     auto helpMenu = m_menuBar->addMenu( tr( "Help" ) );
     helpMenu->addAction( m_aboutAction );
 
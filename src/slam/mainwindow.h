@@ -4,6 +4,12 @@
 
 #include "src/common/supportwidgets.h"
 
+class SlamCameraWidget;
+class SlamWidgetBase;
+class StereoCameraBase;
+class XsensReplay;
+class XsensSource;
+
 class MainWindow : public DocumentMainWindow
 {
     Q_OBJECT
@@ -16,11 +22,29 @@ public slots:
 
     void addImageSlamDialog();
     void addCameraSlamDialog();
+    void addSimulatedCameraSlamDialog();
+
+    void saveMapDialog();
+    void loadMapDialog();
+    void exportMapDialog();
+
+    void memorySettingsDialog();
+
+    void recordStereo( bool checked );
+    void updateRecordAction();
 
 protected:
     QPointer< QAction > m_newSlamDocumentAction;
     QPointer< QAction > m_newImuDocumentAction;
     QPointer< QAction > m_newImuCalibrationDocumentAction;
+    QPointer< QAction > m_recordImuDocumentAction;
+    QPointer< QAction > m_replayImuDocumentAction;
+    QPointer< QAction > m_replayImuCalibrationDocumentAction;
+    QPointer< QAction > m_saveMapAction;
+    QPointer< QAction > m_loadMapAction;
+    QPointer< QAction > m_exportMapAction;
+    QPointer< QAction > m_memorySettingsAction;
+    QPointer< QAction > m_recordStereoAction;
     QPointer< QAction > m_exitAction;
     QPointer< QAction > m_aboutAction;
 
@@ -28,10 +52,24 @@ protected:
 
     QPointer< QToolBar > m_toolBar;
 
-    void addImagesDocument( const QStringList &leftList, const QStringList &rightList, const QString &calibrationFile );
-    void addCamerasDocument( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile );
+    void addImagesDocument( const QStringList &leftList, const QStringList &rightList, const QString &calibrationFile, const QString &recordFile = QString() );
+    void addCamerasDocument( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile,
+                             const QString &imuPort = QString(), const QString &recordFile = QString() );
+    void addCamerasDocument( StereoCameraBase *camera, const QString &calibrationFile, XsensSource *imuSource = nullptr, const QString &recordFile = QString() );
+
+    void setRecordFile( SlamWidgetBase *slamWidget, const QString &recordFile );
     void addImuDocument();
     void addImuCalibrationDocument();
+    void addImuRecordDocument();
+    void addImuReplayDocument();
+    void addImuCalibrationReplayDocument();
+
+    XsensReplay *createImuReplay();
+
+    SlamWidgetBase *currentSlamWidget() const;
+    SlamCameraWidget *currentSlamCameraWidget() const;
+
+    static const QString m_imuPortName;
 
     void setupActions();
     void setupMenus();
@@ -10,6 +10,7 @@
 
 #include "src/common/defs.h"
 #include "src/common/functions.h"
+#include "src/common/profiler.h"
 
 #include <opencv2/sfm.hpp>
 
@@ -81,6 +82,39 @@ const std::list< StereoFramePtr > &Map::frames() const
     return m_frames;
 }
 
+void Map::removeFrame( const StereoFramePtr &frame )
+{
+    if ( !frame )
+        return;
+
+    std::vector< MonoFramePtr > monoFrames = { frame->leftFrame(), frame->rightFrame() };
+
+    for ( auto &monoFrame : monoFrames ) {
+
+        if ( monoFrame ) {
+
+            for ( auto &i : monoFrame->framePoints() ) {
+
+                if ( i ) {
+
+                    auto mapPoint = i->mapPoint();
+
+                    if ( mapPoint )
+                        mapPoint->removeFramePoint( i );
+
+                    i->dissolve();
+
+                }
+
+            }
+
+        }
+
+    }
+
+    m_frames.remove( frame );
+}
+
 const StereoFramePtr &Map::backFrame() const
 {
     return m_frames.back();
@@ -154,6 +188,11 @@ bool Map::isRudimental() const
     return m_frames.size() <= 1;
 }
 
+const StereoCameraMatrix &Map::projectionMatrix() const
+{
+    return m_projectionMatrix;
+}
+
 StereoCameraMatrix Map::backProjectionMatrix() const
 {
     for ( auto i = m_frames.rbegin(); i != m_frames.rend(); ++i ) {
@@ -187,6 +226,10 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
         frame->setProjectionMatrix( m_projectionMatrix );
         m_frames.push_back( frame );
 
+        // Empty pre-integration finishing now, the next key frame's one starts where it ends
+        parentWorld()->imuIntegrator().startKeyFrame();
+        frame->setImuPreintegration( parentWorld()->imuIntegrator().keyFramePreintegration() );
+
         return true;
 
     }
@@ -199,25 +242,68 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
         auto previousFrame = std::dynamic_pointer_cast< FlowStereoFrame >( m_frames.back() );
         auto previousKeyFrame = std::dynamic_pointer_cast< FlowDenseFrame >( m_frames.back() );
 
+        // Gyro rotation since the previous frame moves the flow search start, empty without an IMU
+        auto prediction = parentWorld()->imuIntegrator().predictionHomography( m_projectionMatrix.leftProjectionMatrix().cameraMatrix() );
+
         if ( previousKeyFrame ) {
 
             auto previousLeftFrame = previousKeyFrame->leftFrame();
+            auto previousRightFrame = previousKeyFrame->rightFrame();
             auto leftFrame = frame->leftFrame();
 
-            previousLeftFrame->extractPoints();
+            std::vector< FlowTrackResult > stereoPoints;
+            std::vector< FlowTrackResult > trackedPoints;
+
+            // Dependency tokens for the task graph below
+            char extracted, previousLeftPyramid, previousRightPyramid, leftPyramid;
+
+            // Point extraction and pyramid builds are independent, stereo
+            // match and temporal track only read the key frame. Links are
+            // applied afterwards in the serial order, so the result does not
+            // depend on the schedule. The extraction and KLT kernels split
+            // into tasks of this region, so the team is not nested.
+            #pragma omp parallel if( parentWorld()->flowTracker()->isConcurrent() )
+            #pragma omp single
+            {
+                #pragma omp task depend( out: extracted )
+                previousLeftFrame->extractPoints();
+
+                #pragma omp task depend( out: previousLeftPyramid )
+                if ( previousLeftFrame->imagePyramid().empty() )
+                    previousLeftFrame->buildPyramid();
+
+                #pragma omp task depend( out: previousRightPyramid )
+                if ( previousRightFrame->imagePyramid().empty() )
+                    previousRightFrame->buildPyramid();
+
+                #pragma omp task depend( out: leftPyramid )
+                if ( leftFrame->imagePyramid().empty() )
+                    leftFrame->buildPyramid();
 
-            std::cout << "Extracted points count: " << previousLeftFrame->flowPointsCount() << std::endl;
+                #pragma omp task depend( in: extracted, previousLeftPyramid, previousRightPyramid )
+                previousKeyFrame->computeMatch( &stereoPoints );
 
-            previousKeyFrame->match();
-            slam::track( previousLeftFrame, leftFrame );
+                #pragma omp task depend( in: extracted, previousLeftPyramid, leftPyramid )
+                slam::computeTrack( previousLeftFrame, leftFrame, &trackedPoints, prediction );
 
-            std::cout << "Stereo points count: " << previousKeyFrame->stereoPointsCount() << std::endl;
+            }
+
+            PROFILE_COUNTER( "extracted points", previousLeftFrame->flowPointsCount() );
+
+            previousKeyFrame->applyMatch( stereoPoints );
+            slam::applyTrack( previousLeftFrame, leftFrame, trackedPoints );
+
+            PROFILE_COUNTER( "stereo points", previousKeyFrame->stereoPointsCount() );
 
             auto trackedPointCount = previousLeftFrame->trackedPointsCount();
 
-            previousKeyFrame->triangulatePoints();
+            {
+                PROFILE_SCOPE( "triangulation" );
+
+                previousKeyFrame->triangulatePoints();
+            }
 
-            std::cout << "Tracked points count: " << trackedPointCount << std::endl;
+            PROFILE_COUNTER( "tracked points", trackedPointCount );
 
             previousLeftFrame->cleanMapPoints();
 
@@ -230,7 +316,7 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
             auto previousLeftFrame = previousFrame->leftFrame();
             auto leftFrame = frame->leftFrame();
 
-            slam::track( previousLeftFrame, leftFrame );
+            slam::track( previousLeftFrame, leftFrame, prediction );
 
             auto trackedPointsCount = previousLeftFrame->trackedPointsCount();
 
@@ -239,6 +325,8 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
             auto replacedFrame = FinishedStereoFrame::create( shared_from_this() );
             replacedFrame->replaceAndClean( previousFrame );
 
+            previousFrame->clearPyramid();
+
             m_frames.back() = replacedFrame;
 
             if ( trackedPointsCount < m_minTrackPoints )
@@ -266,7 +354,7 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
 
                 auto inliersRatio = recoverFrame.recoverPose( &recoveredPose );
 
-                std::cout << "Inliers ratio: " << inliersRatio << std::endl;
+                PROFILE_COUNTER( "inliers ratio", inliersRatio );
 
                 if ( inliersRatio > minTrackInliersRatio /*|| adjacentFrame.mapPoints().size() < m_minTrackPoints*/ ) {
 
@@ -274,6 +362,9 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
 
                     newKeyFrame->replace( frame );
 
+                    newKeyFrame->setImuPreintegration( parentWorld()->imuIntegrator().keyFramePreintegration() );
+                    parentWorld()->imuIntegrator().startKeyFrame();
+
                     auto leftFrame = newKeyFrame->leftFrame();
                     auto rightFrame = newKeyFrame->rightFrame();
 
@@ -293,11 +384,15 @@ bool Map::track( const StampedImage &leftImage, const StampedImage &rightImage )
                     auto replacedFrame = FinishedStereoKeyFrame::create( shared_from_this() );
                     replacedFrame->replaceAndClean( keyFrame );
 
+                    keyFrame->clearPyramid();
+
                     auto it = std::find( m_frames.begin(), m_frames.end(), keyFrame );
 
                     if ( it != m_frames.end() )
                         *it = replacedFrame;
 
+                    parentWorld()->recordKeyFrame( shared_from_this(), replacedFrame );
+
                     keyFrame = newKeyFrame;
 
                     return true;
@@ -21,6 +21,8 @@ class World;
 
 class Map : public std::enable_shared_from_this< Map >
 {
+    friend class MapReader;
+
 public:
     using ObjectPtr = std::shared_ptr< Map >;
     using ObjectConstPtr = std::shared_ptr< const Map >;
@@ -45,10 +47,12 @@ public:
     const std::set< MapPointPtr > &mapPoints() const;
 
     const std::list< StereoFramePtr > &frames() const;
+    void removeFrame( const StereoFramePtr &frame );
     const StereoFramePtr &backFrame() const;
 
     bool isRudimental() const;
 
+    const StereoCameraMatrix &projectionMatrix() const;
     StereoCameraMatrix backProjectionMatrix() const;
 
     bool track( const StampedImage &leftImage, const StampedImage &rightImage );
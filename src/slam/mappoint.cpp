@@ -5,12 +5,15 @@
 #include "mappoint.h"
 
 #include "framepoint.h"
+#include "frame.h"
 
 #include "optimizer.h"
 
 namespace slam {
 
 // MapPoint
+std::atomic< size_t > MapPoint::m_currentId( 1 );
+
 MapPoint::MapPoint( const MapPtr &parentMap, const cv::Point3d &point, const cv::Scalar &color )
     : ColorPoint3d( point, color ), m_parentMap( parentMap )
 {
@@ -19,6 +22,7 @@ MapPoint::MapPoint( const MapPtr &parentMap, const cv::Point3d &point, const cv:
 
 void MapPoint::initialize()
 {
+    m_id = m_currentId++;
 }
 
 MapPoint::ObjectPtr MapPoint::create( const MapPtr &parentMap, const cv::Point3d &point, const cv::Scalar &color)
@@ -26,6 +30,11 @@ MapPoint::ObjectPtr MapPoint::create( const MapPtr &parentMap, const cv::Point3d
     return ObjectPtr( new MapPoint( parentMap, point, color ) );
 }
 
+size_t MapPoint::id() const
+{
+    return m_id;
+}
+
 void MapPoint::setEigenPoint( const Eigen::Matrix< double, 3, 1 > &value )
 {
     cv::Point3d point;
@@ -81,6 +90,45 @@ bool MapPoint::isFramePoint( const MonoPointPtr &value ) const
 
 }
 
+size_t MapPoint::framePointsCount() const
+{
+    size_t ret = 0;
+
+    for ( auto &i : m_framePoints )
+        if ( !i.expired() )
+            ++ret;
+
+    return ret;
+}
+
+size_t MapPoint::keyFrameObservationsCount() const
+{
+    size_t ret = 0;
+
+    std::set< MonoPointPtr > counted;
+
+    for ( auto &i : m_framePoints ) {
+
+        auto framePoint = i.lock();
+
+        if ( framePoint && !counted.count( framePoint ) && std::dynamic_pointer_cast< MonoKeyFrame >( framePoint->parentFrame() ) ) {
+
+            ++ret;
+
+            counted.insert( framePoint );
+
+            auto stereoPoint = framePoint->stereoPoint();
+
+            if ( stereoPoint )
+                counted.insert( stereoPoint );
+
+        }
+
+    }
+
+    return ret;
+}
+
 bool MapPoint::isLastFramePoint( const MonoPointPtr &value ) const
 {
     if ( !m_framePoints.empty() )
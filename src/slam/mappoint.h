@@ -2,6 +2,8 @@
 
 #include <opencv2/opencv.hpp>
 
+#include <atomic>
+
 #include <Eigen/Core>
 
 #include "src/common/colorpoint.h"
@@ -21,11 +23,18 @@ public:
 
     static ObjectPtr create( const MapPtr &parentMap, const cv::Point3d &point, const cv::Scalar &color );
 
+    size_t id() const;
+
     void addFramePoint( const MonoPointPtr &value );
     void removeFramePoint( const MonoPointPtr &value );
 
     bool isFramePoint( const MonoPointPtr &value ) const;
 
+    size_t framePointsCount() const;
+
+    // Observations from key frames, a stereo pair counts once
+    size_t keyFrameObservationsCount() const;
+
     bool isLastFramePoint( const MonoPointPtr &value ) const;
 
     void setEigenPoint( const Eigen::Matrix< double, 3, 1 > &value );
@@ -38,6 +47,10 @@ protected:
 
     MapPtr m_parentMap;
 
+    size_t m_id;
+
+    static std::atomic< size_t > m_currentId;
+
     std::list< FramePointPtrImpl > m_framePoints;
 
 private:
@@ -0,0 +1,284 @@
+#include "src/common/precompiled.h"
+
+#include "memorymanager.h"
+
+#include "map.h"
+#include "frame.h"
+#include "framepoint.h"
+#include "mappoint.h"
+#include "settings.h"
+#include "storage.h"
+
+namespace slam {
+
+size_t imageSize( const cv::Mat &image )
+{
+    return image.total() * image.elemSize();
+}
+
+size_t imageSize( const ProcessedFramePtr &frame )
+{
+    size_t ret = 0;
+
+    if ( frame ) {
+
+        ret += imageSize( frame->image() );
+
+        for ( auto &i : frame->imagePyramid() )
+            ret += imageSize( i );
+
+    }
+
+    return ret;
+}
+
+// MemoryManager
+MemoryManager::MemoryManager() = default;
+
+MemoryManager::~MemoryManager() = default;
+
+bool MemoryManager::setSpillFile( const std::string &fileName )
+{
+    if ( fileName.empty() ) {
+        m_spillWriter.reset();
+        return true;
+    }
+
+    auto writer = std::unique_ptr< MapWriter >( new MapWriter() );
+
+    if ( !writer->open( fileName, true ) )
+        return false;
+
+    m_spillWriter = std::move( writer );
+
+    return true;
+}
+
+void MemoryManager::process( const std::list< MapPtr > &maps, const Settings &settings )
+{
+    auto window = std::max< size_t >( settings.trackingWindow(), 1 );
+
+    for ( auto &i : maps ) {
+
+        evictImages( i, window );
+
+        if ( settings.redundantKeyFrameRatio() > 0. )
+            cullKeyFrames( i, window, settings.redundantKeyFrameRatio(), settings.redundantKeyFrameObservations() );
+
+    }
+
+    auto budget = settings.memoryBudget();
+
+    if ( m_spillWriter && budget > 0 )
+        spillFrames( maps, window, budget );
+
+}
+
+size_t MemoryManager::memoryUsage( const std::list< MapPtr > &maps )
+{
+    size_t ret = 0;
+
+    for ( auto &i : maps )
+        ret += memoryUsage( i );
+
+    return ret;
+}
+
+size_t MemoryManager::memoryUsage( const MapPtr &map )
+{
+    size_t ret = 0;
+
+    if ( map ) {
+
+        ret += map->mapPoints().size() * m_mapPointSize;
+
+        for ( auto &i : map->frames() )
+            ret += memoryUsage( i );
+
+    }
+
+    return ret;
+}
+
+size_t MemoryManager::memoryUsage( const StereoFramePtr &frame )
+{
+    size_t ret = 0;
+
+    if ( frame ) {
+
+        std::vector< MonoFramePtr > monoFrames = { frame->leftFrame(), frame->rightFrame() };
+
+        for ( auto &i : monoFrames ) {
+
+            if ( i ) {
+                ret += i->framePointsCount() * m_framePointSize;
+                ret += imageSize( std::dynamic_pointer_cast< ProcessedFrame >( i ) );
+            }
+
+        }
+
+    }
+
+    return ret;
+}
+
+void MemoryManager::evictImages( const MapPtr &map, const size_t window )
+{
+    if ( !map )
+        return;
+
+    auto &frames = map->frames();
+
+    size_t counter = 0;
+
+    // The back frame is the source of the next optical flow step, so only
+    // it keeps a pyramid; images are kept for the drawing window.
+    for ( auto i = frames.rbegin(); i != frames.rend(); ++i, ++counter ) {
+
+        if ( counter > 0 ) {
+
+            auto flowFrame = std::dynamic_pointer_cast< FlowStereoFrame >( *i );
+
+            if ( flowFrame )
+                flowFrame->clearPyramid();
+
+        }
+
+        if ( counter >= window ) {
+
+            auto processedFrame = std::dynamic_pointer_cast< ProcessedStereoFrame >( *i );
+
+            if ( processedFrame )
+                processedFrame->clearImages();
+
+        }
+
+    }
+
+}
+
+bool MemoryManager::isRedundant( const StereoKeyFramePtr &frame, const double ratio, const size_t observations )
+{
+    auto leftFrame = frame->leftFrame();
+
+    if ( !leftFrame )
+        return false;
+
+    size_t mapPointsCount = 0;
+    size_t observedCount = 0;
+
+    for ( auto &i : leftFrame->framePoints() ) {
+
+        if ( i ) {
+
+            auto mapPoint = i->mapPoint();
+
+            if ( mapPoint ) {
+
+                ++mapPointsCount;
+
+                // Consecutive frames see every point of the key frame, only other key frames make it redundant
+                if ( mapPoint->keyFrameObservationsCount() >= observations + 1 )
+                    ++observedCount;
+
+            }
+
+        }
+
+    }
+
+    return mapPointsCount > 0 && observedCount >= ratio * mapPointsCount;
+}
+
+void MemoryManager::cullKeyFrames( const MapPtr &map, const size_t window, const double ratio, const size_t observations )
+{
+    if ( !map )
+        return;
+
+    auto frames = map->frames();
+
+    if ( frames.size() <= window )
+        return;
+
+    auto begin = frames.rbegin();
+    std::advance( begin, window );
+
+    size_t counter = 0;
+
+    // Only the newest key frames outside the window are checked, older ones
+    // had their chance while their observations were accumulated
+    for ( auto i = begin; i != frames.rend() && counter < m_cullingDepth; ++i ) {
+
+        auto keyFrame = std::dynamic_pointer_cast< FinishedStereoKeyFrame >( *i );
+
+        if ( keyFrame ) {
+
+            ++counter;
+
+            // The first key frame anchors the map. Without a spill file a
+            // redundant frame is dropped, other key frames see its points
+            if ( keyFrame != frames.front() && isRedundant( keyFrame, ratio, observations ) ) {
+
+                if ( m_spillWriter )
+                    spillFrame( map, keyFrame );
+                else
+                    map->removeFrame( keyFrame );
+
+            }
+
+        }
+
+    }
+
+}
+
+void MemoryManager::spillFrames( const std::list< MapPtr > &maps, const size_t window, const size_t budget )
+{
+    auto usage = memoryUsage( maps );
+
+    for ( auto &map : maps ) {
+
+        if ( usage <= budget )
+            break;
+
+        if ( !map )
+            continue;
+
+        auto frames = map->frames();
+
+        auto count = map == maps.back() ? frames.size() - std::min( window, frames.size() ) : frames.size();
+
+        auto it = frames.begin();
+
+        for ( size_t i = 0; i < count && usage > budget; ++i, ++it ) {
+
+            // Only key frames can be stored, ordinary frames stay for the path
+            auto finishedKeyFrame = std::dynamic_pointer_cast< FinishedStereoKeyFrame >( *it );
+
+            if ( finishedKeyFrame ) {
+
+                auto frameUsage = memoryUsage( *it );
+
+                if ( spillFrame( map, finishedKeyFrame ) )
+                    usage -= std::min( usage, frameUsage );
+
+            }
+
+        }
+
+    }
+
+}
+
+bool MemoryManager::spillFrame( const MapPtr &map, const StereoKeyFramePtr &frame )
+{
+    // A frame leaves the map only once it is stored
+    if ( !m_spillWriter || !m_spillWriter->writeKeyFrame( map, frame ) )
+        return false;
+
+    map->removeFrame( frame );
+
+    return true;
+}
+
+}
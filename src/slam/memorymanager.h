@@ -0,0 +1,54 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <string>
+
+#include "alias.h"
+
+namespace slam {
+
+class MapWriter;
+class Settings;
+
+// Keeps long runs inside the configured memory budget: images and
+// pyramids are released once frames leave the tracking window and
+// redundant key frames are culled. With a spill file set, culled key
+// frames are written to it and, while the budget is exceeded, the oldest
+// finished key frames are written to the spill file and dropped; only
+// redundant key frames leave the map without being written.
+class MemoryManager
+{
+public:
+    MemoryManager();
+    ~MemoryManager();
+
+    bool setSpillFile( const std::string &fileName );
+
+    void process( const std::list< MapPtr > &maps, const Settings &settings );
+
+    static size_t memoryUsage( const std::list< MapPtr > &maps );
+    static size_t memoryUsage( const MapPtr &map );
+    static size_t memoryUsage( const StereoFramePtr &frame );
+
+protected:
+    std::unique_ptr< MapWriter > m_spillWriter;
+
+    static const size_t m_framePointSize = 256;
+    static const size_t m_mapPointSize = 192;
+
+    static const size_t m_cullingDepth = 10;
+
+    void evictImages( const MapPtr &map, const size_t window );
+
+    void cullKeyFrames( const MapPtr &map, const size_t window, const double ratio, const size_t observations );
+
+    void spillFrames( const std::list< MapPtr > &maps, const size_t window, const size_t budget );
+
+    bool spillFrame( const MapPtr &map, const StereoKeyFramePtr &frame );
+
+    static bool isRedundant( const StereoKeyFramePtr &frame, const double ratio, const size_t observations );
+
+};
+
+}
@@ -7,18 +7,100 @@
 #include "frame.h"
 #include "mappoint.h"
 
-#include <g2o/types/sba/types_six_dof_expmap.h>
+#include "world.h"
+
+#include "src/common/profiler.h"
 
 namespace slam {
 
+// EdgeInertialRotation
+EdgeInertialRotation::EdgeInertialRotation()
+{
+}
+
+bool EdgeInertialRotation::read( std::istream &stream )
+{
+    for ( int i = 0; i < 3; ++i )
+        for ( int j = 0; j < 3; ++j )
+            stream >> _measurement( i, j );
+
+    return readInformationMatrix( stream );
+}
+
+bool EdgeInertialRotation::write( std::ostream &stream ) const
+{
+    for ( int i = 0; i < 3; ++i )
+        for ( int j = 0; j < 3; ++j )
+            stream << _measurement( i, j ) << " ";
+
+    return writeInformationMatrix( stream );
+}
+
+void EdgeInertialRotation::computeError()
+{
+    auto firstVertex = static_cast< const g2o::VertexSE3Expmap * >( _vertices[ 0 ] );
+    auto secondVertex = static_cast< const g2o::VertexSE3Expmap * >( _vertices[ 1 ] );
+
+    Eigen::Matrix3d firstRotation = firstVertex->estimate().rotation().toRotationMatrix();
+    Eigen::Matrix3d secondRotation = secondVertex->estimate().rotation().toRotationMatrix();
+
+    _error = ImuPreintegration::logMap( _measurement.transpose() * firstRotation * secondRotation.transpose() );
+}
+
+// Optimizer
+const double Optimizer::m_gyroBiasSigma = 1.e-3;
+
 Optimizer::Optimizer()
 {
 }
 
+std::shared_ptr< EdgeInertialRotation > Optimizer::createInertialEdge( const StereoKeyFramePtr &previousFrame, const StereoKeyFramePtr &frame ) const
+{
+    if ( !previousFrame || !frame )
+        return nullptr;
+
+    auto &preintegration = frame->imuPreintegration();
+
+    // Only key frames the pre-integration runs between without a gap
+    if ( preintegration.isEmpty() || preintegration.startTime() != previousFrame->imuPreintegration().finishTime() )
+        return nullptr;
+
+    auto world = frame->parentWorld();
+
+    if ( !world )
+        return nullptr;
+
+    auto &imuIntegrator = world->imuIntegrator();
+
+    // Without the extrinsic the body rotation can't be expressed in the camera frame
+    if ( !imuIntegrator.hasCameraRotation() )
+        return nullptr;
+
+    // Key frame poses are in the rectified left camera frame
+    Eigen::Matrix3d cameraRotation = imuIntegrator.rectifiedCameraRotation();
+
+    // The deltas are corrected to the current bias through the pre-integration Jacobians
+    Eigen::Matrix3d rotationJacobian = preintegration.rotationGyroJacobian();
+
+    Eigen::Matrix3d covariance = preintegration.covariance().block< 3, 3 >( 0, 0 )
+                                 + m_gyroBiasSigma * m_gyroBiasSigma * rotationJacobian * rotationJacobian.transpose();
+
+    Eigen::Matrix3d cameraCovariance = cameraRotation * covariance * cameraRotation.transpose();
+
+    auto edge = std::shared_ptr< EdgeInertialRotation >( new EdgeInertialRotation() );
+    edge->setMeasurement( cameraRotation * preintegration.deltaRotation( imuIntegrator.bias() ) * cameraRotation.transpose() );
+    edge->setInformation( cameraCovariance.inverse() );
+
+    return edge;
+
+}
+
 void Optimizer::adjust( std::list<StereoKeyFramePtr> &frames )
 {    
     if ( frames.size() > 1 ) {
 
+        PROFILE_SCOPE( "bundle adjustment" );
+
         g2o::SparseOptimizer optimizer;
         auto linearSolver = g2o::make_unique< g2o::LinearSolverEigen< g2o::BlockSolver_6_3::PoseMatrixType > >();
         auto solver = g2o::make_unique< g2o::OptimizationAlgorithmLevenberg >( g2o::make_unique< g2o::BlockSolver_6_3 >( std::move( linearSolver ) ) );
@@ -136,6 +218,36 @@ void Optimizer::adjust( std::list<StereoKeyFramePtr> &frames )
 
         }
 
+        std::list< std::shared_ptr< EdgeInertialRotation > > inertialEdges;
+
+        StereoKeyFramePtr previousFrame;
+
+        for ( auto &i : frames ) {
+
+            auto it = framesMap.find( i );
+
+            if ( it != framesMap.end() ) {
+
+                auto inertialEdge = createInertialEdge( previousFrame, i );
+
+                if ( inertialEdge ) {
+                    inertialEdges.push_back( inertialEdge );
+
+                    inertialEdge->setVertex( 0, framesMap[ previousFrame ].get() );
+                    inertialEdge->setVertex( 1, it->second.get() );
+
+                    optimizer.addEdge( inertialEdge.get() );
+
+                }
+
+                previousFrame = i;
+
+            }
+
+        }
+
+        PROFILE_COUNTER( "inertial edges", inertialEdges.size() );
+
         optimizer.initializeOptimization();
         optimizer.optimize( m_optimizationsCount );
 
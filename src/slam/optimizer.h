@@ -8,11 +8,29 @@
 #include <g2o/solvers/eigen/linear_solver_eigen.h>
 #include <g2o/core/block_solver.h>
 #include <g2o/core/solver.h>
+#include <g2o/core/base_binary_edge.h>
+#include <g2o/types/sba/types_six_dof_expmap.h>
 
 #include "alias.h"
 
 namespace slam {
 
+// Relative rotation of two key frames from the gyro pre-integration: the measurement is
+// the second camera rotation in the first camera frame, vertices hold world to camera poses
+class EdgeInertialRotation : public g2o::BaseBinaryEdge< 3, Eigen::Matrix3d, g2o::VertexSE3Expmap, g2o::VertexSE3Expmap >
+{
+public:
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+    EdgeInertialRotation();
+
+    virtual bool read( std::istream &stream ) override;
+    virtual bool write( std::ostream &stream ) const override;
+
+    virtual void computeError() override;
+
+};
+
 class Optimizer
 {
 public:
@@ -23,6 +41,11 @@ public:
 protected:
     static const int m_optimizationsCount = 10;
 
+    // Gyro bias left after the static calibration, rad/s; it is not estimated, so it widens the inertial edges
+    static const double m_gyroBiasSigma;
+
+    std::shared_ptr< EdgeInertialRotation > createInertialEdge( const StereoKeyFramePtr &previousFrame, const StereoKeyFramePtr &frame ) const;
+
 };
 
 }
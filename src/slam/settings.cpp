@@ -6,12 +6,24 @@ namespace slam {
 
 double Settings::m_maxReprojectionError = 1.;
 double Settings::m_minStereoDisparity = 7.;
+
+// Stereo depth limits in baselines, zero for no limit
+double Settings::m_minStereoDepth = 2.;
+double Settings::m_maxStereoDepth = 0.;
+
 double Settings::m_minAdjacentPointsDistance = 7.;
 double Settings::m_minAdjacentCameraMultiplier = 1.;
 
 double Settings::m_minTrackInliersRatio = 0.7;
 double Settings::m_goodTrackInliersRatio = 0.9;
 
+size_t Settings::m_memoryBudget = 0;
+size_t Settings::m_trackingWindow = 2;
+
+// Zero disables culling
+double Settings::m_redundantKeyFrameRatio = 0.;
+size_t Settings::m_redundantKeyFrameObservations = 3;
+
 double Settings::maxReprojectionError() const
 {
     return m_maxReprojectionError;
@@ -22,6 +34,16 @@ double Settings::minStereoDisparity() const
     return m_minStereoDisparity;
 }
 
+double Settings::minStereoDepth() const
+{
+    return m_minStereoDepth;
+}
+
+double Settings::maxStereoDepth() const
+{
+    return m_maxStereoDepth;
+}
+
 double Settings::minAdjacentPointsDistance() const
 {
     return m_minAdjacentPointsDistance;
@@ -42,4 +64,34 @@ double Settings::goodTrackInliersRatio() const
     return m_goodTrackInliersRatio;
 }
 
+void Settings::setMemoryBudget( const size_t value )
+{
+    m_memoryBudget = value;
+}
+
+size_t Settings::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+size_t Settings::trackingWindow() const
+{
+    return m_trackingWindow;
+}
+
+void Settings::setRedundantKeyFrameRatio( const double value )
+{
+    m_redundantKeyFrameRatio = value;
+}
+
+double Settings::redundantKeyFrameRatio() const
+{
+    return m_redundantKeyFrameRatio;
+}
+
+size_t Settings::redundantKeyFrameObservations() const
+{
+    return m_redundantKeyFrameObservations;
+}
+
 }
@@ -10,22 +10,44 @@ public:
 
     double minStereoDisparity() const;
 
+    double minStereoDepth() const;
+    double maxStereoDepth() const;
+
     double minAdjacentPointsDistance() const;
     double minAdjacentCameraMultiplier() const;
 
     double minTrackInliersRatio() const;
     double goodTrackInliersRatio() const;
 
+    // Bytes, zero for no budget
+    void setMemoryBudget( const size_t value );
+    size_t memoryBudget() const;
+
+    size_t trackingWindow() const;
+
+    void setRedundantKeyFrameRatio( const double value );
+    double redundantKeyFrameRatio() const;
+    size_t redundantKeyFrameObservations() const;
+
     static double m_maxReprojectionError;
 
     static double m_minStereoDisparity;
 
+    static double m_minStereoDepth;
+    static double m_maxStereoDepth;
+
     static double m_minAdjacentPointsDistance;
     static double m_minAdjacentCameraMultiplier;
 
     static double m_minTrackInliersRatio;
     static double m_goodTrackInliersRatio;
 
+    static size_t m_memoryBudget;
+    static size_t m_trackingWindow;
+
+    static double m_redundantKeyFrameRatio;
+    static size_t m_redundantKeyFrameObservations;
+
 };
 
 }
@@ -2,6 +2,8 @@
 
 #include "slamdialog.h"
 
+#include "src/common/simulatedcamerawidget.h"
+
 // ImagesChoiceWidget
 ImagesChoiceWidget::ImagesChoiceWidget( QWidget *parent )
     : QWidget( parent )
@@ -16,6 +18,9 @@ void ImagesChoiceWidget::initialize()
     m_calibrationFileLine = new FileLine( tr( "Calibration file:" ), tr( "Calibration files (*.yaml)" ), this );
     layout->addWidget( m_calibrationFileLine );
 
+    m_recordFileLine = new FileLine( tr( "Record map:" ), tr( "Maps (*.map)" ), this );
+    layout->addWidget( m_recordFileLine );
+
     m_filesListWidget = new StereoFilesListWidget( this );
     layout->addWidget( m_filesListWidget );
 
@@ -46,6 +51,11 @@ QString ImagesChoiceWidget::calibrationFile() const
     return m_calibrationFileLine->path();
 }
 
+QString ImagesChoiceWidget::recordFile() const
+{
+    return m_recordFileLine->path();
+}
+
 // ImagesDialog
 ImagesDialog::ImagesDialog( QWidget *parent )
     : DialogBase( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, parent )
@@ -90,6 +100,11 @@ QString ImagesDialog::calibrationFile() const
     return widget()->calibrationFile();
 }
 
+QString ImagesDialog::recordFile() const
+{
+    return widget()->recordFile();
+}
+
 // CamerasChoiceWidget
 CamerasChoiceWidget::CamerasChoiceWidget( QWidget *parent )
     : QWidget( parent )
@@ -104,8 +119,21 @@ void CamerasChoiceWidget::initialize()
     m_calibrationFileLine = new FileLine( tr( "Calibration file:" ), tr( "Calibration files (*.yaml)" ), this );
     layout->addWidget( m_calibrationFileLine );
 
+    m_recordFileLine = new FileLine( tr( "Record map:" ), tr( "Maps (*.map)" ), this );
+    layout->addWidget( m_recordFileLine );
+
     m_camerasIpWidget = new StereoIPWidget( this );
     layout->addWidget( m_camerasIpWidget );
+
+    auto imuLayout = new QHBoxLayout();
+
+    m_imuPortEdit = new QLineEdit( this );
+    m_imuPortEdit->setPlaceholderText( tr( "No IMU" ) );
+
+    imuLayout->addWidget( new QLabel( tr( "IMU port:" ), this ) );
+    imuLayout->addWidget( m_imuPortEdit );
+
+    layout->addLayout( imuLayout );
 }
 
 QString CamerasChoiceWidget::leftIp() const
@@ -123,6 +151,16 @@ QString CamerasChoiceWidget::calibrationFile() const
     return m_calibrationFileLine->path();
 }
 
+QString CamerasChoiceWidget::recordFile() const
+{
+    return m_recordFileLine->path();
+}
+
+QString CamerasChoiceWidget::imuPort() const
+{
+    return m_imuPortEdit->text().trimmed();
+}
+
 // StereoIPDialog
 CamerasDialog::CamerasDialog( QWidget* parent )
     : DialogBase( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, parent )
@@ -156,3 +194,227 @@ QString CamerasDialog::calibrationFile() const
 {
     return widget()->calibrationFile();
 }
+
+QString CamerasDialog::recordFile() const
+{
+    return widget()->recordFile();
+}
+
+QString CamerasDialog::imuPort() const
+{
+    return widget()->imuPort();
+}
+
+// SimulatedCamerasChoiceWidget
+SimulatedCamerasChoiceWidget::SimulatedCamerasChoiceWidget( QWidget *parent )
+    : QWidget( parent )
+{
+    initialize();
+}
+
+void SimulatedCamerasChoiceWidget::initialize()
+{
+    QVBoxLayout *layout = new QVBoxLayout( this );
+
+    m_calibrationFileLine = new FileLine( tr( "Calibration file:" ), tr( "Calibration files (*.yaml)" ), this );
+    layout->addWidget( m_calibrationFileLine );
+
+    m_recordFileLine = new FileLine( tr( "Record map:" ), tr( "Maps (*.map)" ), this );
+    layout->addWidget( m_recordFileLine );
+
+    m_imuLogFileLine = new FileLine( tr( "IMU log:" ), tr( "IMU logs (*.imulog)" ), this );
+    layout->addWidget( m_imuLogFileLine );
+
+    m_cameraWidget = new SimulatedCameraWidget( this );
+    layout->addWidget( m_cameraWidget );
+}
+
+SimulatedStereoCamera *SimulatedCamerasChoiceWidget::createCamera( const std::shared_ptr< ReplayClock > &clock )
+{
+    return m_cameraWidget->createCamera( clock );
+}
+
+QString SimulatedCamerasChoiceWidget::errorString() const
+{
+    return m_cameraWidget->errorString();
+}
+
+QString SimulatedCamerasChoiceWidget::calibrationFile() const
+{
+    return m_calibrationFileLine->path();
+}
+
+QString SimulatedCamerasChoiceWidget::recordFile() const
+{
+    return m_recordFileLine->path();
+}
+
+QString SimulatedCamerasChoiceWidget::imuLogFile() const
+{
+    return m_imuLogFileLine->path();
+}
+
+// SimulatedCamerasDialog
+SimulatedCamerasDialog::SimulatedCamerasDialog( QWidget* parent )
+    : DialogBase( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, parent )
+{
+    initialize();
+}
+
+void SimulatedCamerasDialog::initialize()
+{
+    setWidget( new SimulatedCamerasChoiceWidget( this ) );
+
+    connect( m_buttons, &QDialogButtonBox::accepted, this, &DialogBase::accept );
+}
+
+SimulatedCamerasChoiceWidget *SimulatedCamerasDialog::widget() const
+{
+    return dynamic_cast< SimulatedCamerasChoiceWidget * >( m_widget.data() );
+}
+
+SimulatedStereoCamera *SimulatedCamerasDialog::createCamera( const std::shared_ptr< ReplayClock > &clock )
+{
+    return widget()->createCamera( clock );
+}
+
+QString SimulatedCamerasDialog::errorString() const
+{
+    return widget()->errorString();
+}
+
+QString SimulatedCamerasDialog::calibrationFile() const
+{
+    return widget()->calibrationFile();
+}
+
+QString SimulatedCamerasDialog::recordFile() const
+{
+    return widget()->recordFile();
+}
+
+QString SimulatedCamerasDialog::imuLogFile() const
+{
+    return widget()->imuLogFile();
+}
+
+// MemorySettingsWidget
+MemorySettingsWidget::MemorySettingsWidget( QWidget *parent )
+    : QWidget( parent )
+{
+    initialize();
+}
+
+void MemorySettingsWidget::initialize()
+{
+    auto layout = new QVBoxLayout( this );
+
+    auto parametersLayout = new QGridLayout();
+
+    m_memoryBudgetSpinBox = new QSpinBox( this );
+    m_memoryBudgetSpinBox->setMinimum( 0 );
+    m_memoryBudgetSpinBox->setMaximum( 1 << 20 );
+    m_memoryBudgetSpinBox->setValue( 0 );
+    m_memoryBudgetSpinBox->setSpecialValueText( tr( "No budget" ) );
+    m_memoryBudgetSpinBox->setAlignment( Qt::AlignRight );
+
+    m_redundantRatioSpinBox = new QDoubleSpinBox( this );
+    m_redundantRatioSpinBox->setMinimum( 0. );
+    m_redundantRatioSpinBox->setMaximum( 1. );
+    m_redundantRatioSpinBox->setSingleStep( 0.05 );
+    m_redundantRatioSpinBox->setValue( 0. );
+    m_redundantRatioSpinBox->setSpecialValueText( tr( "No culling" ) );
+    m_redundantRatioSpinBox->setAlignment( Qt::AlignRight );
+
+    parametersLayout->addWidget( new QLabel( tr( "Memory budget, MB:" ), this ), 0, 0 );
+    parametersLayout->addWidget( m_memoryBudgetSpinBox, 0, 1 );
+    parametersLayout->addWidget( new QLabel( tr( "Redundant key frame ratio:" ), this ), 1, 0 );
+    parametersLayout->addWidget( m_redundantRatioSpinBox, 1, 1 );
+
+    layout->addLayout( parametersLayout );
+
+    // Key frames over the budget are only dropped once written there
+    m_spillFileLine = new FileLine( tr( "Spill file:" ), tr( "Maps (*.map)" ), this );
+    layout->addWidget( m_spillFileLine );
+}
+
+void MemorySettingsWidget::setMemoryBudget( const size_t value )
+{
+    m_memoryBudgetSpinBox->setValue( static_cast< int >( ( value + m_megabyte - 1 ) / m_megabyte ) );
+}
+
+size_t MemorySettingsWidget::memoryBudget() const
+{
+    return static_cast< size_t >( m_memoryBudgetSpinBox->value() ) * m_megabyte;
+}
+
+void MemorySettingsWidget::setRedundantKeyFrameRatio( const double value )
+{
+    m_redundantRatioSpinBox->setValue( value );
+}
+
+double MemorySettingsWidget::redundantKeyFrameRatio() const
+{
+    return m_redundantRatioSpinBox->value();
+}
+
+void MemorySettingsWidget::setSpillFile( const QString &value )
+{
+    m_spillFileLine->setPath( value );
+}
+
+QString MemorySettingsWidget::spillFile() const
+{
+    return m_spillFileLine->path();
+}
+
+// MemorySettingsDialog
+MemorySettingsDialog::MemorySettingsDialog( QWidget* parent )
+    : DialogBase( QDialogButtonBox::Ok | QDialogButtonBox::Cancel, parent )
+{
+    initialize();
+}
+
+void MemorySettingsDialog::initialize()
+{
+    setWindowTitle( tr( "Memory settings" ) );
+
+    setWidget( new MemorySettingsWidget( this ) );
+
+    connect( m_buttons, &QDialogButtonBox::accepted, this, &DialogBase::accept );
+}
+
+MemorySettingsWidget *MemorySettingsDialog::widget() const
+{
+    return dynamic_cast< MemorySettingsWidget * >( m_widget.data() );
+}
+
+void MemorySettingsDialog::setMemoryBudget( const size_t value )
+{
+    widget()->setMemoryBudget( value );
+}
+
+size_t MemorySettingsDialog::memoryBudget() const
+{
+    return widget()->memoryBudget();
+}
+
+void MemorySettingsDialog::setRedundantKeyFrameRatio( const double value )
+{
+    widget()->setRedundantKeyFrameRatio( value );
+}
+
+double MemorySettingsDialog::redundantKeyFrameRatio() const
+{
+    return widget()->redundantKeyFrameRatio();
+}
+
+void MemorySettingsDialog::setSpillFile( const QString &value )
+{
+    widget()->setSpillFile( value );
+}
+
+QString MemorySettingsDialog::spillFile() const
+{
+    return widget()->spillFile();
+}
@@ -4,6 +4,12 @@
 #include "src/common/supportwidgets.h"
 #include "src/common/ipwidget.h"
 
+#include <memory>
+
+class SimulatedCameraWidget;
+class SimulatedStereoCamera;
+class ReplayClock;
+
 class ImagesChoiceWidget : public QWidget
 {
     Q_OBJECT
@@ -19,8 +25,12 @@ public:
 
     QString calibrationFile() const;
 
+    // Key frames are appended there while tracking, empty without recording
+    QString recordFile() const;
+
 protected:
     QPointer< FileLine > m_calibrationFileLine;
+    QPointer< FileLine > m_recordFileLine;
     QPointer< StereoFilesListWidget > m_filesListWidget;
 
 private:
@@ -45,6 +55,8 @@ public:
 
     QString calibrationFile() const;
 
+    QString recordFile() const;
+
 private:
     void initialize();
 
@@ -62,9 +74,17 @@ public:
 
     QString calibrationFile() const;
 
+    // Empty without recording
+    QString recordFile() const;
+
+    // Empty without an IMU
+    QString imuPort() const;
+
 protected:
     QPointer< FileLine > m_calibrationFileLine;
+    QPointer< FileLine > m_recordFileLine;
     QPointer< StereoIPWidget > m_camerasIpWidget;
+    QPointer< QLineEdit > m_imuPortEdit;
 
 private:
     void initialize();
@@ -85,6 +105,118 @@ public:
 
     QString calibrationFile() const;
 
+    QString recordFile() const;
+
+    QString imuPort() const;
+
+private:
+    void initialize();
+
+};
+
+class SimulatedCamerasChoiceWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedCamerasChoiceWidget( QWidget *parent = nullptr );
+
+    SimulatedStereoCamera *createCamera( const std::shared_ptr< ReplayClock > &clock = nullptr );
+
+    QString errorString() const;
+
+    QString calibrationFile() const;
+
+    // Empty without recording
+    QString recordFile() const;
+
+    // Empty without an IMU
+    QString imuLogFile() const;
+
+protected:
+    QPointer< FileLine > m_calibrationFileLine;
+    QPointer< FileLine > m_recordFileLine;
+    QPointer< FileLine > m_imuLogFileLine;
+    QPointer< SimulatedCameraWidget > m_cameraWidget;
+
+private:
+    void initialize();
+
+};
+
+class SimulatedCamerasDialog : public DialogBase
+{
+    Q_OBJECT
+
+public:
+    explicit SimulatedCamerasDialog( QWidget* parent = nullptr );
+
+    SimulatedCamerasChoiceWidget *widget() const;
+
+    SimulatedStereoCamera *createCamera( const std::shared_ptr< ReplayClock > &clock = nullptr );
+
+    QString errorString() const;
+
+    QString calibrationFile() const;
+
+    QString recordFile() const;
+
+    QString imuLogFile() const;
+
+private:
+    void initialize();
+
+};
+
+class MemorySettingsWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MemorySettingsWidget( QWidget *parent = nullptr );
+
+    // Bytes, zero for no budget
+    void setMemoryBudget( const size_t value );
+    size_t memoryBudget() const;
+
+    // Zero disables culling
+    void setRedundantKeyFrameRatio( const double value );
+    double redundantKeyFrameRatio() const;
+
+    // Empty without spilling
+    void setSpillFile( const QString &value );
+    QString spillFile() const;
+
+protected:
+    QPointer< QSpinBox > m_memoryBudgetSpinBox;
+    QPointer< QDoubleSpinBox > m_redundantRatioSpinBox;
+    QPointer< FileLine > m_spillFileLine;
+
+    static const size_t m_megabyte = 1 << 20;
+
+private:
+    void initialize();
+
+};
+
+class MemorySettingsDialog : public DialogBase
+{
+    Q_OBJECT
+
+public:
+    explicit MemorySettingsDialog( QWidget* parent = nullptr );
+
+    MemorySettingsWidget *widget() const;
+
+    void setMemoryBudget( const size_t value );
+    size_t memoryBudget() const;
+
+    void setRedundantKeyFrameRatio( const double value );
+    double redundantKeyFrameRatio() const;
+
+    void setSpillFile( const QString &value );
+    QString spillFile() const;
+
 private:
     void initialize();
 
@@ -33,15 +33,15 @@ SlamImageWidget *ImageSlamDocument::widget() const
 }
 
 // CameraSlamDocument
-CameraSlamDocument::CameraSlamDocument( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile, QWidget *parent )
+CameraSlamDocument::CameraSlamDocument( StereoCameraBase *camera, const QString &calibrationFile, QWidget *parent )
     : SlamDocumentBase( parent )
 {
-    initialize( leftCameraIp, rightCameraIp, calibrationFile );
+    initialize( camera, calibrationFile );
 }
 
-void CameraSlamDocument::initialize( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile )
+void CameraSlamDocument::initialize( StereoCameraBase *camera, const QString &calibrationFile )
 {
-    setWidget( new SlamCameraWidget( leftCameraIp, rightCameraIp, calibrationFile, this ) );
+    setWidget( new SlamCameraWidget( camera, calibrationFile, this ) );
 }
 
 SlamCameraWidget *CameraSlamDocument::widget() const
@@ -53,12 +53,18 @@ SlamCameraWidget *CameraSlamDocument::widget() const
 ImuDocument::ImuDocument( const QString &portName, QWidget *parent )
     : SlamDocumentBase( parent )
 {
-    initialize( portName );
+    initialize( connectXsensInterface( portName ) );
 }
 
-void ImuDocument::initialize( const QString &portName )
+ImuDocument::ImuDocument( XsensSource *source, QWidget *parent )
+    : SlamDocumentBase( parent )
+{
+    initialize( source );
+}
+
+void ImuDocument::initialize( XsensSource *source )
 {
-    setWidget( new ImuWidget( portName, this ) );
+    setWidget( new ImuWidget( source, this ) );
 }
 
 ImuWidget *ImuDocument::widget() const
@@ -70,12 +76,18 @@ ImuWidget *ImuDocument::widget() const
 ImuCalibrationDocument::ImuCalibrationDocument( const QString &portName, QWidget *parent )
     : SlamDocumentBase( parent )
 {
-    initialize( portName );
+    initialize( connectXsensInterface( portName ) );
+}
+
+ImuCalibrationDocument::ImuCalibrationDocument( XsensSource *source, QWidget *parent )
+    : SlamDocumentBase( parent )
+{
+    initialize( source );
 }
 
-void ImuCalibrationDocument::initialize( const QString &portName )
+void ImuCalibrationDocument::initialize( XsensSource *source )
 {
-    setWidget( new ImuCalibrationWidget( portName, this ) );
+    setWidget( new ImuCalibrationWidget( source, this ) );
 }
 
 ImuCalibrationWidget *ImuCalibrationDocument::widget() const
@@ -6,9 +6,12 @@
 
 class QVBoxLayout;
 
+class StereoCameraBase;
+
 class SlamCameraWidget;
 class SlamImageWidget;
 class ImuWidget;
+class XsensSource;
 class ImuCalibrationWidget;
 
 class SlamDocumentBase : public DocumentBase
@@ -43,12 +46,12 @@ class CameraSlamDocument : public SlamDocumentBase
     Q_OBJECT
 
 public:
-    explicit CameraSlamDocument( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile, QWidget* parent = nullptr );
+    explicit CameraSlamDocument( StereoCameraBase *camera, const QString &calibrationFile, QWidget* parent = nullptr );
 
     SlamCameraWidget *widget() const;
 
 private:
-    void initialize( const QString &leftCameraIp, const QString &rightCameraIp , const QString &calibrationFile );
+    void initialize( StereoCameraBase *camera, const QString &calibrationFile );
 
 };
 
@@ -58,11 +61,12 @@ class ImuDocument : public SlamDocumentBase
 
 public:
     explicit ImuDocument( const QString &portName, QWidget* parent = nullptr );
+    explicit ImuDocument( XsensSource *source, QWidget* parent = nullptr );
 
     ImuWidget *widget() const;
 
 private:
-    void initialize( const QString &portName );
+    void initialize( XsensSource *source );
 
 };
 
@@ -72,10 +76,11 @@ class ImuCalibrationDocument : public SlamDocumentBase
 
 public:
     explicit ImuCalibrationDocument( const QString &portName, QWidget* parent = nullptr );
+    explicit ImuCalibrationDocument( XsensSource *source, QWidget* parent = nullptr );
 
     ImuCalibrationWidget *widget() const;
 
 private:
-    void initialize( const QString &portName );
+    void initialize( XsensSource *source );
 
 };
@@ -4,25 +4,38 @@
 
 #include "src/common/defs.h"
 #include "src/common/functions.h"
-#include "src/common/tictoc.h"
+#include "src/common/profiler.h"
+#include "src/common/xsens.h"
 
 #include "world.h"
 #include "mappoint.h"
 #include "frame.h"
+#include "imudata.h"
+
+#include <opencv2/core/eigen.hpp>
 
 #include <thread>
 
 // SlamThread
+const std::chrono::milliseconds SlamThread::m_imuTimeout( 10 );
+
 SlamThread::SlamThread(const StereoCalibrationDataShort &calibration, QObject *parent )
     : QThread( parent )
 {
     initialize( calibration );
 }
 
+SlamThread::~SlamThread()
+{
+    stopImu();
+}
+
 void SlamThread::initialize( const StereoCalibrationDataShort &calibration )
 {
     m_scaleFactor = 1.0;
 
+    m_imuStopped = true;
+
     m_rectificationProcessor.setCalibrationData( calibration );
     m_leftUndistortionProcessor.setCalibrationData( calibration.leftCameraResults() );
     m_rightUndistortionProcessor.setCalibrationData( calibration.rightCameraResults() );
@@ -37,6 +50,15 @@ void SlamThread::initialize( const StereoCalibrationDataShort &calibration )
 
     m_system = slam::World::create( projectionMatrix );
 
+    // The IMU prediction rotates the rectified images
+    auto rectificationRotation = calibration.leftRectifyMatrix();
+
+    if ( rectificationRotation.rows == 3 && rectificationRotation.cols == 3 ) {
+        Eigen::Matrix3d rotation;
+        cv::cv2eigen( rectificationRotation, rotation );
+        m_system->imuIntegrator().setRectificationRotation( rotation );
+    }
+
 }
 
 void SlamThread::process( const StampedImage leftImage, const StampedImage rightImage )
@@ -50,6 +72,144 @@ void SlamThread::process( const StampedImage leftImage, const StampedImage right
 
 }
 
+bool SlamThread::addImuData( const slam::ImuData &data )
+{
+    return m_system->addImuData( data );
+}
+
+void SlamThread::setImuSource( XsensSource *source )
+{
+    stopImu();
+
+    m_imuSource.reset( source );
+
+    if ( !m_imuSource )
+        return;
+
+    m_imuStopped = false;
+
+    m_imuThread = std::thread( [ this ]() {
+        PROFILE_THREAD( "imu" );
+
+        while ( !m_imuStopped ) {
+
+            auto packets = m_imuSource->getAllPackets( m_imuTimeout );
+
+            for ( auto &i : packets )
+                if ( i.valid() )
+                    addImuData( slam::ImuData( i ) );
+
+        }
+
+    } );
+
+}
+
+bool SlamThread::hasLiveImu() const
+{
+    return dynamic_cast< XsensInterface * >( m_imuSource.get() ) != nullptr;
+}
+
+bool SlamThread::setImuRecordFile( const std::string &fileName )
+{
+    auto xsensInterface = dynamic_cast< XsensInterface * >( m_imuSource.get() );
+
+    if ( !xsensInterface )
+        return false;
+
+    if ( fileName.empty() ) {
+        xsensInterface->closeRecordFile();
+        return true;
+    }
+
+    return xsensInterface->setRecordFile( fileName );
+}
+
+void SlamThread::stopImu()
+{
+    m_imuStopped = true;
+
+    if ( m_imuThread.joinable() )
+        m_imuThread.join();
+}
+
+bool SlamThread::loadImuParameters( const std::string &fileName )
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->imuIntegrator().loadParameters( fileName );
+}
+
+void SlamThread::setMemoryBudget( const size_t value )
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    m_system->settings().setMemoryBudget( value );
+}
+
+size_t SlamThread::memoryBudget() const
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->settings().memoryBudget();
+}
+
+void SlamThread::setRedundantKeyFrameRatio( const double value )
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    m_system->settings().setRedundantKeyFrameRatio( value );
+}
+
+double SlamThread::redundantKeyFrameRatio() const
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->settings().redundantKeyFrameRatio();
+}
+
+bool SlamThread::setSpillFile( const std::string &fileName )
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->memoryManager().setSpillFile( fileName );
+}
+
+bool SlamThread::saveMap( const std::string &fileName ) const
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->save( fileName ) && m_system->verify( fileName );
+}
+
+bool SlamThread::loadMap( const std::string &fileName )
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->load( fileName );
+}
+
+bool SlamThread::setRecordFile( const std::string &fileName )
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->setRecordFile( fileName );
+}
+
+bool SlamThread::exportPly( const std::string &fileName ) const
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->exportPly( fileName );
+}
+
+bool SlamThread::exportPcd( const std::string &fileName ) const
+{
+    std::lock_guard< std::mutex > lock( m_systemMutex );
+
+    return m_system->exportPcd( fileName );
+}
+
 std::shared_ptr< slam::World > SlamThread::system() const
 {
     return m_system;
@@ -114,6 +274,8 @@ std::vector< ColorPoint3d > SlamThread::sparseCloud() const
 
 void SlamThread::run()
 {
+    PROFILE_THREAD( "slam" );
+
    /*auto optimizationThread = std::thread( [ & ] {
 
         while ( !isInterruptionRequested() ) {
@@ -146,7 +308,7 @@ void SlamThread::run()
             // cv::rectangle( leftFrame, cv::Point( 0, 1500 ), cv::Point( 2048, 2048 ), cv::Scalar( 0, 0, 0, 255 ), cv::FILLED );
             // cv::rectangle( rightFrame, cv::Point( 0, 1500 ), cv::Point( 2048, 2048 ), cv::Scalar( 0, 0, 0, 255 ), cv::FILLED );
 
-            TicToc time;
+            PROFILE_SCOPE( "frame" );
 
             // leftCroppedImage = m_leftUndistortionProcessor.undistort( leftFrame );
             // rightCroppedImage = m_rightUndistortionProcessor.undistort( rightFrame );
@@ -173,7 +335,8 @@ void SlamThread::run()
 
                 m_systemMutex.lock();
 
-                m_system->track( leftProcImage, rightProcImage );
+                // Camera timestamps are kept for the IMU pre-integration
+                m_system->track( StampedImage( leftFrame.time(), leftProcImage ), StampedImage( rightFrame.time(), rightProcImage ) );
 
                 m_systemMutex.unlock();
 
@@ -181,8 +344,6 @@ void SlamThread::run()
 
             }
 
-            time.report();
-
             m_leftFrame.release();
             m_rightFrame.release();
 
@@ -3,7 +3,10 @@
 #include <QThread>
 #include <QMutex>
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <thread>
 
 #include "slamgeometry.h"
 
@@ -11,10 +14,13 @@
 
 #include "src/common/rectificationprocessor.h"
 
+class XsensSource;
+
 namespace slam {
     class World;
     class Map;
     class StereoFrame;
+    class ImuData;
 }
 
 class SlamThread : public QThread
@@ -26,9 +32,45 @@ public:
     using FramePtr = std::shared_ptr< slam::StereoFrame >;
 
     explicit SlamThread( const StereoCalibrationDataShort &calibration, QObject *parent = nullptr );
+    ~SlamThread();
 
     void process( const StampedImage leftImage, const StampedImage rightImage );
 
+    // Lock-free, from one IMU thread
+    bool addImuData( const slam::ImuData &data );
+
+    // Takes ownership of the source, its packets are fed to addImuData() from a reader thread
+    void setImuSource( XsensSource *source );
+
+    // A replayed log is not recorded again
+    bool hasLiveImu() const;
+
+    // Logs the live IMU packets there, an empty name stops logging
+    bool setImuRecordFile( const std::string &fileName );
+
+    // IMU extrinsic rotation, bias and noise, see slam::ImuIntegrator::loadParameters()
+    bool loadImuParameters( const std::string &fileName );
+
+    // Bytes, zero keeps every key frame in memory
+    void setMemoryBudget( const size_t value );
+    size_t memoryBudget() const;
+
+    void setRedundantKeyFrameRatio( const double value );
+    double redundantKeyFrameRatio() const;
+
+    // Key frames leaving the memory are written there, an empty name stops spilling
+    bool setSpillFile( const std::string &fileName );
+
+    // The saved file is read back to check that it restores the world
+    bool saveMap( const std::string &fileName ) const;
+    bool loadMap( const std::string &fileName );
+
+    // Finished key frames are appended there while tracking, an empty name stops recording
+    bool setRecordFile( const std::string &fileName );
+
+    bool exportPly( const std::string &fileName ) const;
+    bool exportPcd( const std::string &fileName ) const;
+
     std::shared_ptr< slam::World > system() const;
 
     CvImage pointsImage() const;
@@ -56,6 +98,14 @@ protected:
     MonoUndistortionProcessor m_leftUndistortionProcessor;
     MonoUndistortionProcessor m_rightUndistortionProcessor;
 
+    std::unique_ptr< XsensSource > m_imuSource;
+    std::thread m_imuThread;
+    std::atomic< bool > m_imuStopped;
+
+    static const std::chrono::milliseconds m_imuTimeout;
+
+    void stopImu();
+
     virtual void run() override;
 
 private:
@@ -687,21 +687,36 @@ QList< QPointF > ImuChartWidget::magZPoints() const
     return _magChart->zPoints();
 }
 
+XsensInterface *connectXsensInterface( const QString &portName )
+{
+    auto ret = new XsensInterface();
+
+    ret->connectDevice( portName.toStdString() );
+    ret->prepare();
+
+    return ret;
+}
+
 // ImuWidget
 ImuWidget::ImuWidget( const QString &portName, QWidget* parent )
     : QSplitter( Qt::Horizontal, parent )
 {
-    initialize( portName );
+    initialize( connectXsensInterface( portName ) );
 }
 
-void ImuWidget::initialize( const QString &portName )
+ImuWidget::ImuWidget( XsensSource *source, QWidget* parent )
+    : QSplitter( Qt::Horizontal, parent )
+{
+    initialize( source );
+}
+
+void ImuWidget::initialize( XsensSource *source )
 {
     _rotation = Eigen::Quaterniond::Identity();
     _velocity = Eigen::Vector3d::Zero();
     _translation = Eigen::Vector3d::Zero();
 
-    _xsensInterface.connectDevice( portName.toStdString() );
-    _xsensInterface.prepare();
+    _xsensSource.reset( source );
 
     _imuViewWidget = new ImuView( this );
     _chartWidget = new ImuChartWidget( this );
@@ -726,7 +741,7 @@ Eigen::Quaterniond quaternion( const Eigen::Vector3d &theta )
 
 void ImuWidget::timerEvent( QTimerEvent * )
 {
-    auto measures = _xsensInterface.getAllPackets( std::chrono::milliseconds( static_cast< int >( 1./40. ) ) );
+    auto measures = _xsensSource->getAllPackets( std::chrono::milliseconds( static_cast< int >( 1./40. ) ) );
 
     for ( auto &i : measures ) {
 
@@ -997,13 +1012,18 @@ void ImuParametersWidget::setMagVarZ( const double value )
 ImuCalibrationWidget::ImuCalibrationWidget( const QString &portName, QWidget *parent )
     : QSplitter( Qt::Horizontal, parent )
 {
-    initialize( portName );
+    initialize( connectXsensInterface( portName ) );
+}
+
+ImuCalibrationWidget::ImuCalibrationWidget( XsensSource *source, QWidget *parent )
+    : QSplitter( Qt::Horizontal, parent )
+{
+    initialize( source );
 }
 
-void ImuCalibrationWidget::initialize( const QString &portName )
+void ImuCalibrationWidget::initialize( XsensSource *source )
 {
-    _xsensInterface.connectDevice( portName.toStdString() );
-    _xsensInterface.prepare();
+    _xsensSource.reset( source );
 
     _chartWidget = new ImuChartWidget( this );
     _parametersWidget = new ImuParametersWidget( this );
@@ -1019,7 +1039,7 @@ void ImuCalibrationWidget::initialize( const QString &portName )
 
 void ImuCalibrationWidget::timerEvent( QTimerEvent * )
 {
-    auto measures = _xsensInterface.getAllPackets( std::chrono::milliseconds( static_cast< int >( 1./40. ) ) );
+    auto measures = _xsensSource->getAllPackets( std::chrono::milliseconds( static_cast< int >( 1./40. ) ) );
 
     for ( auto &i : measures )
         _chartWidget->addPacket( i );
@@ -1244,6 +1264,9 @@ void SlamWidgetBase::initialize( const QString &calibrationFile )
 
     m_slamThread = new SlamThread( calibration, this );
 
+    // The IMU extrinsics, bias and noise are optional in the same file
+    m_slamThread->loadImuParameters( calibrationFile.toStdString() );
+
     m_updateTimer = new QTimer( this );
     m_updateTimer->start( 1000 / 20 );
 
@@ -1255,6 +1278,69 @@ void SlamWidgetBase::initialize( const QString &calibrationFile )
 
 }
 
+void SlamWidgetBase::setImuSource( XsensSource *source )
+{
+    m_slamThread->setImuSource( source );
+}
+
+void SlamWidgetBase::setMemoryBudget( const size_t value )
+{
+    m_slamThread->setMemoryBudget( value );
+}
+
+size_t SlamWidgetBase::memoryBudget() const
+{
+    return m_slamThread->memoryBudget();
+}
+
+void SlamWidgetBase::setRedundantKeyFrameRatio( const double value )
+{
+    m_slamThread->setRedundantKeyFrameRatio( value );
+}
+
+double SlamWidgetBase::redundantKeyFrameRatio() const
+{
+    return m_slamThread->redundantKeyFrameRatio();
+}
+
+bool SlamWidgetBase::setSpillFile( const QString &fileName )
+{
+    if ( !m_slamThread->setSpillFile( fileName.toStdString() ) )
+        return false;
+
+    m_spillFile = fileName;
+
+    return true;
+}
+
+const QString &SlamWidgetBase::spillFile() const
+{
+    return m_spillFile;
+}
+
+bool SlamWidgetBase::saveMap( const QString &fileName ) const
+{
+    return m_slamThread->saveMap( fileName.toStdString() );
+}
+
+bool SlamWidgetBase::loadMap( const QString &fileName )
+{
+    return m_slamThread->loadMap( fileName.toStdString() );
+}
+
+bool SlamWidgetBase::setRecordFile( const QString &fileName )
+{
+    return m_slamThread->setRecordFile( fileName.toStdString() );
+}
+
+bool SlamWidgetBase::exportMap( const QString &fileName ) const
+{
+    if ( QFileInfo( fileName ).suffix().compare( "pcd", Qt::CaseInsensitive ) == 0 )
+        return m_slamThread->exportPcd( fileName.toStdString() );
+
+    return m_slamThread->exportPly( fileName.toStdString() );
+}
+
 void SlamWidgetBase::updateVisibility()
 {
     m_viewWidget->showPath( m_controlWidget->isOdometryChecked() );
@@ -1447,21 +1533,71 @@ void SlamImageWidget::timerEvent( QTimerEvent * )
 }
 
 // SlamCameraWidget
-SlamCameraWidget::SlamCameraWidget( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile, QWidget* parent )
-    : SlamWidgetBase( calibrationFile, parent ), m_camera( leftCameraIp.toStdString(), rightCameraIp.toStdString(), parent )
+const QString SlamCameraWidget::m_imuLogName( "imu.imulog" );
+
+SlamCameraWidget::SlamCameraWidget( StereoCameraBase *camera, const QString &calibrationFile, QWidget* parent )
+    : SlamWidgetBase( calibrationFile, parent ), m_camera( camera )
 {
     initialize();
 }
 
 void SlamCameraWidget::initialize()
 {
-    connect( &m_camera, &StereoCamera::receivedFrame, this, &SlamCameraWidget::updateFrame );
+    m_camera->setParent( this );
+
+    connect( m_camera, &StereoCameraBase::receivedFrame, this, &SlamCameraWidget::updateFrame );
+}
+
+SlamCameraWidget::~SlamCameraWidget()
+{
+    stopRecording();
+}
+
+bool SlamCameraWidget::startRecording( const QString &folder )
+{
+    stopRecording();
+
+    if ( !m_recorder.start( folder.toStdString() ) )
+        return false;
+
+    if ( m_slamThread->hasLiveImu() && !m_slamThread->setImuRecordFile( QDir( folder ).filePath( m_imuLogName ).toStdString() ) ) {
+        m_recorder.stop();
+        return false;
+    }
+
+    return true;
+}
+
+void SlamCameraWidget::stopRecording()
+{
+    if ( !m_recorder.isRecording() )
+        return;
+
+    m_slamThread->setImuRecordFile( std::string() );
+
+    m_recorder.stop();
+
+    if ( m_recorder.droppedFrames() > 0 )
+        std::cout << "Stereo recording dropped " << m_recorder.droppedFrames() << " of "
+                  << m_recorder.recordedFrames() + m_recorder.droppedFrames() << " frames" << std::endl;
+}
+
+bool SlamCameraWidget::isRecording() const
+{
+    return m_recorder.isRecording();
 }
 
 void SlamCameraWidget::updateFrame()
 {
-    auto frame = m_camera.getFrame();
+    auto frame = m_camera->getFrame();
+
+    if ( !frame.empty() ) {
+
+        if ( m_recorder.isRecording() )
+            m_recorder.addFrame( frame );
 
-    if ( !frame.empty() )
         m_slamThread->process( frame.leftImage(), frame.rightImage() );
+
+    }
+
 }
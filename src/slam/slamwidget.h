@@ -12,6 +12,7 @@
 #include "src/common/imagewidget.h"
 #include "src/common/pclwidget.h"
 
+#include "src/common/stereorecorder.h"
 #include "src/common/vimbacamera.h"
 
 #include "src/common/xsens.h"
@@ -187,6 +188,9 @@ private:
 
 };
 
+// Live source of the IMU widgets on a serial port
+XsensInterface *connectXsensInterface( const QString &portName );
+
 class ImuWidget : public QSplitter
 {
     Q_OBJECT
@@ -194,8 +198,11 @@ class ImuWidget : public QSplitter
 public:
     explicit ImuWidget( const QString &portName, QWidget* parent = nullptr );
 
+    // Takes ownership of the source, a live device or an IMU log replay
+    explicit ImuWidget( XsensSource *source, QWidget* parent = nullptr );
+
 protected:
-    XsensInterface _xsensInterface;
+    std::unique_ptr< XsensSource > _xsensSource;
 
     XsensData _prevPacket;
 
@@ -215,7 +222,7 @@ protected:
     virtual void timerEvent( QTimerEvent * ) override;
 
 private:
-    void initialize( const QString &portName );
+    void initialize( XsensSource *source );
 
 };
 
@@ -309,6 +316,7 @@ class ImuCalibrationWidget : public QSplitter
 
 public:
     explicit ImuCalibrationWidget( const QString &portName, QWidget* parent = nullptr );
+    explicit ImuCalibrationWidget( XsensSource *source, QWidget* parent = nullptr );
 
     virtual void timerEvent( QTimerEvent * ) override;
 
@@ -317,13 +325,13 @@ protected:
 
     void calculateMeanAndVariance( const QList< QPointF > &list, double &mean, double &var );
 
-    XsensInterface _xsensInterface;
+    std::unique_ptr< XsensSource > _xsensSource;
 
     QPointer< ImuChartWidget > _chartWidget;
     QPointer< ImuParametersWidget > _parametersWidget;
 
 private:
-    void initialize( const QString &portName );
+    void initialize( XsensSource *source );
 
 };
 
@@ -393,6 +401,26 @@ public:
     explicit SlamWidgetBase( const QString &calibrationFile, QWidget* parent = nullptr );
     ~SlamWidgetBase();
 
+    // Takes ownership of the source, its packets aid the tracking
+    void setImuSource( XsensSource *source );
+
+    void setMemoryBudget( const size_t value );
+    size_t memoryBudget() const;
+
+    void setRedundantKeyFrameRatio( const double value );
+    double redundantKeyFrameRatio() const;
+
+    bool setSpillFile( const QString &fileName );
+    const QString &spillFile() const;
+
+    bool saveMap( const QString &fileName ) const;
+    bool loadMap( const QString &fileName );
+
+    bool setRecordFile( const QString &fileName );
+
+    // The format follows the extension, PLY with the path or PCD
+    bool exportMap( const QString &fileName ) const;
+
 public slots:
     void updateViews();
     void updateImages();
@@ -413,6 +441,8 @@ protected:
 
     QPointer< QTimer > m_updateTimer;
 
+    QString m_spillFile;
+
 private:
     void initialize( const QString &calibrationFile );
 
@@ -450,13 +480,25 @@ class SlamCameraWidget : public SlamWidgetBase
     Q_OBJECT
 
 public:
-    explicit SlamCameraWidget( const QString &leftCameraIp, const QString &rightCameraIp, const QString &calibrationFile, QWidget* parent = nullptr );
+    // Takes the ownership of the camera
+    explicit SlamCameraWidget( StereoCameraBase *camera, const QString &calibrationFile, QWidget* parent = nullptr );
+    ~SlamCameraWidget();
+
+    // Stereo pairs go to left/ and right/ and a live IMU to imu.imulog in the folder, both on the system clock
+    bool startRecording( const QString &folder );
+    void stopRecording();
+
+    bool isRecording() const;
 
 protected slots:
     void updateFrame();
 
 protected:
-    StereoCamera m_camera;
+    QPointer< StereoCameraBase > m_camera;
+
+    StereoRecorder m_recorder;
+
+    static const QString m_imuLogName;
 
 private:
     void initialize();
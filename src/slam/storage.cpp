@@ -0,0 +1,747 @@
+#include "src/common/precompiled.h"
+
+#include "storage.h"
+
+#include "world.h"
+#include "map.h"
+#include "frame.h"
+#include "mappoint.h"
+
+#include <chrono>
+#include <cstring>
+#include <unordered_map>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace slam {
+
+template < class T >
+void put( std::vector< char > *buffer, const T &value )
+{
+    auto data = reinterpret_cast< const char * >( &value );
+    buffer->insert( buffer->end(), data, data + sizeof( T ) );
+}
+
+template < class T >
+bool get( const char **cursor, const char *end, T *value )
+{
+    if ( static_cast< size_t >( end - *cursor ) < sizeof( T ) )
+        return false;
+
+    memcpy( value, *cursor, sizeof( T ) );
+    *cursor += sizeof( T );
+
+    return true;
+}
+
+void putColor( std::vector< char > *buffer, const cv::Scalar &color )
+{
+    for ( int i = 0; i < 3; ++i )
+        put( buffer, cv::saturate_cast< uint8_t >( color[ i ] ) );
+}
+
+bool getColor( const char **cursor, const char *end, cv::Scalar *color )
+{
+    uint8_t bgr[ 3 ];
+
+    for ( int i = 0; i < 3; ++i )
+        if ( !get( cursor, end, &bgr[ i ] ) )
+            return false;
+
+    *color = cv::Scalar( bgr[ 0 ], bgr[ 1 ], bgr[ 2 ] );
+
+    return true;
+}
+
+void putMat( std::vector< char > *buffer, const cv::Mat &mat, const int rows, const int cols )
+{
+    cv::Mat value;
+
+    if ( mat.rows == rows && mat.cols == cols )
+        mat.convertTo( value, CV_64F );
+    else
+        value = cv::Mat::zeros( rows, cols, CV_64F );
+
+    for ( int i = 0; i < rows; ++i )
+        for ( int j = 0; j < cols; ++j )
+            put( buffer, value.at< double >( i, j ) );
+}
+
+bool getMat( const char **cursor, const char *end, const int rows, const int cols, cv::Mat *mat )
+{
+    *mat = cv::Mat( rows, cols, CV_64F );
+
+    for ( int i = 0; i < rows; ++i )
+        for ( int j = 0; j < cols; ++j )
+            if ( !get( cursor, end, &mat->at< double >( i, j ) ) )
+                return false;
+
+    return true;
+}
+
+void putProjectionMatrix( std::vector< char > *buffer, const ProjectionMatrix &matrix )
+{
+    putMat( buffer, matrix.cameraMatrix(), 3, 3 );
+    putMat( buffer, matrix.rotation(), 3, 3 );
+    putMat( buffer, matrix.translation(), 3, 1 );
+}
+
+bool getProjectionMatrix( const char **cursor, const char *end, ProjectionMatrix *matrix )
+{
+    cv::Mat cameraMatrix, rotation, translation;
+
+    if ( !getMat( cursor, end, 3, 3, &cameraMatrix ) || !getMat( cursor, end, 3, 3, &rotation ) || !getMat( cursor, end, 3, 1, &translation ) )
+        return false;
+
+    matrix->setCameraMatrix( cameraMatrix );
+    matrix->setRotation( rotation );
+    matrix->setTranslation( translation );
+
+    return true;
+}
+
+int64_t frameTime( const MonoFramePtr &frame )
+{
+    std::chrono::time_point< std::chrono::system_clock > time;
+
+    auto finishedFrame = std::dynamic_pointer_cast< FinishedFrame >( frame );
+    auto processedFrame = std::dynamic_pointer_cast< ProcessedFrame >( frame );
+
+    if ( finishedFrame )
+        time = finishedFrame->time();
+    else if ( processedFrame )
+        time = processedFrame->time();
+
+    return std::chrono::duration_cast< std::chrono::microseconds >( time.time_since_epoch() ).count();
+}
+
+// StorageFormat
+const char StorageFormat::m_magic[ 8 ] = { 'S', 'L', 'A', 'M', 'M', 'A', 'P', '\0' };
+
+// MapWriter
+MapWriter::~MapWriter()
+{
+    close();
+}
+
+bool MapWriter::open( const std::string &fileName, const bool append )
+{
+    close();
+
+    if ( append ) {
+
+        std::ifstream check( fileName, std::ios::binary );
+
+        char magic[ sizeof( StorageFormat::m_magic ) ];
+        uint32_t version = 0;
+
+        if ( check.read( magic, sizeof( magic ) ) && check.read( reinterpret_cast< char * >( &version ), sizeof( version ) ) ) {
+
+            if ( memcmp( magic, StorageFormat::m_magic, sizeof( magic ) ) != 0 || version != StorageFormat::m_version )
+                return false;
+
+            check.close();
+
+            if ( !scanFile( fileName ) )
+                return false;
+
+            m_stream.open( fileName, std::ios::binary | std::ios::app );
+
+            return m_stream.is_open();
+
+        }
+
+    }
+
+    m_stream.open( fileName, std::ios::binary | std::ios::trunc );
+
+    if ( !m_stream.is_open() )
+        return false;
+
+    m_stream.write( StorageFormat::m_magic, sizeof( StorageFormat::m_magic ) );
+    m_stream.write( reinterpret_cast< const char * >( &StorageFormat::m_version ), sizeof( StorageFormat::m_version ) );
+
+    return m_stream.good();
+}
+
+void MapWriter::close()
+{
+    if ( m_stream.is_open() )
+        m_stream.close();
+
+    m_mapIds.clear();
+
+    m_mapIdOffset = 0;
+    m_mapPointIdOffset = 0;
+}
+
+bool MapWriter::scanFile( const std::string &fileName )
+{
+    std::ifstream stream( fileName, std::ios::binary | std::ios::ate );
+
+    if ( !stream.is_open() )
+        return false;
+
+    uint64_t fileSize = stream.tellg();
+    uint64_t position = sizeof( StorageFormat::m_magic ) + sizeof( StorageFormat::m_version );
+
+    while ( position < fileSize ) {
+
+        uint32_t type;
+        uint64_t size;
+        uint32_t mapId;
+
+        stream.seekg( position );
+
+        if ( !stream.read( reinterpret_cast< char * >( &type ), sizeof( type ) ) || !stream.read( reinterpret_cast< char * >( &size ), sizeof( size ) )
+                || fileSize - position - sizeof( type ) - sizeof( size ) < size )
+            break;
+
+        if ( size >= sizeof( mapId ) && stream.read( reinterpret_cast< char * >( &mapId ), sizeof( mapId ) ) ) {
+
+            m_mapIdOffset = std::max( m_mapIdOffset, mapId );
+
+            uint64_t mapPointId;
+
+            if ( type == StorageFormat::MAP_POINT && size >= sizeof( mapId ) + sizeof( mapPointId )
+                    && stream.read( reinterpret_cast< char * >( &mapPointId ), sizeof( mapPointId ) ) )
+                m_mapPointIdOffset = std::max( m_mapPointIdOffset, mapPointId );
+
+        }
+
+        position += sizeof( type ) + sizeof( size ) + size;
+
+    }
+
+    stream.close();
+
+    if ( position < fileSize )
+        return ::truncate( fileName.c_str(), position ) == 0;
+
+    return true;
+}
+
+bool MapWriter::isOpen() const
+{
+    return m_stream.is_open();
+}
+
+void MapWriter::writeWorld( const World &world )
+{
+    for ( auto &i : world.maps() )
+        writeMap( i );
+}
+
+void MapWriter::writeMap( const MapPtr &map )
+{
+    if ( !map || map->frames().empty() )
+        return;
+
+    auto id = mapId( map );
+
+    for ( auto &i : map->mapPoints() )
+        putMapPoint( id, i );
+
+    for ( auto &i : map->frames() ) {
+
+        auto keyFrame = std::dynamic_pointer_cast< StereoKeyFrame >( i );
+
+        if ( keyFrame )
+            putKeyFrame( id, keyFrame );
+
+    }
+
+}
+
+bool MapWriter::writeKeyFrame( const MapPtr &map, const StereoKeyFramePtr &frame )
+{
+    if ( !map || !frame || !m_stream.is_open() )
+        return false;
+
+    auto id = mapId( map );
+
+    auto leftFrame = frame->leftFrame();
+
+    if ( leftFrame )
+        for ( auto &i : leftFrame->framePoints() )
+            if ( i && i->mapPoint() )
+                putMapPoint( id, i->mapPoint() );
+
+    putKeyFrame( id, frame );
+
+    flush();
+
+    return m_stream.good();
+}
+
+void MapWriter::flush()
+{
+    m_stream.flush();
+}
+
+uint32_t MapWriter::mapId( const MapPtr &map )
+{
+    auto it = m_mapIds.find( map );
+
+    if ( it != m_mapIds.end() )
+        return it->second;
+
+    uint32_t ret = m_mapIdOffset + m_mapIds.size() + 1;
+
+    m_mapIds[ map ] = ret;
+
+    auto projectionMatrix = map->projectionMatrix();
+
+    put( &m_buffer, ret );
+    putProjectionMatrix( &m_buffer, projectionMatrix.leftProjectionMatrix() );
+    putProjectionMatrix( &m_buffer, projectionMatrix.rightProjectionMatrix() );
+
+    writeRecord( StorageFormat::MAP );
+
+    return ret;
+}
+
+uint64_t MapWriter::mapPointId( const MapPointPtr &point ) const
+{
+    return point ? m_mapPointIdOffset + point->id() : 0;
+}
+
+void MapWriter::writeRecord( const uint32_t type )
+{
+    uint64_t size = m_buffer.size();
+
+    m_stream.write( reinterpret_cast< const char * >( &type ), sizeof( type ) );
+    m_stream.write( reinterpret_cast< const char * >( &size ), sizeof( size ) );
+    m_stream.write( m_buffer.data(), m_buffer.size() );
+
+    m_buffer.clear();
+}
+
+void MapWriter::putMapPoint( const uint32_t mapId, const MapPointPtr &point )
+{
+    if ( !point )
+        return;
+
+    auto pt = point->point();
+
+    put( &m_buffer, mapId );
+    put( &m_buffer, mapPointId( point ) );
+    put( &m_buffer, pt.x );
+    put( &m_buffer, pt.y );
+    put( &m_buffer, pt.z );
+    putColor( &m_buffer, point->color() );
+
+    writeRecord( StorageFormat::MAP_POINT );
+}
+
+void MapWriter::putKeyFrame( const uint32_t mapId, const StereoKeyFramePtr &frame )
+{
+    auto leftFrame = frame->leftFrame();
+    auto rightFrame = frame->rightFrame();
+
+    if ( !leftFrame || !rightFrame )
+        return;
+
+    auto leftPoints = leftFrame->framePoints();
+    auto rightPoints = rightFrame->framePoints();
+
+    std::map< MonoPoint *, int32_t > rightIndexes;
+
+    for ( size_t i = 0; i < rightPoints.size(); ++i )
+        rightIndexes[ rightPoints[ i ].get() ] = i;
+
+    put( &m_buffer, mapId );
+    put( &m_buffer, frameTime( leftFrame ) );
+    putProjectionMatrix( &m_buffer, *leftFrame );
+    putProjectionMatrix( &m_buffer, *rightFrame );
+
+    put( &m_buffer, static_cast< uint32_t >( leftPoints.size() ) );
+
+    for ( auto &i : leftPoints ) {
+
+        auto mapPoint = i->mapPoint();
+        auto stereoPoint = i->stereoPoint();
+
+        int32_t stereoIndex = -1;
+
+        if ( stereoPoint ) {
+            auto it = rightIndexes.find( stereoPoint.get() );
+
+            if ( it != rightIndexes.end() )
+                stereoIndex = it->second;
+        }
+
+        put( &m_buffer, i->point().x );
+        put( &m_buffer, i->point().y );
+        putColor( &m_buffer, i->color() );
+        put( &m_buffer, mapPointId( mapPoint ) );
+        put( &m_buffer, stereoIndex );
+
+    }
+
+    put( &m_buffer, static_cast< uint32_t >( rightPoints.size() ) );
+
+    for ( auto &i : rightPoints ) {
+
+        auto mapPoint = i->mapPoint();
+
+        put( &m_buffer, i->point().x );
+        put( &m_buffer, i->point().y );
+        putColor( &m_buffer, i->color() );
+        put( &m_buffer, mapPointId( mapPoint ) );
+
+    }
+
+    writeRecord( StorageFormat::KEY_FRAME );
+}
+
+// MapReader
+MapReader::~MapReader()
+{
+    close();
+}
+
+bool MapReader::open( const std::string &fileName, const bool useMmap )
+{
+    close();
+
+    if ( useMmap ) {
+
+        auto fd = ::open( fileName.c_str(), O_RDONLY );
+
+        if ( fd < 0 )
+            return false;
+
+        struct stat info;
+
+        if ( fstat( fd, &info ) == 0 && info.st_size > 0 ) {
+
+            auto mapped = mmap( nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+
+            if ( mapped != MAP_FAILED ) {
+                madvise( mapped, info.st_size, MADV_SEQUENTIAL );
+
+                m_mapped = mapped;
+                m_data = static_cast< const char * >( mapped );
+                m_size = info.st_size;
+            }
+
+        }
+
+        ::close( fd );
+
+        if ( m_mapped )
+            return true;
+
+    }
+
+    std::ifstream stream( fileName, std::ios::binary | std::ios::ate );
+
+    if ( !stream.is_open() )
+        return false;
+
+    m_buffer.resize( stream.tellg() );
+
+    stream.seekg( 0 );
+
+    if ( !stream.read( m_buffer.data(), m_buffer.size() ) )
+        return false;
+
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+
+    return true;
+}
+
+void MapReader::close()
+{
+    if ( m_mapped )
+        munmap( m_mapped, m_size );
+
+    m_mapped = nullptr;
+    m_data = nullptr;
+    m_size = 0;
+
+    m_buffer.clear();
+}
+
+bool MapReader::read( const WorldPtr &world )
+{
+    if ( !world || !m_data )
+        return false;
+
+    const char *cursor = m_data;
+    const char *end = m_data + m_size;
+
+    char magic[ sizeof( StorageFormat::m_magic ) ];
+    uint32_t version;
+
+    if ( !get( &cursor, end, &magic ) || memcmp( magic, StorageFormat::m_magic, sizeof( magic ) ) != 0 )
+        return false;
+
+    if ( !get( &cursor, end, &version ) || version > StorageFormat::m_version )
+        return false;
+
+    std::map< uint32_t, MapPtr > maps;
+    std::list< MapPtr > worldMaps;
+    std::unordered_map< uint64_t, MapPointPtr > mapPoints;
+
+    auto findMapPoint = [ & ]( const uint64_t id ) {
+        auto it = mapPoints.find( id );
+        return it != mapPoints.end() ? it->second : MapPointPtr();
+    };
+
+    while ( cursor < end ) {
+
+        uint32_t type;
+        uint64_t size;
+
+        if ( !get( &cursor, end, &type ) || !get( &cursor, end, &size ) || static_cast< uint64_t >( end - cursor ) < size )
+            return false;
+
+        const char *record = cursor;
+        const char *recordEnd = cursor + size;
+
+        cursor = recordEnd;
+
+        uint32_t mapId;
+
+        if ( type != StorageFormat::MAP && type != StorageFormat::MAP_POINT && type != StorageFormat::KEY_FRAME )
+            continue;
+
+        if ( !get( &record, recordEnd, &mapId ) )
+            return false;
+
+        if ( type == StorageFormat::MAP ) {
+
+            ProjectionMatrix leftMatrix, rightMatrix;
+
+            if ( !getProjectionMatrix( &record, recordEnd, &leftMatrix ) || !getProjectionMatrix( &record, recordEnd, &rightMatrix ) )
+                return false;
+
+            auto map = Map::create( StereoCameraMatrix( leftMatrix, rightMatrix ), world );
+
+            maps[ mapId ] = map;
+            worldMaps.push_back( map );
+
+            continue;
+
+        }
+
+        auto mapIt = maps.find( mapId );
+
+        if ( mapIt == maps.end() )
+            return false;
+
+        auto map = mapIt->second;
+
+        if ( type == StorageFormat::MAP_POINT ) {
+
+            uint64_t id;
+            cv::Point3f pt;
+            cv::Scalar color;
+
+            if ( !get( &record, recordEnd, &id ) || !get( &record, recordEnd, &pt.x ) || !get( &record, recordEnd, &pt.y )
+                    || !get( &record, recordEnd, &pt.z ) || !getColor( &record, recordEnd, &color ) )
+                return false;
+
+            auto mapPoint = findMapPoint( id );
+
+            if ( mapPoint ) {
+                mapPoint->setPoint( pt );
+                mapPoint->setColor( color );
+            }
+            else
+                mapPoints[ id ] = map->createMapPoint( pt, color );
+
+        }
+        else if ( type == StorageFormat::KEY_FRAME ) {
+
+            int64_t time;
+            ProjectionMatrix leftMatrix, rightMatrix;
+
+            if ( !get( &record, recordEnd, &time ) || !getProjectionMatrix( &record, recordEnd, &leftMatrix ) || !getProjectionMatrix( &record, recordEnd, &rightMatrix ) )
+                return false;
+
+            auto frameTime = std::chrono::time_point< std::chrono::system_clock >( std::chrono::duration_cast< std::chrono::system_clock::duration >( std::chrono::microseconds( time ) ) );
+
+            auto leftFrame = FinishedKeyFrame::create( frameTime );
+            auto rightFrame = FinishedKeyFrame::create( frameTime );
+
+            leftFrame->setCameraMatrix( leftMatrix.cameraMatrix() );
+            leftFrame->setRotation( leftMatrix.rotation() );
+            leftFrame->setTranslation( leftMatrix.translation() );
+
+            rightFrame->setCameraMatrix( rightMatrix.cameraMatrix() );
+            rightFrame->setRotation( rightMatrix.rotation() );
+            rightFrame->setTranslation( rightMatrix.translation() );
+
+            auto frame = FinishedStereoKeyFrame::create( map );
+            frame->setFrames( leftFrame, rightFrame );
+
+            uint32_t leftCount;
+
+            if ( !get( &record, recordEnd, &leftCount ) )
+                return false;
+
+            std::vector< std::pair< FinishedFramePointPtr, int32_t > > leftPoints;
+            leftPoints.reserve( leftCount );
+
+            for ( uint32_t i = 0; i < leftCount; ++i ) {
+
+                cv::Point2f pt;
+                cv::Scalar color;
+                uint64_t mapPointId;
+                int32_t stereoIndex;
+
+                if ( !get( &record, recordEnd, &pt.x ) || !get( &record, recordEnd, &pt.y ) || !getColor( &record, recordEnd, &color )
+                        || !get( &record, recordEnd, &mapPointId ) || !get( &record, recordEnd, &stereoIndex ) )
+                    return false;
+
+                auto point = leftFrame->createFramePoint( pt, color );
+
+                auto mapPoint = findMapPoint( mapPointId );
+
+                if ( mapPoint )
+                    point->setMapPoint( mapPoint );
+
+                leftPoints.push_back( std::make_pair( point, stereoIndex ) );
+
+            }
+
+            uint32_t rightCount;
+
+            if ( !get( &record, recordEnd, &rightCount ) )
+                return false;
+
+            std::vector< FinishedFramePointPtr > rightPoints;
+            rightPoints.reserve( rightCount );
+
+            for ( uint32_t i = 0; i < rightCount; ++i ) {
+
+                cv::Point2f pt;
+                cv::Scalar color;
+                uint64_t mapPointId;
+
+                if ( !get( &record, recordEnd, &pt.x ) || !get( &record, recordEnd, &pt.y ) || !getColor( &record, recordEnd, &color )
+                        || !get( &record, recordEnd, &mapPointId ) )
+                    return false;
+
+                auto point = rightFrame->createFramePoint( pt, color );
+
+                auto mapPoint = findMapPoint( mapPointId );
+
+                if ( mapPoint )
+                    point->setMapPoint( mapPoint );
+
+                rightPoints.push_back( point );
+
+            }
+
+            for ( auto &i : leftPoints ) {
+
+                if ( i.second >= 0 && static_cast< size_t >( i.second ) < rightPoints.size() ) {
+                    i.first->setStereoPoint( rightPoints[ i.second ] );
+                    rightPoints[ i.second ]->setStereoPoint( i.first );
+                }
+
+            }
+
+            map->m_frames.push_back( frame );
+
+        }
+
+    }
+
+    world->m_maps = std::move( worldMaps );
+
+    return true;
+}
+
+bool exportPly( const std::string &fileName, const std::vector< ColorPoint3d > &cloud, const std::list< StereoCameraMatrix > &path )
+{
+    std::ofstream stream( fileName, std::ios::binary | std::ios::trunc );
+
+    if ( !stream.is_open() )
+        return false;
+
+    stream << "ply\n"
+           << "format binary_little_endian 1.0\n"
+           << "element vertex " << cloud.size() + path.size() << "\n"
+           << "property float x\n"
+           << "property float y\n"
+           << "property float z\n"
+           << "property uchar red\n"
+           << "property uchar green\n"
+           << "property uchar blue\n"
+           << "end_header\n";
+
+    std::vector< char > buffer;
+    buffer.reserve( ( cloud.size() + path.size() ) * ( 3 * sizeof( float ) + 3 ) );
+
+    auto putVertex = [ &buffer ]( const cv::Point3f &point, const cv::Scalar &color ) {
+        put( &buffer, point.x );
+        put( &buffer, point.y );
+        put( &buffer, point.z );
+
+        for ( int i = 2; i >= 0; --i )
+            put( &buffer, cv::saturate_cast< uint8_t >( color[ i ] ) );
+    };
+
+    for ( auto &i : cloud )
+        putVertex( i.point(), i.color() );
+
+    for ( auto &i : path )
+        putVertex( static_cast< cv::Point3d >( i.leftProjectionMatrix() ), cv::Scalar( 0, 0, 255 ) );
+
+    stream.write( buffer.data(), buffer.size() );
+
+    return stream.good();
+}
+
+bool exportPcd( const std::string &fileName, const std::vector< ColorPoint3d > &cloud )
+{
+    std::ofstream stream( fileName, std::ios::binary | std::ios::trunc );
+
+    if ( !stream.is_open() )
+        return false;
+
+    stream << "# .PCD v0.7 - Point Cloud Data file format\n"
+           << "VERSION 0.7\n"
+           << "FIELDS x y z rgb\n"
+           << "SIZE 4 4 4 4\n"
+           << "TYPE F F F U\n"
+           << "COUNT 1 1 1 1\n"
+           << "WIDTH " << cloud.size() << "\n"
+           << "HEIGHT 1\n"
+           << "VIEWPOINT 0 0 0 1 0 0 0\n"
+           << "POINTS " << cloud.size() << "\n"
+           << "DATA binary\n";
+
+    std::vector< char > buffer;
+    buffer.reserve( cloud.size() * 4 * sizeof( float ) );
+
+    for ( auto &i : cloud ) {
+
+        auto color = i.color();
+
+        uint32_t rgb = ( static_cast< uint32_t >( cv::saturate_cast< uint8_t >( color[ 2 ] ) ) << 16 )
+                     | ( static_cast< uint32_t >( cv::saturate_cast< uint8_t >( color[ 1 ] ) ) << 8 )
+                     | static_cast< uint32_t >( cv::saturate_cast< uint8_t >( color[ 0 ] ) );
+
+        put( &buffer, i.point().x );
+        put( &buffer, i.point().y );
+        put( &buffer, i.point().z );
+        put( &buffer, rgb );
+
+    }
+
+    stream.write( buffer.data(), buffer.size() );
+
+    return stream.good();
+}
+
+}
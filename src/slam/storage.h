@@ -0,0 +1,101 @@
+#pragma once
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "src/common/projectionmatrix.h"
+#include "src/common/colorpoint.h"
+
+#include "alias.h"
+
+namespace slam {
+
+class World;
+
+// Binary map file: header followed by tagged records. Records are appended
+// as key frames are finished, so a later record of the same map point
+// overrides the position stored by an earlier one. A writer appending to
+// an existing file continues its map and map point ids, so sessions never
+// share ids.
+class StorageFormat
+{
+public:
+    enum RecordType : uint32_t { MAP = 1, MAP_POINT = 2, KEY_FRAME = 3 };
+
+    static const char m_magic[ 8 ];
+    static const uint32_t m_version = 1;
+
+};
+
+class MapWriter
+{
+public:
+    MapWriter() = default;
+    ~MapWriter();
+
+    bool open( const std::string &fileName, const bool append = false );
+    void close();
+
+    bool isOpen() const;
+
+    void writeWorld( const World &world );
+    void writeMap( const MapPtr &map );
+    bool writeKeyFrame( const MapPtr &map, const StereoKeyFramePtr &frame );
+
+    void flush();
+
+protected:
+    using MapPtrImpl = std::weak_ptr< Map >;
+
+    std::ofstream m_stream;
+
+    std::map< MapPtrImpl, uint32_t, std::owner_less< MapPtrImpl > > m_mapIds;
+
+    std::vector< char > m_buffer;
+
+    uint32_t m_mapIdOffset = 0;
+    uint64_t m_mapPointIdOffset = 0;
+
+    uint32_t mapId( const MapPtr &map );
+    uint64_t mapPointId( const MapPointPtr &point ) const;
+
+    // Finds the last ids of the file and cuts a record left incomplete by an interrupted session
+    bool scanFile( const std::string &fileName );
+
+    void writeRecord( const uint32_t type );
+
+    void putMapPoint( const uint32_t mapId, const MapPointPtr &point );
+    void putKeyFrame( const uint32_t mapId, const StereoKeyFramePtr &frame );
+
+};
+
+class MapReader
+{
+public:
+    MapReader() = default;
+    ~MapReader();
+
+    bool open( const std::string &fileName, const bool useMmap = true );
+    void close();
+
+    // The world maps are replaced only if the whole file is read
+    bool read( const WorldPtr &world );
+
+protected:
+    std::vector< char > m_buffer;
+
+    const char *m_data = nullptr;
+    size_t m_size = 0;
+
+    void *m_mapped = nullptr;
+
+};
+
+bool exportPly( const std::string &fileName, const std::vector< ColorPoint3d > &cloud, const std::list< StereoCameraMatrix > &path = std::list< StereoCameraMatrix >() );
+bool exportPcd( const std::string &fileName, const std::vector< ColorPoint3d > &cloud );
+
+}
@@ -6,6 +6,17 @@
 
 namespace slam {
 
+void FlowTracker::releasePyramid( std::vector< cv::Mat > *imagePyramid )
+{
+    if ( imagePyramid )
+        imagePyramid->clear();
+}
+
+bool FlowTracker::isConcurrent() const
+{
+    return false;
+}
+
 double FlowTracker::extractPrecision() const
 {
     return m_pointsProcessor->extractPrecision();
@@ -60,11 +71,9 @@ void GPUFlowTracker::extractPoints( FlowKeyFrame *frame )
 
         if ( extractPointsCount > 0 ) {
 
-            frame->createMask();
-
             processor()->setExtractionDistance( frame->pointsInterval() );
 
-            processor()->extractPoints( frame->image(), frame->mask(), &points, extractPointsCount );
+            processor()->extractPoints( frame->image(), frame->points(), &points, extractPointsCount );
 
             frame->addFlowPoints( points );
 
@@ -74,7 +83,7 @@ void GPUFlowTracker::extractPoints( FlowKeyFrame *frame )
 
 }
 
-cv::Mat GPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints )
+cv::Mat GPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat & )
 {
     if ( frame1 && frame2 && trackedPoints ) {
 
@@ -118,6 +127,50 @@ cv::Mat GPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &f
 
 }
 
+cv::Mat GPUFlowTracker::match( const FlowFramePtr &leftFrame, const FlowFramePtr &rightFrame, const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints )
+{
+    if ( leftFrame && rightFrame && trackedPoints ) {
+
+        std::vector< cv::Point2f > points;
+
+        auto flowPoints = leftFrame->flowPoints();
+
+        points.reserve( flowPoints.size() );
+
+        for ( auto &i : flowPoints )
+            if ( i )
+                points.push_back( i->point() );
+
+        std::vector< FlowTrackResult > flowResults;
+
+        processor()->track( leftFrame->image(), points, rightFrame->image(), &flowResults );
+
+        std::vector< cv::Point2f > sourcePoints, targetPoints;
+        sourcePoints.reserve( flowResults.size() );
+        targetPoints.reserve( flowResults.size() );
+
+        for ( auto &i : flowResults ) {
+            sourcePoints.push_back( points[ i.index ]);
+            targetPoints.push_back( i );
+        }
+
+        std::vector< int > rowIndexes;
+
+        auto fmat = processor()->rowTest( sourcePoints, targetPoints, minDisparity, maxDisparity, &rowIndexes );
+
+        trackedPoints->clear();
+
+        for ( auto &i : rowIndexes )
+            trackedPoints->push_back( flowResults[ i ] );
+
+        return fmat;
+
+    }
+
+    return cv::Mat();
+
+}
+
 GPUFlowProcessor *GPUFlowTracker::processor() const
 {
     return dynamic_cast< GPUFlowProcessor* >( m_pointsProcessor.get() );
@@ -147,6 +200,11 @@ void CPUFlowTracker::buildPyramid( FlowFrame *frame )
 
 }
 
+void CPUFlowTracker::releasePyramid( std::vector< cv::Mat > *imagePyramid )
+{
+    processor()->releaseImagePyramid( imagePyramid );
+}
+
 void CPUFlowTracker::extractPoints( FlowKeyFrame *frame )
 {
     if ( frame ) {
@@ -156,11 +214,9 @@ void CPUFlowTracker::extractPoints( FlowKeyFrame *frame )
 
         if ( extractPointsCount > 0 ) {
 
-            frame->createMask();
-
             processor()->setExtractionDistance( frame->pointsInterval() );
 
-            processor()->extractPoints( frame->image(), frame->mask(), &points, extractPointsCount );
+            processor()->extractPoints( frame->image(), frame->points(), &points, extractPointsCount );
 
             frame->addFlowPoints( points );
 
@@ -170,7 +226,7 @@ void CPUFlowTracker::extractPoints( FlowKeyFrame *frame )
 
 }
 
-cv::Mat CPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints )
+cv::Mat CPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat &prediction )
 {
     if ( frame1 && frame2 && trackedPoints ) {
 
@@ -190,9 +246,14 @@ cv::Mat CPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &f
             if ( i )
                 points.push_back( i->point() );
 
+        std::vector< cv::Point2f > guessPoints;
+
+        if ( !prediction.empty() && !points.empty() )
+            cv::perspectiveTransform( points, guessPoints, prediction );
+
         std::vector< FlowTrackResult > flowResults;
 
-        processor()->track( frame1->imagePyramid(), points, frame2->imagePyramid(), &flowResults );
+        processor()->track( frame1->imagePyramid(), points, frame2->imagePyramid(), &flowResults, guessPoints );
 
         std::vector< cv::Point2f > sourcePoints, targetPoints;
         sourcePoints.reserve( flowResults.size() );
@@ -220,6 +281,39 @@ cv::Mat CPUFlowTracker::track( const FlowFramePtr &frame1, const FlowFramePtr &f
 
 }
 
+cv::Mat CPUFlowTracker::match( const FlowFramePtr &leftFrame, const FlowFramePtr &rightFrame, const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints )
+{
+    if ( leftFrame && rightFrame && trackedPoints ) {
+
+        if ( leftFrame->imagePyramid().empty() )
+            leftFrame->buildPyramid();
+
+        if ( rightFrame->imagePyramid().empty() )
+            rightFrame->buildPyramid();
+
+        std::vector< cv::Point2f > points;
+
+        auto flowPoints = leftFrame->flowPoints();
+
+        points.reserve( flowPoints.size() );
+
+        for ( auto &i : flowPoints )
+            if ( i )
+                points.push_back( i->point() );
+
+        return processor()->trackStereo( leftFrame->imagePyramid(), points, rightFrame->imagePyramid(), minDisparity, maxDisparity, trackedPoints );
+
+    }
+
+    return cv::Mat();
+
+}
+
+bool CPUFlowTracker::isConcurrent() const
+{
+    return true;
+}
+
 CPUFlowProcessor *CPUFlowTracker::processor() const
 {
     return dynamic_cast< CPUFlowProcessor* >( m_pointsProcessor.get() );
@@ -15,9 +15,17 @@ class FlowTracker
 {
 public:
     virtual void buildPyramid( FlowFrame *frame ) = 0;
+    virtual void releasePyramid( std::vector< cv::Mat > *imagePyramid );
     virtual void extractPoints( FlowKeyFrame *frame ) = 0;
 
-    virtual cv::Mat track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints ) = 0;
+    // The prediction, if given, is a homography of the first frame points to their expected places in the second one
+    virtual cv::Mat track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat &prediction = cv::Mat() ) = 0;
+
+    // Stereo match of a rectified pair: right points are searched on the
+    // same row within the disparity band
+    virtual cv::Mat match( const FlowFramePtr &leftFrame, const FlowFramePtr &rightFrame, const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints ) = 0;
+
+    virtual bool isConcurrent() const;
 
     double extractPrecision() const;
     void setExtractPrecision( const double value );
@@ -46,7 +54,8 @@ public:
     virtual void buildPyramid( FlowFrame *) override;
     virtual void extractPoints( FlowKeyFrame *frame ) override;
 
-    virtual cv::Mat track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints ) override;
+    virtual cv::Mat track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat &prediction = cv::Mat() ) override;
+    virtual cv::Mat match( const FlowFramePtr &leftFrame, const FlowFramePtr &rightFrame, const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints ) override;
 
 protected:
     GPUFlowProcessor *processor() const;
@@ -62,9 +71,13 @@ public:
     CPUFlowTracker();
 
     virtual void buildPyramid( FlowFrame *frame ) override;
+    virtual void releasePyramid( std::vector< cv::Mat > *imagePyramid ) override;
     virtual void extractPoints( FlowKeyFrame *frame ) override;
 
-    virtual cv::Mat track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints ) override;
+    virtual cv::Mat track( const FlowFramePtr &frame1, const FlowFramePtr &frame2, std::vector< FlowTrackResult > *trackedPoints, const cv::Mat &prediction = cv::Mat() ) override;
+    virtual cv::Mat match( const FlowFramePtr &leftFrame, const FlowFramePtr &rightFrame, const double minDisparity, const double maxDisparity, std::vector< FlowTrackResult > *trackedPoints ) override;
+
+    virtual bool isConcurrent() const override;
 
 protected:
     CPUFlowProcessor *processor() const;
@@ -48,6 +48,8 @@ const std::list< MapPtr > &World::maps() const
 
 bool World::track( const StampedImage &leftImage, const StampedImage &rightImage )
 {
+    m_imuIntegrator.integrate( leftImage.time() );
+
     auto restoreRotation = this->restoreRotation();
     auto restoreTranslation = this->restoreTranslation();
 
@@ -95,6 +97,8 @@ bool World::track( const StampedImage &leftImage, const StampedImage &rightImage
 
         }
 
+        m_memoryManager.process( m_maps, m_settings );
+
         return result;
 
     }
@@ -103,6 +107,21 @@ bool World::track( const StampedImage &leftImage, const StampedImage &rightImage
 
 }
 
+bool World::addImuData( const ImuData &data )
+{
+    return m_imuIntegrator.addData( data );
+}
+
+ImuIntegrator &World::imuIntegrator()
+{
+    return m_imuIntegrator;
+}
+
+const ImuIntegrator &World::imuIntegrator() const
+{
+    return m_imuIntegrator;
+}
+
 void World::setRestoreMatrix( const cv::Mat &rotation, const cv::Mat &translation )
 {
     m_restoreMatrix = cv::Mat( 3, 4, CV_64F );
@@ -151,11 +170,26 @@ const std::unique_ptr< FeatureTracker > &World::featureTracker() const
     return m_featureTracker;
 }
 
+Settings &World::settings()
+{
+    return m_settings;
+}
+
 const Settings &World::settings() const
 {
     return m_settings;
 }
 
+MemoryManager &World::memoryManager()
+{
+    return m_memoryManager;
+}
+
+const MemoryManager &World::memoryManager() const
+{
+    return m_memoryManager;
+}
+
 double World::maxReprojectionError() const
 {
     return m_settings.maxReprojectionError();
@@ -291,6 +325,114 @@ std::vector< ColorPoint3d > World::sparseCloud() const
     return ret;
 }
 
+bool World::save( const std::string &fileName ) const
+{
+    MapWriter writer;
+
+    if ( !writer.open( fileName ) )
+        return false;
+
+    writer.writeWorld( *this );
+    writer.flush();
+
+    return true;
+}
+
+bool World::verify( const std::string &fileName ) const
+{
+    auto world = create( m_startCameraMatrix );
+
+    MapReader reader;
+
+    if ( !reader.open( fileName ) || !reader.read( world ) )
+        return false;
+
+    std::list< StereoCameraMatrix > path;
+
+    auto loadedMap = world->maps().begin();
+
+    for ( auto &map : m_maps ) {
+
+        // Maps without frames are not stored
+        if ( map->frames().empty() )
+            continue;
+
+        if ( loadedMap == world->maps().end() )
+            return false;
+
+        size_t keyFramesCount = 0;
+
+        for ( auto &i : map->frames() ) {
+
+            auto keyFrame = std::dynamic_pointer_cast< StereoKeyFrame >( i );
+
+            if ( keyFrame && keyFrame->leftFrame() && keyFrame->rightFrame() ) {
+                ++keyFramesCount;
+                path.push_back( keyFrame->projectionMatrix() );
+            }
+
+        }
+
+        if ( ( *loadedMap )->frames().size() != keyFramesCount || ( *loadedMap )->mapPoints().size() != map->mapPoints().size() )
+            return false;
+
+        ++loadedMap;
+
+    }
+
+    // Every stored key frame is read as a finished one, so all of them are on the path
+    return loadedMap == world->maps().end() && world->path() == path;
+}
+
+bool World::load( const std::string &fileName, const bool useMmap )
+{
+    MapReader reader;
+
+    if ( !reader.open( fileName, useMmap ) )
+        return false;
+
+    if ( !reader.read( shared_from_this() ) )
+        return false;
+
+    if ( !m_maps.empty() )
+        createMap( m_maps.back()->backProjectionMatrix() );
+
+    return true;
+}
+
+bool World::setRecordFile( const std::string &fileName )
+{
+    if ( fileName.empty() ) {
+        m_recordWriter.reset();
+        return true;
+    }
+
+    auto writer = std::unique_ptr< MapWriter >( new MapWriter() );
+
+    if ( !writer->open( fileName, true ) )
+        return false;
+
+    m_recordWriter = std::move( writer );
+
+    return true;
+}
+
+void World::recordKeyFrame( const MapPtr &map, const StereoKeyFramePtr &frame )
+{
+    if ( m_recordWriter )
+        m_recordWriter->writeKeyFrame( map, frame );
+}
+
+bool World::exportPly( const std::string &fileName ) const
+{
+    return slam::exportPly( fileName, sparseCloud(), path() );
+}
+
+bool World::exportPcd( const std::string &fileName ) const
+{
+    return slam::exportPcd( fileName, sparseCloud() );
+}
+
 void World::createMap( const StereoCameraMatrix &cameraMatrix )
 {
     m_maps.push_back( Map::create( cameraMatrix, shared_from_this() ) );
@@ -2,14 +2,19 @@
 
 #include "map.h"
 #include "tracker.h"
+#include "imudata.h"
 #include "src/common/stereoprocessor.h"
 
 #include "settings.h"
+#include "storage.h"
+#include "memorymanager.h"
 
 namespace slam {
 
 class World : public std::enable_shared_from_this< World >
 {
+    friend class MapReader;
+
 public:
     using ObjectPtr = std::shared_ptr< World >;
     using ObjectConstPtr = std::shared_ptr< const World >;
@@ -20,6 +25,12 @@ public:
 
     bool track( const StampedImage &leftImage, const StampedImage &rightImage );
 
+    // Thread safe against track(), from one producer thread
+    bool addImuData( const ImuData &data );
+
+    ImuIntegrator &imuIntegrator();
+    const ImuIntegrator &imuIntegrator() const;
+
     void setRestoreMatrix( const cv::Mat &rotation, const cv::Mat &translation );
     const cv::Mat &restoreMatrix() const;
     cv::Mat restoreRotation() const;
@@ -31,8 +42,12 @@ public:
     const std::unique_ptr< FlowTracker > &flowTracker() const;
     const std::unique_ptr< FeatureTracker > &featureTracker() const;
 
+    Settings &settings();
     const Settings &settings() const;
 
+    MemoryManager &memoryManager();
+    const MemoryManager &memoryManager() const;
+
     double maxReprojectionError() const;
 
     double minStereoDisparity() const;
@@ -50,6 +65,20 @@ public:
     std::list< StereoCameraMatrix > path() const;
     std::vector< ColorPoint3d > sparseCloud() const;
 
+    bool save( const std::string &fileName ) const;
+
+    // Reads a saved file into a new world and checks that it holds the
+    // maps, key frames, map points and key frame path of this one
+    bool verify( const std::string &fileName ) const;
+
+    bool load( const std::string &fileName, const bool useMmap = true );
+
+    bool setRecordFile( const std::string &fileName );
+    void recordKeyFrame( const MapPtr &map, const StereoKeyFramePtr &frame );
+
+    bool exportPly( const std::string &fileName ) const;
+    bool exportPcd( const std::string &fileName ) const;
+
 protected:
     World( const StereoCameraMatrix &cameraMatrix );
 
@@ -66,6 +95,12 @@ protected:
 
     Settings m_settings;
 
+    std::unique_ptr< MapWriter > m_recordWriter;
+
+    MemoryManager m_memoryManager;
+
+    ImuIntegrator m_imuIntegrator;
+
     void createMap( const StereoCameraMatrix &cameraMatrix );
 
 private:
@@ -211,6 +211,7 @@ size_t ProcFrame::addCornerPoints( const std::vector< cv::Point2f > &points )
 void ProcFrame::setFeaturePoints( const std::vector< cv::KeyPoint > &value )
 {
     std::vector< cv::Point2f > points;
+    points.reserve( value.size() );
 
     for ( auto &i : value )
         points.push_back( i.pt );
@@ -222,32 +223,11 @@ void ProcFrame::setFeaturePoints( const std::vector< cv::KeyPoint > &value )
 
 void ProcFrame::undistortPoints( const std::vector< cv::Point2f > &sourcePoints, std::vector< cv::Point2f > *undistortedPoints ) const
 {
-    cv::undistortPoints( sourcePoints, *undistortedPoints, _cameraMatrix, _distCoefficients );
-
-    for ( auto &i : *undistortedPoints ) {
-        cv::Mat pt( 3, 1, CV_64F );
-        pt.at< double >( 0, 0 ) = i.x;
-        pt.at< double >( 1, 0 ) = i.y;
-        pt.at< double >( 2, 0 ) = 1;
-
-        cv::Mat mul = _cameraMatrix * pt;
-
-        auto w = mul.at< double >( 2, 0 );
-
-        if ( std::abs( w ) > FLOAT_EPS ) {
-            i.x = mul.at< double >( 0, 0 ) / w;
-            i.y = mul.at< double >( 1, 0 ) / w;
-        }
-        else {
-            i.x = 0.;
-            i.y = 0.;
-        }
-
-    }
-
+    // Projecting with the camera matrix straight away gives pixel coordinates
+    // without a normalized round trip, the output vector keeps its capacity
+    cv::undistortPoints( sourcePoints, *undistortedPoints, _cameraMatrix, _distCoefficients, cv::noArray(), _cameraMatrix );
 }
 
-
 const std::vector< cv::KeyPoint > &ProcFrame::featurePoints() const
 {
     return _featurePoints;
@@ -672,4 +652,127 @@ void ProcStereoFrame::setDescriptors( const cv::Mat &left, const cv::Mat &right
     rightFrame()->setDescriptors( right );
 }
 
+// ConsecutiveStereoFrames
+ConsecutiveStereoFrames::ConsecutiveStereoFrames( const ProcStereoFramePtr &previousFrame, const ProcStereoFramePtr &nextFrame )
+    : _previousFrame( previousFrame ), _nextFrame( nextFrame )
+{
+}
+
+const ProcStereoFramePtr &ConsecutiveStereoFrames::previousFrame() const
+{
+    return _previousFrame;
+}
+
+const ProcStereoFramePtr &ConsecutiveStereoFrames::nextFrame() const
+{
+    return _nextFrame;
+}
+
+void ConsecutiveStereoFrames::predictFeaturePoints( std::vector< size_t > *indexes, std::vector< cv::Point2f > *points ) const
+{
+    indexes->clear();
+    points->clear();
+
+    cv::Mat projectionMatrix = _nextFrame->leftProjectionMatrix().projectionMatrix();
+
+    auto &image = _nextFrame->leftFrame()->image();
+
+    for ( auto &i : _previousFrame->_points ) {
+
+        auto featurePoint = std::dynamic_pointer_cast< FeatureStereoPoint >( i );
+
+        if ( featurePoint && featurePoint->isPoint3dExist() ) {
+
+            auto &point3d = featurePoint->point3d();
+
+            cv::Mat pt4d = ( cv::Mat_< double >( 4, 1 ) << point3d.x, point3d.y, point3d.z, 1. );
+            cv::Mat projected = projectionMatrix * pt4d;
+
+            auto w = projected.at< double >( 2, 0 );
+
+            if ( w > DOUBLE_EPS ) {
+
+                cv::Point2f point( projected.at< double >( 0, 0 ) / w, projected.at< double >( 1, 0 ) / w );
+
+                if ( point.x >= 0 && point.y >= 0 && point.x < image.width() && point.y < image.height() ) {
+                    indexes->push_back( featurePoint->leftPoint()->index() );
+                    points->push_back( point );
+                }
+
+            }
+
+        }
+
+    }
+
+}
+
+void ConsecutiveStereoFrames::setMatches( const std::vector< cv::DMatch > &value )
+{
+    _matches = value;
+}
+
+const std::vector< cv::DMatch > &ConsecutiveStereoFrames::matches() const
+{
+    return _matches;
+}
+
+size_t ConsecutiveStereoFrames::estimatePose()
+{
+    auto &parameters = _nextFrame->parentSystem()->parameters();
+
+    std::map< size_t, cv::Point3f > previousPoints;
+
+    for ( auto &i : _previousFrame->_points ) {
+
+        auto featurePoint = std::dynamic_pointer_cast< FeatureStereoPoint >( i );
+
+        if ( featurePoint && featurePoint->isPoint3dExist() )
+            previousPoints[ featurePoint->leftPoint()->index() ] = featurePoint->point3d();
+
+    }
+
+    std::vector< cv::Point3f > objectPoints;
+    std::vector< cv::Point2f > imagePoints;
+
+    auto nextLeftFrame = _nextFrame->leftFrame();
+
+    for ( auto &i : _matches ) {
+
+        auto it = previousPoints.find( i.queryIdx );
+
+        if ( it != previousPoints.end() ) {
+            objectPoints.push_back( it->second );
+            imagePoints.push_back( nextLeftFrame->undistortedFeaturePoint( i.trainIdx ) );
+        }
+
+    }
+
+    if ( objectPoints.size() < parameters.minGuidedMatchesCount() )
+        return 0;
+
+    cv::Mat rvec, tvec;
+
+    cv::Rodrigues( _nextFrame->rotation(), rvec );
+    _nextFrame->translation().convertTo( tvec, CV_64F );
+    rvec.convertTo( rvec, CV_64F );
+
+    std::vector< int > inliers;
+
+    if ( !cv::solvePnPRansac( objectPoints, imagePoints, nextLeftFrame->cameraMatrix(), cv::noArray(), rvec, tvec, true,
+                              100, parameters.maxReprojectionError(), 0.99, inliers ) )
+        return 0;
+
+    if ( inliers.size() < parameters.minGuidedMatchesCount() )
+        return 0;
+
+    cv::Mat rotation;
+    cv::Rodrigues( rvec, rotation );
+
+    _nextFrame->setRotation( rotation );
+    _nextFrame->setTranslation( tvec );
+
+    return inliers.size();
+}
+
 }
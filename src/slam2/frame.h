@@ -72,6 +72,9 @@ class ProcFrame : public FinalFrame
     friend class CPUFlowTracker;
     friend class GPUFlowTracker;
     friend class SiftTracker;
+    friend class OrbTracker;
+    friend class AKazeTracker;
+    friend class FeatureTracker;
 public:
     using ObjectClass = ProcFrame;
     using ParentClass = Frame;
@@ -218,6 +221,8 @@ class ProcStereoFrame : public FinalStereoFrame
     friend class OrbTracker;
     friend class AKazeTracker;
     friend class SuperGlueTracker;
+    friend class FeatureTracker;
+    friend class ConsecutiveStereoFrames;
 public:
     using ObjectClass = ProcStereoFrame;
     using ParentClass = FinalStereoFrame;
@@ -265,6 +270,29 @@ protected:
 
 class ConsecutiveStereoFrames
 {
+public:
+    ConsecutiveStereoFrames( const ProcStereoFramePtr &previousFrame, const ProcStereoFramePtr &nextFrame );
+
+    const ProcStereoFramePtr &previousFrame() const;
+    const ProcStereoFramePtr &nextFrame() const;
+
+    // Triangulated feature points of the previous frame projected into the
+    // left image of the next one with its predicted pose
+    void predictFeaturePoints( std::vector< size_t > *indexes, std::vector< cv::Point2f > *points ) const;
+
+    void setMatches( const std::vector< cv::DMatch > &value );
+    const std::vector< cv::DMatch > &matches() const;
+
+    // Pose of the next frame from the matched triangulated points of the previous one,
+    // the predicted pose is the initial guess and is kept if there are too few inliers
+    size_t estimatePose();
+
+protected:
+    ProcStereoFramePtr _previousFrame;
+    ProcStereoFramePtr _nextFrame;
+
+    std::vector< cv::DMatch > _matches;
+
 };
 
 }
@@ -4,6 +4,9 @@
 
 #include "system.h"
 #include "frame.h"
+#include "tracker.h"
+
+#include "src/common/profiler.h"
 
 namespace slam2 {
 
@@ -81,18 +84,80 @@ void Map::track( const StampedStereoImage &image )
 
     frame->load( image );
 
+    predictPose( frame );
+
     frame->prepareFrame();
 
-    frame->extract();
+    {
+        PROFILE_SCOPE( "frame extraction" );
+
+        frame->extract();
+    }
+
+    if ( !_sequence.empty() ) {
+
+        auto procFrame = std::dynamic_pointer_cast< ProcStereoFrame >( _sequence.back() );
+
+        if ( procFrame ) {
+
+            ConsecutiveStereoFrames consecutiveFrames( procFrame, frame );
+
+            {
+                PROFILE_SCOPE( "frame matching" );
+
+                system->tracker()->match( &consecutiveFrames );
+            }
+
+            {
+                PROFILE_SCOPE( "pose estimation" );
+
+                consecutiveFrames.estimatePose();
+            }
+
+            // Only the newest frame's pyramids are kept for the next match
+            system->tracker()->releaseFrame( procFrame.get() );
+
+        }
+
+    }
+
+    // The points are triangulated with the estimated pose, so the next frame matches against world points
+    {
+        PROFILE_SCOPE( "triangulation" );
 
-    frame->triangulatePoints();
+        frame->triangulatePoints();
+    }
 
-    // TEMPORARY:
+    // TEMPORARY: the newest frame stays, it is the reference of the next match and the motion model
     if ( _sequence.size() > 5 )
-        _sequence.clear();
+        _sequence.erase( _sequence.begin(), _sequence.end() - 1 );
 
     _sequence.push_back( frame );
 
 }
 
+void Map::predictPose( const StereoFramePtr &frame ) const
+{
+    // Constant velocity: the last motion is applied once more
+    if ( _sequence.size() > 1 ) {
+
+        auto &previousFrame = _sequence.back();
+        auto &olderFrame = _sequence[ _sequence.size() - 2 ];
+
+        cv::Mat deltaRotation = previousFrame->rotation() * olderFrame->rotation().t();
+        cv::Mat deltaTranslation = previousFrame->translation() - deltaRotation * olderFrame->translation();
+
+        frame->setRotation( deltaRotation * previousFrame->rotation() );
+        frame->setTranslation( deltaRotation * previousFrame->translation() + deltaTranslation );
+
+    }
+    else if ( !_sequence.empty() ) {
+
+        frame->setRotation( _sequence.back()->rotation().clone() );
+        frame->setTranslation( _sequence.back()->translation().clone() );
+
+    }
+
+}
+
 }
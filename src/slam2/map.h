@@ -38,6 +38,8 @@ protected:
 
     std::vector< StereoFramePtr > _sequence;
 
+    void predictPose( const StereoFramePtr &frame ) const;
+
 };
 
 }
@@ -160,6 +160,16 @@ double Parameters::maxReprojectionError() const
     return 2.;
 }
 
+double Parameters::guidedMatchRadius() const
+{
+    return 15.;
+}
+
+size_t Parameters::minGuidedMatchesCount() const
+{
+    return 30;
+}
+
 double Parameters::pointsDrawScale() const
 {
     return 1./500.;
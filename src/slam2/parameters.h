@@ -86,6 +86,9 @@ public:
 
     double maxReprojectionError() const;
 
+    double guidedMatchRadius() const;
+    size_t minGuidedMatchesCount() const;
+
     double pointsDrawScale() const;
 
 protected:
@@ -4,12 +4,25 @@
 
 #include "system.h"
 
-#include "src/common/tictoc.h"
+#include "src/common/profiler.h"
 
 // ProcessorThread
 ProcessorThread::ProcessorThread( const slam2::Parameters &parameters, QObject *parent )
     : QThread( parent )
 {
+    initialize( parameters );
+}
+
+void ProcessorThread::initialize( const slam2::Parameters &parameters )
+{
+    _queuePolicy = QueuePolicy::DropOldest;
+    _queueSize = _defaultQueueSize;
+
+    _pointsRequested = true;
+    _tracksRequested = true;
+    _stereoRequested = true;
+    _cloudRequested = true;
+
     _system = slam2::System::create( parameters );
 
     _system->createMap();
@@ -19,7 +32,65 @@ void ProcessorThread::process( const StampedStereoImage image )
 {
     QMutexLocker lock( &_queueMutex );
 
-    _processQueue.push_back( image );
+    if ( _queuePolicy == QueuePolicy::Block ) {
+        while ( _processQueue.size() >= _queueSize && isRunning() && !isInterruptionRequested() )
+            _queueNotFull.wait( &_queueMutex, _waitTimeout );
+    }
+    else if ( _queuePolicy == QueuePolicy::KeepLatest ) {
+        _statistics.dropped += _processQueue.size();
+        _processQueue.clear();
+    }
+
+    while ( _processQueue.size() >= _queueSize ) {
+        _processQueue.pop_front();
+        ++_statistics.dropped;
+    }
+
+    _processQueue.push_back( QueueItem{ image, std::chrono::steady_clock::now() } );
+
+    _statistics.depth = _processQueue.size();
+    _statistics.maxDepth = std::max( _statistics.maxDepth, _statistics.depth );
+
+    _queueNotEmpty.wakeOne();
+}
+
+void ProcessorThread::setQueuePolicy( const QueuePolicy value )
+{
+    QMutexLocker lock( &_queueMutex );
+
+    _queuePolicy = value;
+
+    _queueNotFull.wakeAll();
+}
+
+ProcessorThread::QueuePolicy ProcessorThread::queuePolicy() const
+{
+    QMutexLocker lock( &_queueMutex );
+
+    return _queuePolicy;
+}
+
+void ProcessorThread::setQueueSize( const size_t value )
+{
+    QMutexLocker lock( &_queueMutex );
+
+    _queueSize = std::max< size_t >( value, 1 );
+
+    _queueNotFull.wakeAll();
+}
+
+size_t ProcessorThread::queueSize() const
+{
+    QMutexLocker lock( &_queueMutex );
+
+    return _queueSize;
+}
+
+ProcessorThread::QueueStatistics ProcessorThread::statistics() const
+{
+    QMutexLocker lock( &_queueMutex );
+
+    return _statistics;
 }
 
 slam2::SystemPtr ProcessorThread::system() const
@@ -33,6 +104,8 @@ CvImage ProcessorThread::pointsImage() const
     auto ret = _pointsImage;
     _resultMutex.unlock();
 
+    _pointsRequested = true;
+
     return ret;
 }
 
@@ -42,6 +115,8 @@ CvImage ProcessorThread::tracksImage() const
     auto ret = _tracksImage;
     _resultMutex.unlock();
 
+    _tracksRequested = true;
+
     return ret;
 }
 
@@ -51,6 +126,8 @@ CvImage ProcessorThread::stereoImage() const
     auto ret = _stereoImage;
     _resultMutex.unlock();
 
+    _stereoRequested = true;
+
     return ret;
 }
 
@@ -60,51 +137,111 @@ std::vector< ColorPoint3d > ProcessorThread::sparseCloud() const
     auto ret = _sparseCloud;
     _resultMutex.unlock();
 
+    _cloudRequested = true;
+
     return ret;
 }
 
 void ProcessorThread::run()
 {
+    PROFILE_THREAD( "slam2 processor" );
+
     while( !isInterruptionRequested() ) {
+
+        _queueMutex.lock();
+
+        // Timeout lets the loop notice interruption requests
+        if ( _processQueue.empty() )
+            _queueNotEmpty.wait( &_queueMutex, _waitTimeout );
+
+        _queueMutex.unlock();
+
         processNext();
-        std::this_thread::sleep_for( std::chrono::microseconds( 1 ) );
 
     }
 
+    _queueNotFull.wakeAll();
+
 }
 
 void ProcessorThread::processNext()
 {
-    StampedStereoImage frame;
+    QueueItem item;
 
     _queueMutex.lock();
 
     if ( !_processQueue.empty() ) {
-        frame = _processQueue.front();
+        item = _processQueue.front();
         _processQueue.pop_front();
+
+        _statistics.depth = _processQueue.size();
+
+        _queueNotFull.wakeOne();
     }
 
     _queueMutex.unlock();
 
-    if ( !frame.empty() ) {
+    if ( !item.image.empty() ) {
+
+        {
+            PROFILE_SCOPE( "track" );
 
-        TicToc timer;
+            _system->track( item.image );
+        }
 
-        _system->track( frame );
+        updateResults();
 
-        timer.report();
+        auto latency = std::chrono::duration< double >( std::chrono::steady_clock::now() - item.time ).count();
 
-        _resultMutex.lock();
+        _queueMutex.lock();
 
-        _pointsImage = _system->pointsImage();
-        _tracksImage = _system->tracksImage();
-        _stereoImage = _system->stereoImage();
-        _sparseCloud = _system->sparseCloud();
+        ++_statistics.processed;
 
-        _resultMutex.unlock();
+        _statistics.lastLatency = latency;
+        _statistics.meanLatency += ( latency - _statistics.meanLatency ) / _statistics.processed;
+
+        auto statistics = _statistics;
+
+        _queueMutex.unlock();
+
+        PROFILE_COUNTER( "latency", latency );
+        PROFILE_COUNTER( "queue depth", statistics.depth );
+        PROFILE_COUNTER( "dropped frames", statistics.dropped );
 
     }
 
 }
 
+void ProcessorThread::updateResults()
+{
+    // Products are built outside of the result lock, readers only wait for the swap
+    if ( _pointsRequested.exchange( false ) ) {
+        auto image = _system->pointsImage();
+
+        QMutexLocker lock( &_resultMutex );
+        _pointsImage = image;
+    }
+
+    if ( _tracksRequested.exchange( false ) ) {
+        auto image = _system->tracksImage();
+
+        QMutexLocker lock( &_resultMutex );
+        _tracksImage = image;
+    }
+
+    if ( _stereoRequested.exchange( false ) ) {
+        auto image = _system->stereoImage();
+
+        QMutexLocker lock( &_resultMutex );
+        _stereoImage = image;
+    }
+
+    if ( _cloudRequested.exchange( false ) ) {
+        auto cloud = _system->sparseCloud();
+
+        QMutexLocker lock( &_resultMutex );
+        _sparseCloud = cloud;
+    }
+
+}
 
@@ -2,6 +2,10 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QWaitCondition>
+
+#include <atomic>
+#include <chrono>
 
 #include "src/common/colorpoint.h"
 
@@ -18,10 +22,34 @@ class ProcessorThread : public QThread
     friend class SlamImageWidget;
 
 public:
+    // What process() does when the queue is full: wait for a free slot,
+    // drop the oldest queued frame or drop everything queued
+    enum class QueuePolicy { Block, DropOldest, KeepLatest };
+
+    struct QueueStatistics
+    {
+        size_t depth = 0;
+        size_t maxDepth = 0;
+        size_t processed = 0;
+        size_t dropped = 0;
+
+        // Seconds from process() call to tracked frame
+        double lastLatency = 0.;
+        double meanLatency = 0.;
+    };
+
     explicit ProcessorThread( const slam2::Parameters &parameters, QObject *parent = nullptr );
 
     void process( const StampedStereoImage image );
 
+    void setQueuePolicy( const QueuePolicy value );
+    QueuePolicy queuePolicy() const;
+
+    void setQueueSize( const size_t value );
+    size_t queueSize() const;
+
+    QueueStatistics statistics() const;
+
     slam2::SystemPtr system() const;
 
     CvImage pointsImage() const;
@@ -34,11 +62,31 @@ signals:
     void updateSignal();
 
 protected:
-    std::list< StampedStereoImage > _processQueue;
+    struct QueueItem
+    {
+        StampedStereoImage image;
+        std::chrono::time_point< std::chrono::steady_clock > time;
+    };
+
+    std::list< QueueItem > _processQueue;
+
+    QueuePolicy _queuePolicy;
+    size_t _queueSize;
+
+    QueueStatistics _statistics;
+
+    mutable QMutex _queueMutex;
+    QWaitCondition _queueNotEmpty;
+    QWaitCondition _queueNotFull;
 
-    QMutex _queueMutex;
     mutable QMutex _resultMutex;
 
+    // Visualization products are regenerated only after they are read
+    mutable std::atomic_bool _pointsRequested;
+    mutable std::atomic_bool _tracksRequested;
+    mutable std::atomic_bool _stereoRequested;
+    mutable std::atomic_bool _cloudRequested;
+
     CvImage _pointsImage;
     CvImage _tracksImage;
     CvImage _stereoImage;
@@ -47,8 +95,16 @@ protected:
 
     slam2::SystemPtr _system;
 
+    static const size_t _defaultQueueSize = 4;
+    static const unsigned long _waitTimeout = 100;
+
     virtual void run() override;
 
     void processNext();
 
+    void updateResults();
+
+private:
+    void initialize( const slam2::Parameters &parameters );
+
 };
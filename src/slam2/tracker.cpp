@@ -3,9 +3,17 @@
 #include "tracker.h"
 
 #include "frame.h"
+#include "system.h"
+#include "parameters.h"
 
 namespace slam2 {
 
+// Tracker
+void Tracker::releaseFrame( ProcStereoFrame * )
+{
+}
+
+// FlowTracker
 double FlowTracker::extractPrecision() const
 {
     return _pointsProcessor->extractPrecision();
@@ -71,7 +79,7 @@ void CPUFlowTracker::extractFeatures( ProcStereoFrame *frame )
 {
     std::vector< cv::Point2f > cornerPoints;
 
-    processor()->extractPoints( frame->leftFrame()->image(), frame->leftFrame()->mask(), &cornerPoints, frame->leftFrame()->extractionCornersCount() );
+    processor()->extractPoints( frame->leftFrame()->image(), frame->leftFrame()->cornerPoints(), &cornerPoints, frame->leftFrame()->extractionCornersCount() );
 
     frame->leftFrame()->addCornerPoints( cornerPoints );
 
@@ -91,6 +99,12 @@ void CPUFlowTracker::match( ConsecutiveStereoFrames *frame )
 {
 }
 
+void CPUFlowTracker::releaseFrame( ProcStereoFrame *frame )
+{
+    processor()->releaseImagePyramid( &frame->leftFrame()->_imagePyramid );
+    processor()->releaseImagePyramid( &frame->rightFrame()->_imagePyramid );
+}
+
 CPUFlowProcessor *CPUFlowTracker::processor() const
 {
     return dynamic_cast< CPUFlowProcessor* >( _pointsProcessor.get() );
@@ -115,7 +129,7 @@ void GPUFlowTracker::extractFeatures( ProcStereoFrame *frame )
 {
     std::vector< cv::Point2f > cornerPoints;
 
-    processor()->extractPoints( frame->leftFrame()->image(), frame->leftFrame()->mask(), &cornerPoints, frame->leftFrame()->extractionCornersCount() );
+    processor()->extractPoints( frame->leftFrame()->image(), frame->leftFrame()->cornerPoints(), &cornerPoints, frame->leftFrame()->extractionCornersCount() );
 
     frame->leftFrame()->addCornerPoints( cornerPoints );
 
@@ -158,16 +172,13 @@ void SiftTracker::prepareFrame( ProcStereoFrame * )
 
 void SiftTracker::extractFeatures( ProcStereoFrame *frame )
 {
-    std::vector< cv::Point2f > cornerPoints;
+    extractStereoFeatures( frame );
 
-    std::vector< cv::KeyPoint > leftKeypoints, rightKeypoints;
-    cv::Mat leftDescriptors, rightDescriptors;
+    auto &leftKeypoints = frame->leftFrame()->featurePoints();
+    auto &rightKeypoints = frame->rightFrame()->featurePoints();
 
-    processor()->extractAndCompute( frame->leftFrame()->image(), frame->leftFrame()->mask(), &leftKeypoints, &leftDescriptors );
-    processor()->extractAndCompute( frame->rightFrame()->image(), frame->rightFrame()->mask(), &rightKeypoints, &rightDescriptors );
-
-    frame->setFeaturePoints( leftKeypoints, rightKeypoints );
-    frame->setDescriptors( leftDescriptors, rightDescriptors );
+    auto &leftDescriptors = frame->leftFrame()->descriptors();
+    auto &rightDescriptors = frame->rightFrame()->descriptors();
 
     std::vector< cv::DMatch > matches;
 
@@ -178,10 +189,6 @@ void SiftTracker::extractFeatures( ProcStereoFrame *frame )
 
 }
 
-void SiftTracker::match( ConsecutiveStereoFrames *frame )
-{
-}
-
 SiftProcessor *SiftTracker::processor() const
 {
     return dynamic_cast< SiftProcessor* >( _descriptorProcessor.get() );
@@ -192,6 +199,68 @@ FlannMatcher *SiftTracker::matcher() const
     return dynamic_cast< FlannMatcher* >( _featuresMatcher.get() );
 }
 
+// FeatureTracker
+const double FeatureTracker::_stereoRowBand = 0.1;
+
+void FeatureTracker::extractStereoFeatures( ProcStereoFrame *frame )
+{
+    // Both images are extracted at once on separate detector instances
+    _descriptorProcessor->extractAndCompute( { frame->leftFrame()->image(), frame->rightFrame()->image() },
+                                             { frame->leftFrame()->mask(), frame->rightFrame()->mask() }, &_featureBatch );
+
+    frame->setFeaturePoints( _featureBatch.keypoints[ 0 ], _featureBatch.keypoints[ 1 ] );
+
+    // Descriptors are handed over to the frame, the next batch must not
+    // write into them, so they are allocated anew for every frame
+    frame->setDescriptors( _featureBatch.descriptors[ 0 ], _featureBatch.descriptors[ 1 ] );
+
+    _featureBatch.descriptors[ 0 ] = cv::Mat();
+    _featureBatch.descriptors[ 1 ] = cv::Mat();
+}
+
+void FeatureTracker::match( ConsecutiveStereoFrames *frame )
+{
+    auto previousFrame = frame->previousFrame()->leftFrame();
+    auto nextFrame = frame->nextFrame()->leftFrame();
+
+    auto &parameters = nextFrame->parentSystem()->parameters();
+
+    std::vector< size_t > indexes;
+    std::vector< cv::Point2f > predictedPoints;
+
+    frame->predictFeaturePoints( &indexes, &predictedPoints );
+
+    std::vector< cv::DMatch > matches;
+
+    if ( indexes.size() >= parameters.minGuidedMatchesCount() ) {
+
+        cv::Mat queryDescriptors( indexes.size(), previousFrame->descriptors().cols, previousFrame->descriptors().type() );
+
+        for ( size_t i = 0; i < indexes.size(); ++i )
+            previousFrame->descriptors().row( indexes[ i ] ).copyTo( queryDescriptors.row( i ) );
+
+        _featuresMatcher->guidedMatch( predictedPoints, queryDescriptors, nextFrame->_undistFeaturePoints, nextFrame->descriptors(), parameters.guidedMatchRadius(), &matches );
+
+        for ( auto &i : matches )
+            i.queryIdx = indexes[ i.queryIdx ];
+
+    }
+
+    // Tracking is lost, everything is matched against everything
+    if ( matches.size() < parameters.minGuidedMatchesCount() ) {
+
+        auto hammingMatcher = dynamic_cast< HammingMatcher* >( _featuresMatcher.get() );
+
+        if ( hammingMatcher )
+            hammingMatcher->resetConstraints();
+
+        _featuresMatcher->match( previousFrame->featurePoints(), previousFrame->descriptors(), nextFrame->featurePoints(), nextFrame->descriptors(), &matches );
+
+    }
+
+    frame->setMatches( matches );
+}
+
 // OrbTracker
 OrbTracker::OrbTracker()
 {
@@ -201,7 +270,7 @@ OrbTracker::OrbTracker()
 void OrbTracker::initialize()
 {
     _descriptorProcessor = std::unique_ptr< FullProcessor >( new OrbProcessor() );
-    _featuresMatcher = std::unique_ptr< DescriptorMatcher >( new BFMatcher() );
+    _featuresMatcher = std::unique_ptr< DescriptorMatcher >( new HammingMatcher() );
 }
 
 void OrbTracker::prepareFrame( ProcStereoFrame * )
@@ -210,37 +279,31 @@ void OrbTracker::prepareFrame( ProcStereoFrame * )
 
 void OrbTracker::extractFeatures( ProcStereoFrame *frame )
 {
-    std::vector< cv::Point2f > cornerPoints;
+    extractStereoFeatures( frame );
 
-    std::vector< cv::KeyPoint > leftKeypoints, rightKeypoints;
-    cv::Mat leftDescriptors, rightDescriptors;
+    auto &leftKeypoints = frame->leftFrame()->featurePoints();
+    auto &rightKeypoints = frame->rightFrame()->featurePoints();
 
-    processor()->extractAndCompute( frame->leftFrame()->image(), frame->leftFrame()->mask(), &leftKeypoints, &leftDescriptors );
-    processor()->extractAndCompute( frame->rightFrame()->image(), frame->rightFrame()->mask(), &rightKeypoints, &rightDescriptors );
-
-    frame->setFeaturePoints( leftKeypoints, rightKeypoints );
-    frame->setDescriptors( leftDescriptors, rightDescriptors );
+    auto &leftDescriptors = frame->leftFrame()->descriptors();
+    auto &rightDescriptors = frame->rightFrame()->descriptors();
 
     std::vector< cv::DMatch > matches;
 
+    matcher()->setRowBand( frame->leftFrame()->image().rows * _stereoRowBand );
     matcher()->match( leftKeypoints, leftDescriptors, rightKeypoints, rightDescriptors, &matches );
 
     for ( auto &i : matches )
         frame->createFeaturePoint( i.queryIdx, i.trainIdx );
 }
 
-void OrbTracker::match( ConsecutiveStereoFrames *frame )
-{
-}
-
 OrbProcessor *OrbTracker::processor() const
 {
     return dynamic_cast< OrbProcessor* >( _descriptorProcessor.get() );
 }
 
-BFMatcher *OrbTracker::matcher() const
+HammingMatcher *OrbTracker::matcher() const
 {
-    return dynamic_cast< BFMatcher* >( _featuresMatcher.get() );
+    return dynamic_cast< HammingMatcher* >( _featuresMatcher.get() );
 }
 
 // AKazeTracker
@@ -252,7 +315,7 @@ AKazeTracker::AKazeTracker()
 void AKazeTracker::initialize()
 {
     _descriptorProcessor = std::make_unique< AKazeProcessor >();
-    _featuresMatcher = std::make_unique< BFMatcher >();
+    _featuresMatcher = std::make_unique< HammingMatcher >();
 }
 
 void AKazeTracker::prepareFrame( ProcStereoFrame * )
@@ -261,19 +324,17 @@ void AKazeTracker::prepareFrame( ProcStereoFrame * )
 
 void AKazeTracker::extractFeatures( ProcStereoFrame *frame )
 {
-    std::vector< cv::Point2f > cornerPoints;
-
-    std::vector< cv::KeyPoint > leftKeypoints, rightKeypoints;
-    cv::Mat leftDescriptors, rightDescriptors;
+    extractStereoFeatures( frame );
 
-    processor()->extractAndCompute( frame->leftFrame()->image(), frame->leftFrame()->mask(), &leftKeypoints, &leftDescriptors );
-    processor()->extractAndCompute( frame->rightFrame()->image(), frame->rightFrame()->mask(), &rightKeypoints, &rightDescriptors );
+    auto &leftKeypoints = frame->leftFrame()->featurePoints();
+    auto &rightKeypoints = frame->rightFrame()->featurePoints();
 
-    frame->setFeaturePoints( leftKeypoints, rightKeypoints );
-    frame->setDescriptors( leftDescriptors, rightDescriptors );
+    auto &leftDescriptors = frame->leftFrame()->descriptors();
+    auto &rightDescriptors = frame->rightFrame()->descriptors();
 
     std::vector< cv::DMatch > matches;
 
+    matcher()->setRowBand( frame->leftFrame()->image().rows * _stereoRowBand );
     matcher()->match( leftKeypoints, leftDescriptors, rightKeypoints, rightDescriptors, &matches );
 
     for ( auto &i : matches )
@@ -281,29 +342,40 @@ void AKazeTracker::extractFeatures( ProcStereoFrame *frame )
 
 }
 
-void AKazeTracker::match( ConsecutiveStereoFrames *frame )
-{
-}
-
 AKazeProcessor *AKazeTracker::processor() const
 {
     return dynamic_cast< AKazeProcessor* >( _descriptorProcessor.get() );
 }
 
-BFMatcher *AKazeTracker::matcher() const
+HammingMatcher *AKazeTracker::matcher() const
 {
-    return dynamic_cast< BFMatcher* >( _featuresMatcher.get() );
+    return dynamic_cast< HammingMatcher* >( _featuresMatcher.get() );
 }
 
 // SuperGlueTracker
+#ifdef TENSORRT_ENABLED
+const std::string SuperGlueTracker::_defaultDetectorModelFile = "superpoint_fp32_1024.eng";
+const std::string SuperGlueTracker::_defaultMatcherModelFile = "superglue_fp32.eng";
+#else
+const std::string SuperGlueTracker::_defaultDetectorModelFile = "superpoint_1024.pt";
+const std::string SuperGlueTracker::_defaultMatcherModelFile = "superglue.pt";
+#endif
+
 SuperGlueTracker::SuperGlueTracker()
 {
-    initialize();
+    initialize( _defaultDetectorModelFile, _defaultMatcherModelFile );
+}
+
+SuperGlueTracker::SuperGlueTracker( const std::string &detectorModelFile, const std::string &matcherModelFile )
+{
+    initialize( detectorModelFile, matcherModelFile );
 }
 
-void SuperGlueTracker::initialize()
+void SuperGlueTracker::initialize( const std::string &detectorModelFile, const std::string &matcherModelFile )
 {
-    _processor = std::make_unique< SuperGlueProcessor >( "superpoint_fp32_1024.eng", "superglue_fp32.eng" );
+    _processor = std::make_unique< SuperGlueProcessor >( detectorModelFile, matcherModelFile );
+
+    _nextFrameId = 0;
 }
 
 void SuperGlueTracker::prepareFrame( ProcStereoFrame * )
@@ -312,7 +384,7 @@ void SuperGlueTracker::prepareFrame( ProcStereoFrame * )
 
 void SuperGlueTracker::extractFeatures( ProcStereoFrame *frame )
 {
-    std::vector< cv::KeyPoint > leftKeypoints, rightKeypoints;
+    std::vector< std::vector< cv::KeyPoint > > keypoints;
     std::vector< cv::DMatch > matches;
 
     CvImage leftGray, rightGray;
@@ -320,9 +392,16 @@ void SuperGlueTracker::extractFeatures( ProcStereoFrame *frame )
     cv::cvtColor( frame->leftFrame()->image(), leftGray, cv::COLOR_BGR2GRAY );
     cv::cvtColor( frame->rightFrame()->image(), rightGray, cv::COLOR_BGR2GRAY );
 
-    _processor->extractAndMatch( leftGray, frame->leftFrame()->mask(), rightGray, frame->rightFrame()->mask(), &leftKeypoints, &rightKeypoints, 1024, &matches );
+    auto leftId = _nextFrameId++;
+    auto rightId = _nextFrameId++;
+
+    _frameIds[ frame ] = std::make_pair( leftId, rightId );
 
-    frame->setFeaturePoints( leftKeypoints, rightKeypoints );
+    _processor->extractFeatures( { leftId, rightId }, { leftGray, rightGray }, { frame->leftFrame()->mask(), frame->rightFrame()->mask() }, _maxPointsCount, &keypoints );
+
+    _processor->match( leftId, rightId, &matches );
+
+    frame->setFeaturePoints( keypoints[ 0 ], keypoints[ 1 ] );
 
     for ( auto &i : matches )
         frame->createFeaturePoint( i.queryIdx, i.trainIdx );
@@ -330,7 +409,21 @@ void SuperGlueTracker::extractFeatures( ProcStereoFrame *frame )
 
 void SuperGlueTracker::match( ConsecutiveStereoFrames *frame )
 {
+    auto previousIds = _frameIds.find( frame->previousFrame().get() );
+    auto nextIds = _frameIds.find( frame->nextFrame().get() );
+
+    std::vector< cv::DMatch > matches;
 
+    // Left images were detected on extraction, so only SuperGlue runs here
+    if ( previousIds != _frameIds.end() && nextIds != _frameIds.end() )
+        _processor->match( previousIds->second.first, nextIds->second.first, &matches );
+
+    frame->setMatches( matches );
+}
+
+void SuperGlueTracker::releaseFrame( ProcStereoFrame *frame )
+{
+    _frameIds.erase( frame );
 }
 
 SuperGlueProcessor *SuperGlueTracker::processor() const
@@ -15,6 +15,8 @@ public:
     virtual void extractFeatures( ProcStereoFrame *frame ) = 0;
     virtual void match( ConsecutiveStereoFrames *frame ) = 0;
 
+    virtual void releaseFrame( ProcStereoFrame *frame );
+
 protected:
     Tracker() = default;
 
@@ -51,6 +53,8 @@ public:
     void extractFeatures( ProcStereoFrame *frame ) override;
     void match( ConsecutiveStereoFrames *frame ) override;
 
+    void releaseFrame( ProcStereoFrame *frame ) override;
+
 protected:
     CPUFlowProcessor *processor() const;
 
@@ -79,6 +83,7 @@ private:
 class FeatureTracker : public Tracker
 {
 public:
+    void match( ConsecutiveStereoFrames *frame ) override;
 
 protected:
     FeatureTracker() = default;
@@ -86,6 +91,14 @@ protected:
     std::unique_ptr< FullProcessor > _descriptorProcessor;
     std::unique_ptr< DescriptorMatcher > _featuresMatcher;
 
+    FeatureBatch _featureBatch;
+
+    void extractStereoFeatures( ProcStereoFrame *frame );
+
+    // Row band for stereo matches as a part of the image height. Frames are
+    // not rectified, so the band is loose.
+    static const double _stereoRowBand;
+
 };
 
 class SiftTracker : public FeatureTracker
@@ -95,7 +108,6 @@ public:
 
     void prepareFrame( ProcStereoFrame *frame ) override;
     void extractFeatures( ProcStereoFrame *frame ) override;
-    void match( ConsecutiveStereoFrames *frame ) override;
 
 protected:
     SiftProcessor *processor() const;
@@ -113,11 +125,10 @@ public:
 
     void prepareFrame( ProcStereoFrame *frame ) override;
     void extractFeatures( ProcStereoFrame *frame ) override;
-    void match( ConsecutiveStereoFrames *frame ) override;
 
 protected:
     OrbProcessor *processor() const;
-    BFMatcher *matcher() const;
+    HammingMatcher *matcher() const;
 
 private:
     void initialize();
@@ -131,11 +142,10 @@ public:
 
     void prepareFrame( ProcStereoFrame *frame ) override;
     void extractFeatures( ProcStereoFrame *frame ) override;
-    void match( ConsecutiveStereoFrames *frame ) override;
 
 protected:
     AKazeProcessor *processor() const;
-    BFMatcher *matcher() const;
+    HammingMatcher *matcher() const;
 
 private:
     void initialize();
@@ -145,19 +155,32 @@ private:
 class SuperGlueTracker : public Tracker
 {
 public:
+    // TensorRT engines in builds with TensorRT, TorchScript modules on the CPU otherwise
     SuperGlueTracker();
+    SuperGlueTracker( const std::string &detectorModelFile, const std::string &matcherModelFile );
 
     void prepareFrame( ProcStereoFrame *frame ) override;
     void extractFeatures( ProcStereoFrame *frame ) override;
     void match( ConsecutiveStereoFrames *frame ) override;
 
+    void releaseFrame( ProcStereoFrame *frame ) override;
+
 protected:
     SuperGlueProcessor *processor() const;
 
     std::unique_ptr< SuperGlueProcessor > _processor;
 
+    // Processor cache IDs of the left and right images of frames still to be matched
+    std::map< const ProcStereoFrame*, std::pair< size_t, size_t > > _frameIds;
+    size_t _nextFrameId;
+
+    static const size_t _maxPointsCount = 1024;
+
+    static const std::string _defaultDetectorModelFile;
+    static const std::string _defaultMatcherModelFile;
+
 private:
-    void initialize();
+    void initialize( const std::string &detectorModelFile, const std::string &matcherModelFile );
 
 };
 
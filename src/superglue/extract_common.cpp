@@ -44,7 +44,7 @@ namespace marker
         std::copy_n(copy_src, copy_count, copy_dst);
     }
 
-    void KeypointSet::set_keypoints(const std::vector<cv::KeyPoint>& src)
+    void KeypointSet::set_keypoints(const std::vector<cv::KeyPoint>& src, c10::Device device)
     {   
         //  Copy keypoint data to contiguous memory
         cv::Mat cpu_keypoints(src.size(), 2, CV_32FC1);
@@ -59,10 +59,11 @@ namespace marker
         }
         
         //  Prepare device buffers and copy data
-        this->keypoints = tch_u::make_tensor_2d(trt_u::Dims2d(src.size(), 2), torch::kFloat32, torch::kCUDA);
-        this->scores = tch_u::make_tensor_2d(trt_u::Dims2d(src.size(), 1), torch::kFloat32, torch::kCUDA);
-        tch_u::host_to_device(cpu_keypoints, this->keypoints);
-        tch_u::host_to_device(cpu_scores, this->scores);
+        this->keypoints = tch_u::make_tensor_2d(trt_u::Dims2d(src.size(), 2), torch::kFloat32, device);
+        this->scores = tch_u::make_tensor_2d(trt_u::Dims2d(src.size(), 1), torch::kFloat32, device);
+        //  libtorch does the host to device copy, so this needs no CUDA runtime of its own
+        this->keypoints.copy_(torch::from_blob(keypoints_ptr, { static_cast<std::int64_t>(src.size()), 2 }, torch::kFloat32));
+        this->scores.copy_(torch::from_blob(scores_ptr, { static_cast<std::int64_t>(src.size()), 1 }, torch::kFloat32));
     }
 
     DescriptorSetArray sample_descriptors(const DescriptorMap& descriptor_map, 
@@ -76,7 +77,7 @@ namespace marker
         static auto normalize_l2 = tf::NormalizeFuncOptions()
             .dim(1)
             .p(2);
-        DescriptorSetArray ret;
+        DescriptorSetArray ret(keypoints.size());
         for(int i = 0; i < keypoints.size(); ++i)
         {
             auto dmap = descriptor_map.values.select(0, i);
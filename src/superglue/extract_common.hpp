@@ -32,17 +32,20 @@ namespace marker
         cv::Size2i image_size;
 
         void get_keypoints(std::vector<cv::KeyPoint>& dst) const;
-        void set_keypoints(const std::vector<cv::KeyPoint>& src);
+        void set_keypoints(const std::vector<cv::KeyPoint>& src, c10::Device device = torch::kCUDA);
     };
 
-    using KeypointSetArray = std::array<KeypointSet, 2>;
+    using KeypointSetArray = std::vector<KeypointSet>;
 
     struct DescriptorSet
     {
         at::Tensor values;
     };
 
-    using DescriptorSetArray = std::array<DescriptorSet, 2>;
+    using DescriptorSetArray = std::vector<DescriptorSet>;
+
+    //  Indexes of the two batch images matched against each other
+    using ImagePair = std::array<int, 2>;
 
 
     DescriptorSetArray sample_descriptors(const DescriptorMap& descriptor_map, 
@@ -0,0 +1,81 @@
+#include "feature_cache.hpp"
+
+#include <algorithm>
+
+
+namespace marker
+{
+    FeatureCache::FeatureCache(std::size_t capacity)
+        : m_capacity(capacity)
+    {}
+
+    void FeatureCache::set_capacity(std::size_t value)
+    {
+        m_capacity = value;
+        evict(m_capacity);
+    }
+
+    std::size_t FeatureCache::capacity() const
+    {
+        return m_capacity;
+    }
+
+    std::size_t FeatureCache::size() const
+    {
+        return m_entries.size();
+    }
+
+    FrameFeatures* FeatureCache::find(FrameId id)
+    {
+        auto it = m_index.find(id);
+        if (it == m_index.end())
+            return nullptr;
+
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->second;
+    }
+
+    FrameFeatures& FeatureCache::insert(FrameId id, FrameFeatures&& features)
+    {
+        auto it = m_index.find(id);
+        if (it != m_index.end())
+        {
+            it->second->second = std::move(features);
+            m_entries.splice(m_entries.begin(), m_entries, it->second);
+        }
+        else
+        {
+            m_entries.emplace_front(id, std::move(features));
+            m_index[id] = m_entries.begin();
+        }
+
+        //  The new entry is the front one, it survives a zero capacity so the reference stays valid
+        evict(std::max<std::size_t>(m_capacity, 1));
+        return m_entries.front().second;
+    }
+
+    void FeatureCache::erase(FrameId id)
+    {
+        auto it = m_index.find(id);
+        if (it == m_index.end())
+            return;
+
+        m_entries.erase(it->second);
+        m_index.erase(it);
+    }
+
+    void FeatureCache::clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    void FeatureCache::evict(std::size_t capacity)
+    {
+        while (m_entries.size() > capacity)
+        {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+    }
+}
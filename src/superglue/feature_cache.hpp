@@ -0,0 +1,59 @@
+#ifndef _FEATURE_CACHE_HPP_
+#define _FEATURE_CACHE_HPP_
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include "qttorch.h"
+
+#include "extract_common.hpp"
+
+
+namespace marker
+{
+    //  SuperPoint output of one frame: its slices of the score and descriptor maps,
+    //  keypoints selected from them and descriptors sampled at the keypoints
+    struct FrameFeatures
+    {
+        at::Tensor score_map;
+        at::Tensor descriptor_map;
+        cv::Size2i image_size;
+        KeypointSet keypoints;
+        DescriptorSet descriptors;
+        int keypoint_count;
+        std::size_t mask_hash;
+    };
+
+    //  Frame features keyed by frame ID with least recently used eviction
+    class FeatureCache
+    {
+    public:
+        using FrameId = std::uint64_t;
+
+        explicit FeatureCache(std::size_t capacity);
+
+        void set_capacity(std::size_t value);
+        std::size_t capacity() const;
+        std::size_t size() const;
+
+        //  Found entries become the most recently used ones.
+        //  The inserted entry is kept even with zero capacity, until the next insert
+        FrameFeatures* find(FrameId id);
+        FrameFeatures& insert(FrameId id, FrameFeatures&& features);
+        void erase(FrameId id);
+        void clear();
+
+    private:
+        using Entry = std::pair<FrameId, FrameFeatures>;
+
+        void evict(std::size_t capacity);
+
+        std::list<Entry> m_entries;
+        std::unordered_map<FrameId, std::list<Entry>::iterator> m_index;
+        std::size_t m_capacity;
+    };
+}
+
+#endif // _FEATURE_CACHE_HPP_
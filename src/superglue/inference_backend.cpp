@@ -0,0 +1,317 @@
+#include "inference_backend.hpp"
+
+
+namespace marker
+{
+    namespace tch_u = libtorch_utils;
+    namespace trt_u = tensor_rt_utils;
+
+
+    c10::Device BackendConfig::device() const
+    {
+        return type == BackendType::TENSOR_RT ? c10::Device(torch::kCUDA) : c10::Device(torch::kCPU);
+    }
+
+    //  ------------------------------------------------------------- TensorRT backends
+
+#ifdef TENSORRT_ENABLED
+    class TensorRTSuperPoint : public SuperPointBackend
+    {
+    public:
+        TensorRTSuperPoint(const std::string& engine_path, trt_u::Logger& logger)
+            : m_super_point(trt_u::load_engine(engine_path, logger), logger)
+        {}
+
+        c10::Device device() const override
+        {
+            return torch::kCUDA;
+        }
+
+        trt_u::Dims4d images_dims() const override
+        {
+            return batch_dims(m_super_point.images_dims());
+        }
+
+        trt_u::Dims4d scores_dims() const override
+        {
+            return batch_dims(m_super_point.scores_dims());
+        }
+
+        trt_u::Dims4d descrs_dims() const override
+        {
+            return batch_dims(m_super_point.descrs_dims());
+        }
+
+        void forward(const at::Tensor& images, at::Tensor& scores, at::Tensor& descrs) override
+        {
+            if (!m_super_point.resize_batch(images.size(0)))
+                throw std::runtime_error("SuperPoint batch size is out of the engine range");
+
+            void* buffers[] = { images.data_ptr(), scores.data_ptr(), descrs.data_ptr() };
+            m_super_point.execute(buffers);
+        }
+
+    private:
+        SuperPoint m_super_point;
+
+        trt_u::Dims4d batch_dims(trt_u::Dims4d dims) const
+        {
+            dims.batch = m_super_point.max_batch_size();
+            return dims;
+        }
+    };
+
+    class TensorRTSuperGlue : public SuperGlueBackend
+    {
+    public:
+        TensorRTSuperGlue(const std::string& engine_path, trt_u::Logger& logger)
+            : m_super_glue(trt_u::load_engine(engine_path, logger), logger)
+        {}
+
+        c10::Device device() const override
+        {
+            return torch::kCUDA;
+        }
+
+        int keypoint_size() const override
+        {
+            return m_super_glue.keypoints_dims(0).depth;
+        }
+
+        int score_size() const override
+        {
+            return m_super_glue.scores_dims(0).depth;
+        }
+
+        int descr_size() const override
+        {
+            return m_super_glue.descr_dims(0).depth;
+        }
+
+        bool resize_bindings(int index, int count) override
+        {
+            return m_super_glue.resize_bindings(index, count);
+        }
+
+        void forward(const at::Tensor& params, const KeypointSetArray& keypoints,
+            const DescriptorSetArray& descriptors, const ImagePair& pair, at::Tensor& scores) override
+        {
+            auto kpt_count_ptr = params.data_ptr<float>();
+            auto left_img_shape_ptr = kpt_count_ptr + 2;
+            auto right_img_shape_ptr = kpt_count_ptr + 4;
+
+            std::vector<void*> superglue_buffers;
+            superglue_buffers.push_back(left_img_shape_ptr);
+            superglue_buffers.push_back(right_img_shape_ptr);
+            for (int i : pair)
+                superglue_buffers.push_back(descriptors[i].values.data_ptr());
+            for (int i : pair)
+                superglue_buffers.push_back(keypoints[i].keypoints.data_ptr());
+            for (int i : pair)
+                superglue_buffers.push_back(keypoints[i].scores.data_ptr());
+            superglue_buffers.push_back(kpt_count_ptr);
+            superglue_buffers.push_back(scores.data_ptr());
+            m_super_glue.execute(superglue_buffers.data());
+        }
+
+    private:
+        SuperGlue m_super_glue;
+    };
+#endif
+
+    //  ------------------------------------------------------------- TorchScript CPU backends
+
+    //  Thread count and quantized engine are process wide settings of libtorch
+    void configure_torch_cpu(const BackendConfig& cfg)
+    {
+        if (cfg.thread_count > 0)
+            torch::set_num_threads(cfg.thread_count);
+
+        if (cfg.precision == Precision::INT8)
+        {
+            auto& engines = at::globalContext().supportedQEngines();
+            if (std::find(engines.begin(), engines.end(), at::QEngine::FBGEMM) != engines.end())
+                at::globalContext().setQEngine(at::QEngine::FBGEMM);
+        }
+    }
+
+    torch::jit::script::Module load_module(const std::string& module_path, const BackendConfig& cfg)
+    {
+        configure_torch_cpu(cfg);
+
+        auto module = torch::jit::load(module_path, torch::kCPU);
+        module.eval();
+        if (cfg.precision == Precision::FP16)
+            module.to(torch::kHalf);
+        return module;
+    }
+
+    trt_u::Dims4d tensor_dims(const at::Tensor& tensor)
+    {
+        return trt_u::Dims4d(tensor.size(0), tensor.size(1), tensor.size(2), tensor.size(3));
+    }
+
+    class TorchSuperPoint : public SuperPointBackend
+    {
+    public:
+        TorchSuperPoint(const std::string& module_path, const BackendConfig& cfg)
+            : m_module(load_module(module_path, cfg))
+            , m_precision(cfg.precision)
+        {
+            m_images_dims = trt_u::Dims4d(1, IMAGES_CHANNEL_COUNT,
+                cfg.input_size.height, cfg.input_size.width);
+
+            //  Output shapes are not stored in TorchScript, so probe them once (also a warm up run)
+            auto images = tch_u::make_tensor_4d(m_images_dims, torch::kFloat32, torch::kCPU).zero_();
+            auto outputs = run(images);
+            m_scores_dims = tensor_dims(outputs[0]);
+            m_descrs_dims = tensor_dims(outputs[1]);
+
+            //  Any batch runs on CPU, the capacity only sizes caller buffers
+            m_images_dims.batch = cfg.max_batch_size;
+            m_scores_dims.batch = cfg.max_batch_size;
+            m_descrs_dims.batch = cfg.max_batch_size;
+        }
+
+        c10::Device device() const override
+        {
+            return torch::kCPU;
+        }
+
+        trt_u::Dims4d images_dims() const override
+        {
+            return m_images_dims;
+        }
+
+        trt_u::Dims4d scores_dims() const override
+        {
+            return m_scores_dims;
+        }
+
+        trt_u::Dims4d descrs_dims() const override
+        {
+            return m_descrs_dims;
+        }
+
+        void forward(const at::Tensor& images, at::Tensor& scores, at::Tensor& descrs) override
+        {
+            auto outputs = run(images);
+            scores.copy_(outputs[0]);
+            descrs.copy_(outputs[1]);
+        }
+
+    private:
+        torch::jit::script::Module m_module;
+        Precision m_precision;
+        trt_u::Dims4d m_images_dims;
+        trt_u::Dims4d m_scores_dims;
+        trt_u::Dims4d m_descrs_dims;
+
+        std::array<at::Tensor, 2> run(const at::Tensor& images)
+        {
+            torch::NoGradGuard no_grad;
+            auto input = m_precision == Precision::FP16 ? images.to(torch::kHalf) : images;
+            auto output = m_module.forward({ input }).toTuple();
+            return { output->elements()[0].toTensor(), output->elements()[1].toTensor() };
+        }
+    };
+
+    class TorchSuperGlue : public SuperGlueBackend
+    {
+    public:
+        TorchSuperGlue(const std::string& module_path, const BackendConfig& cfg)
+            : m_module(load_module(module_path, cfg))
+            , m_precision(cfg.precision)
+        {}
+
+        c10::Device device() const override
+        {
+            return torch::kCPU;
+        }
+
+        int keypoint_size() const override
+        {
+            return 2;
+        }
+
+        int score_size() const override
+        {
+            return 1;
+        }
+
+        int descr_size() const override
+        {
+            return SuperPointBackend::DESCRS_CHANNEL_COUNT;
+        }
+
+        bool resize_bindings(int index, int count) override
+        {
+            return count > 0;
+        }
+
+        //  Inputs go in the order of the TensorRT engine bindings, see SuperGlue::bindings()
+        void forward(const at::Tensor& params, const KeypointSetArray& keypoints,
+            const DescriptorSetArray& descriptors, const ImagePair& pair, at::Tensor& scores) override
+        {
+            torch::NoGradGuard no_grad;
+
+            std::vector<torch::jit::IValue> inputs;
+            inputs.push_back(cast(params.slice(0, 2, 4).view({ 1, 2 })));
+            inputs.push_back(cast(params.slice(0, 4, 6).view({ 1, 2 })));
+            for (int i : pair)
+                inputs.push_back(cast(descriptors[i].values));
+            for (int i : pair)
+                inputs.push_back(cast(keypoints[i].keypoints.view({ -1, 2 })));
+            for (int i : pair)
+                inputs.push_back(cast(keypoints[i].scores.view({ 1, -1 })));
+            inputs.push_back(cast(params.slice(0, 0, 2).view({ 1, 2 })));
+
+            scores.copy_(m_module.forward(inputs).toTensor().view_as(scores));
+        }
+
+    private:
+        torch::jit::script::Module m_module;
+        Precision m_precision;
+
+        at::Tensor cast(const at::Tensor& tensor) const
+        {
+            return m_precision == Precision::FP16 ? tensor.to(torch::kHalf) : tensor;
+        }
+    };
+
+    //  ------------------------------------------------------------- Factories
+
+    std::unique_ptr<SuperPointBackend> SuperPointBackend::create(const std::string& model_path,
+        const BackendConfig& cfg, trt_u::Logger& logger)
+    {
+        switch (cfg.type)
+        {
+        case BackendType::TENSOR_RT:
+#ifdef TENSORRT_ENABLED
+            return std::make_unique<TensorRTSuperPoint>(model_path, logger);
+#else
+            throw std::runtime_error("Built without TensorRT, use the TorchScript CPU backend");
+#endif
+        case BackendType::TORCH_CPU:
+            return std::make_unique<TorchSuperPoint>(model_path, cfg);
+        }
+        throw std::logic_error("Unknown SuperPoint backend type");
+    }
+
+    std::unique_ptr<SuperGlueBackend> SuperGlueBackend::create(const std::string& model_path,
+        const BackendConfig& cfg, trt_u::Logger& logger)
+    {
+        switch (cfg.type)
+        {
+        case BackendType::TENSOR_RT:
+#ifdef TENSORRT_ENABLED
+            return std::make_unique<TensorRTSuperGlue>(model_path, logger);
+#else
+            throw std::runtime_error("Built without TensorRT, use the TorchScript CPU backend");
+#endif
+        case BackendType::TORCH_CPU:
+            return std::make_unique<TorchSuperGlue>(model_path, cfg);
+        }
+        throw std::logic_error("Unknown SuperGlue backend type");
+    }
+}
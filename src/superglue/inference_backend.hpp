@@ -0,0 +1,95 @@
+#ifndef _INFERENCE_BACKEND_HPP_
+#define _INFERENCE_BACKEND_HPP_
+
+#include <string>
+#include <memory>
+#include <array>
+#include <algorithm>
+#include <stdexcept>
+
+#include "opencv2/core.hpp"
+
+#include "qttorch.h"
+
+#include "extract_common.hpp"
+#include "super_point.hpp"
+#include "super_glue.hpp"
+#include "tensor_rt_utils.hpp"
+
+
+namespace marker
+{
+    enum class BackendType
+    {
+        TENSOR_RT,      //  Serialized TensorRT engine, CUDA tensors, needs a TENSORRT_ENABLED build
+        TORCH_CPU       //  TorchScript module, CPU tensors
+    };
+
+    enum class Precision
+    {
+        FP32,
+        FP16,           //  Module and inputs are cast to half, outputs back to float
+        INT8            //  Module is a quantized TorchScript export, interface stays float
+    };
+
+    struct BackendConfig
+    {
+#ifdef TENSORRT_ENABLED
+        BackendType type = BackendType::TENSOR_RT;
+#else
+        BackendType type = BackendType::TORCH_CPU;
+#endif
+        Precision precision = Precision::FP32;
+
+        //  Intra-op threads of the CPU backend, 0 keeps the libtorch default
+        int thread_count = 0;
+
+        //  SuperPoint input size and batch capacity of the CPU backend, TensorRT takes them from the engine
+        cv::Size2i input_size = cv::Size2i(640, 480);
+        int max_batch_size = 2;
+
+        c10::Device device() const;
+    };
+
+    //  SuperPoint forward: images [N, 1, H, W] -> scores [N, 1, h, w], descriptors [N, 256, h', w']
+    //  Dims are reported for the full batch capacity, forward() takes any N up to it
+    //  Output tensors are preallocated with scores_dims() and descrs_dims() on device() and narrowed to N
+    class SuperPointBackend
+    {
+    public:
+        static constexpr int IMAGES_CHANNEL_COUNT = 1;
+        static constexpr int DESCRS_CHANNEL_COUNT = 256;
+
+        virtual ~SuperPointBackend() = default;
+
+        virtual c10::Device device() const = 0;
+        virtual tensor_rt_utils::Dims4d images_dims() const = 0;
+        virtual tensor_rt_utils::Dims4d scores_dims() const = 0;
+        virtual tensor_rt_utils::Dims4d descrs_dims() const = 0;
+        virtual void forward(const at::Tensor& images, at::Tensor& scores, at::Tensor& descrs) = 0;
+
+        static std::unique_ptr<SuperPointBackend> create(const std::string& model_path,
+            const BackendConfig& cfg, tensor_rt_utils::Logger& logger);
+    };
+
+    //  SuperGlue forward of one image pair: params are { count_0, count_1, rows_0, cols_0, rows_1, cols_1 },
+    //  scores are resized to [1, count_0 + 1, count_1 + 1] by the caller
+    class SuperGlueBackend
+    {
+    public:
+        virtual ~SuperGlueBackend() = default;
+
+        virtual c10::Device device() const = 0;
+        virtual int keypoint_size() const = 0;
+        virtual int score_size() const = 0;
+        virtual int descr_size() const = 0;
+        virtual bool resize_bindings(int index, int count) = 0;
+        virtual void forward(const at::Tensor& params, const KeypointSetArray& keypoints,
+            const DescriptorSetArray& descriptors, const ImagePair& pair, at::Tensor& scores) = 0;
+
+        static std::unique_ptr<SuperGlueBackend> create(const std::string& model_path,
+            const BackendConfig& cfg, tensor_rt_utils::Logger& logger);
+    };
+}
+
+#endif // _INFERENCE_BACKEND_HPP_
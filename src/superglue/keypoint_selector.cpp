@@ -27,70 +27,82 @@ namespace marker
         return tf::pad(inner, border_zero);
     }
 
-    KeypointSelector::KeypointSelector(const Config& cfg, const trt_u::Dims4d& scores_dims)
-        : m_cfg(cfg)
+    KeypointSelector::KeypointSelector(const Config& cfg, const trt_u::Dims4d& scores_dims, 
+        c10::Device device)
+        : m_device(device)
+        , m_cfg(cfg)
     {   
         m_scores_size = cv::Size2i(scores_dims.cols, scores_dims.rows);
-        for(auto& in_mask: m_input_mask_resized)
-            in_mask = cv::cuda::createContinuous(m_scores_size, CV_8UC1);
-        m_score_mask = tch_u::make_tensor_4d(scores_dims, torch::kBool, torch::kCUDA);
-        m_inner_area = make_inner_area_mask(m_score_mask.sizes(), m_cfg.border, torch::kCUDA);
-        m_topk_indices = tch_u::make_tensor_1d(0, torch::kLong, torch::kCUDA);
+        if (m_device.is_cuda())
+        {
+            m_input_mask.resize(scores_dims.batch);
+            m_input_mask_resized.resize(scores_dims.batch);
+            for(auto& in_mask: m_input_mask_resized)
+                in_mask = cv::cuda::createContinuous(m_scores_size, CV_8UC1);
+        }
+        else
+        {
+            m_cpu_mask_resized.resize(scores_dims.batch);
+            for(auto& in_mask: m_cpu_mask_resized)
+                in_mask.create(m_scores_size, CV_8UC1);
+        }
+        m_score_mask = tch_u::make_tensor_4d(scores_dims, torch::kBool, m_device);
+        m_inner_area = make_inner_area_mask(m_score_mask.sizes(), m_cfg.border, m_device);
+        m_topk_indices = tch_u::make_tensor_1d(0, torch::kLong, m_device);
     }
 
     void KeypointSelector::select_keypoints(const ScoreMap& score_map, int count, KeypointSetArray& dst)
     {
-        cv::Mat first_mask, second_mask;
-        select_keypoints(score_map, first_mask, second_mask, count, dst);
+        select_keypoints(score_map, std::vector<cv::Mat>(), count, dst);
     }
 
     void KeypointSelector::select_keypoints(const ScoreMap& score_map, const cv::Mat& first_mask, 
         const cv::Mat& second_mask, int count, KeypointSetArray& dst)
     {
+        select_keypoints(score_map, { first_mask, second_mask }, count, dst);
+    }
+
+    void KeypointSelector::select_keypoints(const ScoreMap& score_map, const std::vector<cv::Mat>& masks, 
+        int count, KeypointSetArray& dst)
+    {
+        //  Keypoint sets follow the detected batch, new ones are created on the selector device
+        auto batch_size = score_map.values.size(0);
+        auto prev_size = dst.size();
+        dst.resize(batch_size);
+        for(std::size_t i = prev_size; i < dst.size(); ++i)
+        {
+            dst[i].keypoints = tch_u::make_tensor_2d(trt_u::Dims2d(0, 2), torch::kFloat32, m_device);
+            dst[i].scores = tch_u::make_tensor_1d(0, torch::kFloat32, m_device);
+        }
+
         //  Mask out scores that are too low or too close to border
-        torch::gt_out(m_score_mask, score_map.values, m_cfg.score_threshold);
-        m_score_mask.logical_and_(m_inner_area);
+        auto score_mask = m_score_mask.narrow(0, 0, batch_size);
+        torch::gt_out(score_mask, score_map.values, m_cfg.score_threshold);
+        score_mask.logical_and_(m_inner_area.narrow(0, 0, batch_size));
 
         //  Check if there are input masks
-        std::array<bool, IMAGE_COUNT> use_mask;
-        use_mask[0] = !first_mask.empty();
-        use_mask[1] = !second_mask.empty();
+        std::vector<bool> use_mask(batch_size);
+        for(int i = 0; i < batch_size; ++i)
+            use_mask[i] = i < static_cast<int>(masks.size()) && !masks[i].empty();
         
         //  Copy masks to device with possible resize and apply them
-        if (use_mask[0])
+        for(int i = 0; i < batch_size; ++i)
         {
-            if (first_mask.rows != m_scores_size.height || first_mask.cols != m_scores_size.width)
-            {
-                if (first_mask.rows != m_input_mask[0].rows || first_mask.cols != m_input_mask[0].cols)
-                    m_input_mask[0].create(first_mask.rows, first_mask.cols, first_mask.type());
-                m_input_mask[0].upload(first_mask);
-                cv::cuda::resize(m_input_mask[0], m_input_mask_resized[0], m_scores_size);
-            }
-            else
-                m_input_mask_resized[0].upload(first_mask);
-        }
-        if (use_mask[1])
-        {
-            if (second_mask.rows != m_scores_size.height || second_mask.cols != m_scores_size.width)
-            {
-                if (second_mask.rows != m_input_mask[1].rows || second_mask.cols != m_input_mask[1].cols)
-                    m_input_mask[1].create(second_mask.rows, second_mask.cols, second_mask.type());
-                m_input_mask[1].upload(second_mask);
-                cv::cuda::resize(m_input_mask[1], m_input_mask_resized[1], m_scores_size);
-            }
-            else
-                m_input_mask_resized[1].upload(second_mask);
+            if (use_mask[i])
+                upload_mask(i, masks[i]);
         }
 
-        
         for(int i = 0; i < dst.size(); ++i)
         {
             if(use_mask[i])
             {
-                auto input_mask_tensor = tch_u::as_tensor(m_input_mask_resized[i], torch::kBool);
-                m_score_mask.select(0, i).select(0, 0).logical_and_(input_mask_tensor);
+                auto input_mask_tensor = m_device.is_cuda() 
+                    ? tch_u::as_tensor(m_input_mask_resized[i], torch::kBool)
+                    : torch::from_blob(m_cpu_mask_resized[i].data, 
+                        { m_scores_size.height, m_scores_size.width }, torch::kBool);
+                score_mask.select(0, i).select(0, 0).logical_and_(input_mask_tensor);
             }
-            auto keypoints = m_score_mask.select(0, i).select(0, 0).nonzero();
+            auto keypoints = score_mask.select(0, i).select(0, 0).nonzero();
             auto scores = score_map.values.select(0, i).select(0, 0)
                 .index({ keypoints.select(1, 0), keypoints.select(1, 1) });
             keypoints = keypoints.fliplr().to(torch::kFloat32);
@@ -120,13 +132,34 @@ namespace marker
         }
     }
 
-    KeypointSetArray KeypointSelector::make_keypoints()
+    void KeypointSelector::upload_mask(int index, const cv::Mat& mask)
+    {
+        bool resize = mask.rows != m_scores_size.height || mask.cols != m_scores_size.width;
+        if (!m_device.is_cuda())
+        {
+            if (resize)
+                cv::resize(mask, m_cpu_mask_resized[index], m_scores_size);
+            else
+                mask.copyTo(m_cpu_mask_resized[index]);
+        }
+        else if (resize)
+        {
+            if (mask.rows != m_input_mask[index].rows || mask.cols != m_input_mask[index].cols)
+                m_input_mask[index].create(mask.rows, mask.cols, mask.type());
+            m_input_mask[index].upload(mask);
+            cv::cuda::resize(m_input_mask[index], m_input_mask_resized[index], m_scores_size);
+        }
+        else
+            m_input_mask_resized[index].upload(mask);
+    }
+
+    KeypointSetArray KeypointSelector::make_keypoints(c10::Device device, int size)
     {
-        KeypointSetArray ret;
+        KeypointSetArray ret(size);
         for(auto& ks: ret)
         {
-            ks.keypoints = tch_u::make_tensor_2d(trt_u::Dims2d(0, 2), torch::kFloat32, torch::kCUDA);
-            ks.scores = tch_u::make_tensor_1d(0, torch::kFloat32, torch::kCUDA);
+            ks.keypoints = tch_u::make_tensor_2d(trt_u::Dims2d(0, 2), torch::kFloat32, device);
+            ks.scores = tch_u::make_tensor_1d(0, torch::kFloat32, device);
         }
         return ret;
     }
@@ -8,6 +8,7 @@
 #include "qttorch.h"
 
 #include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
 #include "opencv2/cudaimgproc.hpp"
 #include "opencv2/cudawarping.hpp"
 #include "libtorch_utils.hpp"
@@ -20,24 +21,29 @@ namespace marker
     class KeypointSelector
     {
     public:
-        static constexpr int IMAGE_COUNT = 2;
-
         struct Config
         {
             int border;
             float score_threshold;
         };
 
-        KeypointSelector(const Config& cfg, const tensor_rt_utils::Dims4d& scores_dims);
+        KeypointSelector(const Config& cfg, const tensor_rt_utils::Dims4d& scores_dims, 
+            c10::Device device = torch::kCUDA);
         void select_keypoints(const ScoreMap& score_map, int count, KeypointSetArray& dst);
         void select_keypoints(const ScoreMap& score_map, const cv::Mat& first_mask, 
             const cv::Mat& second_mask, int count, KeypointSetArray& dst);
-        static KeypointSetArray make_keypoints();
+        void select_keypoints(const ScoreMap& score_map, const std::vector<cv::Mat>& masks, 
+            int count, KeypointSetArray& dst);
+        static KeypointSetArray make_keypoints(c10::Device device = torch::kCUDA, int size = 2);
 
     private:
+        void upload_mask(int index, const cv::Mat& mask);
+
+        c10::Device m_device;
         cv::Size2i m_scores_size;
-        std::array<cv::cuda::GpuMat, IMAGE_COUNT> m_input_mask;
-        std::array<cv::cuda::GpuMat, IMAGE_COUNT> m_input_mask_resized;
+        std::vector<cv::cuda::GpuMat> m_input_mask;
+        std::vector<cv::cuda::GpuMat> m_input_mask_resized;
+        std::vector<cv::Mat> m_cpu_mask_resized;
         at::Tensor m_score_mask;
         at::Tensor m_inner_area;
         at::Tensor m_topk_indices;
@@ -7,7 +7,10 @@
 #include "tensor_rt_utils.hpp"
 #include "opencv2/core.hpp"
 #include "opencv2/cudaimgproc.hpp"
+
+#ifdef TENSORRT_ENABLED
 #include "cuda_runtime.h"
+#endif
 
 
 namespace libtorch_utils
@@ -71,6 +74,7 @@ namespace libtorch_utils
             throw std::logic_error("Unknown BlockLayout template parameter! Must be COUNT_FIRST or DEPTH_FIRST");
     }
 
+#ifdef TENSORRT_ENABLED
     inline void host_to_device(const cv::Mat& src, at::Tensor& dst)
     {
         auto status = cudaMemcpy(dst.data_ptr(), src.data, src.total() * src.elemSize(), 
@@ -86,6 +90,7 @@ namespace libtorch_utils
         if (status != cudaSuccess)
             throw std::runtime_error(cudaGetErrorString(status));
     }
+#endif
 
     inline at::Tensor as_tensor(cv::cuda::GpuMat& mat, c10::ScalarType dtype)
     {
@@ -4,6 +4,7 @@
 	#undef slots
 #endif
 #include "torch/torch.h"
+#include "torch/script.h"
 #ifdef QT_VERSION
 	#define slots Q_SLOTS
 #endif
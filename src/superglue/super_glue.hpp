@@ -3,6 +3,7 @@
 
 #include "tensor_rt_utils.hpp"
 
+#ifdef TENSORRT_ENABLED
 
 namespace marker
 {
@@ -213,4 +214,6 @@ namespace marker
     };
 }
 
+#endif // TENSORRT_ENABLED
+
 #endif // _SUPER_GLUE_HPP_
\ No newline at end of file
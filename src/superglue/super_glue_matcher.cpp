@@ -7,83 +7,118 @@ namespace marker
     namespace trt_u = tensor_rt_utils;
 
 
-    SuperGlueMatcher::SuperGlueMatcher(const std::string& engine_path, trt_u::Logger& logger)
-        : m_super_glue(trt_u::load_engine(engine_path, logger), logger)
+    SuperGlueMatcher::SuperGlueMatcher(const std::string& engine_path, trt_u::Logger& logger, 
+        const BackendConfig& backend_cfg)
+        : m_backend(SuperGlueBackend::create(engine_path, backend_cfg, logger))
     {
-        //  Initialize CPU and GPU buffers for keypoint counts and image shapes
-        //  Use one buffer for all those parameters to copy memory only once
-        auto kcd = m_super_glue.keypoint_count_dims();
-        auto lsd = m_super_glue.left_image_shape_dims();
-        auto rsd = m_super_glue.right_image_shape_dims();
-        m_params_cpu.create(1, kcd.count + lsd.count + rsd.count, CV_32FC1);
-        m_params_gpu = cv::cuda::createContinuous(m_params_cpu.rows, m_params_cpu.cols, CV_32FC1);
-
-        //  Initialize output buffer data type and device
-        m_output.scores = tch_u::make_tensor_2d(trt_u::Dims2d(0, 0), torch::kFloat32, torch::kCUDA);
+        //  Keypoint counts and image shapes of all pairs share one buffer to copy memory only once
+        prepare_outputs(1);
     }
 
-    void SuperGlueMatcher::match(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors)
+    c10::Device SuperGlueMatcher::device() const
+    {
+        return m_backend->device();
+    }
+
+    void SuperGlueMatcher::prepare_outputs(std::size_t count)
     {
-        //  Try to resize SuperGlue bindings
-        std::array<std::int64_t, IMAGE_COUNT> keypoint_count;
-        for (int i = 0; i < IMAGE_COUNT; ++i)
+        //  Initialize output buffers data type and device
+        while (m_outputs.size() < count)
         {
-            keypoint_count[i] = keypoints[i].keypoints.size(0);
-            if (!m_super_glue.resize_bindings(i, keypoint_count[i]))
-            {
-                m_output.scores.resize_({ 1, 0, 0 });
-                return;
-            }
+            MatchTable table;
+            table.scores = tch_u::make_tensor_2d(trt_u::Dims2d(0, 0), torch::kFloat32, m_backend->device());
+            m_outputs.push_back(table);
         }
+    }
 
-        // Copy keypoint counts and image shapes to device.
-        m_params_cpu.at<float>(0, 0) = keypoint_count[0];
-        m_params_cpu.at<float>(0, 1) = keypoint_count[1];
-        m_params_cpu.at<float>(0, 2) = keypoints[0].image_size.height;
-        m_params_cpu.at<float>(0, 3) = keypoints[0].image_size.width;
-        m_params_cpu.at<float>(0, 4) = keypoints[1].image_size.height;
-        m_params_cpu.at<float>(0, 5) = keypoints[1].image_size.width;
-        m_params_gpu.upload(m_params_cpu);
-        auto kpt_count_ptr = m_params_gpu.cudaPtr();
-        auto left_img_shape_ptr = static_cast<float*>(m_params_gpu.cudaPtr()) + 2;
-        auto right_img_shape_ptr = static_cast<float*>(m_params_gpu.cudaPtr()) + 4;
-
-        //  Prepare output scores buffer
-        m_output.scores.resize_({ 1, keypoint_count[0] + 1, keypoint_count[1] + 1 });
-
-        //  Set buffer pointers and do forward
-        std::vector<void*> superglue_buffers;
-        superglue_buffers.push_back(left_img_shape_ptr);
-        superglue_buffers.push_back(right_img_shape_ptr);
-        for (const DescriptorSet& ds : descriptors)
-            superglue_buffers.push_back(ds.values.data_ptr());
-        for (const KeypointSet& ks : keypoints)
-            superglue_buffers.push_back(ks.keypoints.data_ptr());
-        for (const KeypointSet& ks : keypoints)
-            superglue_buffers.push_back(ks.scores.data_ptr());
-        superglue_buffers.push_back(kpt_count_ptr);
-        superglue_buffers.push_back(m_output.scores.data_ptr());
-        m_super_glue.execute(superglue_buffers.data());
+    void SuperGlueMatcher::upload_params(const KeypointSetArray& keypoints, const std::vector<ImagePair>& pairs)
+    {
+        m_params_cpu.create(pairs.size(), PARAMS_SIZE, CV_32FC1);
+        for (int i = 0; i < m_params_cpu.rows; ++i)
+        {
+            auto& first = keypoints[pairs[i][0]];
+            auto& second = keypoints[pairs[i][1]];
+            auto row = m_params_cpu.ptr<float>(i);
+            row[0] = first.keypoints.size(0);
+            row[1] = second.keypoints.size(0);
+            row[2] = first.image_size.height;
+            row[3] = first.image_size.width;
+            row[4] = second.image_size.height;
+            row[5] = second.image_size.width;
+        }
+
+        auto cpu_params = torch::from_blob(m_params_cpu.data, { m_params_cpu.rows, PARAMS_SIZE }, torch::kFloat32);
+        m_params = cpu_params.to(m_backend->device(), /*non_blocking=*/false, /*copy=*/true);
     }
 
-    int SuperGlueMatcher::keypoint_size() const
+    bool SuperGlueMatcher::resize_bindings(const KeypointSetArray& keypoints, const ImagePair& pair)
     {
-        return m_super_glue.keypoints_dims(0).depth;
+        for (int i = 0; i < static_cast<int>(pair.size()); ++i)
+        {
+            if (!m_backend->resize_bindings(i, keypoints[pair[i]].keypoints.size(0)))
+                return false;
+        }
+        return true;
     }
 
-    int SuperGlueMatcher::score_size() const
+    void SuperGlueMatcher::forward(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors, 
+        const std::vector<ImagePair>& pairs, std::size_t index)
     {
-        return m_super_glue.scores_dims(0).depth;
+        //  Prepare output scores buffer and forward
+        auto& pair = pairs[index];
+        auto& scores = m_outputs[index].scores;
+        scores.resize_({ 1, keypoints[pair[0]].keypoints.size(0) + 1, keypoints[pair[1]].keypoints.size(0) + 1 });
+        m_backend->forward(m_params.select(0, index), keypoints, descriptors, pair, scores);
     }
 
-    int SuperGlueMatcher::descr_size() const
+    void SuperGlueMatcher::match(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors)
     {
-        return m_super_glue.descr_dims(0).depth;
+        match(keypoints, descriptors, { ImagePair{ 0, 1 } });
+    }
+
+    //  Pairs share the detection batch and one parameters upload, but run one forward each:
+    //  keypoint counts differ per image and SuperGlue graphs take a single pair
+    void SuperGlueMatcher::match(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors, 
+        const std::vector<ImagePair>& pairs)
+    {
+        prepare_outputs(pairs.size());
+
+        // Copy keypoint counts and image shapes to device.
+        upload_params(keypoints, pairs);
+
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+        {
+            //  Try to resize SuperGlue bindings
+            if (!resize_bindings(keypoints, pairs[i]))
+                m_outputs[i].scores.resize_({ 1, 0, 0 });
+            else
+                forward(keypoints, descriptors, pairs, i);
+        }
     }
 
     const MatchTable& SuperGlueMatcher::output() const
     {
-        return m_output;
+        return m_outputs.front();
+    }
+
+    const std::vector<MatchTable>& SuperGlueMatcher::outputs() const
+    {
+        return m_outputs;
+    }
+
+    int SuperGlueMatcher::keypoint_size() const
+    {
+        return m_backend->keypoint_size();
+    }
+
+    int SuperGlueMatcher::score_size() const
+    {
+        return m_backend->score_size();
+    }
+
+    int SuperGlueMatcher::descr_size() const
+    {
+        return m_backend->descr_size();
     }
 
     //  ------------------------------------------------------------- Performance measurement utilities
@@ -97,6 +132,13 @@ namespace marker
 
     void SuperGlueMatcher::performance_test_match(const KeypointSetArray& keypoints, 
         const DescriptorSetArray& descriptors, PerformanceStats& perf_stats)
+    {
+        performance_test_match(keypoints, descriptors, { ImagePair{ 0, 1 } }, perf_stats);
+    }
+
+    void SuperGlueMatcher::performance_test_match(const KeypointSetArray& keypoints, 
+        const DescriptorSetArray& descriptors, const std::vector<ImagePair>& pairs, 
+        PerformanceStats& perf_stats)
     {
         namespace chr = std::chrono;
         using Clock = chr::steady_clock;
@@ -106,60 +148,41 @@ namespace marker
             return chr::duration_cast<chr::microseconds>(end - beg);
         };
 
-        auto on_resize_bindings = chr::steady_clock::now();
-
-        //  Try to resize SuperGlue bindings
-        std::array<std::int64_t, IMAGE_COUNT> keypoint_count;
-        for (int i = 0; i < IMAGE_COUNT; ++i)
-        {
-            keypoint_count[i] = keypoints[i].keypoints.size(0);
-            if (!m_super_glue.resize_bindings(i, keypoint_count[i]))
-            {
-                m_output.scores.resize_({ 1, 0, 0 });
-                return;
-            }
-        }
+        prepare_outputs(pairs.size());
 
         auto on_keypoint_count = chr::steady_clock::now();
 
         // Copy keypoint counts and image shapes to device.
-        m_params_cpu.at<float>(0, 0) = keypoint_count[0];
-        m_params_cpu.at<float>(0, 1) = keypoint_count[1];
-        m_params_cpu.at<float>(0, 2) = keypoints[0].image_size.height;
-        m_params_cpu.at<float>(0, 3) = keypoints[0].image_size.width;
-        m_params_cpu.at<float>(0, 4) = keypoints[1].image_size.height;
-        m_params_cpu.at<float>(0, 5) = keypoints[1].image_size.width;
-        m_params_gpu.upload(m_params_cpu);
-        auto kpt_count_ptr = m_params_gpu.cudaPtr();
-        auto left_img_shape_ptr = static_cast<float*>(m_params_gpu.cudaPtr()) + 2;
-        auto right_img_shape_ptr = static_cast<float*>(m_params_gpu.cudaPtr()) + 4;
-
-        //  Prepare output scores buffer
-        m_output.scores.resize_({ 1, keypoint_count[0] + 1, keypoint_count[1] + 1 });
-
-        auto on_forward = chr::steady_clock::now();
-
-        //  Set buffer pointers and do forward
-        std::vector<void*> superglue_buffers;
-        superglue_buffers.push_back(left_img_shape_ptr);
-        superglue_buffers.push_back(right_img_shape_ptr);
-        for (const DescriptorSet& ds : descriptors)
-            superglue_buffers.push_back(ds.values.data_ptr());
-        for (const KeypointSet& ks : keypoints)
-            superglue_buffers.push_back(ks.keypoints.data_ptr());
-        for (const KeypointSet& ks : keypoints)
-            superglue_buffers.push_back(ks.scores.data_ptr());
-        superglue_buffers.push_back(kpt_count_ptr);
-        superglue_buffers.push_back(m_output.scores.data_ptr());
-        m_super_glue.execute(superglue_buffers.data());
-
-        auto on_exit = chr::steady_clock::now();
+        upload_params(keypoints, pairs);
+
+        auto on_pairs = chr::steady_clock::now();
+
+        chr::microseconds binding_resize_duration(0);
+        chr::microseconds forward_duration(0);
+        for (std::size_t i = 0; i < pairs.size(); ++i)
+        {
+            auto on_resize_bindings = chr::steady_clock::now();
+
+            //  Try to resize SuperGlue bindings
+            bool resized = resize_bindings(keypoints, pairs[i]);
+
+            auto on_forward = chr::steady_clock::now();
+
+            if (!resized)
+                m_outputs[i].scores.resize_({ 1, 0, 0 });
+            else
+                forward(keypoints, descriptors, pairs, i);
+
+            auto on_exit = chr::steady_clock::now();
+            binding_resize_duration += diff_time(on_resize_bindings, on_forward);
+            forward_duration += diff_time(on_forward, on_exit);
+        }
 
         if (perf_stats.call_count > 0)
         {
-            perf_stats.binding_resize_duration += diff_time(on_resize_bindings, on_keypoint_count);
-            perf_stats.keypoint_count_duration += diff_time(on_keypoint_count, on_forward);
-            perf_stats.forward_duration += diff_time(on_forward, on_exit);
+            perf_stats.binding_resize_duration += binding_resize_duration;
+            perf_stats.keypoint_count_duration += diff_time(on_keypoint_count, on_pairs);
+            perf_stats.forward_duration += forward_duration;
         }
         ++perf_stats.call_count;
 
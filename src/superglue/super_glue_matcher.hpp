@@ -12,6 +12,7 @@
 #include "extract_common.hpp"
 
 #include "super_glue.hpp"
+#include "inference_backend.hpp"
 #include "tensor_rt_utils.hpp"
 #include "libtorch_utils.hpp"
 
@@ -21,15 +22,17 @@ namespace marker
     class SuperGlueMatcher
     {
     public:
-        static constexpr int IMAGE_COUNT = 2;
-
-    public:
-        SuperGlueMatcher(const std::string& engine_path, tensor_rt_utils::Logger& logger);
+        SuperGlueMatcher(const std::string& engine_path, tensor_rt_utils::Logger& logger, 
+            const BackendConfig& backend_cfg = BackendConfig());
+        c10::Device device() const;
         int keypoint_size() const;
         int score_size() const;
         int descr_size() const;
         void match(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors);
+        void match(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors, 
+            const std::vector<ImagePair>& pairs);
         const MatchTable& output() const;
+        const std::vector<MatchTable>& outputs() const;
 
     public:
         struct PerformanceStats
@@ -43,12 +46,23 @@ namespace marker
         };
         void performance_test_match(const KeypointSetArray& keypoints, 
             const DescriptorSetArray& descriptors, PerformanceStats& perf_stats);
+        void performance_test_match(const KeypointSetArray& keypoints, 
+            const DescriptorSetArray& descriptors, const std::vector<ImagePair>& pairs, 
+            PerformanceStats& perf_stats);
 
     private:
-        SuperGlue m_super_glue;
+        static constexpr int PARAMS_SIZE = 6;
+
+        void prepare_outputs(std::size_t count);
+        void upload_params(const KeypointSetArray& keypoints, const std::vector<ImagePair>& pairs);
+        bool resize_bindings(const KeypointSetArray& keypoints, const ImagePair& pair);
+        void forward(const KeypointSetArray& keypoints, const DescriptorSetArray& descriptors, 
+            const std::vector<ImagePair>& pairs, std::size_t index);
+
+        std::unique_ptr<SuperGlueBackend> m_backend;
         cv::Mat m_params_cpu;
-        cv::cuda::GpuMat m_params_gpu;
-        MatchTable m_output;
+        at::Tensor m_params;
+        std::vector<MatchTable> m_outputs;
     };
 }
 
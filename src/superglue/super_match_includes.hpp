@@ -2,10 +2,12 @@
 #define _SUPER_MATCH_INCLUDES_HPP_
 
 #include "tensor_rt_utils.hpp"
+#include "inference_backend.hpp"
 #include "super_point_detector.hpp"
 #include "keypoint_selector.hpp"
 #include "super_glue_matcher.hpp"
 #include "extract_common.hpp"
+#include "feature_cache.hpp"
 
 
 namespace marker
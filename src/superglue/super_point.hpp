@@ -3,6 +3,7 @@
 
 #include "tensor_rt_utils.hpp"
 
+#ifdef TENSORRT_ENABLED
 
 namespace marker
 {
@@ -12,15 +13,12 @@ namespace marker
         static constexpr auto NAME = "SuperPoint";
 
         static constexpr int IMAGES_BINDING_INDEX = 0;
-        static constexpr int IMAGES_BATCH_SIZE = 2;
         static constexpr int IMAGES_CHANNEL_COUNT = 1;
 
         static constexpr int SCORES_BINDING_INDEX = 1;
-        static constexpr int SCORES_BATCH_SIZE = 2;
         static constexpr int SCORES_CHANNEL_COUNT = 1;
 
         static constexpr int DESCRS_BINDING_INDEX = 2;
-        static constexpr int DESCRS_BATCH_SIZE = 2;
         static constexpr int DESCRS_CHANNEL_COUNT = 256;
 
     public:
@@ -43,6 +41,35 @@ namespace marker
             return tensor_rt_utils::Dims4d(binding_dims(DESCRS_BINDING_INDEX));
         }
 
+        //  Batch is either fixed when the engine is built or dynamic within the optimization profile
+        bool dynamic_batch() const
+        {
+            return images_dims().batch == -1;
+        }
+
+        int max_batch_size() const
+        {
+            if (!dynamic_batch())
+                return images_dims().batch;
+
+            int profile = context().getOptimizationProfile();
+            return engine().getProfileDimensions(IMAGES_BINDING_INDEX, profile, 
+                nvinfer1::OptProfileSelector::kMAX).d[0];
+        }
+
+        //  Fixed batch engines always run the full batch, surplus images are ignored
+        bool resize_batch(int count)
+        {
+            if (count < 1 || count > max_batch_size())
+                return false;
+            if (!dynamic_batch())
+                return true;
+
+            tensor_rt_utils::Dims dims = binding_dims(IMAGES_BINDING_INDEX);
+            dims.d[0] = count;
+            return context().setBindingDimensions(IMAGES_BINDING_INDEX, dims);
+        }
+
         static EngineWrapper::BindingRequirements bindings()
         {
             BindingRequirements ret(3);
@@ -50,19 +77,19 @@ namespace marker
             //  Images
             ret[IMAGES_BINDING_INDEX]
                 .is_input(true)
-                .dims({ IMAGES_BATCH_SIZE, IMAGES_CHANNEL_COUNT, -1, -1 })
+                .dims({ -1, IMAGES_CHANNEL_COUNT, -1, -1 })
                 .dtype(tensor_rt_utils::DataType::kFLOAT);
 
             //  Scores
             ret[SCORES_BINDING_INDEX]
                 .is_input(false)
-                .dims({ SCORES_BATCH_SIZE, SCORES_CHANNEL_COUNT, -1, -1 })
+                .dims({ -1, SCORES_CHANNEL_COUNT, -1, -1 })
                 .dtype(tensor_rt_utils::DataType::kFLOAT);
 
             //  Descriptors
             ret[DESCRS_BINDING_INDEX]
                 .is_input(false)
-                .dims({ DESCRS_BATCH_SIZE, DESCRS_CHANNEL_COUNT, -1, -1 })
+                .dims({ -1, DESCRS_CHANNEL_COUNT, -1, -1 })
                 .dtype(tensor_rt_utils::DataType::kFLOAT);
 
             return ret;
@@ -70,4 +97,6 @@ namespace marker
     };
 }
 
+#endif // TENSORRT_ENABLED
+
 #endif // _SUPER_POINT_HPP_
\ No newline at end of file
@@ -8,20 +8,52 @@ namespace marker
     namespace trt_u = tensor_rt_utils;
 
 
-    SuperPointDetector::SuperPointDetector(const std::string& engine_path, trt_u::Logger& logger)
-        : m_super_point(trt_u::load_engine(engine_path, logger), logger)
+    SuperPointDetector::SuperPointDetector(const std::string& engine_path, trt_u::Logger& logger, 
+        const BackendConfig& backend_cfg)
+        : m_backend(SuperPointBackend::create(engine_path, backend_cfg, logger))
     {
-        //  Input buffers init
-        auto in_dims = m_super_point.images_dims();
+        //  Input buffers init, GPU backends are fed from GpuMat and CPU ones from Mat
+        auto in_dims = m_backend->images_dims();
+        auto device = m_backend->device();
         m_input_shape = trt_u::Dims3d(in_dims.chan, in_dims.rows, in_dims.cols);
-        m_gpu_uint8.create(IMAGE_COUNT, in_dims.rows, in_dims.cols, CV_8UC1);
-        m_gpu_float.create(IMAGE_COUNT, in_dims.rows, in_dims.cols, CV_32FC1);
+        m_max_batch_size = in_dims.batch;
+        auto opt = torch::TensorOptions()
+            .dtype(torch::kFloat32)
+            .device(device)
+            .requires_grad(false);
+        if (device.is_cuda())
+        {
+            m_gpu_input.resize(m_max_batch_size);
+            m_gpu_uint8.create(m_max_batch_size, in_dims.rows, in_dims.cols, CV_8UC1);
+            m_gpu_float.create(m_max_batch_size, in_dims.rows, in_dims.cols, CV_32FC1);
+            m_images = torch::from_blob(m_gpu_float.content.cudaPtr(), 
+                { m_max_batch_size, 1, in_dims.rows, in_dims.cols }, opt);
+        }
+        else
+        {
+            m_cpu_input.resize(m_max_batch_size);
+            m_cpu_float.create(m_max_batch_size * in_dims.rows, in_dims.cols, CV_32FC1);
+            m_images = torch::from_blob(m_cpu_float.data, 
+                { m_max_batch_size, 1, in_dims.rows, in_dims.cols }, opt);
+        }
         
         //  Output buffers init
-        auto score_map_dims = m_super_point.scores_dims();
-        auto descr_map_dims = m_super_point.descrs_dims();
-        m_score_map.init(score_map_dims, torch::kFloat32, torch::kCUDA);
-        m_descr_map.values = tch_u::make_tensor_4d(descr_map_dims, torch::kFloat32, torch::kCUDA);
+        auto score_map_dims = m_backend->scores_dims();
+        auto descr_map_dims = m_backend->descrs_dims();
+        m_score_buffer = tch_u::make_tensor_4d(score_map_dims, torch::kFloat32, device);
+        m_descr_buffer = tch_u::make_tensor_4d(descr_map_dims, torch::kFloat32, device);
+        m_score_map.values = m_score_buffer;
+        m_descr_map.values = m_descr_buffer;
+    }
+
+    c10::Device SuperPointDetector::device() const
+    {
+        return m_backend->device();
+    }
+
+    int SuperPointDetector::max_batch_size() const
+    {
+        return m_max_batch_size;
     }
 
     const trt_u::Dims3d& SuperPointDetector::input_shape() const
@@ -31,12 +63,12 @@ namespace marker
 
     tensor_rt_utils::Dims4d SuperPointDetector::scores_shape() const
     {
-        return m_super_point.scores_dims();
+        return m_backend->scores_dims();
     }
 
     tensor_rt_utils::Dims4d SuperPointDetector::descriptors_shape() const
     {
-        return m_super_point.descrs_dims();
+        return m_backend->descrs_dims();
     }
 
     const ScoreMap& SuperPointDetector::score_map() const
@@ -51,41 +83,77 @@ namespace marker
 
     void SuperPointDetector::detect(const cv::Mat& first, const cv::Mat& second)
     {
-        //  Copy to device, possibly using intermediate buffers (m_gpu_input) to resize on GPU
-        if (first.rows != m_input_shape.rows || first.cols != m_input_shape.cols)
+        detect({ first, second });
+    }
+
+    void SuperPointDetector::detect(const std::vector<cv::Mat>& images)
+    {
+        upload(images);
+        forward(images);
+    }
+
+    void SuperPointDetector::upload(const std::vector<cv::Mat>& images)
+    {
+        if (images.empty() || static_cast<int>(images.size()) > m_max_batch_size)
+            throw std::runtime_error("SuperPoint batch size is out of the detector range");
+
+        for (int i = 0; i < static_cast<int>(images.size()); ++i)
         {
-            if (first.rows != m_gpu_input[0].rows || first.cols != m_gpu_input[0].cols)
-                m_gpu_input[0].create(first.rows, first.cols, first.type());
-            m_gpu_input[0].upload(first);
-            cv::cuda::resize(m_gpu_input[0], m_gpu_uint8.header[0], 
-                cv::Size(m_input_shape.cols, m_input_shape.rows));
+            if (m_backend->device().is_cuda())
+                upload_gpu(i, images[i]);
+            else
+                upload_cpu(i, images[i]);
         }
-        else
-            m_gpu_uint8.header[0].upload(first);    
-        if (second.rows != m_input_shape.rows || second.cols != m_input_shape.cols)
+    }
+
+    void SuperPointDetector::forward(const std::vector<cv::Mat>& images)
+    {
+        //  Narrow the maps to the batch so consumers only see the images just detected
+        auto count = static_cast<std::int64_t>(images.size());
+        m_score_map.values = m_score_buffer.narrow(0, 0, count);
+        m_descr_map.values = m_descr_buffer.narrow(0, 0, count);
+        m_backend->forward(m_images.narrow(0, 0, count), m_score_map.values, m_descr_map.values);
+
+        m_score_map.image_size.resize(images.size());
+        for (std::size_t i = 0; i < images.size(); ++i)
+        {
+            m_score_map.image_size[i].width = images[i].cols;
+            m_score_map.image_size[i].height = images[i].rows;
+        }
+    }
+
+    void SuperPointDetector::upload_gpu(int index, const cv::Mat& image)
+    {
+        //  Copy to device, possibly using intermediate buffers (m_gpu_input) to resize on GPU
+        if (image.rows != m_input_shape.rows || image.cols != m_input_shape.cols)
         {
-            if (second.rows != m_gpu_input[1].rows || second.cols != m_gpu_input[1].cols)
-                m_gpu_input[1].create(second.rows, second.cols, second.type());
-            m_gpu_input[1].upload(second);
-            cv::cuda::resize(m_gpu_input[1], m_gpu_uint8.header[1], 
+            if (image.rows != m_gpu_input[index].rows || image.cols != m_gpu_input[index].cols)
+                m_gpu_input[index].create(image.rows, image.cols, image.type());
+            m_gpu_input[index].upload(image);
+            cv::cuda::resize(m_gpu_input[index], m_gpu_uint8.header[index], 
                 cv::Size(m_input_shape.cols, m_input_shape.rows));
         }
         else
-            m_gpu_uint8.header[1].upload(second);   
+            m_gpu_uint8.header[index].upload(image);
 
         //  Convert to float in range [0, 255]
-        for (int i = 0; i < IMAGE_COUNT; ++i)
-            m_gpu_uint8.header[i].convertTo(m_gpu_float.header[i], m_gpu_float.header[i].type(), 1.f / 255);
+        m_gpu_uint8.header[index].convertTo(m_gpu_float.header[index], 
+            m_gpu_float.header[index].type(), 1.f / 255);
+    }
 
-        //  Forward
-        void* buffers[] = { m_gpu_float.content.cudaPtr(), 
-            m_score_map.values.data_ptr(), m_descr_map.values.data_ptr() };
-        m_super_point.execute(buffers);
+    void SuperPointDetector::upload_cpu(int index, const cv::Mat& image)
+    {
+        //  Resize into intermediate buffer (m_cpu_input) and convert straight into the batch
+        cv::Mat src = image;
+        if (image.rows != m_input_shape.rows || image.cols != m_input_shape.cols)
+        {
+            cv::resize(image, m_cpu_input[index], cv::Size(m_input_shape.cols, m_input_shape.rows));
+            src = m_cpu_input[index];
+        }
 
-        m_score_map.image_size[0].width = first.cols;
-        m_score_map.image_size[0].height = first.rows;
-        m_score_map.image_size[1].width = second.cols;
-        m_score_map.image_size[1].height = second.rows;
+        //  Convert to float in range [0, 255]
+        cv::Mat dst = m_cpu_float.rowRange(index * m_input_shape.rows, (index + 1) * m_input_shape.rows);
+        src.convertTo(dst, CV_32FC1, 1.f / 255);
     }
 
 
@@ -99,6 +167,12 @@ namespace marker
 
     void SuperPointDetector::performance_test_detect(const cv::Mat& first, const cv::Mat& second, 
             PerformanceStats& perf_stats)
+    {
+        performance_test_detect({ first, second }, perf_stats);
+    }
+
+    void SuperPointDetector::performance_test_detect(const std::vector<cv::Mat>& images, 
+            PerformanceStats& perf_stats)
     {
         namespace chr = std::chrono;
         using Clock = chr::steady_clock;
@@ -111,39 +185,16 @@ namespace marker
 
         auto on_preprocess = chr::steady_clock::now();
 
-                //  Copy to device, possibly using intermediate buffers (m_gpu_input) to resize on GPU
-        if (first.rows != m_input_shape.rows || first.cols != m_input_shape.cols)
-        {
-            if (first.rows != m_gpu_input[0].rows || first.cols != m_gpu_input[0].cols)
-                m_gpu_input[0].create(first.rows, first.cols, first.type());
-            m_gpu_input[0].upload(first);
-            cv::cuda::resize(m_gpu_input[0], m_gpu_uint8.header[0], 
-                cv::Size(m_input_shape.cols, m_input_shape.rows));
-        }
-        else
-            m_gpu_uint8.header[0].upload(first);    
-        if (second.rows != m_input_shape.rows || second.cols != m_input_shape.cols)
-        {
-            if (second.rows != m_gpu_input[1] .rows || second.cols != m_gpu_input[1].cols)
-                m_gpu_input[1].create(second.rows, second.cols, second.type());
-            m_gpu_input[1].upload(second);
-            cv::cuda::resize(m_gpu_input[1], m_gpu_uint8.header[1], 
-                cv::Size(m_input_shape.cols, m_input_shape.rows));
-        }
-        else
-            m_gpu_uint8.header[1].upload(second);    
-
-        //  Convert to float in range [0, 255]
-        for (int i = 0; i < IMAGE_COUNT; ++i)
-            m_gpu_uint8.header[i].convertTo(m_gpu_float.header[i], m_gpu_float.header[i].type(), 1.f / 255);
+        upload(images);
 
         auto on_forward = chr::steady_clock::now();
 
         //  Forward
-        void* buffers[] = { m_gpu_float.content.cudaPtr(), 
-            m_score_map.values.data_ptr(), m_descr_map.values.data_ptr() };
-        m_super_point.execute(buffers);
-        cudaDeviceSynchronize();
+        forward(images);
+#ifdef TENSORRT_ENABLED
+        if (m_backend->device().is_cuda())
+            cudaDeviceSynchronize();
+#endif
 
         auto on_exit = chr::steady_clock::now();
         if (perf_stats.call_count > 0)
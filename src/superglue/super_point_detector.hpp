@@ -7,6 +7,7 @@
 #include <chrono>
 
 #include "opencv2/core.hpp"
+#include "opencv2/imgproc.hpp"
 #include "opencv2/cudaarithm.hpp"
 #include "opencv2/cudaimgproc.hpp"
 #include "opencv2/cudawarping.hpp"
@@ -15,6 +16,7 @@
 
 #include "extract_common.hpp"
 #include "super_point.hpp"
+#include "inference_backend.hpp"
 #include "tensor_rt_utils.hpp"
 #include "libtorch_utils.hpp"
 #include "gpu_mat_batch.hpp"
@@ -24,10 +26,10 @@ namespace marker
     class SuperPointDetector
     {
     public:
-        static constexpr int IMAGE_COUNT = 2;
-
-    public:
-        SuperPointDetector(const std::string& engine_path, tensor_rt_utils::Logger& logger);
+        SuperPointDetector(const std::string& engine_path, tensor_rt_utils::Logger& logger, 
+            const BackendConfig& backend_cfg = BackendConfig());
+        c10::Device device() const;
+        int max_batch_size() const;
         const tensor_rt_utils::Dims3d& input_shape() const;
         tensor_rt_utils::Dims4d scores_shape() const;
         tensor_rt_utils::Dims4d descriptors_shape() const;
@@ -35,6 +37,7 @@ namespace marker
         //     const cv::Mat& second, const cv::Mat& second_mask);
 
         void detect(const cv::Mat& first, const cv::Mat& second);
+        void detect(const std::vector<cv::Mat>& images);
 
         const ScoreMap& score_map() const;
         const DescriptorMap& descriptor_map() const;
@@ -50,13 +53,24 @@ namespace marker
         };
         void performance_test_detect(const cv::Mat& first, const cv::Mat& second, 
             PerformanceStats& perf_stats);
+        void performance_test_detect(const std::vector<cv::Mat>& images, 
+            PerformanceStats& perf_stats);
 
     private:
-        SuperPoint m_super_point;
+        void upload(const std::vector<cv::Mat>& images);
+        void upload_cpu(int index, const cv::Mat& image);
+        void upload_gpu(int index, const cv::Mat& image);
+        void forward(const std::vector<cv::Mat>& images);
+
+        std::unique_ptr<SuperPointBackend> m_backend;
         tensor_rt_utils::Dims3d m_input_shape;
-        std::array<cv::cuda::GpuMat, IMAGE_COUNT> m_gpu_input;      
+        int m_max_batch_size;
+        std::vector<cv::cuda::GpuMat> m_gpu_input;      
         GpuMatBatch m_gpu_uint8;
         GpuMatBatch m_gpu_float;
+        std::vector<cv::Mat> m_cpu_input;
+        cv::Mat m_cpu_float;
+        at::Tensor m_images;
         // std::array<at::Tensor, IMAGE_COUNT> m_input_masks;
 
         // at::Tensor m_score_map;
@@ -65,6 +79,10 @@ namespace marker
         // at::Tensor m_descr_map;
 
         // KeypointSetArray m_output;
+
+        //  Buffers have the full batch capacity, maps are their views of the last batch
+        at::Tensor m_score_buffer;
+        at::Tensor m_descr_buffer;
         ScoreMap m_score_map;
         DescriptorMap m_descr_map;
     };
@@ -11,14 +11,17 @@
 #include <stdexcept>
 #include <memory>
 
+#ifdef TENSORRT_ENABLED
 #include "NvInfer.h"
 #include "NvOnnxParser.h"
 
 #include "cuda_runtime.h"
+#endif
 
 
 namespace tensor_rt_utils
 {
+#ifdef TENSORRT_ENABLED
     /*! 
         Deleter для std::unique_ptr на объекты классов 
         TensorRT, имеющих метод destroy()
@@ -59,6 +62,33 @@ namespace tensor_rt_utils
 
     using Dims = nvinfer1::Dims;
     using DataType = nvinfer1::DataType;
+#else
+    //  Builds without TensorRT keep the dims and loggers of the CPU backend on these
+    struct Dims
+    {
+        static constexpr int MAX_DIMS = 8;
+
+        int nbDims;
+        int d[MAX_DIMS];
+    };
+
+    class Logger
+    {
+    public:
+        enum class Severity
+        {
+            kINTERNAL_ERROR,
+            kERROR,
+            kWARNING,
+            kINFO,
+            kVERBOSE
+        };
+
+        virtual ~Logger() = default;
+
+        virtual void log(Severity severity, const char* msg) = 0;
+    };
+#endif
 
     struct ShapeSpec
     {
@@ -232,6 +262,7 @@ namespace tensor_rt_utils
         return !(first == second);
     }
 
+#ifdef TENSORRT_ENABLED
     /*! 
         \brief Обёртка для создания IBuilder
         \param logger Логгер
@@ -455,6 +486,7 @@ namespace tensor_rt_utils
         EnginePtr m_engine;
         ContextPtr m_context;
     };
+#endif
 
     //! Вывод уровня логгирования в std::ostream
     inline std::ostream& operator<<(std::ostream &out, Logger::Severity severity)
@@ -480,6 +512,7 @@ namespace tensor_rt_utils
         return out;
     }
 
+#ifdef TENSORRT_ENABLED
     inline std::ostream& operator<<(std::ostream& out, DataType dtype)
     {
         switch (dtype)
@@ -502,6 +535,7 @@ namespace tensor_rt_utils
         }
         return out;
     }
+#endif
 
     inline std::ostream& operator<<(std::ostream& out, Dims dims)
     {